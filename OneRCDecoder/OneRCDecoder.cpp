@@ -0,0 +1,325 @@
+/**
+ *******************************************************************************
+ *      ______  _   __  ______  ____     ______        ___    ______   ____
+ *     / __  / / \ / / / ____/ / __ \   /  ___/       /  /   /_   _/  / __ \
+ *    / /_/ / /   \ / / ____/ /  -- /  /  /__   __   /  /__  _/  /_  / __ <
+ *   /_____/ /_/ \_/ /_____/ /__/ \_\ /_____/  /_/  /_____/ /_____/ /_____/
+ *
+ *     An amateur remote control software library. Use at your own risk.
+ *
+ * @file    OneRCDecoder.cpp
+ * @brief   Ground side MP frame decoder, converts captured telemetry (or a live
+ *          serial stream) to one CSV file per frame type.
+ * @author  Y.S.Kuo in Hsinchu
+ *******************************************************************************
+ */
+
+/*
+ * Build:
+ *      g++ -std=c++11 -O2 -pthread -I../OneRCFW/libraries/OneRCLib \
+ *          -o OneRCDecoder OneRCDecoder.cpp mp_parser.cpp mp_output.cpp
+ *
+ * Tables (OneRCGUI):
+ *      python MP_layout.py -o mp_layout.txt
+ *      python MP_log.py -o mp_log_table.txt
+ *
+ * Usage:
+ *      OneRCDecoder -l mp_layout.txt -t mp_log_table.txt -o flight1 capture.bin
+ *      stty -F /dev/ttyUSB0 500000 raw; OneRCDecoder -l mp_layout.txt -o - /dev/ttyUSB0
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "mcu_protocol.h"
+#include "mp_parser.h"
+#include "mp_output.h"
+
+
+/*
+ *******************************************************************************
+ * Constant value definition
+ *******************************************************************************
+ */
+
+#define DECODER_STREAM_BUF_SIZE     4096
+
+
+/*
+ *******************************************************************************
+ * Private functions declaration
+ *******************************************************************************
+ */
+
+static void Decoder_Usage(const char *p_name);
+static int8_t Decoder_DecodeFile(const char *p_path, unsigned thread_num, MPOUT_WRITER *p_writer,
+                                 MPDEC_CHUNK *p_result);
+static void Decoder_DecodeStream(FILE *p_input, MPOUT_WRITER *p_writer, uint64_t *p_crc_err_cnt,
+                                 uint64_t *p_input_size);
+
+
+/*
+ *******************************************************************************
+ * Public functions
+ *******************************************************************************
+ */
+
+int main(int argc, char *argv[])
+{
+    MPOUT_WRITER writer;
+    MPDEC_CHUNK result;
+    const char *p_layout_path;
+    const char *p_log_path;
+    const char *p_prefix;
+    const char *p_input_path;
+    unsigned thread_num;
+    uint64_t crc_err_cnt;
+    uint64_t input_size;
+    struct stat input_stat;
+    std::chrono::steady_clock::time_point start_time;
+    int arg_idx;
+
+    p_layout_path = NULL;
+    p_log_path = NULL;
+    p_prefix = "mp";
+    p_input_path = NULL;
+    thread_num = std::max(1U, std::thread::hardware_concurrency());
+
+    for(arg_idx = 1; arg_idx < argc; arg_idx++){
+        if(strcmp(argv[arg_idx], "-j") == 0 && arg_idx + 1 < argc)
+            thread_num = std::max(1, atoi(argv[++arg_idx]));
+        else if(strcmp(argv[arg_idx], "-l") == 0 && arg_idx + 1 < argc)
+            p_layout_path = argv[++arg_idx];
+        else if(strcmp(argv[arg_idx], "-t") == 0 && arg_idx + 1 < argc)
+            p_log_path = argv[++arg_idx];
+        else if(strcmp(argv[arg_idx], "-o") == 0 && arg_idx + 1 < argc)
+            p_prefix = argv[++arg_idx];
+        else if(p_input_path == NULL && (argv[arg_idx][0] != '-' || argv[arg_idx][1] == 0))
+            p_input_path = argv[arg_idx];
+        else{
+            Decoder_Usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if(p_input_path == NULL){
+        Decoder_Usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    MPOut_Init(p_prefix, &writer);
+
+    if(p_layout_path != NULL && MPOut_LoadLayout(p_layout_path, &writer) != 0){
+        fprintf(stderr, "Unable to load layout %s\n", p_layout_path);
+        return EXIT_FAILURE;
+    }
+
+    if(p_log_path != NULL && MPOut_LoadLogTable(p_log_path, &writer) != 0){
+        fprintf(stderr, "Unable to load log table %s\n", p_log_path);
+        return EXIT_FAILURE;
+    }
+
+    start_time = std::chrono::steady_clock::now();
+
+    /* Serial port, pipe or stdin is decoded as it comes */
+    if(strcmp(p_input_path, "-") == 0){
+        Decoder_DecodeStream(stdin, &writer, &crc_err_cnt, &input_size);
+    }
+    else if(stat(p_input_path, &input_stat) != 0){
+        fprintf(stderr, "Unable to open %s\n", p_input_path);
+        return EXIT_FAILURE;
+    }
+    else if(S_ISREG(input_stat.st_mode) == false){
+        FILE *p_input = fopen(p_input_path, "rb");
+        if(p_input == NULL){
+            fprintf(stderr, "Unable to open %s\n", p_input_path);
+            return EXIT_FAILURE;
+        }
+        Decoder_DecodeStream(p_input, &writer, &crc_err_cnt, &input_size);
+        fclose(p_input);
+    }
+    else{
+        if(Decoder_DecodeFile(p_input_path, thread_num, &writer, &result) != 0){
+            fprintf(stderr, "Unable to read %s\n", p_input_path);
+            return EXIT_FAILURE;
+        }
+        crc_err_cnt = result.crc_err_cnt;
+        input_size = result.end;
+    }
+
+    MPOut_Close(&writer);
+
+    fprintf(stderr, "Bytes %llu, frames %llu, CRC err %llu, seq err %llu, unknown %llu, %.2f s\n",
+            (unsigned long long)input_size, (unsigned long long)writer.frm_cnt,
+            (unsigned long long)crc_err_cnt, (unsigned long long)writer.seq_err_cnt,
+            (unsigned long long)writer.unknown_cnt,
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count());
+
+    return EXIT_SUCCESS;
+}
+
+
+/*
+ *******************************************************************************
+ * Private functions
+ *******************************************************************************
+ */
+
+/**
+ * Decoder_Usage - Function to print command line usage.
+ *
+ * @param   [in]        *p_name     Program name.
+ *
+ * @return  [none]
+ *
+ */
+static void Decoder_Usage(const char *p_name)
+{
+    fprintf(stderr, "Usage: %s [-j threads] [-l layout] [-t log_table] [-o prefix|-] input|-\n", p_name);
+    fprintf(stderr, "  -l layout     Frame layout table of MP_layout.py, raw payload only if not set\n");
+    fprintf(stderr, "  -t log_table  Log format table of MP_log.py\n");
+    fprintf(stderr, "  -o prefix     Output \"<prefix>_<FRAME>.csv\", \"-\" for stdout (default \"mp\")\n");
+    fprintf(stderr, "  input         Captured file (parsed by all threads), serial port or \"-\" for stdin\n");
+}
+
+/**
+ * Decoder_DecodeFile - Function to decode a captured file, the file is mapped
+ *                      to memory and parsed by several threads.
+ *
+ * @param   [in]        *p_path     Input file.
+ * @param   [in]        thread_num  Max threads.
+ * @param   [in/out]    *p_writer   Output writer.
+ * @param   [out]       *p_result   Parsed frames.
+ *
+ * @return  [int8_t]    Function executing result.
+ * @retval  [0]         Success.
+ * @retval  [-1]        Fail.
+ *
+ */
+static int8_t Decoder_DecodeFile(const char *p_path, unsigned thread_num, MPOUT_WRITER *p_writer,
+                                 MPDEC_CHUNK *p_result)
+{
+    const uint8_t *p_data;
+    uint64_t data_size;
+    size_t frame_idx;
+    MPDEC_FRAME *p_frame;
+
+#if defined(_WIN32)
+    std::vector<uint8_t> file_buf;
+    FILE *p_file;
+    long file_size;
+
+    p_file = fopen(p_path, "rb");
+    if(p_file == NULL)
+        return -1;
+
+    fseek(p_file, 0, SEEK_END);
+    file_size = ftell(p_file);
+    fseek(p_file, 0, SEEK_SET);
+
+    file_buf.resize(file_size > 0 ? file_size : 1);
+    data_size = fread(&file_buf[0], 1, file_size, p_file);
+    fclose(p_file);
+
+    p_data = &file_buf[0];
+#else
+    struct stat file_stat;
+    int file_fd;
+
+    file_fd = open(p_path, O_RDONLY);
+    if(file_fd < 0)
+        return -1;
+
+    if(fstat(file_fd, &file_stat) != 0){
+        close(file_fd);
+        return -1;
+    }
+
+    data_size = file_stat.st_size;
+    p_data = NULL;
+
+    if(data_size != 0){
+        p_data = (const uint8_t *)mmap(NULL, data_size, PROT_READ, MAP_PRIVATE, file_fd, 0);
+        if(p_data == MAP_FAILED){
+            close(file_fd);
+            return -1;
+        }
+    }
+#endif
+
+    MPDec_ParseParallel(p_data, data_size, thread_num, p_result);
+
+    for(frame_idx = 0; frame_idx < p_result->frames.size(); frame_idx++){
+        p_frame = &p_result->frames[frame_idx];
+        MPOut_WriteFrame(p_writer, p_frame->offset, p_frame->cmd, p_frame->sequence,
+                         p_result->payload.data() + p_frame->payload_idx, p_frame->len);
+    }
+
+#if !defined(_WIN32)
+    if(p_data != NULL)
+        munmap((void *)p_data, data_size);
+
+    close(file_fd);
+#endif
+
+    return 0;
+}
+
+/**
+ * Decoder_DecodeStream - Function to decode serial port, pipe or stdin until
+ *                        end of input, each frame is written once it is
+ *                        received.
+ *
+ * @param   [in]        *p_input        Input stream.
+ * @param   [in/out]    *p_writer       Output writer.
+ * @param   [out]       *p_crc_err_cnt  Total CRC errors.
+ * @param   [out]       *p_input_size   Total input bytes.
+ *
+ * @return  [none]
+ *
+ */
+static void Decoder_DecodeStream(FILE *p_input, MPOUT_WRITER *p_writer, uint64_t *p_crc_err_cnt,
+                                 uint64_t *p_input_size)
+{
+    MPDEC_PARSER parser;
+    MP_FRAME_HDR *p_frm_hdr;
+    uint8_t input_buf[DECODER_STREAM_BUF_SIZE];
+    size_t read_size;
+    size_t idx;
+    uint64_t offset;
+
+    MPDec_Init(&parser);
+    p_frm_hdr = (MP_FRAME_HDR *)parser.frm_buf;
+    offset = 0;
+
+    /* Read what is available, don't wait for a full buffer of slow link */
+    setvbuf(p_input, NULL, _IONBF, 0);
+
+    while((read_size = fread(input_buf, 1, sizeof(input_buf), p_input)) > 0){
+
+        for(idx = 0; idx < read_size; idx++, offset++){
+            if(MPDec_Put(&parser, input_buf[idx], offset))
+                MPOut_WriteFrame(p_writer, parser.frm_offset, p_frm_hdr->cmd, p_frm_hdr->sequence,
+                                 p_frm_hdr->payload, p_frm_hdr->len);
+        }
+
+        fflush(NULL);
+    }
+
+    *p_crc_err_cnt = parser.crc_err_cnt;
+    *p_input_size = offset;
+}
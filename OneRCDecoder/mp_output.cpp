@@ -0,0 +1,761 @@
+/**
+ *******************************************************************************
+ *      ______  _   __  ______  ____     ______        ___    ______   ____
+ *     / __  / / \ / / / ____/ / __ \   /  ___/       /  /   /_   _/  / __ \
+ *    / /_/ / /   \ / / ____/ /  -- /  /  /__   __   /  /__  _/  /_  / __ <
+ *   /_____/ /_/ \_/ /_____/ /__/ \_\ /_____/  /_/  /_____/ /_____/ /_____/
+ *
+ *     An amateur remote control software library. Use at your own risk.
+ *
+ * @file    mp_output.cpp
+ * @brief
+ * @author  Y.S.Kuo in Hsinchu
+ *******************************************************************************
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "mcu_protocol.h"
+#include "mp_output.h"
+
+
+/*
+ *******************************************************************************
+ * Private functions declaration
+ *******************************************************************************
+ */
+
+static void MPOut_WritePayload(MPOUT_WRITER *p_writer, uint64_t offset, uint8_t cmd, uint8_t sequence,
+                               const uint8_t *p_payload, uint8_t len);
+static FILE *MPOut_GetFile(MPOUT_WRITER *p_writer, const std::string &name, const std::string &header);
+static uint8_t MPOut_FieldSize(char type);
+static std::string MPOut_FormatField(char type, const uint8_t *p_data);
+static bool MPOut_GetVarint(const uint8_t *p_data, uint8_t len, uint8_t *p_idx, uint32_t *p_value);
+static void MPOut_WriteCompact(MPOUT_WRITER *p_writer, MPOUT_LAYOUT *p_layout, uint64_t offset,
+                               uint8_t sequence, const uint8_t *p_payload, uint8_t len);
+static void MPOut_WriteLog(MPOUT_WRITER *p_writer, uint64_t offset, uint8_t sequence,
+                           const uint8_t *p_payload, uint8_t len);
+static std::string MPOut_ExpandLog(const std::string &fmt, const uint8_t *p_args, uint8_t len);
+static std::string MPOut_Unescape(const std::string &str);
+static std::string MPOut_Quote(const std::string &str);
+static std::vector<std::string> MPOut_Split(const std::string &str, char delim);
+
+
+/*
+ *******************************************************************************
+ * Public functions
+ *******************************************************************************
+ */
+
+/**
+ * MPOut_LoadLayout - Function to load payload layout table of MP_layout.py.
+ *
+ * @param   [in]        *p_path     Layout table file.
+ * @param   [in/out]    *p_writer   Output writer.
+ *
+ * @return  [int8_t]    Function executing result.
+ * @retval  [0]         Success.
+ * @retval  [-1]        Fail.
+ *
+ */
+int8_t MPOut_LoadLayout(const char *p_path, MPOUT_WRITER *p_writer)
+{
+    FILE *p_file;
+    char line[1024];
+    std::vector<std::string> columns;
+    std::vector<std::string> scales;
+    MPOUT_LAYOUT layout;
+    size_t idx;
+
+    p_file = fopen(p_path, "r");
+    if(p_file == NULL)
+        return -1;
+
+    while(fgets(line, sizeof(line), p_file) != NULL){
+
+        line[strcspn(line, "\r\n")] = 0;
+        columns = MPOut_Split(line, '\t');
+
+        if(columns.size() < 4 || columns[0].empty() || columns[0][0] == '#')
+            continue;
+
+        layout.name = columns[1];
+        layout.is_compact = (columns[2][0] == MPOUT_COMPACT_FLAG);
+        layout.format = layout.is_compact ? columns[2].substr(1) : columns[2];
+        layout.fields = MPOut_Split(columns[3], ',');
+        layout.scales.clear();
+        layout.size = 0;
+
+        if(layout.is_compact){
+            scales = MPOut_Split(columns.size() > 4 ? columns[4] : "", ',');
+            for(idx = 0; idx < layout.format.size(); idx++)
+                layout.scales.push_back(idx < scales.size() ? atof(scales[idx].c_str()) : 1.0);
+        }
+        else{
+            for(idx = 0; idx < layout.format.size(); idx++)
+                layout.size += MPOut_FieldSize(layout.format[idx]);
+        }
+
+        p_writer->layouts[(uint8_t)atoi(columns[0].c_str())] = layout;
+    }
+
+    fclose(p_file);
+
+    return p_writer->layouts.empty() ? -1 : 0;
+}
+
+/**
+ * MPOut_LoadLogTable - Function to load log format table of MP_log.py.
+ *
+ * @param   [in]        *p_path     Log table file, "ID<TAB>format" per line.
+ * @param   [in/out]    *p_writer   Output writer.
+ *
+ * @return  [int8_t]    Function executing result.
+ * @retval  [0]         Success.
+ * @retval  [-1]        Fail.
+ *
+ */
+int8_t MPOut_LoadLogTable(const char *p_path, MPOUT_WRITER *p_writer)
+{
+    FILE *p_file;
+    char line[1024];
+    char *p_tab;
+
+    p_file = fopen(p_path, "r");
+    if(p_file == NULL)
+        return -1;
+
+    while(fgets(line, sizeof(line), p_file) != NULL){
+
+        line[strcspn(line, "\r\n")] = 0;
+
+        p_tab = strchr(line, '\t');
+        if(p_tab == NULL)
+            continue;
+
+        *p_tab = 0;
+        p_writer->log_table[(uint16_t)strtoul(line, NULL, 16)] = MPOut_Unescape(p_tab + 1);
+    }
+
+    fclose(p_file);
+
+    return 0;
+}
+
+/**
+ * MPOut_Init - Function to initialize output writer.
+ *
+ * @param   [in]        *p_prefix   Output file name prefix, "<prefix>_<NAME>.csv".
+ * @param   [out]       *p_writer   Output writer.
+ *
+ * @return  [none]
+ *
+ */
+void MPOut_Init(const char *p_prefix, MPOUT_WRITER *p_writer)
+{
+    p_writer->prefix = p_prefix;
+    p_writer->layouts.clear();
+    p_writer->log_table.clear();
+    p_writer->files.clear();
+    p_writer->compact_val.clear();
+    p_writer->compact_is_valid.clear();
+
+    p_writer->is_first_frm = true;
+    p_writer->last_sequence = 0;
+    p_writer->frm_cnt = 0;
+    p_writer->seq_err_cnt = 0;
+    p_writer->unknown_cnt = 0;
+}
+
+/**
+ * MPOut_WriteFrame - Function to write one frame to CSV file of its type.
+ *
+ * Records of container frame are written as frames with sequence of the
+ * container, log frame is expanded to text.
+ *
+ * @param   [in/out]    *p_writer   Output writer.
+ * @param   [in]        offset      Input offset of the frame.
+ * @param   [in]        cmd         Frame command.
+ * @param   [in]        sequence    Frame sequence.
+ * @param   [in]        *p_payload  Frame payload.
+ * @param   [in]        len         Payload length.
+ *
+ * @return  [none]
+ *
+ */
+void MPOut_WriteFrame(MPOUT_WRITER *p_writer, uint64_t offset, uint8_t cmd, uint8_t sequence,
+                      const uint8_t *p_payload, uint8_t len)
+{
+    const MP_RECORD_HDR *p_record;
+    uint8_t idx;
+
+    p_writer->frm_cnt++;
+
+    if(p_writer->is_first_frm == false && (uint8_t)(p_writer->last_sequence + 1) != sequence)
+        p_writer->seq_err_cnt++;
+
+    p_writer->is_first_frm = false;
+    p_writer->last_sequence = sequence;
+
+    if(cmd != MP_RSP_SYS_CONTAINER){
+        MPOut_WritePayload(p_writer, offset, cmd, sequence, p_payload, len);
+        return;
+    }
+
+    /* Records share the sequence of container */
+    for(idx = 0; idx + sizeof(MP_RECORD_HDR) <= len; idx += sizeof(MP_RECORD_HDR) + p_record->len){
+        p_record = (const MP_RECORD_HDR *)&p_payload[idx];
+
+        if(idx + sizeof(MP_RECORD_HDR) + p_record->len > len || p_record->tag == MP_RSP_SYS_CONTAINER){
+            p_writer->unknown_cnt++;
+            break;
+        }
+
+        MPOut_WritePayload(p_writer, offset, p_record->tag, sequence,
+                           &p_payload[idx + sizeof(MP_RECORD_HDR)], p_record->len);
+    }
+}
+
+
+/**
+ * MPOut_Close - Function to close all output files.
+ *
+ * @param   [in/out]    *p_writer   Output writer.
+ *
+ * @return  [none]
+ *
+ */
+void MPOut_Close(MPOUT_WRITER *p_writer)
+{
+    std::map<std::string, FILE *>::iterator file_it;
+
+    for(file_it = p_writer->files.begin(); file_it != p_writer->files.end(); file_it++){
+        if(file_it->second != stdout)
+            fclose(file_it->second);
+    }
+
+    p_writer->files.clear();
+}
+
+
+/*
+ *******************************************************************************
+ * Private functions
+ *******************************************************************************
+ */
+
+/**
+ * MPOut_WritePayload - Function to write payload of one frame (or record) to
+ *                      CSV file of its type.
+ *
+ * @param   [in/out]    *p_writer   Output writer.
+ * @param   [in]        offset      Input offset of the frame.
+ * @param   [in]        cmd         Frame command.
+ * @param   [in]        sequence    Frame sequence.
+ * @param   [in]        *p_payload  Frame payload.
+ * @param   [in]        len         Payload length.
+ *
+ * @return  [none]
+ *
+ */
+static void MPOut_WritePayload(MPOUT_WRITER *p_writer, uint64_t offset, uint8_t cmd, uint8_t sequence,
+                               const uint8_t *p_payload, uint8_t len)
+{
+    std::map<uint8_t, MPOUT_LAYOUT>::iterator layout_it;
+    std::string header;
+    std::string row;
+    FILE *p_file;
+    uint8_t idx;
+    size_t field_idx;
+    char hex[3];
+
+    if(cmd == MP_RSP_SYS_LOG){
+        MPOut_WriteLog(p_writer, offset, sequence, p_payload, len);
+        return;
+    }
+
+    layout_it = p_writer->layouts.find(cmd);
+
+    if(layout_it != p_writer->layouts.end() && layout_it->second.is_compact){
+        MPOut_WriteCompact(p_writer, &layout_it->second, offset, sequence, p_payload, len);
+        return;
+    }
+
+    /* Unknown frame or layout mismatch, keep raw bytes */
+    if(layout_it == p_writer->layouts.end() || layout_it->second.size != len){
+        p_writer->unknown_cnt++;
+
+        row = std::to_string(offset) + "," + std::to_string(sequence) + "," + std::to_string(cmd) + ",";
+        for(idx = 0; idx < len; idx++){
+            snprintf(hex, sizeof(hex), "%02X", p_payload[idx]);
+            row += hex;
+        }
+
+        p_file = MPOut_GetFile(p_writer, MPOUT_RAW_NAME, "offset,seq,cmd,payload");
+        fprintf(p_file, "%s\n", row.c_str());
+
+        return;
+    }
+
+    header = "offset,seq";
+    for(field_idx = 0; field_idx < layout_it->second.fields.size(); field_idx++)
+        header += "," + layout_it->second.fields[field_idx];
+
+    row = std::to_string(offset) + "," + std::to_string(sequence);
+
+    for(field_idx = 0, idx = 0; field_idx < layout_it->second.format.size(); field_idx++){
+        row += "," + MPOut_FormatField(layout_it->second.format[field_idx], &p_payload[idx]);
+        idx += MPOut_FieldSize(layout_it->second.format[field_idx]);
+    }
+
+    p_file = MPOut_GetFile(p_writer, layout_it->second.name, header);
+    fprintf(p_file, "%s\n", row.c_str());
+}
+
+/**
+ * MPOut_GetFile - Function to get (open) CSV file of frame type, the header
+ *                 row is written when the file is opened. All types are
+ *                 written to stdout if prefix is "-".
+ *
+ * @param   [in/out]    *p_writer   Output writer.
+ * @param   [in]        &name       Frame type name.
+ * @param   [in]        &header     CSV header row.
+ *
+ * @return  [FILE *]    CSV file.
+ *
+ */
+static FILE *MPOut_GetFile(MPOUT_WRITER *p_writer, const std::string &name, const std::string &header)
+{
+    std::map<std::string, FILE *>::iterator file_it;
+    FILE *p_file;
+
+    file_it = p_writer->files.find(name);
+    if(file_it != p_writer->files.end())
+        return file_it->second;
+
+    if(p_writer->prefix == "-"){
+        p_file = stdout;
+        fprintf(p_file, "#%s\n", name.c_str());
+    }
+    else{
+        p_file = fopen((p_writer->prefix + "_" + name + ".csv").c_str(), "w");
+        if(p_file == NULL){
+            fprintf(stderr, "Unable to create %s_%s.csv\n", p_writer->prefix.c_str(), name.c_str());
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    fprintf(p_file, "%s\n", header.c_str());
+    p_writer->files[name] = p_file;
+
+    return p_file;
+}
+
+/**
+ * MPOut_FieldSize - Function to get byte size of struct format character.
+ *
+ * @param   [in]        type        Struct format character.
+ *
+ * @return  [uint8_t]   Field size.
+ *
+ */
+static uint8_t MPOut_FieldSize(char type)
+{
+    switch(type){
+        case 'B':
+        case 'b':
+        case 'c':
+            return 1;
+        case 'H':
+        case 'h':
+            return 2;
+        case 'I':
+        case 'i':
+        case 'f':
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+/**
+ * MPOut_FormatField - Function to format one little endian field.
+ *
+ * @param   [in]        type        Struct format character.
+ * @param   [in]        *p_data     Field data.
+ *
+ * @return  [std::string]   Field text.
+ *
+ */
+static std::string MPOut_FormatField(char type, const uint8_t *p_data)
+{
+    char text[32];
+    uint16_t value16;
+    uint32_t value32;
+    float value_float;
+
+    value16 = p_data[0] | ((uint16_t)p_data[1] << 8);
+    value32 = value16 | ((uint32_t)p_data[2] << 16) | ((uint32_t)p_data[3] << 24);
+
+    switch(type){
+        case 'B':
+            snprintf(text, sizeof(text), "%u", p_data[0]);
+            break;
+        case 'b':
+            snprintf(text, sizeof(text), "%d", (int8_t)p_data[0]);
+            break;
+        case 'c':
+            snprintf(text, sizeof(text), "%c", p_data[0]);
+            break;
+        case 'H':
+            snprintf(text, sizeof(text), "%u", value16);
+            break;
+        case 'h':
+            snprintf(text, sizeof(text), "%d", (int16_t)value16);
+            break;
+        case 'I':
+            snprintf(text, sizeof(text), "%lu", (unsigned long)value32);
+            break;
+        case 'i':
+            snprintf(text, sizeof(text), "%ld", (long)(int32_t)value32);
+            break;
+        case 'f':
+            memcpy(&value_float, &value32, sizeof(value_float));
+            snprintf(text, sizeof(text), "%.7g", value_float);
+            break;
+        default:
+            text[0] = 0;
+            break;
+    }
+
+    return text;
+}
+
+/**
+ * MPOut_GetVarint - Function to decode varint, same as MP_PutVarint().
+ *
+ * @param   [in]        *p_data     Payload.
+ * @param   [in]        len         Payload length.
+ * @param   [in/out]    *p_idx      Payload index.
+ * @param   [out]       *p_value    Decoded value.
+ *
+ * @return  [bool]      Varint is decoded.
+ *
+ */
+static bool MPOut_GetVarint(const uint8_t *p_data, uint8_t len, uint8_t *p_idx, uint32_t *p_value)
+{
+    uint8_t shift;
+
+    *p_value = 0;
+
+    for(shift = 0; *p_idx < len && shift < 7 * MP_VARINT_MAX_SIZE; shift += 7){
+        *p_value |= (uint32_t)(p_data[*p_idx] & 0x7F) << shift;
+
+        if((p_data[(*p_idx)++] & 0x80) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+/**
+ * MPOut_WriteCompact - Function to write compact telemetry, fields which are
+ *                      not present keep the value of previous frames.
+ *
+ * @param   [in/out]    *p_writer   Output writer.
+ * @param   [in]        *p_layout   Compact telemetry layout.
+ * @param   [in]        offset      Input offset of the frame.
+ * @param   [in]        sequence    Frame sequence.
+ * @param   [in]        *p_payload  Frame payload.
+ * @param   [in]        len         Payload length.
+ *
+ * @return  [none]
+ *
+ */
+static void MPOut_WriteCompact(MPOUT_WRITER *p_writer, MPOUT_LAYOUT *p_layout, uint64_t offset,
+                               uint8_t sequence, const uint8_t *p_payload, uint8_t len)
+{
+    uint32_t heartbeat;
+    uint32_t field_mask;
+    uint16_t value16;
+    std::string header;
+    std::string row;
+    uint8_t idx;
+    size_t field_idx;
+    char text[32];
+
+    p_writer->compact_val.resize(p_layout->format.size(), 0.0);
+    p_writer->compact_is_valid.resize(p_layout->format.size(), false);
+
+    idx = 0;
+    if(MPOut_GetVarint(p_payload, len, &idx, &heartbeat) == false
+    || MPOut_GetVarint(p_payload, len, &idx, &field_mask) == false){
+        p_writer->unknown_cnt++;
+        return;
+    }
+
+    for(field_idx = 0; field_idx < p_layout->format.size(); field_idx++){
+
+        if((field_mask & (1UL << field_idx)) == 0)
+            continue;
+
+        if(idx + sizeof(value16) > len){
+            p_writer->unknown_cnt++;
+            return;
+        }
+
+        value16 = p_payload[idx] | ((uint16_t)p_payload[idx + 1] << 8);
+        idx += sizeof(value16);
+
+        if(p_layout->format[field_idx] == 'h')
+            p_writer->compact_val[field_idx] = (int16_t)value16 / p_layout->scales[field_idx];
+        else
+            p_writer->compact_val[field_idx] = value16 / p_layout->scales[field_idx];
+
+        p_writer->compact_is_valid[field_idx] = true;
+    }
+
+    header = "offset,seq";
+    for(field_idx = 0; field_idx < p_layout->fields.size(); field_idx++)
+        header += "," + p_layout->fields[field_idx];
+
+    row = std::to_string(offset) + "," + std::to_string(sequence) + ","
+        + std::to_string(heartbeat) + "," + std::to_string(field_mask);
+
+    /* Empty until the field is received */
+    for(field_idx = 0; field_idx < p_layout->format.size(); field_idx++){
+        row += ",";
+        if(p_writer->compact_is_valid[field_idx]){
+            snprintf(text, sizeof(text), "%g", p_writer->compact_val[field_idx]);
+            row += text;
+        }
+    }
+
+    fprintf(MPOut_GetFile(p_writer, p_layout->name, header), "%s\n", row.c_str());
+}
+
+/**
+ * MPOut_WriteLog - Function to write binary log message as text.
+ *
+ * @param   [in/out]    *p_writer   Output writer.
+ * @param   [in]        offset      Input offset of the frame.
+ * @param   [in]        sequence    Frame sequence.
+ * @param   [in]        *p_payload  Frame payload, log ID and arguments.
+ * @param   [in]        len         Payload length.
+ *
+ * @return  [none]
+ *
+ */
+static void MPOut_WriteLog(MPOUT_WRITER *p_writer, uint64_t offset, uint8_t sequence,
+                           const uint8_t *p_payload, uint8_t len)
+{
+    std::map<uint16_t, std::string>::iterator log_it;
+    std::string text;
+    uint16_t log_id;
+    uint8_t idx;
+    char hex[8];
+
+    if(len < sizeof(log_id)){
+        p_writer->unknown_cnt++;
+        return;
+    }
+
+    log_id = p_payload[0] | ((uint16_t)p_payload[1] << 8);
+    log_it = p_writer->log_table.find(log_id);
+
+    if(log_it != p_writer->log_table.end()){
+        text = MPOut_ExpandLog(log_it->second, &p_payload[sizeof(log_id)], len - sizeof(log_id));
+    }
+    else{
+        snprintf(hex, sizeof(hex), "%04X", log_id);
+        text = std::string("[LOG ") + hex + "] ";
+        for(idx = sizeof(log_id); idx < len; idx++){
+            snprintf(hex, sizeof(hex), "%02x", p_payload[idx]);
+            text += hex;
+        }
+    }
+
+    snprintf(hex, sizeof(hex), "%04X", log_id);
+
+    fprintf(MPOut_GetFile(p_writer, MPOUT_LOG_NAME, "offset,seq,log_id,text"), "%llu,%u,%s,%s\n",
+            (unsigned long long)offset, sequence, hex, MPOut_Quote(text).c_str());
+}
+
+/**
+ * MPOut_ExpandLog - Function to expand log arguments with format string, same
+ *                   as mp_log_expand() of MP_log.py.
+ *
+ * @param   [in]        &fmt        Format string.
+ * @param   [in]        *p_args     Raw arguments.
+ * @param   [in]        len         Arguments length.
+ *
+ * @return  [std::string]   Message text.
+ *
+ */
+static std::string MPOut_ExpandLog(const std::string &fmt, const uint8_t *p_args, uint8_t len)
+{
+    std::string text;
+    std::string spec;
+    size_t fmt_idx;
+    uint8_t arg_idx;
+    uint8_t arg_size;
+    uint8_t byte_idx;
+    uint32_t raw;
+    int32_t value_signed;
+    float value_float;
+    char type;
+    char value[32];
+
+    arg_idx = 0;
+
+    for(fmt_idx = 0; fmt_idx < fmt.size(); fmt_idx++){
+
+        if(fmt[fmt_idx] != '%' || fmt_idx + 1 >= fmt.size()){
+            text += fmt[fmt_idx];
+            continue;
+        }
+
+        /* Specifier without "%", same as UartStrm_PrintFormat() */
+        spec = fmt.substr(fmt_idx + 1, fmt.compare(fmt_idx + 1, 2, "hh") == 0 ? 3 : (fmt[fmt_idx + 1] == 'h' ? 2 : 1));
+        fmt_idx += spec.size();
+
+        if(spec == "%"){
+            text += '%';
+            continue;
+        }
+
+        if(spec == "s"){
+            while(arg_idx < len && p_args[arg_idx] != 0)
+                text += (char)p_args[arg_idx++];
+            arg_idx++;
+            continue;
+        }
+
+        type = spec[spec.size() - 1];
+        arg_size = (spec.size() == 3 || type == 'c') ? 1 : (spec.size() == 2 ? 2 : 4);
+
+        if(strchr("udxXofc", type) == NULL){
+            text += '?';
+            continue;
+        }
+
+        if(arg_idx + arg_size > len){
+            text += '?';
+            continue;
+        }
+
+        raw = 0;
+        for(byte_idx = 0; byte_idx < arg_size; byte_idx++)
+            raw |= (uint32_t)p_args[arg_idx + byte_idx] << (8 * byte_idx);
+        arg_idx += arg_size;
+
+        if(type == 'f'){
+            memcpy(&value_float, &raw, sizeof(value_float));
+            snprintf(value, sizeof(value), "%.2f", value_float);
+        }
+        else if(type == 'c'){
+            snprintf(value, sizeof(value), "%c", (char)raw);
+        }
+        else if(type == 'd'){
+            value_signed = (arg_size == 1) ? (int8_t)raw : (arg_size == 2) ? (int16_t)raw : (int32_t)raw;
+            snprintf(value, sizeof(value), "%ld", (long)value_signed);
+        }
+        else{
+            snprintf(value, sizeof(value), (type == 'u') ? "%lu" : (type == 'o') ? "%lo" : "%lX", (unsigned long)raw);
+        }
+
+        text += value;
+    }
+
+    return text;
+}
+
+/**
+ * MPOut_Unescape - Function to unescape Python string_escape text.
+ *
+ * @param   [in]        &str        Escaped text.
+ *
+ * @return  [std::string]   Text.
+ *
+ */
+static std::string MPOut_Unescape(const std::string &str)
+{
+    std::string text;
+    size_t idx;
+
+    for(idx = 0; idx < str.size(); idx++){
+
+        if(str[idx] != '\\' || idx + 1 >= str.size()){
+            text += str[idx];
+            continue;
+        }
+
+        switch(str[++idx]){
+            case 'n':   text += '\n';   break;
+            case 'r':   text += '\r';   break;
+            case 't':   text += '\t';   break;
+            case 'x':
+                if(idx + 2 < str.size()){
+                    text += (char)strtoul(str.substr(idx + 1, 2).c_str(), NULL, 16);
+                    idx += 2;
+                }
+                break;
+            default:    text += str[idx];   break;
+        }
+    }
+
+    return text;
+}
+
+/**
+ * MPOut_Quote - Function to quote CSV text field.
+ *
+ * @param   [in]        &str        Text.
+ *
+ * @return  [std::string]   Quoted text.
+ *
+ */
+static std::string MPOut_Quote(const std::string &str)
+{
+    std::string text;
+    size_t idx;
+
+    text = "\"";
+
+    for(idx = 0; idx < str.size(); idx++){
+        if(str[idx] == '"')
+            text += '"';
+        text += str[idx];
+    }
+
+    return text + "\"";
+}
+
+/**
+ * MPOut_Split - Function to split text.
+ *
+ * @param   [in]        &str        Text.
+ * @param   [in]        delim       Delimiter.
+ *
+ * @return  [std::vector<std::string>]  Split text, empty for empty text.
+ *
+ */
+static std::vector<std::string> MPOut_Split(const std::string &str, char delim)
+{
+    std::vector<std::string> items;
+    std::stringstream stream(str);
+    std::string item;
+
+    while(std::getline(stream, item, delim))
+        items.push_back(item);
+
+    return items;
+}
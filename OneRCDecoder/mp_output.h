@@ -0,0 +1,87 @@
+/**
+ *******************************************************************************
+ *      ______  _   __  ______  ____     ______        ___    ______   ____
+ *     / __  / / \ / / / ____/ / __ \   /  ___/       /  /   /_   _/  / __ \
+ *    / /_/ / /   \ / / ____/ /  -- /  /  /__   __   /  /__  _/  /_  / __ <
+ *   /_____/ /_/ \_/ /_____/ /__/ \_\ /_____/  /_/  /_____/ /_____/ /_____/
+ *
+ *     An amateur remote control software library. Use at your own risk.
+ *
+ * @file    mp_output.h
+ * @brief   Columnar (CSV) output of parsed MP frames, one file per frame type.
+ *          Payload layouts are exported from MP_frames.py by MP_layout.py,
+ *          log formats by MP_log.py.
+ * @author  Y.S.Kuo in Hsinchu
+ *******************************************************************************
+ */
+
+#ifndef MP_OUTPUT_H_
+#define MP_OUTPUT_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+
+/*
+ *******************************************************************************
+ * Constant value definition
+ *******************************************************************************
+ */
+
+#define MPOUT_COMPACT_FLAG      '@'     /* Format prefix of compact telemetry */
+#define MPOUT_RAW_NAME          "RAW"   /* File of unknown frames */
+#define MPOUT_LOG_NAME          "LOG"   /* File of binary log messages */
+
+
+/*
+ *******************************************************************************
+ * Data type definition
+ *******************************************************************************
+ */
+
+/* Payload layout of one frame type */
+typedef struct mpout_layout{
+    std::string name;
+    std::string format;                 /* Struct format, without compact flag */
+    std::vector<std::string> fields;
+    std::vector<double> scales;         /* Compact telemetry only */
+    bool is_compact;
+    uint16_t size;                      /* Payload size, 0 for compact telemetry */
+}MPOUT_LAYOUT;
+
+typedef struct mpout_writer{
+    std::string prefix;                 /* Output file name prefix */
+    std::map<uint8_t, MPOUT_LAYOUT> layouts;
+    std::map<uint16_t, std::string> log_table;
+    std::map<std::string, FILE *> files;
+
+    std::vector<double> compact_val;    /* Last compact telemetry fields */
+    std::vector<bool> compact_is_valid;
+
+    bool is_first_frm;
+    uint8_t last_sequence;
+    uint64_t frm_cnt;
+    uint64_t seq_err_cnt;
+    uint64_t unknown_cnt;
+}MPOUT_WRITER;
+
+
+/*
+ *******************************************************************************
+ * Public functions
+ *******************************************************************************
+ */
+
+int8_t MPOut_LoadLayout(const char *p_path, MPOUT_WRITER *p_writer);
+int8_t MPOut_LoadLogTable(const char *p_path, MPOUT_WRITER *p_writer);
+void MPOut_Init(const char *p_prefix, MPOUT_WRITER *p_writer);
+void MPOut_WriteFrame(MPOUT_WRITER *p_writer, uint64_t offset, uint8_t cmd, uint8_t sequence,
+                      const uint8_t *p_payload, uint8_t len);
+void MPOut_Close(MPOUT_WRITER *p_writer);
+
+
+#endif // MP_OUTPUT_H_
@@ -0,0 +1,391 @@
+/**
+ *******************************************************************************
+ *      ______  _   __  ______  ____     ______        ___    ______   ____
+ *     / __  / / \ / / / ____/ / __ \   /  ___/       /  /   /_   _/  / __ \
+ *    / /_/ / /   \ / / ____/ /  -- /  /  /__   __   /  /__  _/  /_  / __ <
+ *   /_____/ /_/ \_/ /_____/ /__/ \_\ /_____/  /_/  /_____/ /_____/ /_____/
+ *
+ *     An amateur remote control software library. Use at your own risk.
+ *
+ * @file    mp_parser.cpp
+ * @brief
+ * @author  Y.S.Kuo in Hsinchu
+ *******************************************************************************
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "mp_parser.h"
+
+
+/*
+ *******************************************************************************
+ * Private functions declaration
+ *******************************************************************************
+ */
+
+static bool MPDec_PutFrameByte(MPDEC_PARSER *p_parser, uint8_t data_byte);
+static uint64_t MPDec_FindSync(MPDEC_CHUNK *p_prev, MPDEC_CHUNK *p_next);
+
+
+/*
+ *******************************************************************************
+ * Public functions
+ *******************************************************************************
+ */
+
+/**
+ * MPDec_CrcAccumulate - Function to accumulate CRC-16-CCITT, same as
+ *                       CRC_Accumulate() of firmware.
+ *
+ * @param   [in]        data        Input byte.
+ * @param   [in]        accum_crc   Accumulated CRC.
+ *
+ * @return  [uint16_t]  New accumulated CRC.
+ *
+ */
+uint16_t MPDec_CrcAccumulate(uint8_t data, uint16_t accum_crc)
+{
+    uint8_t tmp;
+
+    tmp = data ^ (uint8_t)(accum_crc & 0xFF);
+    tmp ^= (uint8_t)(tmp << 4);
+
+    return (accum_crc >> 8) ^ ((uint16_t)tmp << 8) ^ ((uint16_t)tmp << 3) ^ (tmp >> 4);
+}
+
+/**
+ * MPDec_Init - Function to reset parser.
+ *
+ * @param   [out]       *p_parser   Parser.
+ *
+ * @return  [none]
+ *
+ */
+void MPDec_Init(MPDEC_PARSER *p_parser)
+{
+    memset(p_parser, 0, sizeof(MPDEC_PARSER));
+
+    p_parser->state = MPDEC_WAIT_SFLAG;
+}
+
+/**
+ * MPDec_Put - Function to parse one input byte.
+ *
+ * A delimiter (0x00) always starts a COBS frame, unless a legacy frame is
+ * being collected. 0x7E starts a legacy frame until a valid COBS frame is
+ * received, same as MP_Recv() of firmware.
+ *
+ * @param   [in/out]    *p_parser   Parser.
+ * @param   [in]        data_byte   Input byte.
+ * @param   [in]        offset      Input offset of the byte.
+ *
+ * @return  [bool]      Frame is completed.
+ * @retval  [true]      Valid frame is in p_parser->frm_buf.
+ * @retval  [false]     Frame is not completed.
+ *
+ */
+bool MPDec_Put(MPDEC_PARSER *p_parser, uint8_t data_byte, uint64_t offset)
+{
+    bool is_frm_done;
+
+    is_frm_done = false;
+
+    /* Delimiter always starts a new frame, drop the collecting COBS frame */
+    if(data_byte == MP_FRM_DELIM
+    && (p_parser->is_cobs_frm == true || p_parser->state == MPDEC_WAIT_SFLAG)){
+        p_parser->is_cobs_frm = true;
+        p_parser->cobs_code = 0;
+        p_parser->cobs_remain = 0;
+        p_parser->state = MPDEC_WAIT_SFLAG;
+        p_parser->frm_offset = offset;
+        MPDec_PutFrameByte(p_parser, MP_FRM_SFLAG);
+    }
+    /* Decoding COBS frame */
+    else if(p_parser->is_cobs_frm == true && p_parser->state != MPDEC_WAIT_SFLAG){
+
+        if(p_parser->cobs_remain == 0){
+            /* Code byte, previous block (if any) is ended by a zero byte */
+            if(p_parser->cobs_code != 0 && p_parser->cobs_code != 0xFF)
+                is_frm_done = MPDec_PutFrameByte(p_parser, 0);
+
+            p_parser->cobs_code = data_byte;
+            p_parser->cobs_remain = data_byte - 1;
+        }
+        else{
+            p_parser->cobs_remain--;
+            is_frm_done = MPDec_PutFrameByte(p_parser, data_byte);
+        }
+    }
+    /* Legacy 0x7E frame */
+    else if(p_parser->is_peer_cobs == false){
+        if(p_parser->state == MPDEC_WAIT_SFLAG)
+            p_parser->frm_offset = offset;
+
+        p_parser->is_cobs_frm = false;
+        is_frm_done = MPDec_PutFrameByte(p_parser, data_byte);
+    }
+
+    if(is_frm_done && p_parser->is_cobs_frm)
+        p_parser->is_peer_cobs = true;
+
+    return is_frm_done;
+}
+
+/**
+ * MPDec_ParseChunk - Function to parse frames started in chunk range.
+ *
+ * Parsing starts at a random position of input, the parser resyncs at the
+ * next valid frame. It continues MPDEC_CHUNK_OVERLAP bytes after the chunk,
+ * so the frames can be matched with the next chunk.
+ *
+ * @param   [in]        *p_data     Input data.
+ * @param   [in]        data_size   Input size.
+ * @param   [in/out]    *p_chunk    Chunk, start and end are set by caller.
+ *
+ * @return  [none]
+ *
+ */
+void MPDec_ParseChunk(const uint8_t *p_data, uint64_t data_size, MPDEC_CHUNK *p_chunk)
+{
+    MPDEC_PARSER parser;
+    MPDEC_FRAME frame;
+    uint64_t parse_end;
+    uint64_t crc_err_cnt;
+    uint64_t offset;
+
+    MPDec_Init(&parser);
+
+    parse_end = std::min(data_size, p_chunk->end + MPDEC_CHUNK_OVERLAP);
+    crc_err_cnt = 0;
+
+    for(offset = p_chunk->start; offset < parse_end; offset++){
+
+        if(MPDec_Put(&parser, p_data[offset], offset) == false){
+            /* Errors are filtered by sync offset as frames, false errors before resync are dropped */
+            if(parser.crc_err_cnt != crc_err_cnt){
+                crc_err_cnt = parser.crc_err_cnt;
+                p_chunk->crc_err_offsets.push_back(parser.frm_offset);
+            }
+
+            continue;
+        }
+
+        frame.offset = parser.frm_offset;
+        frame.payload_idx = p_chunk->payload.size();
+        frame.cmd = ((MP_FRAME_HDR *)parser.frm_buf)->cmd;
+        frame.sequence = ((MP_FRAME_HDR *)parser.frm_buf)->sequence;
+        frame.len = ((MP_FRAME_HDR *)parser.frm_buf)->len;
+
+        p_chunk->frames.push_back(frame);
+        p_chunk->payload.insert(p_chunk->payload.end(), ((MP_FRAME_HDR *)parser.frm_buf)->payload,
+                                ((MP_FRAME_HDR *)parser.frm_buf)->payload + frame.len);
+    }
+}
+
+/**
+ * MPDec_ParseParallel - Function to parse whole input by several threads.
+ *
+ * The input is split into chunks, each chunk is parsed by one thread. Then
+ * the chunks are merged at the first frame found by both neighbour chunks
+ * (frame resync point), so a chunk which started in the middle of a frame
+ * doesn't lose or duplicate frames.
+ *
+ * @param   [in]        *p_data     Input data.
+ * @param   [in]        data_size   Input size.
+ * @param   [in]        thread_num  Max threads.
+ * @param   [out]       *p_result   All frames in input order.
+ *
+ * @return  [none]
+ *
+ */
+void MPDec_ParseParallel(const uint8_t *p_data, uint64_t data_size, unsigned thread_num,
+                         MPDEC_CHUNK *p_result)
+{
+    std::vector<MPDEC_CHUNK> chunks;
+    std::vector<std::thread> threads;
+    uint64_t chunk_size;
+    uint64_t sync_offset;
+    uint64_t next_sync_offset;
+    MPDEC_FRAME frame;
+    unsigned chunk_idx;
+    size_t frame_idx;
+
+    chunk_size = std::max<uint64_t>(MPDEC_CHUNK_MIN_SIZE, (data_size + thread_num - 1) / std::max(thread_num, 1U));
+    chunks.resize((data_size + chunk_size - 1) / chunk_size);
+
+    for(chunk_idx = 0; chunk_idx < chunks.size(); chunk_idx++){
+        chunks[chunk_idx].start = chunk_idx * chunk_size;
+        chunks[chunk_idx].end = std::min(data_size, (chunk_idx + 1) * chunk_size);
+
+        threads.push_back(std::thread(MPDec_ParseChunk, p_data, data_size, &chunks[chunk_idx]));
+    }
+
+    for(chunk_idx = 0; chunk_idx < threads.size(); chunk_idx++)
+        threads[chunk_idx].join();
+
+    p_result->start = 0;
+    p_result->end = data_size;
+    p_result->crc_err_cnt = 0;
+    p_result->frames.clear();
+    p_result->payload.clear();
+
+    /* Frames of chunk are used from its sync offset to the sync offset of next chunk */
+    sync_offset = 0;
+
+    for(chunk_idx = 0; chunk_idx < chunks.size(); chunk_idx++){
+
+        if(chunk_idx + 1 < chunks.size())
+            next_sync_offset = MPDec_FindSync(&chunks[chunk_idx], &chunks[chunk_idx + 1]);
+        else
+            next_sync_offset = data_size;
+
+        for(frame_idx = 0; frame_idx < chunks[chunk_idx].frames.size(); frame_idx++){
+            frame = chunks[chunk_idx].frames[frame_idx];
+
+            if(frame.offset < sync_offset || frame.offset >= next_sync_offset)
+                continue;
+
+            p_result->payload.insert(p_result->payload.end(),
+                                     chunks[chunk_idx].payload.begin() + frame.payload_idx,
+                                     chunks[chunk_idx].payload.begin() + frame.payload_idx + frame.len);
+            frame.payload_idx = p_result->payload.size() - frame.len;
+            p_result->frames.push_back(frame);
+        }
+
+        for(frame_idx = 0; frame_idx < chunks[chunk_idx].crc_err_offsets.size(); frame_idx++){
+            if(chunks[chunk_idx].crc_err_offsets[frame_idx] >= sync_offset
+            && chunks[chunk_idx].crc_err_offsets[frame_idx] < next_sync_offset)
+                p_result->crc_err_cnt++;
+        }
+
+        sync_offset = next_sync_offset;
+    }
+}
+
+
+/*
+ *******************************************************************************
+ * Private functions
+ *******************************************************************************
+ */
+
+/**
+ * MPDec_PutFrameByte - Function to collect one (decoded) frame byte.
+ *
+ * @param   [in/out]    *p_parser   Parser.
+ * @param   [in]        data_byte   Frame byte.
+ *
+ * @return  [bool]      Valid frame is completed.
+ *
+ */
+static bool MPDec_PutFrameByte(MPDEC_PARSER *p_parser, uint8_t data_byte)
+{
+    MP_FRAME_HDR *p_frm_hdr;
+    uint16_t frm_crc;
+
+    p_frm_hdr = (MP_FRAME_HDR *)p_parser->frm_buf;
+
+    switch(p_parser->state){
+
+        case MPDEC_WAIT_SFLAG:
+
+            if(data_byte == MP_FRM_SFLAG){
+                p_parser->frm_buf[0] = data_byte;
+                p_parser->frm_idx = 1;
+                p_parser->crc = 0xFFFF;
+                p_parser->state = MPDEC_WAIT_HDR;
+            }
+
+            break;
+
+        case MPDEC_WAIT_HDR:
+
+            p_parser->frm_buf[p_parser->frm_idx++] = data_byte;
+            p_parser->crc = MPDec_CrcAccumulate(data_byte, p_parser->crc);
+
+            if(p_parser->frm_idx == sizeof(MP_FRAME_HDR)){
+                /* Version bit is included in CRC, but not in payload length */
+                p_frm_hdr->len &= MP_FRM_LEN_MASK;
+                p_parser->frm_size = sizeof(MP_FRAME_HDR) + p_frm_hdr->len + sizeof(MP_FRAME_TAIL);
+
+                p_parser->state = (p_frm_hdr->len == 0) ? MPDEC_WAIT_CRC : MPDEC_WAIT_PAYLOAD;
+            }
+
+            break;
+
+        case MPDEC_WAIT_PAYLOAD:
+
+            p_parser->frm_buf[p_parser->frm_idx++] = data_byte;
+            p_parser->crc = MPDec_CrcAccumulate(data_byte, p_parser->crc);
+
+            if(p_parser->frm_idx == sizeof(MP_FRAME_HDR) + p_frm_hdr->len)
+                p_parser->state = MPDEC_WAIT_CRC;
+
+            break;
+
+        case MPDEC_WAIT_CRC:
+
+            p_parser->frm_buf[p_parser->frm_idx++] = data_byte;
+
+            if(p_parser->frm_idx == p_parser->frm_size){
+                p_parser->state = MPDEC_WAIT_SFLAG;
+
+                /* Little endian */
+                frm_crc = p_parser->frm_buf[p_parser->frm_idx - 2]
+                        | ((uint16_t)p_parser->frm_buf[p_parser->frm_idx - 1] << 8);
+
+                if(frm_crc == p_parser->crc)
+                    return true;
+
+                p_parser->crc_err_cnt++;
+            }
+
+            break;
+
+        default:
+            break;
+    }
+
+    return false;
+}
+
+/**
+ * MPDec_FindSync - Function to find the first frame of next chunk which is
+ *                  also found by previous chunk.
+ *
+ * @param   [in]        *p_prev     Previous chunk.
+ * @param   [in]        *p_next     Next chunk.
+ *
+ * @return  [uint64_t]  Input offset of the common frame, end of previous chunk
+ *                      if there is no common frame.
+ *
+ */
+static uint64_t MPDec_FindSync(MPDEC_CHUNK *p_prev, MPDEC_CHUNK *p_next)
+{
+    size_t prev_idx;
+    size_t next_idx;
+
+    prev_idx = 0;
+
+    for(next_idx = 0; next_idx < p_next->frames.size(); next_idx++){
+
+        if(p_next->frames[next_idx].offset >= p_prev->end + MPDEC_CHUNK_OVERLAP)
+            break;
+
+        while(prev_idx < p_prev->frames.size()
+           && p_prev->frames[prev_idx].offset < p_next->frames[next_idx].offset)
+            prev_idx++;
+
+        if(prev_idx < p_prev->frames.size()
+        && p_prev->frames[prev_idx].offset == p_next->frames[next_idx].offset)
+            return p_next->frames[next_idx].offset;
+    }
+
+    return p_prev->end;
+}
@@ -0,0 +1,106 @@
+/**
+ *******************************************************************************
+ *      ______  _   __  ______  ____     ______        ___    ______   ____
+ *     / __  / / \ / / / ____/ / __ \   /  ___/       /  /   /_   _/  / __ \
+ *    / /_/ / /   \ / / ____/ /  -- /  /  /__   __   /  /__  _/  /_  / __ <
+ *   /_____/ /_/ \_/ /_____/ /__/ \_\ /_____/  /_/  /_____/ /_____/ /_____/
+ *
+ *     An amateur remote control software library. Use at your own risk.
+ *
+ * @file    mp_parser.h
+ * @brief   MP frame parser of ground side, legacy 0x7E and COBS framing.
+ *          Same rules as MP_Recv() of firmware, large logs are parsed by
+ *          several threads and merged at frame resync points.
+ * @author  Y.S.Kuo in Hsinchu
+ *******************************************************************************
+ */
+
+#ifndef MP_PARSER_H_
+#define MP_PARSER_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <vector>
+
+#include "mcu_protocol.h"
+
+
+/*
+ *******************************************************************************
+ * Constant value definition
+ *******************************************************************************
+ */
+
+#define MPDEC_FRM_BUF_SIZE      (sizeof(MP_FRAME_HDR) + 255 + sizeof(MP_FRAME_TAIL))
+
+/* Each thread parses this many bytes after its chunk, to meet the next thread at a common frame */
+#define MPDEC_CHUNK_OVERLAP     4096
+#define MPDEC_CHUNK_MIN_SIZE    (64 * 1024)
+
+
+/*
+ *******************************************************************************
+ * Data type definition
+ *******************************************************************************
+ */
+
+typedef enum mpdec_state{
+    MPDEC_WAIT_SFLAG            = 0,
+    MPDEC_WAIT_HDR,
+    MPDEC_WAIT_PAYLOAD,
+    MPDEC_WAIT_CRC,
+}__attribute__((packed)) MPDEC_STATE;
+
+/* Parser of one byte stream */
+typedef struct mpdec_parser{
+    MPDEC_STATE state;
+    bool is_cobs_frm;                   /* Current frame is COBS frame */
+    bool is_peer_cobs;                  /* Valid COBS frame is received, ignore 0x7E frame */
+    uint8_t cobs_code;                  /* Current code byte, 0 for first block */
+    uint8_t cobs_remain;                /* Data bytes left in current block */
+    uint16_t frm_idx;
+    uint16_t frm_size;                  /* Expected frame size, header + payload + tail */
+    uint16_t crc;
+    uint64_t frm_offset;                /* Input offset of frame start flag (delimiter) */
+    uint64_t crc_err_cnt;
+    uint8_t frm_buf[MPDEC_FRM_BUF_SIZE];    /* Decoded frame, version bit of len is cleared */
+}MPDEC_PARSER;
+
+/* Parsed frame, payload is stored in payload buffer of chunk */
+typedef struct mpdec_frame{
+    uint64_t offset;                    /* Input offset of frame start */
+    uint32_t payload_idx;               /* Payload index in chunk payload buffer */
+    uint8_t cmd;
+    uint8_t sequence;
+    uint8_t len;
+}MPDEC_FRAME;
+
+/* Parsed frames of a part of input */
+typedef struct mpdec_chunk{
+    uint64_t start;                     /* Chunk range of input, [start, end) */
+    uint64_t end;
+    uint64_t crc_err_cnt;               /* CRC errors of merged result */
+    std::vector<uint64_t> crc_err_offsets;
+    std::vector<MPDEC_FRAME> frames;
+    std::vector<uint8_t> payload;
+}MPDEC_CHUNK;
+
+
+/*
+ *******************************************************************************
+ * Public functions
+ *******************************************************************************
+ */
+
+uint16_t MPDec_CrcAccumulate(uint8_t data, uint16_t accum_crc);
+
+void MPDec_Init(MPDEC_PARSER *p_parser);
+bool MPDec_Put(MPDEC_PARSER *p_parser, uint8_t data_byte, uint64_t offset);
+
+void MPDec_ParseChunk(const uint8_t *p_data, uint64_t data_size, MPDEC_CHUNK *p_chunk);
+void MPDec_ParseParallel(const uint8_t *p_data, uint64_t data_size, unsigned thread_num,
+                         MPDEC_CHUNK *p_result);
+
+
+#endif // MP_PARSER_H_
@@ -72,7 +72,20 @@
 #define AIRPLANE_GET_LOITER_RADIUS()    ((ADC_Read(AIRPLANE_NAV_LOITER_CH) * 0.20)  \
                                          + AIRPLANE_WPT_ARRIVE_RADIUS)
 
-#define AIRPLANE_WPT_NUM                5
+#define AIRPLANE_WPT_NUM                5   /* Long missions are stored by mission.cpp */
+
+/* UART0 RX is used by serial RC receiver, features need MP uplink are not available, see rc_in.h */
+#if RCIN_SERIAL_EN
+    #if defined(IMU_SENSOR_FG_EN)
+        #error "IMU sensor data of FlightGear is received by MP uplink, it can't be used with RCIN_SERIAL_EN."
+    #endif
+
+    #if GPS_BENCH_EN
+        #error "NMEA stream of GPS_BENCH_EN is received by MP uplink, it can't be used with RCIN_SERIAL_EN."
+    #endif
+
+    #warning "RCIN_SERIAL_EN: no MP uplink, baud rate switching, parameter/PID/waypoint/mission upload, configuration saving and mission start are not available."
+#endif
 
 
 /*
@@ -86,6 +99,28 @@ typedef struct airplane_waypoint{
     GPS_COORD_POINT wpt_coord;
 }AIRPLANE_WAYPOINT;
 
+typedef struct airplane_pid_config{
+    float KP;
+    float KI;
+    float KD;
+    float scale;
+    float integral_max;
+    float output_max;
+}AIRPLANE_PID_CONFIG;
+
+/* Field of AIRPLANE_PID_CONFIG, same order as AIRPLANE_PARAM_ID of each PID controller */
+typedef enum airplane_pid_field{
+    AIRPLANE_PID_FIELD_KP                   = 0,
+    AIRPLANE_PID_FIELD_KI,
+    AIRPLANE_PID_FIELD_KD,
+    AIRPLANE_PID_FIELD_SCALE,
+    AIRPLANE_PID_FIELD_INTEGRAL_MAX,
+    AIRPLANE_PID_FIELD_OUTPUT_MAX,
+    AIRPLANE_PID_FIELD_TOTAL,
+}AIRPLANE_PID_FIELD;
+
+static_assert(AIRPLANE_PID_FIELD_TOTAL == AIRPLANE_PID_PARAM_NUM, "Incorrect AIRPLANE_PID_PARAM_NUM");
+
 typedef struct airplane_navigation{
     float loiter_radius;                    /* Loiter radius (meters) around home position */
     uint8_t current_wpt_idx;
@@ -111,41 +146,10 @@ typedef struct airplane_config{
     uint16_t rc_in_min_ticks[RCIN_CH_TOTAL];
     uint16_t rc_in_failsafe_ticks[RCIN_CH_TOTAL];
 
-    struct{
-        float KP;
-        float KI;
-        float KD;
-        float scale;
-        float integral_max;
-        float output_max;
-    }pid_aile_cfg;
-
-    struct{
-        float KP;
-        float KI;
-        float KD;
-        float scale;
-        float integral_max;
-        float output_max;
-    }pid_elev_cfg;
-
-    struct{
-        float KP;
-        float KI;
-        float KD;
-        float scale;
-        float integral_max;
-        float output_max;
-    }pid_rudd_cfg;
-
-    struct{
-        float KP;
-        float KI;
-        float KD;
-        float scale;
-        float integral_max;
-        float output_max;
-    }pid_bank_turn_cfg;
+    AIRPLANE_PID_CONFIG pid_aile_cfg;
+    AIRPLANE_PID_CONFIG pid_elev_cfg;
+    AIRPLANE_PID_CONFIG pid_rudd_cfg;
+    AIRPLANE_PID_CONFIG pid_bank_turn_cfg;
 
     AIRPLANE_NAVIGATION navigation;
 
@@ -160,6 +164,9 @@ typedef struct airplane_status{
     PID_DATA pid_rudd_servo;                /* Rudder servo PID data */
     PID_DATA pid_band_turn;                 /* Bank turn PID data */
 
+}AIRPLANE_STATUS;
+
+typedef struct airplane_tick{
     struct{
         float roll_angle;
         float pitch_angle;
@@ -187,7 +194,103 @@ typedef struct airplane_status{
 
     uint32_t heartbeat;
 
-}AIRPLANE_STATUS;
+}AIRPLANE_TICK;
+
+/* Payload of MP_REQ_IMU_SENSOR_DATA */
+typedef struct airplane_mp_imu_sensor{
+    uint16_t idx;
+    IMU_SENSOR_DATA sensor;
+    uint16_t delta_time;
+}AIRPLANE_MP_IMU_SENSOR;
+
+/* Payload of MP_REQ_CFG_PARAM_READ/WRITE and MP_RSP_CFG_PARAM_READ/WRITE */
+typedef struct airplane_mp_param{
+    uint8_t param_id;                       /* AIRPLANE_PARAM_ID */
+    int8_t result;                          /* Response only, 1: busy, 0: success, -1: fail */
+    float value;
+}AIRPLANE_MP_PARAM;
+
+/* Payload of MP_REQ_CFG_PID_READ/WRITE and MP_RSP_CFG_PID_READ/WRITE */
+typedef struct airplane_mp_pid{
+    uint8_t pid_idx;                        /* AIRPLANE_PID_IDX */
+    int8_t result;                          /* Response only, 1: busy, 0: success, -1: fail */
+    AIRPLANE_PID_CONFIG pid_cfg;
+}AIRPLANE_MP_PID;
+
+/* Payload of MP_REQ_CFG_WPT_READ/WRITE and MP_RSP_CFG_WPT_READ/WRITE */
+typedef struct airplane_mp_wpt{
+    uint8_t wpt_type;                       /* AIRPLANE_WPT_TYPE */
+    int8_t result;                          /* Response only, 1: busy, 0: success, -1: fail */
+    uint16_t wpt_idx;
+    GPS_COORD_POINT coord;
+}AIRPLANE_MP_WPT;
+
+/* Payload of MP_REQ_CFG_MISSION_BEGIN/END and MP_RSP_CFG_MISSION_BEGIN/END */
+typedef struct airplane_mp_mission{
+    uint16_t total_wpt;                     /* MISSION_END only */
+    int8_t result;                          /* Response only, 0: success, -1: fail */
+    GPS_COORD_POINT origin;                 /* MISSION_BEGIN only */
+}AIRPLANE_MP_MISSION;
+
+/* Payload of MP_REQ_CFG_MISSION_START and MP_RSP_CFG_MISSION_START */
+typedef struct airplane_mp_mission_start{
+    uint8_t is_start;                       /* 1: start, 0: stop and return to home */
+    int8_t result;                          /* Response only, 0: success, -1: fail */
+    uint16_t wpt_idx;                       /* First active waypoint */
+}AIRPLANE_MP_MISSION_START;
+
+/* Payload of MP_REQ_CFG_TLM_RATE_READ/WRITE and MP_RSP_CFG_TLM_RATE_READ/WRITE */
+typedef struct airplane_mp_tlm_rate{
+    uint8_t stream_id;                      /* AIRPLANE_TLM_STREAM_ID */
+    int8_t result;                          /* Response only, 0: success, -1: fail */
+    uint16_t period_ms;                     /* Sending period, 0: disabled */
+}AIRPLANE_MP_TLM_RATE;
+
+/* Payload of MP_REQ_CFG_BAUD and MP_RSP_CFG_BAUD */
+typedef struct airplane_mp_baud{
+    uint32_t baud_rate;                     /* New rate, same as current to confirm it */
+    int8_t result;                          /* Response only, 0: success, -1: fail */
+}AIRPLANE_MP_BAUD;
+
+/* Payload of MP_RSP_SYS_LINK_STATS, counters since boot, bytes/s is calculated by ground tool */
+typedef struct airplane_mp_link_stats{
+    uint32_t time_ms;                       /* Time of the counters, Timer1_GetMillis() */
+    UART_STATS uart0;                       /* MP link */
+    UART_STATS uarts;                       /* Simulated UART, all zero if it is disabled */
+    MP_RX_STATS mp_rx;
+    uint16_t mp_tx_drop_cnt;                /* Frames dropped because UART0 TX FIFO is full */
+    GPS_ERROR_LOG gps_err_log;
+}AIRPLANE_MP_LINK_STATS;
+
+/* Payload of MP_RSP_SYS_LATENCY, statistics since last frame */
+typedef struct airplane_mp_latency{
+    uint32_t time_ms;                       /* Time of the report, Timer1_GetMillis() */
+    LATENCY_REPORT report;
+}AIRPLANE_MP_LATENCY;
+
+/* MP request handler, the payload length is checked before calling */
+typedef void (*AIRPLANE_RX_HANDLER)(uint8_t cmd, uint8_t *p_payload, uint8_t len);
+
+/* MP request dispatching */
+typedef struct airplane_rx_cmd{
+    uint8_t cmd;                            /* MP_REQ_CMD */
+    uint8_t len;                            /* Payload length, AIRPLANE_RX_LEN_ANY: variable length */
+    AIRPLANE_RX_HANDLER p_handler;
+}AIRPLANE_RX_CMD;
+
+/* Telemetry stream scheduling */
+typedef struct airplane_tlm_stream{
+    uint16_t period_ms;                     /* Target sending period, 0: disabled */
+    uint16_t elapsed_ms;                    /* Time since last sending */
+    uint8_t priority;                       /* Smaller value is sent first */
+}AIRPLANE_TLM_STREAM;
+
+/* Payload of MP_REQ_CFG_SAVE and MP_RSP_CFG_SAVE */
+typedef struct airplane_mp_save{
+    uint8_t is_start;                       /* Request only, 1: start saving, 0: query state */
+    uint8_t state;                          /* Response only, AIRPLANE_SAVE_STATE */
+    int8_t result;                          /* Response only, result of last saving, 1: never saved */
+}AIRPLANE_MP_SAVE;
 
 
 /*
@@ -322,7 +425,11 @@ static AIRPLANE_CONFIG Airplane_Config =
     .rom_crc16 = 0xFFFF,
 };
 
-/* Airplane runtime status */
+/* Airplane configuration must not overlap with the mission ROM region */
+static_assert(AIRPLANE_CFG_ROM_ADDR + sizeof(AIRPLANE_CONFIG) <= MISSION_ROM_ADDR,
+              "AIRPLANE_CONFIG overlaps mission ROM region");
+
+/* Airplane controller state, AHRS and PID are updated in place */
 static AIRPLANE_STATUS Airplane_Status =
 {
     /* AHRS computation, will be initialized later */
@@ -333,56 +440,156 @@ static AIRPLANE_STATUS Airplane_Status =
     .pid_elev_servo = {0},
     .pid_rudd_servo = {0},
     .pid_band_turn = {0},
+};
 
-    .setpoint =
+/*
+ * Published status of control cycle, double buffered. Airplane_FlyCtrl() writes
+ * the back buffer and publishes it by flipping Airplane_TickFront, so telemetry
+ * and blackbox always read one complete control cycle without copying it.
+ */
+static AIRPLANE_TICK Airplane_Tick[2] =
+{
     {
-        .roll_angle = 0.0,
-        .pitch_angle = 0.0,
-        .heading_angle = 0.0,
-    },
+        .setpoint =
+        {
+            .roll_angle = 0.0,
+            .pitch_angle = 0.0,
+            .heading_angle = 0.0,
+        },
 
-    /* default RC channel input value */
-    .rc_pulse_in =
-    {
-        [RCIN_THRO_IDX] = TIMER1_MICROS_TO_TICKS(0),
-        [RCIN_AILE_IDX] = TIMER1_MICROS_TO_TICKS(0),
-        [RCIN_ELEV_IDX] = TIMER1_MICROS_TO_TICKS(0),
-        [RCIN_RUDD_IDX] = TIMER1_MICROS_TO_TICKS(0),
-        [RCIN_AUX1_IDX] = TIMER1_MICROS_TO_TICKS(0)
-    },
+        /* default RC channel input value */
+        .rc_pulse_in =
+        {
+            [RCIN_THRO_IDX] = TIMER1_MICROS_TO_TICKS(0),
+            [RCIN_AILE_IDX] = TIMER1_MICROS_TO_TICKS(0),
+            [RCIN_ELEV_IDX] = TIMER1_MICROS_TO_TICKS(0),
+            [RCIN_RUDD_IDX] = TIMER1_MICROS_TO_TICKS(0),
+            [RCIN_AUX1_IDX] = TIMER1_MICROS_TO_TICKS(0)
+        },
 
-    /* default RC channel output value */
-    .rc_pulse_out =
-    {
-        [RCIN_THRO_IDX] = TIMER1_MICROS_TO_TICKS(1000),
-        [RCIN_AILE_IDX] = TIMER1_MICROS_TO_TICKS(1500),
-        [RCIN_ELEV_IDX] = TIMER1_MICROS_TO_TICKS(1500),
-        [RCIN_RUDD_IDX] = TIMER1_MICROS_TO_TICKS(1500),
-    },
+        /* default RC channel output value */
+        .rc_pulse_out =
+        {
+            [RCIN_THRO_IDX] = TIMER1_MICROS_TO_TICKS(1000),
+            [RCIN_AILE_IDX] = TIMER1_MICROS_TO_TICKS(1500),
+            [RCIN_ELEV_IDX] = TIMER1_MICROS_TO_TICKS(1500),
+            [RCIN_RUDD_IDX] = TIMER1_MICROS_TO_TICKS(1500),
+        },
 
-    .general =
-    {
-        .fly_mode = AIRPLANE_MANUAL_FLY,                    /* Manual fly by default */
+        .general =
+        {
+            .fly_mode = AIRPLANE_MANUAL_FLY,                    /* Manual fly by default */
 
-        .imu_fail_cnt = 0,
-        .ahrs_delay_cnt = 0,
-        .rcin_cyc_cnt = 0,
-        .rcout_cyc_cnt = 0,
-        .delta_ctrl_time = 0,
+            .imu_fail_cnt = 0,
+            .ahrs_delay_cnt = 0,
+            .rcin_cyc_cnt = 0,
+            .rcout_cyc_cnt = 0,
+            .delta_ctrl_time = 0,
 
-        .mcu_vcc = 0.0,
-    },
+            .mcu_vcc = 0.0,
+        },
 
-    .current_cruise_state = AIRPLANE_CRUISE_AWAYFROM_WPT,
+        .current_cruise_state = AIRPLANE_CRUISE_AWAYFROM_WPT,
 
-    .heartbeat = 0,
+        .heartbeat = 0,
+    },
 };
 
+static uint8_t Airplane_TickFront = 0;
+
 /* GPS and navigation status */
 static GPS_DATA Airplane_GPS;
 
-#if AIRPLANE_STATUS_SNAPSHOT_EN
-static AIRPLANE_STATUS Airplane_StatusSnapshot = {0};
+/* PID configuration and controller of each AIRPLANE_PID_IDX */
+static AIRPLANE_PID_CONFIG * const Airplane_PidConfigTable[AIRPLANE_PID_TOTAL] =
+{
+    [AIRPLANE_PID_ROLL] = &Airplane_Config.pid_aile_cfg,
+    [AIRPLANE_PID_PITCH] = &Airplane_Config.pid_elev_cfg,
+    [AIRPLANE_PID_YAW] = &Airplane_Config.pid_rudd_cfg,
+    [AIRPLANE_PID_BANK] = &Airplane_Config.pid_bank_turn_cfg,
+};
+
+static PID_DATA * const Airplane_PidDataTable[AIRPLANE_PID_TOTAL] =
+{
+    [AIRPLANE_PID_ROLL] = &Airplane_Status.pid_aile_servo,
+    [AIRPLANE_PID_PITCH] = &Airplane_Status.pid_elev_servo,
+    [AIRPLANE_PID_YAW] = &Airplane_Status.pid_rudd_servo,
+    [AIRPLANE_PID_BANK] = &Airplane_Status.pid_band_turn,
+};
+
+/*
+ * Parameters are uploaded by ground tool, the potentiometers will not override
+ * PID and loiter radius setting until next boot.
+ */
+static bool Airplane_IsGndTuned = false;
+
+/* Deferred configuration saving */
+static AIRPLANE_SAVE_STATE Airplane_SaveState = AIRPLANE_SAVE_IDLE;
+static int8_t Airplane_SaveResult = 1;
+static uint16_t Airplane_SaveOffset = 0;
+static uint16_t Airplane_SaveCRC;
+
+/* Uploaded mission is being stored to ROM */
+static bool Airplane_IsMissionPending = false;
+
+/*
+ * ROM mission is flown in place of returning to home only after it's started
+ * by ground tool, RC failsafe stops it.
+ */
+static bool Airplane_IsMissionArmed = false;
+static uint8_t Airplane_MissionFailCnt;     /* RCIN_GetFailCnt() when mission is started */
+static bool Airplane_IsNavMission = false;  /* GPS waypoint is the active mission waypoint */
+
+/* UART0 baud rate switching */
+static AIRPLANE_BAUD_STATE Airplane_BaudState = AIRPLANE_BAUD_IDLE;
+static uint32_t Airplane_BaudPending;
+static uint32_t Airplane_BaudSwitchTime;
+
+/* Telemetry streams, the period can be changed by ground tool */
+static AIRPLANE_TLM_STREAM Airplane_TlmStream[AIRPLANE_TLM_STREAM_TOTAL] =
+{
+    [AIRPLANE_TLM_HEARTBEAT] = {.period_ms = 200, .elapsed_ms = 0, .priority = 0},
+#if AIRPLANE_TLM_COMPACT_EN
+    [AIRPLANE_TLM_COMPACT] = {.period_ms = 20, .elapsed_ms = 0, .priority = 1},
+    [AIRPLANE_TLM_AHRS] = {.period_ms = 200, .elapsed_ms = 0, .priority = 4},
+    [AIRPLANE_TLM_SETPOINT] = {.period_ms = 0, .elapsed_ms = 0, .priority = 2},
+    [AIRPLANE_TLM_RC] = {.period_ms = 100, .elapsed_ms = 0, .priority = 2},
+    [AIRPLANE_TLM_PID_VAL] = {.period_ms = 500, .elapsed_ms = 0, .priority = 4},
+#else
+    [AIRPLANE_TLM_COMPACT] = {.period_ms = 0, .elapsed_ms = 0, .priority = 1},
+    [AIRPLANE_TLM_AHRS] = {.period_ms = 50, .elapsed_ms = 0, .priority = 1},
+    [AIRPLANE_TLM_SETPOINT] = {.period_ms = 100, .elapsed_ms = 0, .priority = 2},
+    [AIRPLANE_TLM_RC] = {.period_ms = 100, .elapsed_ms = 0, .priority = 2},
+    [AIRPLANE_TLM_PID_VAL] = {.period_ms = 100, .elapsed_ms = 0, .priority = 3},
+#endif
+    [AIRPLANE_TLM_PID_CFG] = {.period_ms = 2000, .elapsed_ms = 0, .priority = 6},
+    [AIRPLANE_TLM_GPS_FIX] = {.period_ms = 200, .elapsed_ms = 0, .priority = 3},
+    [AIRPLANE_TLM_GPS_NAV] = {.period_ms = 200, .elapsed_ms = 0, .priority = 3},
+    [AIRPLANE_TLM_ERR_LOG] = {.period_ms = 1000, .elapsed_ms = 0, .priority = 5},
+#if AIRPLANE_BLACKBOX_EN
+    [AIRPLANE_TLM_BLACKBOX] = {.period_ms = 20, .elapsed_ms = 0, .priority = 5},
+#else
+    [AIRPLANE_TLM_BLACKBOX] = {.period_ms = 0, .elapsed_ms = 0, .priority = 5},
+#endif
+    [AIRPLANE_TLM_LINK] = {.period_ms = 1000, .elapsed_ms = 0, .priority = 6},
+#if LATENCY_EN
+    [AIRPLANE_TLM_LATENCY] = {.period_ms = 1000, .elapsed_ms = 0, .priority = 6},
+#else
+    [AIRPLANE_TLM_LATENCY] = {.period_ms = 0, .elapsed_ms = 0, .priority = 6},
+#endif
+};
+
+#if AIRPLANE_TLM_COMPACT_EN
+/* Compact telemetry fields of last frame, and frames since last keyframe */
+static int16_t Airplane_TlmLastVal[AIRPLANE_TLM_FIELD_TOTAL];
+static uint8_t Airplane_TlmKeyCnt = 0;
+#endif
+
+#if AIRPLANE_BLACKBOX_EN
+/* Samples around last trigger */
+static BLACKBOX_DATA Airplane_Blackbox;
+
+static_assert(AIRPLANE_BB_FIELD_TOTAL <= BLACKBOX_FIELD_MAX, "Too many blackbox fields");
 #endif
 
 
@@ -407,15 +614,103 @@ static int8_t Airplane_ClearConfig(AIRPLANE_CONFIG *p_config);
 static void Airplane_RemoteCtrlCalibration();
 static void Airplane_ConfigControl();
 static uint8_t Airplane_GetDipSwOpt();
-static void Airplane_UpdateAdcIO();
+static AIRPLANE_TICK *Airplane_BeginTick();
+static void Airplane_PublishTick();
+static AIRPLANE_TICK *Airplane_GetTick();
+static void Airplane_UpdateAdcIO(AIRPLANE_TICK *p_tick);
 static int8_t Airplane_MixRC(int16_t *p_aile_mix_diff, int16_t *p_elev_mix_diff,
                              int16_t *p_rudd_mix_diff, AIRPLANE_TYPE wing_type);
 static void Airplane_UpdatePidParam();
 static AIRPLANE_FLY_MODE Airplane_ChkFlyMode(uint16_t *p_rc_in);
+static int8_t Airplane_SetNavWpt(bool is_mission);
 static float Airplane_CalAngleDiff(float current_angle, float target_angle,
                                    float max_angle, float min_angle);
 static void Airplane_TxMessage(uint32_t delta_time);
-static void Airplane_RxMessage();
+static uint8_t Airplane_TxStream(uint8_t stream_id, AIRPLANE_TICK *p_tick, bool is_send);
+static uint8_t Airplane_TlmRecord(MP_RECORD *p_records, uint8_t record_num,
+                                  uint8_t cmd, void *p_data, uint8_t data_size);
+static uint8_t Airplane_TxRecords(MP_RECORD *p_records, uint8_t record_num, bool is_send);
+#if AIRPLANE_TLM_COMPACT_EN
+static uint8_t Airplane_TxCompactStatus(AIRPLANE_TICK *p_tick);
+#endif
+#if AIRPLANE_TLM_COMPACT_EN || AIRPLANE_BLACKBOX_EN
+static int16_t Airplane_TlmQuantize(float value, float scale);
+static int16_t Airplane_TlmHeading(float heading_angle);
+#endif
+#if AIRPLANE_BLACKBOX_EN
+static void Airplane_BlackboxTask(IMU_SENSOR_DATA *p_imu_data);
+static uint8_t Airplane_TxBlackbox();
+#endif
+static uint8_t Airplane_TxLinkStats();
+#if LATENCY_EN
+static uint8_t Airplane_TxLatency();
+#endif
+static bool Airplane_RxMessage();
+static void Airplane_RxDispatch(MP_FRAME_HDR *p_rx_hdr);
+#if defined(IMU_SENSOR_FG_EN)
+static void Airplane_RxImuSensor(uint8_t cmd, uint8_t *p_payload, uint8_t len);
+#endif
+#if defined(IMU_SENSOR_ANGLE_FROM_FG) && IMU_SENSOR_ANGLE_FROM_FG
+static void Airplane_RxNedAngle(uint8_t cmd, uint8_t *p_payload, uint8_t len);
+#endif
+#if GPS_BENCH_EN
+static void Airplane_RxGpsBench(uint8_t cmd, uint8_t *p_payload, uint8_t len);
+#endif
+static void Airplane_RxParam(uint8_t cmd, uint8_t *p_payload, uint8_t len);
+static void Airplane_RxPid(uint8_t cmd, uint8_t *p_payload, uint8_t len);
+static void Airplane_RxWpt(uint8_t cmd, uint8_t *p_payload, uint8_t len);
+static void Airplane_RxMission(uint8_t cmd, uint8_t *p_payload, uint8_t len);
+static void Airplane_RxMissionStart(uint8_t cmd, uint8_t *p_payload, uint8_t len);
+static void Airplane_RxSave(uint8_t cmd, uint8_t *p_payload, uint8_t len);
+static void Airplane_RxTlmRate(uint8_t cmd, uint8_t *p_payload, uint8_t len);
+static void Airplane_RxBaud(uint8_t cmd, uint8_t *p_payload, uint8_t len);
+static void Airplane_RxLinkStats(uint8_t cmd, uint8_t *p_payload, uint8_t len);
+#if LATENCY_EN
+static void Airplane_RxLatency(uint8_t cmd, uint8_t *p_payload, uint8_t len);
+#endif
+static void Airplane_ApplyPidConfig(uint8_t pid_idx);
+static int8_t Airplane_SetParam(uint8_t param_id, float value);
+static int8_t Airplane_GetParam(uint8_t param_id, float *p_value);
+static float *Airplane_GetPidField(AIRPLANE_PID_CONFIG *p_pid_cfg, uint8_t field_idx);
+static int8_t Airplane_ChkPidField(uint8_t field_idx, float value);
+static bool Airplane_IsCoordValid(GPS_COORD_POINT *p_coord);
+static int8_t Airplane_SetWpt(AIRPLANE_MP_WPT *p_mp_wpt);
+static int8_t Airplane_GetWpt(AIRPLANE_MP_WPT *p_mp_wpt);
+static void Airplane_SaveConfigTask();
+static void Airplane_MissionTask();
+static void Airplane_BaudTask(bool is_rx_frm);
+
+/* MP request dispatching table, see Airplane_RxDispatch() */
+static const AIRPLANE_RX_CMD Airplane_RxCmdTable[] PROGMEM =
+{
+#if defined(IMU_SENSOR_FG_EN)
+    {MP_REQ_IMU_SENSOR_DATA,    sizeof(AIRPLANE_MP_IMU_SENSOR), Airplane_RxImuSensor},
+#endif
+#if defined(IMU_SENSOR_ANGLE_FROM_FG) && IMU_SENSOR_ANGLE_FROM_FG
+    {MP_REQ_NED_ANGLE_DATA,     sizeof(AHRS_NED_ATTITUDE),      Airplane_RxNedAngle},
+#endif
+#if GPS_BENCH_EN
+    {MP_REQ_GPS_BENCH_RESET,    AIRPLANE_RX_LEN_ANY,            Airplane_RxGpsBench},
+    {MP_REQ_GPS_BENCH_FEED,     AIRPLANE_RX_LEN_ANY,            Airplane_RxGpsBench},
+#endif
+    {MP_REQ_CFG_PARAM_READ,     sizeof(AIRPLANE_MP_PARAM),      Airplane_RxParam},
+    {MP_REQ_CFG_PARAM_WRITE,    sizeof(AIRPLANE_MP_PARAM),      Airplane_RxParam},
+    {MP_REQ_CFG_PID_READ,       sizeof(AIRPLANE_MP_PID),        Airplane_RxPid},
+    {MP_REQ_CFG_PID_WRITE,      sizeof(AIRPLANE_MP_PID),        Airplane_RxPid},
+    {MP_REQ_CFG_WPT_READ,       sizeof(AIRPLANE_MP_WPT),        Airplane_RxWpt},
+    {MP_REQ_CFG_WPT_WRITE,      sizeof(AIRPLANE_MP_WPT),        Airplane_RxWpt},
+    {MP_REQ_CFG_MISSION_BEGIN,  sizeof(AIRPLANE_MP_MISSION),    Airplane_RxMission},
+    {MP_REQ_CFG_MISSION_END,    sizeof(AIRPLANE_MP_MISSION),    Airplane_RxMission},
+    {MP_REQ_CFG_MISSION_START,  sizeof(AIRPLANE_MP_MISSION_START), Airplane_RxMissionStart},
+    {MP_REQ_CFG_SAVE,           sizeof(AIRPLANE_MP_SAVE),       Airplane_RxSave},
+    {MP_REQ_CFG_TLM_RATE_READ,  sizeof(AIRPLANE_MP_TLM_RATE),   Airplane_RxTlmRate},
+    {MP_REQ_CFG_TLM_RATE_WRITE, sizeof(AIRPLANE_MP_TLM_RATE),   Airplane_RxTlmRate},
+    {MP_REQ_CFG_BAUD,           sizeof(AIRPLANE_MP_BAUD),       Airplane_RxBaud},
+    {MP_REQ_SYS_LINK_STATS,     0,                              Airplane_RxLinkStats},
+#if LATENCY_EN
+    {MP_REQ_SYS_LATENCY,        0,                              Airplane_RxLatency},
+#endif
+};
 
 
 /*
@@ -447,12 +742,13 @@ void loop()
 {
     Airplane_FlyCtrl();
 
-    /* Blink twice per second for AIRPLANE_RETURN_TO_HOME mode. */
-    if(Airplane_Status.general.fly_mode == AIRPLANE_RETURN_TO_HOME){
+    /* Blink twice per second for AIRPLANE_RETURN_TO_HOME and AIRPLANE_FLY_MISSION mode. */
+    if(Airplane_GetTick()->general.fly_mode == AIRPLANE_RETURN_TO_HOME
+       || Airplane_GetTick()->general.fly_mode == AIRPLANE_FLY_MISSION){
         LEDS_Lightning(LEDS_MASTER_IDX, 600, 100, 100);
     }
     /* Blink twice per 2 second for AIRPLANE_SELF_STABILIZE mode. */
-    else if(Airplane_Status.general.fly_mode == AIRPLANE_SELF_STABILIZE){
+    else if(Airplane_GetTick()->general.fly_mode == AIRPLANE_SELF_STABILIZE){
         LEDS_Lightning(LEDS_MASTER_IDX, 1600, 100, 100);
     }
     /* Blink twice per 4 second for manual mode. */
@@ -488,7 +784,7 @@ static int8_t Airplane_Init()
     uint8_t current_wpt_idx;
 
     /* UART0 initialization */
-    Uart0_Init(57600);
+    Uart0_Init(AIRPLANE_UART0_BAUD);
     Uart0_Println(PSTR("[Airplane] ONERC_LIB"));
     Uart0_Println(PSTR("[Airplane] FW date = %X"), AIRPLANE_FW_DATE);
 
@@ -532,6 +828,10 @@ static int8_t Airplane_Init()
     RCIN_SetMaxMinStick(Airplane_Config.rc_in_max_ticks, Airplane_Config.rc_in_min_ticks);
     RCIN_Init();
 
+#if LATENCY_EN
+    Latency_Init();
+#endif
+
     /* Initial RC output channel */
     RCOUT_Init();
 
@@ -562,6 +862,13 @@ static int8_t Airplane_Init()
         Uart0_Println(PSTR(""));
     }
 
+    /*
+     * Load stored mission, it's not flown until it's started by ground tool
+     * (MP_REQ_CFG_MISSION_START), so return to home and failsafe always fly
+     * to home after boot.
+     */
+    Mission_Init();
+
     Uart0_Println(PSTR("[GPS] loiter radius = %f meters"), AIRPLANE_GET_LOITER_RADIUS());
 
     /* Initial IMU sensors */
@@ -596,6 +903,9 @@ static int8_t Airplane_Init()
     IMU_Get6RawData(&imu_sensor_data);
     AHRS_Init(&(Airplane_Status.ahrs_data), imu_sensor_data.accel_raw);
 
+    /* Both status buffers start from default value */
+    Airplane_Tick[Airplane_TickFront ^ 1] = Airplane_Tick[Airplane_TickFront];
+
     /* Initial PID data and parameters for ROLL */
     PID_Create(&Airplane_Status.pid_aile_servo);
     PID_SetTuning(&Airplane_Status.pid_aile_servo,
@@ -638,6 +948,10 @@ static int8_t Airplane_Init()
 
     Airplane_RemoteCtrlCalibration();
 
+#if AIRPLANE_BLACKBOX_EN
+    Blackbox_Init(&Airplane_Blackbox, AIRPLANE_BB_FIELD_TOTAL, AIRPLANE_BB_POST_CNT);
+#endif
+
     /* Launch related initializing procedure and store new configuration to ROM if needed */
     Airplane_ConfigControl();
 
@@ -656,10 +970,14 @@ static void Airplane_FlyCtrl()
     static uint32_t prev_ctrl_update = Timer1_GetMicros();
     IMU_SENSOR_DATA imu_sensor_data = {0};
     AIRPLANE_NAVIGATION *p_nav_config;
+    AIRPLANE_TICK *p_tick;
     uint32_t current_ctrl_time;
     uint32_t delta_ctrl_time;
+    bool is_rx_frm;
     int16_t rc_in_diff[RCIN_CH_TOTAL];
     uint8_t prev_wpt_idx;
+    MISSION_GUIDANCE mission_guide;
+    GPS_RX_NMEA_TYPE nmea_type;
     float roll_cosine;
     float pitch_pid_gain;
     float pitch_setpoint;
@@ -677,6 +995,7 @@ static void Airplane_FlyCtrl()
     bool is_manual_elev;
     bool is_manual_rudd;
     bool is_nav_updated;
+    bool is_l1_guided;
 
     /* Check time difference */
     current_ctrl_time = Timer1_GetMicros();
@@ -685,6 +1004,9 @@ static void Airplane_FlyCtrl()
     /* Update AHRS, PID and output PWM every 5 ms */
     if(delta_ctrl_time >= AIRPLANE_CTRL_LOOP_PERIOD){
 
+        /* Status of this control cycle is written to the back buffer */
+        p_tick = Airplane_BeginTick();
+
         /* Read accelerometer and gyroscope raw data */
         if(IMU_Get6RawData(&imu_sensor_data) == 0){
             /* Update AHRS */
@@ -692,7 +1014,7 @@ static void Airplane_FlyCtrl()
                                 (uint16_t)delta_ctrl_time, &(Airplane_Status.ahrs_data));
         }
         else{
-            Airplane_Status.general.imu_fail_cnt++;
+            p_tick->general.imu_fail_cnt++;
         }
 
         /*
@@ -700,8 +1022,21 @@ static void Airplane_FlyCtrl()
          * this function may occupies 1 ms runtime per call.
          */
         is_nav_updated = false;
+        is_l1_guided = false;
+
+        nmea_type = GPS_UpdateNMEA(&Airplane_GPS);
+        if(nmea_type != GPS_RX_NMEA_TYPE_UNKNOWN){
 
-        if(GPS_UpdateNMEA(&Airplane_GPS) != GPS_RX_NMEA_TYPE_UNKNOWN){
+            /* Convert new position fix to mission local frame for leg guidance */
+            if(nmea_type == GPS_RX_NMEA_TYPE_GGA)
+                Mission_UpdateFix(&Airplane_GPS.nmea);
+
+            /*
+             * Waypoint bearing and distance are still updated on every fix in
+             * mission mode, AIRPLANE_TLM_GPS_NAV reports them, and they steer
+             * the airplane when L1 guidance is not available (stale fix or
+             * ground speed below MISSION_L1_MIN_SPEED_MS).
+             */
             if(GPS_UpdateNav(&Airplane_GPS) == 0){
                 is_nav_updated = true;
             }
@@ -713,23 +1048,30 @@ static void Airplane_FlyCtrl()
         }
 
         /* Read latest RC input value, range 0 or 1000 ~ 2000 us */
-        Airplane_Status.general.rcin_cyc_cnt = RCIN_ReadChannels(Airplane_Status.rc_pulse_in);
-        RCIN_GetChannelsDiff(Airplane_Status.rc_pulse_in, rc_in_diff);
+        p_tick->general.rcin_cyc_cnt = RCIN_ReadChannels(p_tick->rc_pulse_in);
+#if LATENCY_EN
+        Latency_RcInRead();
+#endif
+        RCIN_GetChannelsDiff(p_tick->rc_pulse_in, rc_in_diff);
 
         /* Check current fly mode according the input PWM width on AUX channel */
-        Airplane_Status.general.fly_mode = Airplane_ChkFlyMode(Airplane_Status.rc_pulse_in);
+        p_tick->general.fly_mode = Airplane_ChkFlyMode(p_tick->rc_pulse_in);
+
+        /* Fly to active mission waypoint in mission mode, otherwise to home */
+        if((p_tick->general.fly_mode == AIRPLANE_FLY_MISSION) != Airplane_IsNavMission)
+            Airplane_SetNavWpt(p_tick->general.fly_mode == AIRPLANE_FLY_MISSION);
 
         /* Reset PID for manual mode */
-        if(Airplane_Status.general.fly_mode == AIRPLANE_MANUAL_FLY){
+        if(p_tick->general.fly_mode == AIRPLANE_MANUAL_FLY){
 
             aile_pid_val = 0;
             elev_pid_val = 0;
             rudd_pid_val = 0;
 
-            Airplane_Status.setpoint.roll_angle = 0.0;
-            Airplane_Status.setpoint.pitch_angle = 0.0;
-            Airplane_Status.setpoint.heading_angle = Airplane_Status.ahrs_data.ned_att.heading_angle;
-            Airplane_Status.current_cruise_state = AIRPLANE_CRUISE_FORWARDTO_WPT;
+            p_tick->setpoint.roll_angle = 0.0;
+            p_tick->setpoint.pitch_angle = 0.0;
+            p_tick->setpoint.heading_angle = Airplane_Status.ahrs_data.ned_att.heading_angle;
+            p_tick->current_cruise_state = AIRPLANE_CRUISE_FORWARDTO_WPT;
 
             PID_Reset(&Airplane_Status.pid_aile_servo);
             PID_Reset(&Airplane_Status.pid_elev_servo);
@@ -743,10 +1085,29 @@ static void Airplane_FlyCtrl()
             is_manual_elev = (abs(rc_in_diff[RCIN_ELEV_IDX]) >= TIMER1_MICROS_TO_TICKS(20)) ? true : false;
             is_manual_rudd = (abs(rc_in_diff[RCIN_RUDD_IDX]) >= TIMER1_MICROS_TO_TICKS(20)) ? true : false;
 
-            /* Return to home */
-            if(Airplane_Status.general.fly_mode == AIRPLANE_RETURN_TO_HOME){
+            /* Return to home or fly mission */
+            if(p_tick->general.fly_mode == AIRPLANE_RETURN_TO_HOME
+               || p_tick->general.fly_mode == AIRPLANE_FLY_MISSION){
+
+                /*
+                 * Follow mission legs by L1 guidance every control cycle, the leg
+                 * geometry is precomputed when the active waypoint is changed.
+                 */
+                if(p_tick->general.fly_mode == AIRPLANE_FLY_MISSION
+                   && Mission_UpdateGuidance(GPS_GetFixAge(&Airplane_GPS), &mission_guide) == 0){
+
+                    is_l1_guided = true;
 
-                if(is_nav_updated == true){
+                    /*
+                     * Active waypoint is passed, switch to next leg. Mission is
+                     * completed if there is no next leg, then return to home.
+                     */
+                    if(mission_guide.is_leg_done == true){
+                        Mission_Advance();
+                        Airplane_SetNavWpt(Mission_IsActive());
+                    }
+                }
+                else if(is_nav_updated == true){
 
                     GPS_GetWptDistance(&Airplane_GPS, &wpt_distance);
 
@@ -756,9 +1117,9 @@ static void Airplane_FlyCtrl()
                      * the current distance to home point is larger than loiter_radius, and
                      * then we return to home point again.
                      */
-                    if(Airplane_Status.current_cruise_state == AIRPLANE_CRUISE_AWAYFROM_WPT){
+                    if(p_tick->current_cruise_state == AIRPLANE_CRUISE_AWAYFROM_WPT){
                         if(wpt_distance > Airplane_Config.navigation.loiter_radius)
-                            Airplane_Status.current_cruise_state = AIRPLANE_CRUISE_FORWARDTO_WPT;
+                            p_tick->current_cruise_state = AIRPLANE_CRUISE_FORWARDTO_WPT;
                     }
                     /* Forward to way point */
                     else{
@@ -770,24 +1131,38 @@ static void Airplane_FlyCtrl()
                         if(wpt_distance <= AIRPLANE_WPT_ARRIVE_RADIUS){
                             p_nav_config = &Airplane_Config.navigation;
 
-                            prev_wpt_idx = p_nav_config->current_wpt_idx;
-                            p_nav_config->current_wpt_idx++;
-                            if(p_nav_config->current_wpt_idx >= p_nav_config->total_wpt)
-                                p_nav_config->current_wpt_idx = 0;
+                            /*
+                             * Fly the mission legs, the next page is prefetched from ROM here.
+                             * Mission is completed if there is no next leg, then return to home,
+                             * or loiter if home is not set.
+                             */
+                            if(Airplane_IsNavMission == true){
 
-                            /* Update new waypoint if it's available */
-                            if(prev_wpt_idx != p_nav_config->current_wpt_idx
-                               && p_nav_config->wpt[p_nav_config->current_wpt_idx].is_actived){
-                                GPS_SetWpt(&Airplane_GPS, &(p_nav_config->wpt[p_nav_config->current_wpt_idx].wpt_coord));
+                                Mission_Advance();
+
+                                if(Airplane_SetNavWpt(Mission_IsActive()) != 0)
+                                    p_tick->current_cruise_state = AIRPLANE_CRUISE_AWAYFROM_WPT;
                             }
-                            /* Otherwise, enter loitering mode */
                             else{
-                                Airplane_Status.current_cruise_state = AIRPLANE_CRUISE_AWAYFROM_WPT;
+                                prev_wpt_idx = p_nav_config->current_wpt_idx;
+                                p_nav_config->current_wpt_idx++;
+                                if(p_nav_config->current_wpt_idx >= p_nav_config->total_wpt)
+                                    p_nav_config->current_wpt_idx = 0;
+
+                                /* Update new waypoint if it's available */
+                                if(prev_wpt_idx != p_nav_config->current_wpt_idx
+                                   && p_nav_config->wpt[p_nav_config->current_wpt_idx].is_actived){
+                                    GPS_SetWpt(&Airplane_GPS, &(p_nav_config->wpt[p_nav_config->current_wpt_idx].wpt_coord));
+                                }
+                                /* Otherwise, enter loitering mode */
+                                else{
+                                    p_tick->current_cruise_state = AIRPLANE_CRUISE_AWAYFROM_WPT;
+                                }
                             }
                         }
                         /* We are still faraway to current waypoint, keeping adjust heading angle */
                         else{
-                            Airplane_Status.setpoint.heading_angle = Airplane_Status.ahrs_data.ned_att.heading_angle
+                            p_tick->setpoint.heading_angle = Airplane_Status.ahrs_data.ned_att.heading_angle
                                                                    + GPS_GetWptRelativeBearing(&Airplane_GPS);
                         }
                     }
@@ -796,23 +1171,31 @@ static void Airplane_FlyCtrl()
             /* Stabilize mode */
             else{
                 /* Do nothing */
-                Airplane_Status.current_cruise_state = AIRPLANE_CRUISE_AWAYFROM_WPT;
+                p_tick->current_cruise_state = AIRPLANE_CRUISE_AWAYFROM_WPT;
             }
 
-            /* Update heading setpoint when the airplane pilot trying to control airplane roll or yaw manually */
-            if(is_manual_aile == true || is_manual_rudd == true){
-                Airplane_Status.setpoint.heading_angle = Airplane_Status.ahrs_data.ned_att.heading_angle;
+            /*
+             * Update heading setpoint when the airplane pilot trying to control airplane roll or yaw manually,
+             * or the bank angle is commanded by L1 guidance directly.
+             */
+            if(is_manual_aile == true || is_manual_rudd == true || is_l1_guided == true){
+                p_tick->setpoint.heading_angle = Airplane_Status.ahrs_data.ned_att.heading_angle;
             }
 
             /* Heading (bank turn), convert expected NED heading -> roll angle -> ailerons servo */
             heading_angle_diff = Airplane_CalAngleDiff(Airplane_Status.ahrs_data.ned_att.heading_angle,
-                                                       Airplane_Status.setpoint.heading_angle,
+                                                       p_tick->setpoint.heading_angle,
                                                        180.0, -180.0);
 
-            Airplane_Status.setpoint.roll_angle = (int16_t)PID_Update(&Airplane_Status.pid_band_turn,
+            p_tick->setpoint.roll_angle = (int16_t)PID_Update(&Airplane_Status.pid_band_turn,
                                                                       -heading_angle_diff,
                                                                       (uint16_t)delta_ctrl_time,
-                                                                      !(is_manual_aile || is_manual_rudd));
+                                                                      !(is_manual_aile || is_manual_rudd || is_l1_guided));
+
+            /* L1 guidance commands bank angle directly */
+            if(is_l1_guided == true && !(is_manual_aile || is_manual_rudd)){
+                p_tick->setpoint.roll_angle = mission_guide.bank_angle;
+            }
 
             /*
              * Compensate pitch setpoint and elevator PID scale according to current roll angle.
@@ -825,7 +1208,7 @@ static void Airplane_FlyCtrl()
             /* Increase NED pitch setpoint according to current roll angle (0 ~ +N degree). */
             pitch_setpoint = (1.0 - fabs(roll_cosine)) * AIRPLANE_BANK_TURN_PITCH_GAIN;
             pitch_setpoint = constrain(pitch_setpoint, 0, AIRPLANE_BANK_TURN_MAX_PITCH);
-            Airplane_Status.setpoint.pitch_angle = pitch_setpoint;
+            p_tick->setpoint.pitch_angle = pitch_setpoint;
 
             /* Increase elevator control gain (the divisor should not equal to 0) */
             if(roll_cosine != 0.0)
@@ -846,11 +1229,11 @@ static void Airplane_FlyCtrl()
 
             /* Calculate the angle difference between current attitude and expected attitude. */
             roll_angle_diff = Airplane_CalAngleDiff(Airplane_Status.ahrs_data.ned_att.roll_angle,
-                                                    Airplane_Status.setpoint.roll_angle,
+                                                    p_tick->setpoint.roll_angle,
                                                     180.0, -180.0);
 
             pitch_angle_diff = Airplane_CalAngleDiff(Airplane_Status.ahrs_data.ned_att.pitch_angle,
-                                                     Airplane_Status.setpoint.pitch_angle,
+                                                     p_tick->setpoint.pitch_angle,
                                                      90.0, -90.0);
 
             /* Update ailerons and elevator and rudder servo control PID */
@@ -878,50 +1261,121 @@ static void Airplane_FlyCtrl()
         Airplane_MixRC(&aile_out_diff, &elev_out_diff, &rudd_out_diff, Airplane_Config.model_type);
 
         /* Decide width of output control pulse for AILE, ELEV and RUDD */
-        Airplane_Status.rc_pulse_out[RCOUT_AILE_IDX] = Airplane_Config.rc_in_neutral_ticks[RCOUT_AILE_IDX] + aile_out_diff;
-        Airplane_Status.rc_pulse_out[RCOUT_ELEV_IDX] = Airplane_Config.rc_in_neutral_ticks[RCOUT_ELEV_IDX] + elev_out_diff;
-        Airplane_Status.rc_pulse_out[RCOUT_RUDD_IDX] = Airplane_Config.rc_in_neutral_ticks[RCOUT_RUDD_IDX] + rudd_out_diff;
+        p_tick->rc_pulse_out[RCOUT_AILE_IDX] = Airplane_Config.rc_in_neutral_ticks[RCOUT_AILE_IDX] + aile_out_diff;
+        p_tick->rc_pulse_out[RCOUT_ELEV_IDX] = Airplane_Config.rc_in_neutral_ticks[RCOUT_ELEV_IDX] + elev_out_diff;
+        p_tick->rc_pulse_out[RCOUT_RUDD_IDX] = Airplane_Config.rc_in_neutral_ticks[RCOUT_RUDD_IDX] + rudd_out_diff;
 
         /* Correct AILE, ELEV and RUDD pulse output range to 1000 ~ 2000 us */
-        Airplane_Status.rc_pulse_out[RCOUT_AILE_IDX] = constrain(Airplane_Status.rc_pulse_out[RCOUT_AILE_IDX],
+        p_tick->rc_pulse_out[RCOUT_AILE_IDX] = constrain(p_tick->rc_pulse_out[RCOUT_AILE_IDX],
                                                                  TIMER1_MICROS_TO_TICKS(1000),
                                                                  TIMER1_MICROS_TO_TICKS(2000));
-        Airplane_Status.rc_pulse_out[RCOUT_ELEV_IDX] = constrain(Airplane_Status.rc_pulse_out[RCOUT_ELEV_IDX],
+        p_tick->rc_pulse_out[RCOUT_ELEV_IDX] = constrain(p_tick->rc_pulse_out[RCOUT_ELEV_IDX],
                                                                  TIMER1_MICROS_TO_TICKS(1000),
                                                                  TIMER1_MICROS_TO_TICKS(2000));
-        Airplane_Status.rc_pulse_out[RCOUT_RUDD_IDX] = constrain(Airplane_Status.rc_pulse_out[RCOUT_RUDD_IDX],
+        p_tick->rc_pulse_out[RCOUT_RUDD_IDX] = constrain(p_tick->rc_pulse_out[RCOUT_RUDD_IDX],
                                                                  TIMER1_MICROS_TO_TICKS(1000),
                                                                  TIMER1_MICROS_TO_TICKS(2000));
 
         /* Output THRO pulse directly */
-        Airplane_Status.rc_pulse_out[RCOUT_THRO_IDX] = constrain(Airplane_Status.rc_pulse_in[RCIN_THRO_IDX],
+        p_tick->rc_pulse_out[RCOUT_THRO_IDX] = constrain(p_tick->rc_pulse_in[RCIN_THRO_IDX],
                                                                  TIMER1_MICROS_TO_TICKS(1000),
                                                                  TIMER1_MICROS_TO_TICKS(2000));
 
         /* Update ADC based data */
-        Airplane_UpdateAdcIO();
+        Airplane_UpdateAdcIO(p_tick);
 
         /* Update output PPM/PWM pulse width */
-        RCOUT_SetServoPWM(Airplane_Status.rc_pulse_out, RCOUT_CH_TOTAL);
-        Airplane_Status.general.rcout_cyc_cnt = RCOUT_GetCycUpdateCnt();
+        RCOUT_SetServoPWM(p_tick->rc_pulse_out, RCOUT_CH_TOTAL);
+        p_tick->general.rcout_cyc_cnt = RCOUT_GetCycUpdateCnt();
 
-        Airplane_Status.general.delta_ctrl_time = delta_ctrl_time;
-        Airplane_Status.heartbeat = Timer1_GetMillis();
+        p_tick->general.delta_ctrl_time = delta_ctrl_time;
+        p_tick->heartbeat = Timer1_GetMillis();
 
         if(delta_ctrl_time > AIRPLANE_CTRL_LOOP_DELAY_THR){
-            Airplane_Status.general.ahrs_delay_cnt++;
+            p_tick->general.ahrs_delay_cnt++;
         }
 
+        /* Control cycle is completed, publish it to telemetry and blackbox */
+        Airplane_PublishTick();
+
+#if AIRPLANE_BLACKBOX_EN
+        /* Record this control cycle and check blackbox triggers */
+        Airplane_BlackboxTask(&imu_sensor_data);
+#endif
+
         prev_ctrl_update = current_ctrl_time;
 
-        /* Receive protocol message */
-        Airplane_RxMessage();
+        /*
+         * Receive protocol message, uploaded parameters and waypoints are
+         * applied here, between two control cycles.
+         */
+#if RCIN_SERIAL_EN
+        /* UART0 RX is used by serial RC receiver (RCIN_ReadChannels()), there is no uplink */
+        is_rx_frm = false;
+#else
+        is_rx_frm = Airplane_RxMessage();
+#endif
+
+        /* Store uploaded configuration and mission to ROM in background */
+        Airplane_SaveConfigTask();
+        Airplane_MissionTask();
+
+        /* Switch or confirm UART0 baud rate requested by ground tool */
+        Airplane_BaudTask(is_rx_frm);
 
         /* Transmit protocol message */
         Airplane_TxMessage(delta_ctrl_time);
     }
 }
 
+/**
+ * Airplane_BeginTick - Function to start a control cycle on the back buffer,
+ *                      values which are accumulated or kept across cycles are
+ *                      carried over from the published cycle.
+ *
+ * @param   [none]
+ * @return  [AIRPLANE_TICK *]   Back buffer of control cycle status.
+ *
+ */
+static AIRPLANE_TICK *Airplane_BeginTick()
+{
+    AIRPLANE_TICK *p_front = &Airplane_Tick[Airplane_TickFront];
+    AIRPLANE_TICK *p_back = &Airplane_Tick[Airplane_TickFront ^ 1];
+
+    p_back->setpoint = p_front->setpoint;
+    p_back->current_cruise_state = p_front->current_cruise_state;
+    p_back->general.imu_fail_cnt = p_front->general.imu_fail_cnt;
+    p_back->general.ahrs_delay_cnt = p_front->general.ahrs_delay_cnt;
+    p_back->general.mcu_vcc = p_front->general.mcu_vcc;
+
+    return p_back;
+}
+
+/**
+ * Airplane_PublishTick - Function to publish completed control cycle by
+ *                        swapping front and back buffer.
+ *
+ * @param   [none]
+ * @return  [none]
+ *
+ */
+static void Airplane_PublishTick()
+{
+    Airplane_TickFront ^= 1;
+}
+
+/**
+ * Airplane_GetTick - Function to get status of last completed control cycle.
+ *
+ * @param   [none]
+ * @return  [AIRPLANE_TICK *]   Front buffer of control cycle status.
+ *
+ */
+static AIRPLANE_TICK *Airplane_GetTick()
+{
+    return &Airplane_Tick[Airplane_TickFront];
+}
+
 /**
  * Airplane_LoadConfig - Function to load airplane configuration from ROM.
 
@@ -1190,6 +1644,7 @@ static void Airplane_RemoteCtrlCalibration()
 static void Airplane_ConfigControl()
 {
     GPS_COORD_POINT home_point;
+    uint16_t rc_pulse_in[RCIN_CH_TOTAL];
     uint8_t gps_sample_cnt;
     uint32_t detect_start;
     uint32_t led_time;
@@ -1201,24 +1656,24 @@ static void Airplane_ConfigControl()
     while((Timer1_GetMillis() - detect_start) < AIRPLANE_CHK_CFG_MODE_TIMEOUT){
 
         /* Check current RX pulse width */
-        RCIN_ReadChannels(Airplane_Status.rc_pulse_in);
+        RCIN_ReadChannels(rc_pulse_in);
 
         /*
         * Activate IMU calibration procedure when current
         * TX elevator stick is in bottom position
         */
-        if(Airplane_Status.rc_pulse_in[RCIN_ELEV_IDX] >= TIMER1_MICROS_TO_TICKS(900)
-           && Airplane_Status.rc_pulse_in[RCIN_ELEV_IDX] <= TIMER1_MICROS_TO_TICKS(1200)){
+        if(rc_pulse_in[RCIN_ELEV_IDX] >= TIMER1_MICROS_TO_TICKS(900)
+           && rc_pulse_in[RCIN_ELEV_IDX] <= TIMER1_MICROS_TO_TICKS(1200)){
 
             LEDS_PwrON(LEDS_MASTER_IDX);
 
             do{
                 /* Check current RX pulse width */
-                RCIN_ReadChannels(Airplane_Status.rc_pulse_in);
+                RCIN_ReadChannels(rc_pulse_in);
 
                 /* Clear configuration when TX ailerons stick is in left position. */
-                if(Airplane_Status.rc_pulse_in[RCIN_AILE_IDX] >= TIMER1_MICROS_TO_TICKS(1800)
-                   && Airplane_Status.rc_pulse_in[RCIN_AILE_IDX] <= TIMER1_MICROS_TO_TICKS(2100)){
+                if(rc_pulse_in[RCIN_AILE_IDX] >= TIMER1_MICROS_TO_TICKS(1800)
+                   && rc_pulse_in[RCIN_AILE_IDX] <= TIMER1_MICROS_TO_TICKS(2100)){
 
                     Airplane_ClearConfig(&Airplane_Config);
 
@@ -1228,8 +1683,8 @@ static void Airplane_ConfigControl()
                  * Do IMU sensors calibration and save the bias to ROM when TX ailerons stick is
                  * in right position.
                  */
-                else if(Airplane_Status.rc_pulse_in[RCIN_AILE_IDX] >= TIMER1_MICROS_TO_TICKS(900)
-                        && Airplane_Status.rc_pulse_in[RCIN_AILE_IDX] <= TIMER1_MICROS_TO_TICKS(1200)){
+                else if(rc_pulse_in[RCIN_AILE_IDX] >= TIMER1_MICROS_TO_TICKS(900)
+                        && rc_pulse_in[RCIN_AILE_IDX] <= TIMER1_MICROS_TO_TICKS(1200)){
 
                     IMU_DoCalibration(IMU_SENSOR_CAL_RUNTIME);
                     IMU_GetCalibratedBias(Airplane_Config.accel_bias, Airplane_Config.gyro_bias);
@@ -1251,8 +1706,8 @@ static void Airplane_ConfigControl()
         /*
         * Activate GPS homepoint setup procedure when TX elevator stick is in top position
         */
-        else if(Airplane_Status.rc_pulse_in[RCIN_ELEV_IDX] >= TIMER1_MICROS_TO_TICKS(1800)
-                && Airplane_Status.rc_pulse_in[RCIN_ELEV_IDX] <= TIMER1_MICROS_TO_TICKS(2100)){
+        else if(rc_pulse_in[RCIN_ELEV_IDX] >= TIMER1_MICROS_TO_TICKS(1800)
+                && rc_pulse_in[RCIN_ELEV_IDX] <= TIMER1_MICROS_TO_TICKS(2100)){
 
             gps_sample_cnt = 0;
 
@@ -1372,7 +1827,7 @@ static uint8_t Airplane_GetDipSwOpt()
  * @return  [none]
  *
  */
-static void Airplane_UpdateAdcIO()
+static void Airplane_UpdateAdcIO(AIRPLANE_TICK *p_tick)
 {
     static uint8_t adc_idx = 0;
 
@@ -1382,7 +1837,9 @@ static void Airplane_UpdateAdcIO()
         case 0:
 
 #if AIRPLANE_PID_POT_EN
-            Airplane_UpdatePidParam();
+            /* Configuration is not changed while it's being saved */
+            if(Airplane_IsGndTuned == false && Airplane_SaveState == AIRPLANE_SAVE_IDLE)
+                Airplane_UpdatePidParam();
 #endif
             break;
 
@@ -1390,7 +1847,8 @@ static void Airplane_UpdateAdcIO()
         case 1:
 
             /* 20.0 ~ 224.6 meters */
-            Airplane_Config.navigation.loiter_radius = AIRPLANE_GET_LOITER_RADIUS();
+            if(Airplane_IsGndTuned == false && Airplane_SaveState == AIRPLANE_SAVE_IDLE)
+                Airplane_Config.navigation.loiter_radius = AIRPLANE_GET_LOITER_RADIUS();
 
             break;
 
@@ -1410,7 +1868,7 @@ static void Airplane_UpdateAdcIO()
             break;
 
         case 3:
-            Airplane_Status.general.mcu_vcc = ADC_ReadSysVoltage();
+            p_tick->general.mcu_vcc = ADC_ReadSysVoltage();
 
             break;
 
@@ -1605,6 +2063,8 @@ static void Airplane_UpdatePidParam()
  * @retval  [AIRPLANE_MANUAL_FLY]
  * @retval  [AIRPLANE_SELF_STABILIZE]
  * @retval  [AIRPLANE_RETURN_TO_HOME]
+ * @retval  [AIRPLANE_FLY_MISSION]      Return to home is selected and ROM
+ *                                      mission is started by ground tool.
  *
  */
 static AIRPLANE_FLY_MODE Airplane_ChkFlyMode(uint16_t *p_rc_in)
@@ -1622,11 +2082,68 @@ static AIRPLANE_FLY_MODE Airplane_ChkFlyMode(uint16_t *p_rc_in)
     }
     else{
         fly_mode = AIRPLANE_RETURN_TO_HOME;
+        Airplane_IsMissionArmed = false;
+    }
+
+    /*
+     * Stop the mission if RC failsafe has been applied since it's started
+     * (failsafe pulse of AUX1 selects AIRPLANE_RETURN_TO_HOME), or it's
+     * completed.
+     */
+    if(RCIN_GetFailCnt() != Airplane_MissionFailCnt || Mission_IsActive() == false)
+        Airplane_IsMissionArmed = false;
+
+    if(Airplane_IsMissionArmed == false){
+        Mission_Stop();
+    }
+    else if(fly_mode == AIRPLANE_RETURN_TO_HOME){
+        fly_mode = AIRPLANE_FLY_MISSION;
     }
 
     return fly_mode;
 }
 
+/**
+ * Airplane_SetNavWpt - Function to set GPS navigation waypoint to active
+ *                      mission waypoint or home (current waypoint of
+ *                      configuration).
+ *
+ * @param   [input]     is_mission      Fly to active mission waypoint.
+ *
+ * @return  [int8_t]    Function executing result.
+ * @retval  [0]         Success.
+ * @retval  [-1]        Fail, the waypoint is not available.
+ *
+ */
+static int8_t Airplane_SetNavWpt(bool is_mission)
+{
+    AIRPLANE_NAVIGATION *p_nav_config;
+    GPS_COORD_POINT mission_wpt;
+
+    Airplane_IsNavMission = false;
+
+    if(is_mission == true){
+
+        if(Mission_GetActiveWpt(&mission_wpt) != 0)
+            return -1;
+
+        GPS_SetWpt(&Airplane_GPS, &mission_wpt);
+        Airplane_IsNavMission = true;
+
+        return 0;
+    }
+
+    p_nav_config = &Airplane_Config.navigation;
+
+    if(p_nav_config->total_wpt == 0
+       || p_nav_config->wpt[p_nav_config->current_wpt_idx].is_actived == false)
+        return -1;
+
+    GPS_SetWpt(&Airplane_GPS, &(p_nav_config->wpt[p_nav_config->current_wpt_idx].wpt_coord));
+
+    return 0;
+}
+
 /**
  * Airplane_CalAngleDiff - Function to calculate the angle difference between current
  *                         angle and target angle.
@@ -1663,6 +2180,15 @@ static float Airplane_CalAngleDiff(float current_angle, float target_angle,
  * Airplane_TxMessage - Function to transmit FC status to external tool
  *                      via UART interface.
  *
+ *                      Each telemetry stream is due when its period is
+ *                      elapsed, the due stream with highest priority (most
+ *                      overdue if same priority) is sent first. A stream
+ *                      which doesn't fit in UART TX FIFO or byte budget is
+ *                      skipped in this cycle, smaller lower priority streams
+ *                      may still fill the remaining budget. The skipped
+ *                      stream keeps its overdue time, so it is tried first
+ *                      in later cycles.
+ *
  * @param   [in]        delta_time
  *
  * @return  [none]
@@ -1671,178 +2197,1488 @@ static float Airplane_CalAngleDiff(float current_angle, float target_angle,
 static void Airplane_TxMessage(uint32_t delta_time)
 {
     static uint32_t accum_delta_time = 0;
-    static uint8_t mp_send_idx = 0;
-
-#if AIRPLANE_STATUS_SNAPSHOT_EN
-    static AIRPLANE_STATUS *p_current_status = &Airplane_StatusSnapshot;
-#else
-    static AIRPLANE_STATUS *p_current_status = &Airplane_Status;
-#endif
-
-    /*
-     * Send out airplay status every 10ms sequentially.
-     * 20 ms * 5 kinds status = 100 ms, 10Hz update rate.
-     */
+    static uint32_t tx_budget = 0;          /* Bytes * 1000000 */
+    AIRPLANE_TLM_STREAM *p_stream;
+    uint16_t delta_ms;
+    uint8_t stream_idx;
+    uint8_t send_idx;
+    uint8_t tx_bytes;
+    uint32_t skip_mask;                     /* Streams which don't fit in this cycle */
+
+    /* All streams of this call are sent from the same published control cycle */
+    AIRPLANE_TICK *p_tick = Airplane_GetTick();
+
+    /* Avoid overflow after long blocking, up to 1M baud */
+    if(delta_time > 20000)
+        delta_time = 20000;
+
+    /* Byte budget */
+    tx_budget += delta_time * AIRPLANE_TLM_BYTES_PER_SEC(Uart0_GetBaud());
+    if(tx_budget > AIRPLANE_TLM_BURST_BYTES * 1000000UL)
+        tx_budget = AIRPLANE_TLM_BURST_BYTES * 1000000UL;
+
+    /* Stream timing */
     accum_delta_time += delta_time;
-    if(accum_delta_time >= 20000){
+    delta_ms = accum_delta_time / 1000;
+    accum_delta_time -= (uint32_t)delta_ms * 1000;
 
-        switch(mp_send_idx){
+    for(stream_idx = 0; stream_idx < AIRPLANE_TLM_STREAM_TOTAL; stream_idx++){
+        p_stream = &Airplane_TlmStream[stream_idx];
 
-            /* General status */
-            case 0:
+        if(p_stream->elapsed_ms > 0xFFFF - delta_ms)
+            p_stream->elapsed_ms = 0xFFFF;
+        else
+            p_stream->elapsed_ms += delta_ms;
+    }
 
-#if AIRPLANE_STATUS_SNAPSHOT_EN
-                /* Store current completed status */
-                memcpy((void *)&Airplane_StatusSnapshot, (void *)&Airplane_Status,
-                       sizeof(Airplane_StatusSnapshot));
-#endif
+    /* Let TX FIFO drain before changing baud rate */
+    if(Airplane_BaudState == AIRPLANE_BAUD_SWITCH)
+        return;
 
-                MP_Send(MP_RSP_SYS_HEARTBEAT, (uint8_t *)&(p_current_status->heartbeat),
-                        sizeof((p_current_status->heartbeat)));
-                MP_Send(MP_RSP_SYS_GENERAL, (uint8_t *)&(p_current_status->general),
-                        sizeof((p_current_status->general)));
-                MP_Send(MP_RSP_SYS_SETPOINT, (uint8_t *)&(p_current_status->setpoint),
-                        sizeof(p_current_status->setpoint));
-                MP_Send(MP_RSP_SYS_CRUISE_STATE, (uint8_t *)&(p_current_status->current_cruise_state),
-                        sizeof(p_current_status->current_cruise_state));
-                MP_Send(MP_RSP_IN_CHANNELS, (uint8_t *)(p_current_status->rc_pulse_in),
-                        sizeof(p_current_status->rc_pulse_in));
-                MP_Send(MP_RSP_OUT_CHANNELS, (uint8_t *)(p_current_status->rc_pulse_out),
-                        sizeof(p_current_status->rc_pulse_out));
+    skip_mask = 0;
 
-                break;
+    while(1){
 
-            /* AHRS status */
-            case 1:
+        /* Find the due stream with highest priority */
+        send_idx = AIRPLANE_TLM_STREAM_TOTAL;
 
-                MP_Send(MP_RSP_AHRS_FULL, (uint8_t *)&(p_current_status->ahrs_data),
-                        sizeof((p_current_status->ahrs_data)));
-                break;
+        for(stream_idx = 0; stream_idx < AIRPLANE_TLM_STREAM_TOTAL; stream_idx++){
+            p_stream = &Airplane_TlmStream[stream_idx];
 
-            /* PID status */
-            case 2:
-                MP_Send(MP_RSP_PID_VAL_ROLL, (uint8_t *)&(p_current_status->pid_aile_servo.value),
-                        sizeof(p_current_status->pid_aile_servo.value));
-                MP_Send(MP_RSP_PID_VAL_PITCH, (uint8_t *)&(p_current_status->pid_elev_servo.value),
-                        sizeof(p_current_status->pid_elev_servo.value));
-                MP_Send(MP_RSP_PID_VAL_YAW, (uint8_t *)&(p_current_status->pid_rudd_servo.value),
-                        sizeof(p_current_status->pid_rudd_servo.value));
-                MP_Send(MP_RSP_PID_VAL_BANK, (uint8_t *)&(p_current_status->pid_band_turn.value),
-                        sizeof(p_current_status->pid_rudd_servo.value));
-                break;
+            if(p_stream->period_ms == 0 || p_stream->elapsed_ms < p_stream->period_ms)
+                continue;
 
-            /* PID configuration */
-            case 3:
-
-                MP_Send(MP_RSP_PID_CFG_ROLL, (uint8_t *)&(p_current_status->pid_aile_servo.config),
-                        sizeof(p_current_status->pid_aile_servo.config));
-                MP_Send(MP_RSP_PID_CFG_PITCH, (uint8_t *)&(p_current_status->pid_elev_servo.config),
-                        sizeof(p_current_status->pid_elev_servo.config));
-                MP_Send(MP_RSP_PID_CFG_YAW, (uint8_t *)&(p_current_status->pid_rudd_servo.config),
-                        sizeof(p_current_status->pid_rudd_servo.config));
-                MP_Send(MP_RSP_PID_CFG_BANK, (uint8_t *)&(p_current_status->pid_band_turn.config),
-                        sizeof(p_current_status->pid_rudd_servo.config));
-                break;
+            if(skip_mask & ((uint32_t)1 << stream_idx))
+                continue;
 
-            /* GPS */
-            case 4:
-
-                MP_Send(MP_RSP_GPS_GENERAL, (uint8_t *)&Airplane_GPS.general,
-                        sizeof(Airplane_GPS.general));
-                MP_Send(MP_RSP_GPS_NMEA_GGA, (uint8_t *)&Airplane_GPS.nmea.gpgga,
-                        sizeof(Airplane_GPS.nmea.gpgga));
-                MP_Send(MP_RSP_GPS_NMEA_RMC, (uint8_t *)&Airplane_GPS.nmea.gprmc,
-                        sizeof(Airplane_GPS.nmea.gprmc));
-                MP_Send(MP_RSP_GPS_WAYPOINT, (uint8_t *)&Airplane_GPS.wpt,
-                        sizeof(Airplane_GPS.wpt));
-                MP_Send(MP_RSP_GPS_NAVIGATION, (uint8_t *)&Airplane_GPS.nav,
-                        sizeof(Airplane_GPS.nav));
-                MP_Send(MP_RSP_GPS_ERR_LOG, (uint8_t *)&GPS_ErrorLog,
-                        sizeof(GPS_ErrorLog));
+            if(send_idx == AIRPLANE_TLM_STREAM_TOTAL
+            || p_stream->priority < Airplane_TlmStream[send_idx].priority
+            || (p_stream->priority == Airplane_TlmStream[send_idx].priority
+                && (p_stream->elapsed_ms - p_stream->period_ms)
+                   > (Airplane_TlmStream[send_idx].elapsed_ms - Airplane_TlmStream[send_idx].period_ms))){
+                send_idx = stream_idx;
+            }
+        }
 
-                break;
+        if(send_idx == AIRPLANE_TLM_STREAM_TOTAL)
+            break;
 
-            default:
-                break;
+        /* Wait until whole stream can be sent, try smaller streams */
+        tx_bytes = Airplane_TxStream(send_idx, p_tick, false);
+        if(tx_bytes * 1000000UL > tx_budget || tx_bytes > Uart0_GetTxFree()){
+            skip_mask |= ((uint32_t)1 << send_idx);
+            continue;
         }
 
-        mp_send_idx++;
-        if(mp_send_idx > 4)
-            mp_send_idx = 0;
+        tx_bytes = Airplane_TxStream(send_idx, p_tick, true);
 
-        accum_delta_time = 0;
+        tx_budget -= tx_bytes * 1000000UL;
+        Airplane_TlmStream[send_idx].elapsed_ms = 0;
     }
 }
 
 /**
- * Airplane_RxMessage - Function to receive FC message transmitted by external tool
- *                      via UART interface.
+ * Airplane_TxStream - Function to transmit all frames of telemetry stream, or
+ *                     get total bytes of them.
  *
- * @param   [none]
- * @return  [none]
+ * @param   [in]        stream_id   Stream ID (AIRPLANE_TLM_STREAM_ID).
+ * @param   [in]        *p_tick     Published control cycle status.
+ * @param   [in]        is_send     true: send frames, false: get bytes only.
+ *
+ * @return  [uint8_t]   Total frame bytes, max bytes for variable length frame
+ *                      if is_send is false.
  *
  */
-static void Airplane_RxMessage()
+static uint8_t Airplane_TxStream(uint8_t stream_id, AIRPLANE_TICK *p_tick, bool is_send)
 {
-    struct{
-        uint16_t idx;
-        IMU_SENSOR_DATA sensor;
-        uint16_t delta_time;
-    }mp_imu_sensor_frm;
+    MP_RECORD records[AIRPLANE_TLM_RECORD_MAX];
+    uint8_t record_num;
+    uint8_t tx_bytes;
 
-    uint8_t rx_frm_buf[MP_RX_FRM_BUF_SIZE];
-    uint8_t rx_frm_size;
-    MP_FRAME_HDR *p_rx_hdr;
-    AHRS_NED_ATTITUDE *p_ned_att;
+    record_num = 0;
+    tx_bytes = 0;
 
-    rx_frm_size = MP_Recv(rx_frm_buf, sizeof(rx_frm_buf));
+    switch(stream_id){
 
-    if(rx_frm_size){
-        p_rx_hdr = (MP_FRAME_HDR *)rx_frm_buf;
+        case AIRPLANE_TLM_HEARTBEAT:
 
-        switch(p_rx_hdr->cmd){
-            /*
-             * Process simulating IMU (accelerometer, gyroscope)
-             * data which is transmitted by FDM from PC.
-             */
-            case MP_REQ_IMU_SENSOR_DATA:
+            record_num = Airplane_TlmRecord(records, record_num, MP_RSP_SYS_HEARTBEAT,
+                                            &p_tick->heartbeat, sizeof(p_tick->heartbeat));
+            record_num = Airplane_TlmRecord(records, record_num, MP_RSP_SYS_GENERAL,
+                                            &p_tick->general, sizeof(p_tick->general));
+            record_num = Airplane_TlmRecord(records, record_num, MP_RSP_SYS_CRUISE_STATE,
+                                            &p_tick->current_cruise_state, sizeof(p_tick->current_cruise_state));
+            break;
 
-#if defined(IMU_SENSOR_FG_EN)
+        case AIRPLANE_TLM_COMPACT:
+
+#if AIRPLANE_TLM_COMPACT_EN
+            if(is_send)
+                tx_bytes = Airplane_TxCompactStatus(p_tick);
+            else
+                tx_bytes = MP_FRM_SIZE(MP_VARINT_MAX_SIZE * 2 + AIRPLANE_TLM_FIELD_TOTAL * sizeof(int16_t));
+#endif
+            break;
 
-                if(p_rx_hdr->len == sizeof(mp_imu_sensor_frm)){
+        case AIRPLANE_TLM_AHRS:
 
-                    memcpy((void *)&mp_imu_sensor_frm, (void *)(rx_frm_buf + sizeof(MP_FRAME_HDR)),
-                           sizeof(mp_imu_sensor_frm));
+            record_num = Airplane_TlmRecord(records, record_num, MP_RSP_AHRS_FULL,
+                                            &Airplane_Status.ahrs_data, sizeof(Airplane_Status.ahrs_data));
+            break;
 
-                    IMU_SENSOR_UPDATE_FROM_UART(mp_imu_sensor_frm.sensor.accel_raw,
-                                                mp_imu_sensor_frm.sensor.gyro_raw);
+        case AIRPLANE_TLM_SETPOINT:
 
-                }
-#endif
+            record_num = Airplane_TlmRecord(records, record_num, MP_RSP_SYS_SETPOINT,
+                                            &p_tick->setpoint, sizeof(p_tick->setpoint));
+            break;
+
+        case AIRPLANE_TLM_RC:
+
+            record_num = Airplane_TlmRecord(records, record_num, MP_RSP_IN_CHANNELS,
+                                            p_tick->rc_pulse_in, sizeof(p_tick->rc_pulse_in));
+            record_num = Airplane_TlmRecord(records, record_num, MP_RSP_OUT_CHANNELS,
+                                            p_tick->rc_pulse_out, sizeof(p_tick->rc_pulse_out));
+            break;
+
+        case AIRPLANE_TLM_PID_VAL:
+
+            record_num = Airplane_TlmRecord(records, record_num, MP_RSP_PID_VAL_ROLL,
+                                            &Airplane_Status.pid_aile_servo.value, sizeof(Airplane_Status.pid_aile_servo.value));
+            record_num = Airplane_TlmRecord(records, record_num, MP_RSP_PID_VAL_PITCH,
+                                            &Airplane_Status.pid_elev_servo.value, sizeof(Airplane_Status.pid_elev_servo.value));
+            record_num = Airplane_TlmRecord(records, record_num, MP_RSP_PID_VAL_YAW,
+                                            &Airplane_Status.pid_rudd_servo.value, sizeof(Airplane_Status.pid_rudd_servo.value));
+            record_num = Airplane_TlmRecord(records, record_num, MP_RSP_PID_VAL_BANK,
+                                            &Airplane_Status.pid_band_turn.value, sizeof(Airplane_Status.pid_band_turn.value));
+            break;
+
+        case AIRPLANE_TLM_PID_CFG:
+
+            record_num = Airplane_TlmRecord(records, record_num, MP_RSP_PID_CFG_ROLL,
+                                            &Airplane_Status.pid_aile_servo.config, sizeof(Airplane_Status.pid_aile_servo.config));
+            record_num = Airplane_TlmRecord(records, record_num, MP_RSP_PID_CFG_PITCH,
+                                            &Airplane_Status.pid_elev_servo.config, sizeof(Airplane_Status.pid_elev_servo.config));
+            record_num = Airplane_TlmRecord(records, record_num, MP_RSP_PID_CFG_YAW,
+                                            &Airplane_Status.pid_rudd_servo.config, sizeof(Airplane_Status.pid_rudd_servo.config));
+            record_num = Airplane_TlmRecord(records, record_num, MP_RSP_PID_CFG_BANK,
+                                            &Airplane_Status.pid_band_turn.config, sizeof(Airplane_Status.pid_band_turn.config));
+            break;
+
+        case AIRPLANE_TLM_GPS_FIX:
+
+            record_num = Airplane_TlmRecord(records, record_num, MP_RSP_GPS_GENERAL,
+                                            &Airplane_GPS.general, sizeof(Airplane_GPS.general));
+            record_num = Airplane_TlmRecord(records, record_num, MP_RSP_GPS_NMEA_GGA,
+                                            &Airplane_GPS.nmea.gpgga, sizeof(Airplane_GPS.nmea.gpgga));
+            record_num = Airplane_TlmRecord(records, record_num, MP_RSP_GPS_NMEA_RMC,
+                                            &Airplane_GPS.nmea.gprmc, sizeof(Airplane_GPS.nmea.gprmc));
+            break;
+
+        case AIRPLANE_TLM_GPS_NAV:
+
+            record_num = Airplane_TlmRecord(records, record_num, MP_RSP_GPS_WAYPOINT,
+                                            &Airplane_GPS.wpt, sizeof(Airplane_GPS.wpt));
+            record_num = Airplane_TlmRecord(records, record_num, MP_RSP_GPS_NAVIGATION,
+                                            &Airplane_GPS.nav, sizeof(Airplane_GPS.nav));
+            break;
 
+        case AIRPLANE_TLM_ERR_LOG:
+
+            record_num = Airplane_TlmRecord(records, record_num, MP_RSP_GPS_ERR_LOG,
+                                            &GPS_ErrorLog, sizeof(GPS_ErrorLog));
+            break;
+
+        case AIRPLANE_TLM_BLACKBOX:
+
+#if AIRPLANE_BLACKBOX_EN
+            /* Nothing to send until a window is frozen */
+            if(Blackbox_IsFrozen(&Airplane_Blackbox) == false)
                 break;
 
-            /*
-             * Process simulating attitude (NED angle) which is
-             * generated and transmitted by FDM from PC.
-             */
-            case MP_REQ_NED_ANGLE_DATA:
-#if defined(IMU_SENSOR_ANGLE_FROM_FG) && IMU_SENSOR_ANGLE_FROM_FG
+            if(is_send)
+                tx_bytes = Airplane_TxBlackbox();
+            else
+                tx_bytes = MP_FRM_SIZE(sizeof(BLACKBOX_CHUNK_HDR) + BLACKBOX_CHUNK_SIZE);
+#endif
+            break;
 
-                if(p_rx_hdr->len == sizeof(AHRS_NED_ATTITUDE)){
+        case AIRPLANE_TLM_LINK:
 
-                    p_ned_att = (AHRS_NED_ATTITUDE *)(rx_frm_buf + sizeof(MP_FRAME_HDR));
+            if(is_send)
+                tx_bytes = Airplane_TxLinkStats();
+            else
+                tx_bytes = MP_FRM_SIZE(sizeof(AIRPLANE_MP_LINK_STATS));
+            break;
 
-                    AHRS_SetSimAngle(p_ned_att->roll_angle,
-                                     p_ned_att->pitch_angle,
-                                     p_ned_att->heading_angle);
+        case AIRPLANE_TLM_LATENCY:
 
-                }
+#if LATENCY_EN
+            if(is_send)
+                tx_bytes = Airplane_TxLatency();
+            else
+                tx_bytes = MP_FRM_SIZE(sizeof(AIRPLANE_MP_LATENCY));
 #endif
-                break;
+            break;
 
-            default:
-                break;
-        }
+        default:
+            break;
+    }
+
+    if(record_num != 0)
+        tx_bytes = Airplane_TxRecords(records, record_num, is_send);
+
+    return tx_bytes;
+}
+
+/**
+ * Airplane_TlmRecord - Function to append one telemetry frame to the record
+ *                      list of a stream.
+ *
+ * @param   [out]       *p_records  Record list, AIRPLANE_TLM_RECORD_MAX records.
+ * @param   [in]        record_num  Current records in the list.
+ * @param   [in]        cmd         MP command ID (Refer to enum mp_rsp_cmd).
+ * @param   [in]        *p_data     Frame data buffer.
+ * @param   [in]        data_size   Size of frame data.
+ *
+ * @return  [uint8_t]   Records in the list.
+ *
+ */
+static uint8_t Airplane_TlmRecord(MP_RECORD *p_records, uint8_t record_num,
+                                  uint8_t cmd, void *p_data, uint8_t data_size)
+{
+    if(record_num >= AIRPLANE_TLM_RECORD_MAX)
+        return record_num;
+
+    p_records[record_num].cmd = cmd;
+    p_records[record_num].size = data_size;
+    p_records[record_num].p_data = p_data;
+
+    return record_num + 1;
+}
+
+/**
+ * Airplane_TxRecords - Function to transmit record list of a stream, or get
+ *                      total bytes of it.
+ *
+ * The records are sent in one container frame if they fit in, a single
+ * record is sent as normal frame since container costs 2 more bytes.
+ *
+ * @param   [in]        *p_records  Record list.
+ * @param   [in]        record_num  Total records in the list.
+ * @param   [in]        is_send     true: send frames, false: get bytes only.
+ *
+ * @return  [uint8_t]   Total frame bytes.
+ *
+ */
+static uint8_t Airplane_TxRecords(MP_RECORD *p_records, uint8_t record_num, bool is_send)
+{
+#if AIRPLANE_TLM_CONTAINER_EN
+    uint16_t data_size;
+#endif
+    uint8_t tx_bytes;
+    uint8_t idx;
+
+#if AIRPLANE_TLM_CONTAINER_EN
+    if(record_num > 1){
+        data_size = MP_GetRecordsSize(p_records, record_num);
+
+        if(data_size != 0 && data_size <= MP_FRM_DATA_MAX){
+            if(is_send)
+                return MP_SendRecords(p_records, record_num);
+
+            return MP_FRM_SIZE(data_size);
+        }
+    }
+#endif
+
+    tx_bytes = 0;
+
+    for(idx = 0; idx < record_num; idx++){
+        if(is_send)
+            tx_bytes += MP_Send(p_records[idx].cmd, (uint8_t *)p_records[idx].p_data, p_records[idx].size);
+        else
+            tx_bytes += MP_FRM_SIZE(p_records[idx].size);
+    }
+
+    return tx_bytes;
+}
+
+
+#if AIRPLANE_TLM_COMPACT_EN
+/**
+ * Airplane_TxCompactStatus - Function to transmit attitude, setpoint and PID
+ *                            status in compact telemetry frame.
+ *
+ * Payload:
+ *      - Varint heartbeat.
+ *      - Varint field mask, bit n is set if field n (AIRPLANE_TLM_FIELD) is
+ *        present.
+ *      - Int16 of each present field, in field order.
+ *
+ * Only fields changed since last frame are sent, all fields are sent every
+ * AIRPLANE_TLM_KEYFRAME_CYC frames, or after a frame is dropped by UART.
+ *
+ * @param   [in]        *p_tick     Published control cycle status.
+ *
+ * @return  [uint8_t]   Transmitted frame bytes, 0 if the frame is dropped.
+ *
+ */
+static uint8_t Airplane_TxCompactStatus(AIRPLANE_TICK *p_tick)
+{
+    int16_t tlm_val[AIRPLANE_TLM_FIELD_TOTAL];
+    uint8_t payload[MP_VARINT_MAX_SIZE * 2 + sizeof(tlm_val)];
+    uint8_t payload_size;
+    uint32_t field_mask;
+    uint8_t tx_bytes;
+    uint8_t idx;
+
+    tlm_val[AIRPLANE_TLM_NED_ROLL] = Airplane_TlmQuantize(Airplane_Status.ahrs_data.ned_att.roll_angle,
+                                                          AIRPLANE_TLM_ANGLE_SCALE);
+    tlm_val[AIRPLANE_TLM_NED_PITCH] = Airplane_TlmQuantize(Airplane_Status.ahrs_data.ned_att.pitch_angle,
+                                                           AIRPLANE_TLM_ANGLE_SCALE);
+    tlm_val[AIRPLANE_TLM_NED_HEADING] = Airplane_TlmHeading(Airplane_Status.ahrs_data.ned_att.heading_angle);
+
+    tlm_val[AIRPLANE_TLM_GYRO_X] = Airplane_Status.ahrs_data.gyro_sensor_data[AHRS_X];
+    tlm_val[AIRPLANE_TLM_GYRO_Y] = Airplane_Status.ahrs_data.gyro_sensor_data[AHRS_Y];
+    tlm_val[AIRPLANE_TLM_GYRO_Z] = Airplane_Status.ahrs_data.gyro_sensor_data[AHRS_Z];
+
+    tlm_val[AIRPLANE_TLM_SP_ROLL] = Airplane_TlmQuantize(p_tick->setpoint.roll_angle,
+                                                         AIRPLANE_TLM_ANGLE_SCALE);
+    tlm_val[AIRPLANE_TLM_SP_PITCH] = Airplane_TlmQuantize(p_tick->setpoint.pitch_angle,
+                                                          AIRPLANE_TLM_ANGLE_SCALE);
+    tlm_val[AIRPLANE_TLM_SP_HEADING] = Airplane_TlmHeading(p_tick->setpoint.heading_angle);
+
+    for(idx = 0; idx < AIRPLANE_PID_TOTAL; idx++){
+        tlm_val[AIRPLANE_TLM_PID_OUT + idx] = Airplane_TlmQuantize(Airplane_PidDataTable[idx]->value.output,
+                                                                   AIRPLANE_TLM_PID_OUT_SCALE);
+        tlm_val[AIRPLANE_TLM_PID_INTG + idx] = Airplane_TlmQuantize(Airplane_PidDataTable[idx]->value.integral,
+                                                                    AIRPLANE_TLM_PID_INTG_SCALE);
+    }
+
+    /* Header */
+    payload_size = MP_PutVarint(payload, p_tick->heartbeat);
+
+    field_mask = 0;
+    for(idx = 0; idx < AIRPLANE_TLM_FIELD_TOTAL; idx++){
+        if(Airplane_TlmKeyCnt == 0 || tlm_val[idx] != Airplane_TlmLastVal[idx])
+            field_mask |= ((uint32_t)1 << idx);
+    }
+
+    payload_size += MP_PutVarint(&payload[payload_size], field_mask);
+
+    /* Changed fields */
+    for(idx = 0; idx < AIRPLANE_TLM_FIELD_TOTAL; idx++){
+        if(field_mask & ((uint32_t)1 << idx)){
+            memcpy((void *)&payload[payload_size], (void *)&tlm_val[idx], sizeof(tlm_val[idx]));
+            payload_size += sizeof(tlm_val[idx]);
+        }
+    }
+
+    memcpy((void *)Airplane_TlmLastVal, (void *)tlm_val, sizeof(Airplane_TlmLastVal));
+
+    /* Receiver missed the changes if the frame is dropped, send keyframe next time */
+    tx_bytes = MP_Send(MP_RSP_SYS_TLM_COMPACT, payload, payload_size);
+    if(tx_bytes == 0){
+        Airplane_TlmKeyCnt = 0;
+    }
+    else{
+        Airplane_TlmKeyCnt++;
+        if(Airplane_TlmKeyCnt >= AIRPLANE_TLM_KEYFRAME_CYC)
+            Airplane_TlmKeyCnt = 0;
+    }
+
+    return tx_bytes;
+}
+#endif
+
+#if AIRPLANE_TLM_COMPACT_EN || AIRPLANE_BLACKBOX_EN
+/**
+ * Airplane_TlmQuantize - Function to convert value to scaled and rounded int16,
+ *                        value out of range is saturated.
+ *
+ * @param   [in]        value       Input value.
+ * @param   [in]        scale       Scale factor.
+ *
+ * @return  [int16_t]   Scaled value.
+ *
+ */
+static int16_t Airplane_TlmQuantize(float value, float scale)
+{
+    value *= scale;
+
+    if(value >= 32767.0)
+        return 32767;
+
+    if(value <= -32767.0)
+        return -32767;
+
+    return (int16_t)((value >= 0) ? (value + 0.5) : (value - 0.5));
+}
+
+/**
+ * Airplane_TlmHeading - Function to convert heading angle to unsigned
+ *                       centi-degree (0 ~ 35999), stored in int16.
+ *
+ * @param   [in]        heading_angle   Heading angle in degree.
+ *
+ * @return  [int16_t]   Unsigned centi-degree heading.
+ *
+ */
+static int16_t Airplane_TlmHeading(float heading_angle)
+{
+    int32_t heading;
+
+    heading = (int32_t)(heading_angle * AIRPLANE_TLM_ANGLE_SCALE + 0.5);
+
+    heading %= 36000;
+    if(heading < 0)
+        heading += 36000;
+
+    return (int16_t)(uint16_t)heading;
+}
+#endif
+
+#if AIRPLANE_BLACKBOX_EN
+/**
+ * Airplane_BlackboxTask - Function to record current control cycle to
+ *                         blackbox, and trigger the window if any error
+ *                         counter is increased or fly mode is changed.
+ *
+ * @param   [in]        *p_imu_data     IMU raw data of this cycle, all 0 if
+ *                                      the reading is failed.
+ *
+ * @return  [none]
+ *
+ */
+static void Airplane_BlackboxTask(IMU_SENSOR_DATA *p_imu_data)
+{
+    static uint8_t prev_imu_fail_cnt = 0;
+    static uint8_t prev_ahrs_delay_cnt = 0;
+    static uint8_t prev_accel_exceed_cnt = 0;
+    static uint8_t prev_rcin_fail_cnt = 0;
+    static AIRPLANE_FLY_MODE prev_fly_mode = AIRPLANE_MANUAL_FLY;
+    AIRPLANE_TICK *p_tick = Airplane_GetTick();
+    int16_t bb_val[AIRPLANE_BB_FIELD_TOTAL];
+    uint8_t rcin_fail_cnt;
+    uint8_t trigger;
+    uint8_t idx;
+
+    for(idx = 0; idx < IMU_AXES; idx++){
+        bb_val[AIRPLANE_BB_ACCEL_X + idx] = p_imu_data->accel_raw[idx];
+        bb_val[AIRPLANE_BB_GYRO_X + idx] = p_imu_data->gyro_raw[idx];
+    }
+
+    bb_val[AIRPLANE_BB_NED_ROLL] = Airplane_TlmQuantize(Airplane_Status.ahrs_data.ned_att.roll_angle,
+                                                        AIRPLANE_TLM_ANGLE_SCALE);
+    bb_val[AIRPLANE_BB_NED_PITCH] = Airplane_TlmQuantize(Airplane_Status.ahrs_data.ned_att.pitch_angle,
+                                                         AIRPLANE_TLM_ANGLE_SCALE);
+    bb_val[AIRPLANE_BB_NED_HEADING] = Airplane_TlmHeading(Airplane_Status.ahrs_data.ned_att.heading_angle);
+
+    for(idx = 0; idx < AIRPLANE_PID_TOTAL; idx++){
+        bb_val[AIRPLANE_BB_PID_OUT + idx] = Airplane_TlmQuantize(Airplane_PidDataTable[idx]->value.output,
+                                                                 AIRPLANE_TLM_PID_OUT_SCALE);
+    }
+
+    for(idx = 0; idx < RCIN_CH_TOTAL; idx++)
+        bb_val[AIRPLANE_BB_RC_IN + idx] = (int16_t)p_tick->rc_pulse_in[idx];
+
+    for(idx = 0; idx < RCOUT_CH_TOTAL; idx++)
+        bb_val[AIRPLANE_BB_RC_OUT + idx] = (int16_t)p_tick->rc_pulse_out[idx];
+
+    bb_val[AIRPLANE_BB_CTRL_TIME] = (int16_t)p_tick->general.delta_ctrl_time;
+
+    Blackbox_Record(&Airplane_Blackbox, bb_val);
+
+    /* Triggers, the counters wrap around */
+    trigger = 0;
+    rcin_fail_cnt = RCIN_GetFailCnt();
+
+    if(p_tick->general.imu_fail_cnt != prev_imu_fail_cnt)
+        trigger |= AIRPLANE_BB_TRIG_IMU_FAIL;
+
+    if(p_tick->general.ahrs_delay_cnt != prev_ahrs_delay_cnt)
+        trigger |= AIRPLANE_BB_TRIG_AHRS_DELAY;
+
+    if(Airplane_Status.ahrs_data.accel_exceed_cnt != prev_accel_exceed_cnt)
+        trigger |= AIRPLANE_BB_TRIG_ACCEL_EXCEED;
+
+    if(rcin_fail_cnt != prev_rcin_fail_cnt)
+        trigger |= AIRPLANE_BB_TRIG_RCIN_FAIL;
+
+    if(p_tick->general.fly_mode != prev_fly_mode)
+        trigger |= AIRPLANE_BB_TRIG_MODE_CHANGE;
+
+    prev_imu_fail_cnt = p_tick->general.imu_fail_cnt;
+    prev_ahrs_delay_cnt = p_tick->general.ahrs_delay_cnt;
+    prev_accel_exceed_cnt = Airplane_Status.ahrs_data.accel_exceed_cnt;
+    prev_rcin_fail_cnt = rcin_fail_cnt;
+    prev_fly_mode = p_tick->general.fly_mode;
+
+    Blackbox_Trigger(&Airplane_Blackbox, trigger);
+}
+
+/**
+ * Airplane_TxBlackbox - Function to transmit next chunk of frozen blackbox
+ *                       window, the chunk is sent again if it is dropped.
+ *
+ * @param   [none]
+ *
+ * @return  [uint8_t]   Transmitted frame bytes, 0 if the frame is dropped.
+ *
+ */
+static uint8_t Airplane_TxBlackbox()
+{
+    uint8_t payload[sizeof(BLACKBOX_CHUNK_HDR) + BLACKBOX_CHUNK_SIZE];
+    uint8_t payload_size;
+    uint8_t tx_bytes;
+
+    payload_size = Blackbox_GetChunk(&Airplane_Blackbox, payload);
+    if(payload_size == 0)
+        return 0;
+
+    tx_bytes = MP_Send(MP_RSP_SYS_BLACKBOX, payload, payload_size);
+    if(tx_bytes != 0)
+        Blackbox_NextChunk(&Airplane_Blackbox);
+
+    return tx_bytes;
+}
+#endif
+
+/**
+ * Airplane_TxLinkStats - Function to transmit link statistics, the counters
+ *                        are taken just before sending.
+ *
+ * @param   [none]
+ *
+ * @return  [uint8_t]   Transmitted frame bytes, 0 if the frame is dropped.
+ *
+ */
+static uint8_t Airplane_TxLinkStats()
+{
+    AIRPLANE_MP_LINK_STATS mp_link_stats;
+
+    memset((void *)&mp_link_stats, 0, sizeof(mp_link_stats));
+
+    mp_link_stats.time_ms = Timer1_GetMillis();
+
+    Uart0_GetStats(&mp_link_stats.uart0);
+#if UARTS_FUNCTION_EN
+    UartS_GetStats(&mp_link_stats.uarts);
+#endif
+
+    MP_GetRxStats(&mp_link_stats.mp_rx);
+    mp_link_stats.mp_tx_drop_cnt = MP_GetTxDropCnt();
+
+    mp_link_stats.gps_err_log = GPS_ErrorLog;
+
+    return MP_Send(MP_RSP_SYS_LINK_STATS, (uint8_t *)&mp_link_stats, sizeof(mp_link_stats));
+}
+
+#if LATENCY_EN
+/**
+ * Airplane_TxLatency - Function to transmit latency statistics, the
+ *                      statistics are cleared after each report.
+ *
+ * @param   [none]
+ *
+ * @return  [uint8_t]   Transmitted frame bytes, 0 if the frame is dropped.
+ *
+ */
+static uint8_t Airplane_TxLatency()
+{
+    AIRPLANE_MP_LATENCY mp_latency;
+
+    mp_latency.time_ms = Timer1_GetMillis();
+    Latency_GetReport(&mp_latency.report);
+
+    return MP_Send(MP_RSP_SYS_LATENCY, (uint8_t *)&mp_latency, sizeof(mp_latency));
+}
+#endif
+
+/**
+ * Airplane_RxMessage - Function to receive FC message transmitted by external tool
+ *                      via UART interface.
+ *
+ *                      All received frames are processed in one control cycle,
+ *                      limited by AIRPLANE_RX_CALL_BUDGET and
+ *                      AIRPLANE_RX_TIME_BUDGET, the rest frames are kept in
+ *                      UART RX FIFO for next cycle. Each frame is dispatched
+ *                      by Airplane_RxCmdTable.
+ *
+ * @param   [none]
+ *
+ * @return  [bool]      Frame receiving result.
+ * @retval  [true]      A valid frame is received.
+ * @retval  [false]     No frame.
+ *
+ */
+static bool Airplane_RxMessage()
+{
+    uint8_t rx_frm_buf[MP_RX_FRM_BUF_SIZE];
+    uint8_t rx_frm_size;
+    uint8_t call_cnt;
+    uint32_t start_time;
+    bool is_rx_frm;
+
+    is_rx_frm = false;
+    start_time = Timer1_GetMicros();
+
+    for(call_cnt = 0; call_cnt < AIRPLANE_RX_CALL_BUDGET; call_cnt++){
+
+        rx_frm_size = MP_Recv(rx_frm_buf, sizeof(rx_frm_buf));
+
+        if(rx_frm_size == 0){
+
+            /* All received bytes are processed */
+            if(Uart0_ReadAvailable() == 0)
+                break;
+
+            continue;
+        }
+
+        is_rx_frm = true;
+        Airplane_RxDispatch((MP_FRAME_HDR *)rx_frm_buf);
+
+        /* Frame handler may take long time, Eg. writing ROM */
+        if(Timer1_GetMicros() - start_time > AIRPLANE_RX_TIME_BUDGET)
+            break;
+    }
+
+    return is_rx_frm;
+}
+
+/**
+ * Airplane_RxDispatch - Function to call the handler of received MP frame.
+ *
+ * @param   [in]        *p_rx_hdr   Received frame, header and payload.
+ *
+ * @return  [none]
+ *
+ */
+static void Airplane_RxDispatch(MP_FRAME_HDR *p_rx_hdr)
+{
+    AIRPLANE_RX_CMD rx_cmd;
+    uint8_t idx;
+
+    for(idx = 0; idx < sizeof(Airplane_RxCmdTable) / sizeof(Airplane_RxCmdTable[0]); idx++){
+
+        if(pgm_read_byte(&Airplane_RxCmdTable[idx].cmd) != p_rx_hdr->cmd)
+            continue;
+
+        memcpy_P((void *)&rx_cmd, (const void *)&Airplane_RxCmdTable[idx], sizeof(rx_cmd));
+
+        /* Drop the frame if payload length is mismatched */
+        if(rx_cmd.len == AIRPLANE_RX_LEN_ANY || rx_cmd.len == p_rx_hdr->len)
+            rx_cmd.p_handler(p_rx_hdr->cmd, p_rx_hdr->payload, p_rx_hdr->len);
+
+        break;
+    }
+}
+
+#if defined(IMU_SENSOR_FG_EN)
+/**
+ * Airplane_RxImuSensor - Function to process simulating IMU (accelerometer,
+ *                        gyroscope) data which is transmitted by FDM from PC.
+ *
+ * @param   [in]        cmd         MP_REQ_IMU_SENSOR_DATA.
+ * @param   [in]        *p_payload  AIRPLANE_MP_IMU_SENSOR.
+ * @param   [in]        len         Payload length.
+ *
+ * @return  [none]
+ *
+ */
+static void Airplane_RxImuSensor(uint8_t cmd, uint8_t *p_payload, uint8_t len)
+{
+    AIRPLANE_MP_IMU_SENSOR mp_imu_sensor;
+
+    memcpy((void *)&mp_imu_sensor, (void *)p_payload, sizeof(mp_imu_sensor));
+
+    IMU_SENSOR_UPDATE_FROM_UART(mp_imu_sensor.sensor.accel_raw,
+                                mp_imu_sensor.sensor.gyro_raw);
+}
+#endif
+
+#if defined(IMU_SENSOR_ANGLE_FROM_FG) && IMU_SENSOR_ANGLE_FROM_FG
+/**
+ * Airplane_RxNedAngle - Function to process simulating attitude (NED angle)
+ *                       which is generated and transmitted by FDM from PC.
+ *
+ * @param   [in]        cmd         MP_REQ_NED_ANGLE_DATA.
+ * @param   [in]        *p_payload  AHRS_NED_ATTITUDE.
+ * @param   [in]        len         Payload length.
+ *
+ * @return  [none]
+ *
+ */
+static void Airplane_RxNedAngle(uint8_t cmd, uint8_t *p_payload, uint8_t len)
+{
+    AHRS_NED_ATTITUDE ned_att;
+
+    memcpy((void *)&ned_att, (void *)p_payload, sizeof(ned_att));
+
+    AHRS_SetSimAngle(ned_att.roll_angle, ned_att.pitch_angle, ned_att.heading_angle);
+}
+#endif
+
+#if GPS_BENCH_EN
+/**
+ * Airplane_RxGpsBench - Function to reset NMEA parser benchmark, or feed
+ *                       recorded NMEA stream which is transmitted by benchmark
+ *                       tool from PC, then reply benchmark statistic.
+ *
+ * @param   [in]        cmd         MP_REQ_GPS_BENCH_RESET or MP_REQ_GPS_BENCH_FEED.
+ * @param   [in]        *p_payload  NMEA stream (FEED only).
+ * @param   [in]        len         Payload length.
+ *
+ * @return  [none]
+ *
+ */
+static void Airplane_RxGpsBench(uint8_t cmd, uint8_t *p_payload, uint8_t len)
+{
+    GPS_BENCH_STAT gps_bench_stat;
+
+    if(cmd == MP_REQ_GPS_BENCH_RESET)
+        GPS_BenchReset(&Airplane_GPS);
+    else
+        GPS_BenchFeed(&Airplane_GPS, p_payload, len);
+
+    GPS_BenchGetStat(&gps_bench_stat);
+
+    MP_Send(cmd + 128, (uint8_t *)&gps_bench_stat, sizeof(gps_bench_stat));
+}
+#endif
+
+/**
+ * Airplane_RxParam - Function to read or write one parameter, see
+ *                    AIRPLANE_PARAM_ID.
+ *
+ * @param   [in]        cmd         MP_REQ_CFG_PARAM_READ or MP_REQ_CFG_PARAM_WRITE.
+ * @param   [in]        *p_payload  AIRPLANE_MP_PARAM.
+ * @param   [in]        len         Payload length.
+ *
+ * @return  [none]
+ *
+ */
+static void Airplane_RxParam(uint8_t cmd, uint8_t *p_payload, uint8_t len)
+{
+    AIRPLANE_MP_PARAM mp_param;
+
+    memcpy((void *)&mp_param, (void *)p_payload, sizeof(mp_param));
+
+    if(cmd == MP_REQ_CFG_PARAM_WRITE)
+        mp_param.result = Airplane_SetParam(mp_param.param_id, mp_param.value);
+    else
+        mp_param.result = 0;
+
+    if(mp_param.result == 0)
+        mp_param.result = Airplane_GetParam(mp_param.param_id, &mp_param.value);
+
+    MP_Send(cmd + 128, (uint8_t *)&mp_param, sizeof(mp_param));
+}
+
+/**
+ * Airplane_RxPid - Function to read or write the whole parameter set of one
+ *                  PID controller.
+ *
+ * @param   [in]        cmd         MP_REQ_CFG_PID_READ or MP_REQ_CFG_PID_WRITE.
+ * @param   [in]        *p_payload  AIRPLANE_MP_PID.
+ * @param   [in]        len         Payload length.
+ *
+ * @return  [none]
+ *
+ */
+static void Airplane_RxPid(uint8_t cmd, uint8_t *p_payload, uint8_t len)
+{
+    AIRPLANE_MP_PID mp_pid;
+    uint8_t field_idx;
+
+    memcpy((void *)&mp_pid, (void *)p_payload, sizeof(mp_pid));
+
+    mp_pid.result = -1;
+
+    if(mp_pid.pid_idx < AIRPLANE_PID_TOTAL){
+
+        mp_pid.result = 0;
+
+        if(cmd == MP_REQ_CFG_PID_WRITE){
+
+            /* Same checks as Airplane_SetParam(), nothing is changed if any field is invalid */
+            for(field_idx = 0; field_idx < AIRPLANE_PID_FIELD_TOTAL; field_idx++){
+                if(Airplane_ChkPidField(field_idx, *Airplane_GetPidField(&mp_pid.pid_cfg, field_idx)) != 0)
+                    mp_pid.result = -1;
+            }
+
+            if(mp_pid.result == 0 && Airplane_SaveState != AIRPLANE_SAVE_IDLE)
+                mp_pid.result = 1;
+
+            /* All parameters are applied together before next control cycle */
+            if(mp_pid.result == 0){
+                *Airplane_PidConfigTable[mp_pid.pid_idx] = mp_pid.pid_cfg;
+                Airplane_ApplyPidConfig(mp_pid.pid_idx);
+                Airplane_IsGndTuned = true;
+            }
+        }
+
+        mp_pid.pid_cfg = *Airplane_PidConfigTable[mp_pid.pid_idx];
+    }
+
+    MP_Send(cmd + 128, (uint8_t *)&mp_pid, sizeof(mp_pid));
+}
+
+/**
+ * Airplane_RxWpt - Function to read or write one waypoint of configuration or
+ *                  ROM mission.
+ *
+ * @param   [in]        cmd         MP_REQ_CFG_WPT_READ or MP_REQ_CFG_WPT_WRITE.
+ * @param   [in]        *p_payload  AIRPLANE_MP_WPT.
+ * @param   [in]        len         Payload length.
+ *
+ * @return  [none]
+ *
+ */
+static void Airplane_RxWpt(uint8_t cmd, uint8_t *p_payload, uint8_t len)
+{
+    AIRPLANE_MP_WPT mp_wpt;
+
+    memcpy((void *)&mp_wpt, (void *)p_payload, sizeof(mp_wpt));
+
+    if(cmd == MP_REQ_CFG_WPT_WRITE)
+        mp_wpt.result = Airplane_SetWpt(&mp_wpt);
+    else
+        mp_wpt.result = Airplane_GetWpt(&mp_wpt);
+
+    MP_Send(cmd + 128, (uint8_t *)&mp_wpt, sizeof(mp_wpt));
+}
+
+/**
+ * Airplane_RxMission - Function to start uploading a new ROM mission, or
+ *                      commit uploaded ROM mission.
+ *
+ *                      At beginning, the stored mission is stopped and the
+ *                      airplane returns to configuration waypoint. The
+ *                      response of commit is sent by Airplane_MissionTask()
+ *                      once the mission is stored, it's flown after it's
+ *                      started by MP_REQ_CFG_MISSION_START.
+ *
+ * @param   [in]        cmd         MP_REQ_CFG_MISSION_BEGIN or MP_REQ_CFG_MISSION_END.
+ * @param   [in]        *p_payload  AIRPLANE_MP_MISSION.
+ * @param   [in]        len         Payload length.
+ *
+ * @return  [none]
+ *
+ */
+static void Airplane_RxMission(uint8_t cmd, uint8_t *p_payload, uint8_t len)
+{
+    AIRPLANE_MP_MISSION mp_mission;
+
+    memcpy((void *)&mp_mission, (void *)p_payload, sizeof(mp_mission));
+
+    if(cmd == MP_REQ_CFG_MISSION_BEGIN){
+
+        Airplane_IsMissionPending = false;
+        Airplane_IsMissionArmed = false;
+
+        if(Airplane_IsCoordValid(&mp_mission.origin) == true)
+            mp_mission.result = Mission_Create(&mp_mission.origin);
+        else
+            mp_mission.result = -1;
+
+        Airplane_SetNavWpt(false);
+
+        MP_Send(MP_RSP_CFG_MISSION_BEGIN, (uint8_t *)&mp_mission, sizeof(mp_mission));
+    }
+    else{
+
+        if(Mission_Commit(mp_mission.total_wpt) == 0){
+            Airplane_IsMissionPending = true;
+        }
+        else{
+            mp_mission.result = -1;
+            MP_Send(MP_RSP_CFG_MISSION_END, (uint8_t *)&mp_mission, sizeof(mp_mission));
+        }
+    }
+}
+
+/**
+ * Airplane_RxMissionStart - Function to start or stop flying stored ROM
+ *                           mission.
+ *
+ *                           The started mission is flown when return to
+ *                           home is selected by AUX1 channel, until it's
+ *                           completed, stopped, or RC failsafe is applied.
+ *                           Then the airplane returns to home again.
+ *
+ * @param   [in]        cmd         MP_REQ_CFG_MISSION_START.
+ * @param   [in]        *p_payload  AIRPLANE_MP_MISSION_START.
+ * @param   [in]        len         Payload length.
+ *
+ * @return  [none]
+ *
+ */
+static void Airplane_RxMissionStart(uint8_t cmd, uint8_t *p_payload, uint8_t len)
+{
+    AIRPLANE_MP_MISSION_START mp_start;
+
+    memcpy((void *)&mp_start, (void *)p_payload, sizeof(mp_start));
+
+    Airplane_IsMissionArmed = false;
+    mp_start.result = 0;
+
+    if(mp_start.is_start != 0){
+
+        /* Uploaded mission must be stored first */
+        if(Airplane_IsMissionPending == false && Mission_Start(mp_start.wpt_idx) == 0){
+            Airplane_IsMissionArmed = true;
+            Airplane_MissionFailCnt = RCIN_GetFailCnt();
+        }
+        else{
+            mp_start.result = -1;
+        }
+    }
+
+    MP_Send(MP_RSP_CFG_MISSION_START, (uint8_t *)&mp_start, sizeof(mp_start));
+}
+
+/**
+ * Airplane_RxSave - Function to start deferred configuration saving or query
+ *                   its state.
+ *
+ * @param   [in]        cmd         MP_REQ_CFG_SAVE.
+ * @param   [in]        *p_payload  AIRPLANE_MP_SAVE.
+ * @param   [in]        len         Payload length.
+ *
+ * @return  [none]
+ *
+ */
+static void Airplane_RxSave(uint8_t cmd, uint8_t *p_payload, uint8_t len)
+{
+    AIRPLANE_MP_SAVE mp_save;
+
+    memcpy((void *)&mp_save, (void *)p_payload, sizeof(mp_save));
+
+    if(mp_save.is_start && Airplane_SaveState == AIRPLANE_SAVE_IDLE){
+        Airplane_SaveOffset = 0;
+        Airplane_SaveState = AIRPLANE_SAVE_BODY;
+    }
+
+    mp_save.state = Airplane_SaveState;
+    mp_save.result = Airplane_SaveResult;
+
+    MP_Send(MP_RSP_CFG_SAVE, (uint8_t *)&mp_save, sizeof(mp_save));
+}
+
+/**
+ * Airplane_RxTlmRate - Function to read or change sending period of telemetry
+ *                      stream.
+ *
+ * @param   [in]        cmd         MP_REQ_CFG_TLM_RATE_READ or MP_REQ_CFG_TLM_RATE_WRITE.
+ * @param   [in]        *p_payload  AIRPLANE_MP_TLM_RATE.
+ * @param   [in]        len         Payload length.
+ *
+ * @return  [none]
+ *
+ */
+static void Airplane_RxTlmRate(uint8_t cmd, uint8_t *p_payload, uint8_t len)
+{
+    AIRPLANE_MP_TLM_RATE mp_tlm_rate;
+
+    memcpy((void *)&mp_tlm_rate, (void *)p_payload, sizeof(mp_tlm_rate));
+
+    mp_tlm_rate.result = -1;
+
+    if(mp_tlm_rate.stream_id < AIRPLANE_TLM_STREAM_TOTAL){
+
+        if(cmd == MP_REQ_CFG_TLM_RATE_WRITE)
+            Airplane_TlmStream[mp_tlm_rate.stream_id].period_ms = mp_tlm_rate.period_ms;
+
+        mp_tlm_rate.period_ms = Airplane_TlmStream[mp_tlm_rate.stream_id].period_ms;
+        mp_tlm_rate.result = 0;
+    }
+
+    MP_Send(cmd + 128, (uint8_t *)&mp_tlm_rate, sizeof(mp_tlm_rate));
+}
+
+/**
+ * Airplane_RxBaud - Function to change UART0 baud rate, the response is sent
+ *                   at current rate, then the rate is switched by
+ *                   Airplane_BaudTask().
+ *
+ * @param   [in]        cmd         MP_REQ_CFG_BAUD.
+ * @param   [in]        *p_payload  AIRPLANE_MP_BAUD.
+ * @param   [in]        len         Payload length.
+ *
+ * @return  [none]
+ *
+ */
+static void Airplane_RxBaud(uint8_t cmd, uint8_t *p_payload, uint8_t len)
+{
+    AIRPLANE_MP_BAUD mp_baud;
+
+    memcpy((void *)&mp_baud, (void *)p_payload, sizeof(mp_baud));
+
+    mp_baud.result = -1;
+
+    if(Airplane_BaudState != AIRPLANE_BAUD_SWITCH
+    && (mp_baud.baud_rate == AIRPLANE_UART0_BAUD
+        || (Uart0_IsExactBaud(mp_baud.baud_rate) == true
+            && mp_baud.baud_rate <= AIRPLANE_UART0_BAUD_MAX))){
+
+        if(mp_baud.baud_rate != Uart0_GetBaud()){
+            Airplane_BaudPending = mp_baud.baud_rate;
+            Airplane_BaudState = AIRPLANE_BAUD_SWITCH;
+        }
+
+        mp_baud.result = 0;
+    }
+
+    MP_Send(MP_RSP_CFG_BAUD, (uint8_t *)&mp_baud, sizeof(mp_baud));
+}
+
+/**
+ * Airplane_RxLinkStats - Function to send link statistics on request, same
+ *                        frame as LINK telemetry stream.
+ *
+ * @param   [in]        cmd         MP_REQ_SYS_LINK_STATS.
+ * @param   [in]        *p_payload  No payload.
+ * @param   [in]        len         Payload length.
+ *
+ * @return  [none]
+ *
+ */
+static void Airplane_RxLinkStats(uint8_t cmd, uint8_t *p_payload, uint8_t len)
+{
+    Airplane_TxLinkStats();
+}
+
+#if LATENCY_EN
+/**
+ * Airplane_RxLatency - Function to send latency statistics on request, same
+ *                      frame as LATENCY telemetry stream (the statistics are
+ *                      cleared).
+ *
+ * @param   [in]        cmd         MP_REQ_SYS_LATENCY.
+ * @param   [in]        *p_payload  No payload.
+ * @param   [in]        len         Payload length.
+ *
+ * @return  [none]
+ *
+ */
+static void Airplane_RxLatency(uint8_t cmd, uint8_t *p_payload, uint8_t len)
+{
+    Airplane_TxLatency();
+}
+#endif
+
+/**
+ * Airplane_ApplyPidConfig - Function to apply PID configuration to PID controller.
+ *
+ * @param   [in]        pid_idx         Index of PID controller, see AIRPLANE_PID_IDX.
+ *
+ * @return  [none]
+ *
+ */
+static void Airplane_ApplyPidConfig(uint8_t pid_idx)
+{
+    AIRPLANE_PID_CONFIG *p_pid_cfg;
+    PID_DATA *p_pid;
+
+    p_pid_cfg = Airplane_PidConfigTable[pid_idx];
+    p_pid = Airplane_PidDataTable[pid_idx];
+
+    PID_SetTuning(p_pid, p_pid_cfg->KP, p_pid_cfg->KI, p_pid_cfg->KD);
+    PID_SetScaleFactor(p_pid, p_pid_cfg->scale);
+    PID_SetIntegralMax(p_pid, p_pid_cfg->integral_max);
+    PID_SetOutputMax(p_pid, p_pid_cfg->output_max);
+}
+
+/**
+ * Airplane_SetParam - Function to update one parameter of configuration.
+ *
+ * The parameter is applied to the controller immediately, and it will be
+ * stored to ROM by next deferred configuration saving. Configuration can't be
+ * changed while it's being saved.
+ *
+ * @param   [in]        param_id        Parameter ID, see AIRPLANE_PARAM_ID.
+ * @param   [in]        value           New value.
+ *
+ * @return  [int8_t]    Function executing result.
+ * @retval  [1]         Busy, retry later.
+ * @retval  [0]         Success.
+ * @retval  [-1]        Fail.
+ *
+ */
+static int8_t Airplane_SetParam(uint8_t param_id, float value)
+{
+    uint8_t pid_idx;
+    uint8_t field_idx;
+
+    if(param_id >= AIRPLANE_PARAM_TOTAL || isnan(value) || isinf(value))
+        return -1;
+
+    if(Airplane_SaveState != AIRPLANE_SAVE_IDLE)
+        return 1;
+
+    if(param_id == AIRPLANE_PARAM_LOITER_RADIUS){
+
+        if(value < AIRPLANE_WPT_ARRIVE_RADIUS)
+            return -1;
+
+        Airplane_Config.navigation.loiter_radius = value;
+    }
+    else{
+        pid_idx = param_id / AIRPLANE_PID_PARAM_NUM;
+        field_idx = param_id % AIRPLANE_PID_PARAM_NUM;
+
+        if(Airplane_ChkPidField(field_idx, value) != 0)
+            return -1;
+
+        *Airplane_GetPidField(Airplane_PidConfigTable[pid_idx], field_idx) = value;
+        Airplane_ApplyPidConfig(pid_idx);
+    }
+
+    Airplane_IsGndTuned = true;
+
+    return 0;
+}
+
+/**
+ * Airplane_GetParam - Function to read one parameter of configuration.
+ *
+ * @param   [in]        param_id        Parameter ID, see AIRPLANE_PARAM_ID.
+ * @param   [out]       *p_value        Current value.
+ *
+ * @return  [int8_t]    Function executing result.
+ * @retval  [0]         Success.
+ * @retval  [-1]        Fail.
+ *
+ */
+static int8_t Airplane_GetParam(uint8_t param_id, float *p_value)
+{
+    if(param_id >= AIRPLANE_PARAM_TOTAL)
+        return -1;
+
+    if(param_id == AIRPLANE_PARAM_LOITER_RADIUS)
+        *p_value = Airplane_Config.navigation.loiter_radius;
+    else
+        *p_value = *Airplane_GetPidField(Airplane_PidConfigTable[param_id / AIRPLANE_PID_PARAM_NUM],
+                                         param_id % AIRPLANE_PID_PARAM_NUM);
+
+    return 0;
+}
+
+/**
+ * Airplane_GetPidField - Function to get one field of PID configuration.
+ *
+ * @param   [in]        *p_pid_cfg      PID configuration.
+ * @param   [in]        field_idx       Field index, see AIRPLANE_PID_FIELD.
+ *
+ * @return  [float *]   Address of the field, output_max if field_idx is out
+ *                      of range.
+ *
+ */
+static float *Airplane_GetPidField(AIRPLANE_PID_CONFIG *p_pid_cfg, uint8_t field_idx)
+{
+    switch(field_idx){
+        case AIRPLANE_PID_FIELD_KP:
+            return &p_pid_cfg->KP;
+
+        case AIRPLANE_PID_FIELD_KI:
+            return &p_pid_cfg->KI;
+
+        case AIRPLANE_PID_FIELD_KD:
+            return &p_pid_cfg->KD;
+
+        case AIRPLANE_PID_FIELD_SCALE:
+            return &p_pid_cfg->scale;
+
+        case AIRPLANE_PID_FIELD_INTEGRAL_MAX:
+            return &p_pid_cfg->integral_max;
+
+        default:
+            return &p_pid_cfg->output_max;
+    }
+}
+
+/**
+ * Airplane_ChkPidField - Function to check new value of one PID
+ *                        configuration field.
+ *
+ * @param   [in]        field_idx       Field index, see AIRPLANE_PID_FIELD.
+ * @param   [in]        value           New value.
+ *
+ * @return  [int8_t]    Function executing result.
+ * @retval  [0]         Valid.
+ * @retval  [-1]        Invalid.
+ *
+ */
+static int8_t Airplane_ChkPidField(uint8_t field_idx, float value)
+{
+    if(field_idx >= AIRPLANE_PID_FIELD_TOTAL || isnan(value) || isinf(value))
+        return -1;
+
+    /* integral_max and output_max are limitations */
+    if((field_idx == AIRPLANE_PID_FIELD_INTEGRAL_MAX || field_idx == AIRPLANE_PID_FIELD_OUTPUT_MAX)
+       && value < 0.0)
+        return -1;
+
+    return 0;
+}
+
+/**
+ * Airplane_IsCoordValid - Function to check coordinate from ground tool.
+ *
+ * @param   [in]        *p_coord        Coordinate in decimal degrees.
+ *
+ * @return  [bool]      Latitude is in [-90, 90] and longitude is in [-180, 180].
+ *
+ */
+static bool Airplane_IsCoordValid(GPS_COORD_POINT *p_coord)
+{
+    /* NaN fails both comparisons */
+    if(!(fabs(p_coord->LAT_DD) <= 90.0) || !(fabs(p_coord->LONG_DD) <= 180.0))
+        return false;
+
+    return true;
+}
+
+/**
+ * Airplane_SetWpt - Function to update one waypoint of configuration or
+ *                   ROM mission.
+ *
+ * Configuration waypoint is activated and becomes the GPS target immediately
+ * if it's the current one and no ROM mission is flying, it can't be changed
+ * while configuration is being saved. ROM mission waypoint is stored by
+ * Mission_Task() in background.
+ *
+ * @param   [in]        *p_mp_wpt       Waypoint type, index and coordinate.
+ *
+ * @return  [int8_t]    Function executing result.
+ * @retval  [1]         Busy, retry later.
+ * @retval  [0]         Success.
+ * @retval  [-1]        Fail.
+ *
+ */
+static int8_t Airplane_SetWpt(AIRPLANE_MP_WPT *p_mp_wpt)
+{
+    AIRPLANE_NAVIGATION *p_nav_config;
+
+    if(Airplane_IsCoordValid(&p_mp_wpt->coord) == false)
+        return -1;
+
+    if(p_mp_wpt->wpt_type == AIRPLANE_WPT_MISSION)
+        return Mission_SetWpt(p_mp_wpt->wpt_idx, &p_mp_wpt->coord);
+
+    if(p_mp_wpt->wpt_type != AIRPLANE_WPT_NAV || p_mp_wpt->wpt_idx >= AIRPLANE_WPT_NUM)
+        return -1;
+
+    if(Airplane_SaveState != AIRPLANE_SAVE_IDLE)
+        return 1;
+
+    p_nav_config = &Airplane_Config.navigation;
+
+    p_nav_config->wpt[p_mp_wpt->wpt_idx].wpt_coord = p_mp_wpt->coord;
+    p_nav_config->wpt[p_mp_wpt->wpt_idx].is_actived = true;
+
+    if(p_mp_wpt->wpt_idx >= p_nav_config->total_wpt)
+        p_nav_config->total_wpt = p_mp_wpt->wpt_idx + 1;
+
+    if(p_mp_wpt->wpt_idx == p_nav_config->current_wpt_idx && Airplane_IsNavMission == false)
+        GPS_SetWpt(&Airplane_GPS, &(p_nav_config->wpt[p_mp_wpt->wpt_idx].wpt_coord));
+
+    return 0;
+}
+
+/**
+ * Airplane_GetWpt - Function to read one waypoint of configuration or
+ *                   ROM mission.
+ *
+ * @param   [in/out]    *p_mp_wpt       Waypoint type and index, coordinate
+ *                                      is outputted.
+ *
+ * @return  [int8_t]    Function executing result.
+ * @retval  [0]         Success.
+ * @retval  [-1]        Fail.
+ *
+ */
+static int8_t Airplane_GetWpt(AIRPLANE_MP_WPT *p_mp_wpt)
+{
+    AIRPLANE_NAVIGATION *p_nav_config;
+
+    if(p_mp_wpt->wpt_type == AIRPLANE_WPT_MISSION)
+        return Mission_GetWpt(p_mp_wpt->wpt_idx, &p_mp_wpt->coord);
+
+    if(p_mp_wpt->wpt_type != AIRPLANE_WPT_NAV || p_mp_wpt->wpt_idx >= AIRPLANE_WPT_NUM)
+        return -1;
+
+    p_nav_config = &Airplane_Config.navigation;
+
+    p_mp_wpt->coord = p_nav_config->wpt[p_mp_wpt->wpt_idx].wpt_coord;
+
+    return (p_nav_config->wpt[p_mp_wpt->wpt_idx].is_actived == true) ? 0 : -1;
+}
+
+/**
+ * Airplane_SaveConfigTask - Function to save airplane configuration to ROM
+ *                           without blocking the control loop.
+ *
+ * Call this function once per control cycle. One changed byte is written per
+ * call, then the CRC16 is calculated from the ROM content (a few bytes per call)
+ * and written at last.
+ *
+ * Multi-byte values (parameters, PID settings and waypoints from ground tool,
+ * potentiometer readings) are not changed until saving is done, otherwise a
+ * half-written value would be stored with a valid CRC. Only single byte
+ * navigation status (Eg. current_wpt_idx) may change during saving.
+ *
+ * @param   [none]
+ * @return  [none]
+ *
+ */
+static void Airplane_SaveConfigTask()
+{
+    uint8_t rom_buf[AIRPLANE_SAVE_CRC_CHUNK_SIZE];
+    uint16_t body_size;
+    uint16_t chunk_size;
+    uint16_t rom_crc;
+
+    body_size = sizeof(AIRPLANE_CONFIG) - sizeof(Airplane_Config.rom_crc16);
+
+    switch(Airplane_SaveState){
+
+        case AIRPLANE_SAVE_BODY:
+
+            if(ROM_UpdateStep(AIRPLANE_CFG_ROM_ADDR, (uint8_t *)&Airplane_Config,
+                              body_size, &Airplane_SaveOffset) == 0){
+                Airplane_SaveOffset = 0;
+                Airplane_SaveCRC = CRC_INIT_VAL;
+                Airplane_SaveState = AIRPLANE_SAVE_CRC_CALC;
+            }
+
+            break;
+
+        case AIRPLANE_SAVE_CRC_CALC:
+
+            /* Do not wait for the ROM write procedure of mission */
+            if(ROM_IsBusy() == true)
+                break;
+
+            chunk_size = body_size - Airplane_SaveOffset;
+            if(chunk_size > sizeof(rom_buf))
+                chunk_size = sizeof(rom_buf);
+
+            ROM_ReadBytes(AIRPLANE_CFG_ROM_ADDR + Airplane_SaveOffset, rom_buf, chunk_size);
+            Airplane_SaveCRC = CRC_Update(rom_buf, chunk_size, Airplane_SaveCRC);
+
+            Airplane_SaveOffset += chunk_size;
+            if(Airplane_SaveOffset >= body_size){
+                Airplane_SaveOffset = 0;
+                Airplane_SaveState = AIRPLANE_SAVE_CRC_WRITE;
+            }
+
+            break;
+
+        case AIRPLANE_SAVE_CRC_WRITE:
+
+            if(ROM_UpdateStep(AIRPLANE_CFG_ROM_ADDR + body_size, (uint8_t *)&Airplane_SaveCRC,
+                              sizeof(Airplane_SaveCRC), &Airplane_SaveOffset) == 0){
+
+                /* Read after write, make sure the CRC is saved correctly */
+                ROM_ReadBytes(AIRPLANE_CFG_ROM_ADDR + body_size, (uint8_t *)&rom_crc, sizeof(rom_crc));
+
+                Airplane_Config.rom_crc16 = Airplane_SaveCRC;
+                Airplane_SaveResult = (rom_crc == Airplane_SaveCRC) ? 0 : -1;
+                Airplane_SaveOffset = 0;
+                Airplane_SaveState = AIRPLANE_SAVE_IDLE;
+
+                MP_LOG("[ROM] Save: %s (0x%hX)", Airplane_SaveResult ? "Fail" : "OK", rom_crc);
+            }
+
+            break;
+
+        default:
+            break;
+    }
+}
+
+/**
+ * Airplane_MissionTask - Function to store uploaded ROM mission in background,
+ *                        and respond once it's stored. The mission is not
+ *                        started, see Airplane_RxMissionStart().
+ *
+ * @param   [none]
+ * @return  [none]
+ *
+ */
+static void Airplane_MissionTask()
+{
+    AIRPLANE_MP_MISSION mp_mission;
+    int8_t ret_val;
+
+    ret_val = Mission_Task();
+
+    if(ret_val == 1 || Airplane_IsMissionPending == false)
+        return;
+
+    Airplane_IsMissionPending = false;
+
+    memset((void *)&mp_mission, 0, sizeof(mp_mission));
+    mp_mission.total_wpt = Mission_GetTotalWpt();
+    mp_mission.result = ret_val;
+
+    MP_Send(MP_RSP_CFG_MISSION_END, (uint8_t *)&mp_mission, sizeof(mp_mission));
+}
+
+/**
+ * Airplane_BaudTask - Function to switch UART0 baud rate requested by ground
+ *                     tool, and fall back to default rate if the new rate is
+ *                     not confirmed.
+ *
+ * Telemetry is paused until TX FIFO is empty (response of the request is sent
+ * at old rate), then the rate is changed. Any valid frame received at new rate
+ * confirms it, otherwise default rate is restored after
+ * AIRPLANE_BAUD_CONFIRM_TIMEOUT.
+ *
+ * @param   [in]        is_rx_frm   A valid frame is received in this cycle.
+ *
+ * @return  [none]
+ *
+ */
+static void Airplane_BaudTask(bool is_rx_frm)
+{
+    switch(Airplane_BaudState){
+
+        case AIRPLANE_BAUD_SWITCH:
+
+            if(Uart0_GetTxFree() < UART0_TX_FIFO_SIZE - 1)
+                break;
+
+            Uart0_SetBaud(Airplane_BaudPending);
+
+            if(Airplane_BaudPending == AIRPLANE_UART0_BAUD){
+                Airplane_BaudState = AIRPLANE_BAUD_IDLE;
+            }
+            else{
+                Airplane_BaudSwitchTime = Timer1_GetMillis();
+                Airplane_BaudState = AIRPLANE_BAUD_CONFIRM;
+            }
+
+            MP_LOG("[Airplane] Baud: %u", Airplane_BaudPending);
+
+            break;
+
+        case AIRPLANE_BAUD_CONFIRM:
+
+            if(is_rx_frm == true){
+                Airplane_BaudState = AIRPLANE_BAUD_IDLE;
+            }
+            else if(Timer1_GetMillis() - Airplane_BaudSwitchTime > AIRPLANE_BAUD_CONFIRM_TIMEOUT){
+                Airplane_BaudPending = AIRPLANE_UART0_BAUD;
+                Airplane_BaudState = AIRPLANE_BAUD_SWITCH;
+            }
+
+            break;
+
+        default:
+            break;
     }
 }
@@ -59,8 +59,67 @@
  */
 #define AIRPLANE_BANK_TURN_PITCH_GAIN   22.3923048447
 
-/* Airplane status snapshot function */
-#define AIRPLANE_STATUS_SNAPSHOT_EN     false
+/* Parameters of each PID controller, KP, KI, KD, scale, integral_max and output_max */
+#define AIRPLANE_PID_PARAM_NUM          6
+
+/* Bytes of ROM configuration are read back and CRCed per control cycle */
+#define AIRPLANE_SAVE_CRC_CHUNK_SIZE    16
+
+/*
+ * Compact telemetry, attitude and PID status are quantised to int16 and only
+ * changed fields are sent, so they can be sent in every telemetry slot.
+ */
+#define AIRPLANE_TLM_COMPACT_EN         true
+#define AIRPLANE_TLM_KEYFRAME_CYC       25      /* All fields are sent every 25 compact frames */
+#define AIRPLANE_TLM_ANGLE_SCALE        100.0   /* Centi-degree */
+#define AIRPLANE_TLM_PID_OUT_SCALE      10.0
+#define AIRPLANE_TLM_PID_INTG_SCALE     100.0
+
+/*
+ * UART0 boots at the safe default baud rate, the ground tool may switch it to
+ * an exact divider rate (250k, 500k, 1M at 16MHz) by MP_REQ_CFG_BAUD. The new
+ * rate must be confirmed by any valid frame from ground, or it falls back.
+ */
+#define AIRPLANE_UART0_BAUD             57600UL
+#define AIRPLANE_UART0_BAUD_MAX         1000000UL
+#define AIRPLANE_BAUD_CONFIRM_TIMEOUT   1000    /* 1000 ms = 1 second */
+
+/*
+ * Received MP frames are all processed in one control cycle, within the
+ * budget. Each MP_Recv() call handles one frame or up to MP_RX_FRM_BUF_SIZE
+ * bytes, the rest are kept in UART RX FIFO.
+ */
+#define AIRPLANE_RX_CALL_BUDGET         8       /* MP_Recv() calls per control cycle */
+#define AIRPLANE_RX_TIME_BUDGET         1000    /* 1000 us = 1.0 ms */
+#define AIRPLANE_RX_LEN_ANY             0xFF    /* Variable length request */
+
+/*
+ * Telemetry scheduler, streams are sent by priority when UART TX FIFO has
+ * space and the byte budget (part of link bandwidth) allows.
+ */
+#define AIRPLANE_TLM_LINK_USAGE         85      /* % of link bandwidth, the rest for responses and debug message */
+#define AIRPLANE_TLM_BYTES_PER_SEC(baud)    (((baud) / 10) * AIRPLANE_TLM_LINK_USAGE / 100)
+#define AIRPLANE_TLM_BURST_BYTES        (UART0_TX_FIFO_SIZE - 1)    /* Max budget, each stream must not exceed it */
+
+/*
+ * Frames of one telemetry stream are packed as records in one container frame
+ * (MP_RSP_SYS_CONTAINER), they share one frame header and CRC. Streams longer
+ * than max frame payload are still sent frame by frame.
+ */
+#define AIRPLANE_TLM_CONTAINER_EN       true
+#define AIRPLANE_TLM_RECORD_MAX         4       /* Max frames (records) of one stream */
+
+/*
+ * RAM blackbox, raw IMU, attitude, PID outputs, RC in/out and control period
+ * of each control cycle are recorded around a trigger (IMU/AHRS errors, RCIN
+ * failsafe or fly mode change), then the window is sent by
+ * AIRPLANE_TLM_BLACKBOX stream (MP_RSP_SYS_BLACKBOX).
+ *
+ * Disabled by default, BLACKBOX_DATA takes 368 bytes of RAM (with
+ * BLACKBOX_BUF_SIZE 256), check free RAM before enabling it.
+ */
+#define AIRPLANE_BLACKBOX_EN            false
+#define AIRPLANE_BB_POST_CNT            3       /* Control cycles recorded after trigger */
 
 
 /*
@@ -91,8 +150,132 @@ typedef enum airplane_fly_mode{
     AIRPLANE_MANUAL_FLY                         = 0,
     AIRPLANE_SELF_STABILIZE,
     AIRPLANE_RETURN_TO_HOME,
+    AIRPLANE_FLY_MISSION,                       /* Return to home switch, ROM mission is started by ground tool */
 }__attribute__((packed)) AIRPLANE_FLY_MODE;
 
+typedef enum airplane_pid_idx{
+    AIRPLANE_PID_ROLL                           = 0,
+    AIRPLANE_PID_PITCH,
+    AIRPLANE_PID_YAW,
+    AIRPLANE_PID_BANK,
+    AIRPLANE_PID_TOTAL,
+}__attribute__((packed)) AIRPLANE_PID_IDX;
+
+/* Parameter ID for MP_REQ_CFG_PARAM_READ/WRITE */
+typedef enum airplane_param_id{
+    AIRPLANE_PARAM_ROLL_KP                      = AIRPLANE_PID_ROLL * AIRPLANE_PID_PARAM_NUM,
+    AIRPLANE_PARAM_ROLL_KI,
+    AIRPLANE_PARAM_ROLL_KD,
+    AIRPLANE_PARAM_ROLL_SCALE,
+    AIRPLANE_PARAM_ROLL_INTEGRAL_MAX,
+    AIRPLANE_PARAM_ROLL_OUTPUT_MAX,
+
+    AIRPLANE_PARAM_PITCH_KP                     = AIRPLANE_PID_PITCH * AIRPLANE_PID_PARAM_NUM,
+    AIRPLANE_PARAM_PITCH_KI,
+    AIRPLANE_PARAM_PITCH_KD,
+    AIRPLANE_PARAM_PITCH_SCALE,
+    AIRPLANE_PARAM_PITCH_INTEGRAL_MAX,
+    AIRPLANE_PARAM_PITCH_OUTPUT_MAX,
+
+    AIRPLANE_PARAM_YAW_KP                       = AIRPLANE_PID_YAW * AIRPLANE_PID_PARAM_NUM,
+    AIRPLANE_PARAM_YAW_KI,
+    AIRPLANE_PARAM_YAW_KD,
+    AIRPLANE_PARAM_YAW_SCALE,
+    AIRPLANE_PARAM_YAW_INTEGRAL_MAX,
+    AIRPLANE_PARAM_YAW_OUTPUT_MAX,
+
+    AIRPLANE_PARAM_BANK_KP                      = AIRPLANE_PID_BANK * AIRPLANE_PID_PARAM_NUM,
+    AIRPLANE_PARAM_BANK_KI,
+    AIRPLANE_PARAM_BANK_KD,
+    AIRPLANE_PARAM_BANK_SCALE,
+    AIRPLANE_PARAM_BANK_INTEGRAL_MAX,
+    AIRPLANE_PARAM_BANK_OUTPUT_MAX,
+
+    AIRPLANE_PARAM_LOITER_RADIUS                = AIRPLANE_PID_TOTAL * AIRPLANE_PID_PARAM_NUM,
+    AIRPLANE_PARAM_TOTAL,
+}__attribute__((packed)) AIRPLANE_PARAM_ID;
+
+typedef enum airplane_wpt_type{
+    AIRPLANE_WPT_NAV                            = 0,    /* Waypoints of airplane configuration */
+    AIRPLANE_WPT_MISSION,                               /* Waypoints of ROM mission */
+}__attribute__((packed)) AIRPLANE_WPT_TYPE;
+
+/* Field bit of compact telemetry (MP_RSP_SYS_TLM_COMPACT) field mask */
+typedef enum airplane_tlm_field{
+    AIRPLANE_TLM_NED_ROLL                       = 0,
+    AIRPLANE_TLM_NED_PITCH,
+    AIRPLANE_TLM_NED_HEADING,                           /* Unsigned, 0 ~ 35999 */
+    AIRPLANE_TLM_GYRO_X,                                /* Raw sensor data */
+    AIRPLANE_TLM_GYRO_Y,
+    AIRPLANE_TLM_GYRO_Z,
+    AIRPLANE_TLM_SP_ROLL,
+    AIRPLANE_TLM_SP_PITCH,
+    AIRPLANE_TLM_SP_HEADING,                            /* Unsigned, 0 ~ 35999 */
+    AIRPLANE_TLM_PID_OUT,                               /* AIRPLANE_PID_TOTAL fields */
+    AIRPLANE_TLM_PID_INTG                       = AIRPLANE_TLM_PID_OUT + AIRPLANE_PID_TOTAL,
+    AIRPLANE_TLM_FIELD_TOTAL                    = AIRPLANE_TLM_PID_INTG + AIRPLANE_PID_TOTAL,
+}__attribute__((packed)) AIRPLANE_TLM_FIELD;
+
+/* Telemetry stream ID for MP_REQ_CFG_TLM_RATE_READ/WRITE */
+typedef enum airplane_tlm_stream_id{
+    AIRPLANE_TLM_HEARTBEAT                      = 0,    /* Heartbeat, general and cruise state */
+    AIRPLANE_TLM_COMPACT,                               /* Compact attitude, setpoint and PID status */
+    AIRPLANE_TLM_AHRS,
+    AIRPLANE_TLM_SETPOINT,
+    AIRPLANE_TLM_RC,                                    /* RC in and out channels */
+    AIRPLANE_TLM_PID_VAL,
+    AIRPLANE_TLM_PID_CFG,
+    AIRPLANE_TLM_GPS_FIX,                               /* GPS general, GGA and RMC */
+    AIRPLANE_TLM_GPS_NAV,                               /* GPS waypoint and navigation */
+    AIRPLANE_TLM_ERR_LOG,
+    AIRPLANE_TLM_BLACKBOX,                              /* Frozen blackbox window, one chunk per frame */
+    AIRPLANE_TLM_LINK,                                  /* UART, MP and GPS link statistics */
+    AIRPLANE_TLM_LATENCY,                               /* Stick-to-servo latency, LATENCY_EN */
+    AIRPLANE_TLM_STREAM_TOTAL,
+}__attribute__((packed)) AIRPLANE_TLM_STREAM_ID;
+
+/* Field of blackbox sample */
+typedef enum airplane_bb_field{
+    AIRPLANE_BB_ACCEL_X                         = 0,    /* Raw sensor data */
+    AIRPLANE_BB_ACCEL_Y,
+    AIRPLANE_BB_ACCEL_Z,
+    AIRPLANE_BB_GYRO_X,
+    AIRPLANE_BB_GYRO_Y,
+    AIRPLANE_BB_GYRO_Z,
+    AIRPLANE_BB_NED_ROLL,                               /* Centi-degree */
+    AIRPLANE_BB_NED_PITCH,
+    AIRPLANE_BB_NED_HEADING,                            /* Unsigned, 0 ~ 35999 */
+    AIRPLANE_BB_PID_OUT,                                /* AIRPLANE_PID_TOTAL fields */
+    AIRPLANE_BB_RC_IN                           = AIRPLANE_BB_PID_OUT + AIRPLANE_PID_TOTAL,
+    AIRPLANE_BB_RC_OUT                          = AIRPLANE_BB_RC_IN + RCIN_CH_TOTAL,
+    AIRPLANE_BB_CTRL_TIME                       = AIRPLANE_BB_RC_OUT + RCOUT_CH_TOTAL,  /* Unsigned, us */
+    AIRPLANE_BB_FIELD_TOTAL,
+}__attribute__((packed)) AIRPLANE_BB_FIELD;
+
+/* Trigger flags of blackbox window */
+typedef enum airplane_bb_trigger{
+    AIRPLANE_BB_TRIG_IMU_FAIL                   = 0x01,
+    AIRPLANE_BB_TRIG_AHRS_DELAY                 = 0x02,
+    AIRPLANE_BB_TRIG_ACCEL_EXCEED               = 0x04,
+    AIRPLANE_BB_TRIG_RCIN_FAIL                  = 0x08,
+    AIRPLANE_BB_TRIG_MODE_CHANGE                = 0x10,
+}__attribute__((packed)) AIRPLANE_BB_TRIGGER;
+
+/* Deferred configuration saving state */
+typedef enum airplane_save_state{
+    AIRPLANE_SAVE_IDLE                          = 0,
+    AIRPLANE_SAVE_BODY,
+    AIRPLANE_SAVE_CRC_CALC,
+    AIRPLANE_SAVE_CRC_WRITE,
+}__attribute__((packed)) AIRPLANE_SAVE_STATE;
+
+/* UART0 baud rate switching state */
+typedef enum airplane_baud_state{
+    AIRPLANE_BAUD_IDLE                          = 0,
+    AIRPLANE_BAUD_SWITCH,                               /* Wait for TX FIFO empty */
+    AIRPLANE_BAUD_CONFIRM,                              /* Wait for frame at new rate */
+}__attribute__((packed)) AIRPLANE_BAUD_STATE;
+
 
 /*
  *******************************************************************************
@@ -22,9 +22,11 @@
 #include "i2c_drv.h"
 #include "imu_ctrl.h"
 #include "rc_in.h"
+#include "rc_serial.h"
 #include "failsafe.h"
 #include "timers_drv.h"
 #include "rc_out.h"
+#include "ring_buffer.h"
 #include "uart_drv.h"
 #include "uart_stream.h"
 #include "pid.h"
@@ -35,6 +37,9 @@
 #include "pin_change.h"
 #include "debug.h"
 #include "gps.h"
+#include "mission.h"
+#include "blackbox.h"
+#include "latency.h"
 #include "ublox6m_drv.h"
 #include "math_lib.h"
 
@@ -0,0 +1,434 @@
+/**
+ *******************************************************************************
+ *      ______  _   __  ______  ____     ______        ___    ______   ____
+ *     / __  / / \ / / / ____/ / __ \   /  ___/       /  /   /_   _/  / __ \
+ *    / /_/ / /   \ / / ____/ /  -- /  /  /__   __   /  /__  _/  /_  / __ <
+ *   /_____/ /_/ \_/ /_____/ /__/ \_\ /_____/  /_/  /_____/ /_____/ /_____/
+ *
+ *     An amateur remote control software library. Use at your own risk.
+ *
+ * @file    blackbox.cpp
+ * @brief   RAM blackbox.
+ *
+ *          Each sample is a set of int16 fields, it is stored as zig-zag
+ *          varint of the delta to previous sample, so a field that changes
+ *          slowly costs one byte. When the ring is full, the oldest samples
+ *          are dropped and added to the base values, so the oldest sample in
+ *          the ring can always be decoded.
+ *
+ *          A trigger keeps recording for post_max samples and then freezes
+ *          the ring, so the window holds the samples before and after the
+ *          trigger. The frozen window is read out in small chunks by the
+ *          caller (when the link has bandwidth), then the blackbox is armed
+ *          again. Triggers are ignored while a window is being read out.
+ * @author  Y.S.Kuo in Hsinchu
+ *******************************************************************************
+ */
+
+#include <Arduino.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "blackbox.h"
+
+
+/*
+ *******************************************************************************
+ * Constant value definition
+ *******************************************************************************
+ */
+
+
+/*
+ *******************************************************************************
+ * Data type definition
+ *******************************************************************************
+ */
+
+
+/*
+ *******************************************************************************
+ * Global variables
+ *******************************************************************************
+ */
+
+
+/*
+ *******************************************************************************
+ * Public functions declaration
+ *******************************************************************************
+ */
+
+
+/*
+ *******************************************************************************
+ * Private functions declaration
+ *******************************************************************************
+ */
+
+static uint8_t Blackbox_PutVarint(uint8_t *p_buf, int16_t delta);
+static int16_t Blackbox_GetVarint(BLACKBOX_DATA *p_bb, uint16_t *p_idx);
+static void Blackbox_DropOldest(BLACKBOX_DATA *p_bb);
+static uint8_t Blackbox_GetWindowByte(BLACKBOX_DATA *p_bb, uint16_t offset);
+static uint16_t Blackbox_GetWindowSize(BLACKBOX_DATA *p_bb);
+static void Blackbox_Rearm(BLACKBOX_DATA *p_bb);
+
+
+/*
+ *******************************************************************************
+ * Public functions
+ *******************************************************************************
+ */
+
+/**
+ * Blackbox_Init - Function to initialize blackbox, all base values are 0.
+ *
+ * @param   [out]       *p_bb       Blackbox.
+ * @param   [in]        field_num   Fields per sample, 1 ~ BLACKBOX_FIELD_MAX.
+ * @param   [in]        post_max    Samples to record after trigger.
+ *
+ * @return  [int8_t]    Function executing result.
+ * @retval  [0]         Success.
+ * @retval  [-1]        Fail.
+ *
+ */
+int8_t Blackbox_Init(BLACKBOX_DATA *p_bb, uint8_t field_num, uint8_t post_max)
+{
+    if(field_num == 0 || field_num > BLACKBOX_FIELD_MAX)
+        return -1;
+
+    memset((void *)p_bb, 0, sizeof(BLACKBOX_DATA));
+
+    p_bb->window.field_num = field_num;
+    p_bb->post_max = post_max;
+
+    Blackbox_Rearm(p_bb);
+
+    return 0;
+}
+
+/**
+ * Blackbox_Record - Function to append one sample, oldest samples are dropped
+ *                   if there is no space. Sample is ignored if the window is
+ *                   frozen.
+ *
+ * @param   [in/out]    *p_bb       Blackbox.
+ * @param   [in]        *p_val      Field values, field_num values.
+ *
+ * @return  [none]
+ *
+ */
+void Blackbox_Record(BLACKBOX_DATA *p_bb, int16_t *p_val)
+{
+    uint8_t sample[BLACKBOX_SAMPLE_MAX_SIZE];
+    uint8_t sample_size;
+    uint8_t copy_size;
+    uint8_t idx;
+
+    if(p_bb->state == BLACKBOX_FROZEN)
+        return;
+
+    sample_size = 0;
+
+    for(idx = 0; idx < p_bb->window.field_num; idx++){
+        /* Wrap around delta, signed overflow is avoided */
+        sample_size += Blackbox_PutVarint(&sample[sample_size],
+                                          (int16_t)((uint16_t)p_val[idx] - (uint16_t)p_bb->last_val[idx]));
+        p_bb->last_val[idx] = p_val[idx];
+    }
+
+    while(BLACKBOX_BUF_SIZE - p_bb->used < sample_size)
+        Blackbox_DropOldest(p_bb);
+
+    /* Copy to ring, wrap around at end of buffer */
+    copy_size = sample_size;
+    if(copy_size > BLACKBOX_BUF_SIZE - p_bb->head)
+        copy_size = BLACKBOX_BUF_SIZE - p_bb->head;
+
+    memcpy((void *)&p_bb->buf[p_bb->head], (void *)sample, copy_size);
+    memcpy((void *)p_bb->buf, (void *)&sample[copy_size], sample_size - copy_size);
+
+    p_bb->head += sample_size;
+    if(p_bb->head >= BLACKBOX_BUF_SIZE)
+        p_bb->head -= BLACKBOX_BUF_SIZE;
+
+    p_bb->used += sample_size;
+    p_bb->window.sample_cnt++;
+
+    if(p_bb->state == BLACKBOX_POST_TRIGGER){
+        p_bb->window.post_cnt++;
+
+        if(p_bb->window.post_cnt >= p_bb->post_max){
+            p_bb->state = BLACKBOX_FROZEN;
+            p_bb->window_id++;
+            p_bb->read_offset = 0;
+        }
+    }
+}
+
+/**
+ * Blackbox_Trigger - Function to trigger the window at latest sample, flags
+ *                    of triggers during post-trigger recording are merged.
+ *
+ * @param   [in/out]    *p_bb       Blackbox.
+ * @param   [in]        trigger     Trigger flags, 0 is ignored.
+ *
+ * @return  [none]
+ *
+ */
+void Blackbox_Trigger(BLACKBOX_DATA *p_bb, uint8_t trigger)
+{
+    if(trigger == 0)
+        return;
+
+    if(p_bb->state == BLACKBOX_RECORD){
+        p_bb->state = BLACKBOX_POST_TRIGGER;
+        p_bb->window.trigger = trigger;
+        p_bb->window.post_cnt = 0;
+
+        if(p_bb->post_max == 0){
+            p_bb->state = BLACKBOX_FROZEN;
+            p_bb->window_id++;
+            p_bb->read_offset = 0;
+        }
+    }
+    else if(p_bb->state == BLACKBOX_POST_TRIGGER){
+        p_bb->window.trigger |= trigger;
+    }
+}
+
+/**
+ * Blackbox_IsFrozen - Function to check whether a window is ready to read.
+ *
+ * @param   [in]        *p_bb       Blackbox.
+ *
+ * @return  [bool]      Window is frozen.
+ *
+ */
+bool Blackbox_IsFrozen(BLACKBOX_DATA *p_bb)
+{
+    return (p_bb->state == BLACKBOX_FROZEN);
+}
+
+/**
+ * Blackbox_GetChunk - Function to get next chunk of frozen window, the read
+ *                     offset is not moved until Blackbox_NextChunk() is called,
+ *                     so a chunk which can't be sent is read again.
+ *
+ * @param   [in]        *p_bb       Blackbox.
+ * @param   [out]       *p_buf      Chunk buffer, at least
+ *                                  sizeof(BLACKBOX_CHUNK_HDR) + BLACKBOX_CHUNK_SIZE.
+ *
+ * @return  [uint8_t]   Chunk bytes, 0 if the window is not frozen.
+ *
+ */
+uint8_t Blackbox_GetChunk(BLACKBOX_DATA *p_bb, uint8_t *p_buf)
+{
+    BLACKBOX_CHUNK_HDR *p_chunk_hdr;
+    uint16_t window_size;
+    uint8_t data_size;
+    uint8_t idx;
+
+    if(p_bb->state != BLACKBOX_FROZEN)
+        return 0;
+
+    window_size = Blackbox_GetWindowSize(p_bb);
+    data_size = BLACKBOX_CHUNK_SIZE;
+    if(data_size > window_size - p_bb->read_offset)
+        data_size = window_size - p_bb->read_offset;
+
+    p_chunk_hdr = (BLACKBOX_CHUNK_HDR *)p_buf;
+    p_chunk_hdr->window_id = p_bb->window_id;
+    p_chunk_hdr->window_size = window_size;
+    p_chunk_hdr->offset = p_bb->read_offset;
+
+    for(idx = 0; idx < data_size; idx++)
+        p_buf[sizeof(BLACKBOX_CHUNK_HDR) + idx] = Blackbox_GetWindowByte(p_bb, p_bb->read_offset + idx);
+
+    return sizeof(BLACKBOX_CHUNK_HDR) + data_size;
+}
+
+/**
+ * Blackbox_NextChunk - Function to move to next chunk after the chunk is sent,
+ *                      the blackbox is armed again after the last chunk.
+ *
+ * @param   [in/out]    *p_bb       Blackbox.
+ *
+ * @return  [none]
+ *
+ */
+void Blackbox_NextChunk(BLACKBOX_DATA *p_bb)
+{
+    if(p_bb->state != BLACKBOX_FROZEN)
+        return;
+
+    p_bb->read_offset += BLACKBOX_CHUNK_SIZE;
+
+    if(p_bb->read_offset >= Blackbox_GetWindowSize(p_bb))
+        Blackbox_Rearm(p_bb);
+}
+
+
+/*
+ *******************************************************************************
+ * Private functions
+ *******************************************************************************
+ */
+
+/**
+ * Blackbox_PutVarint - Function to encode delta as zig-zag varint.
+ *
+ * @param   [out]       *p_buf      Output buffer, at least BLACKBOX_VARINT_MAX_SIZE
+ *                                  bytes.
+ * @param   [in]        delta       Delta value.
+ *
+ * @return  [uint8_t]   Encoded bytes.
+ *
+ */
+static uint8_t Blackbox_PutVarint(uint8_t *p_buf, int16_t delta)
+{
+    uint16_t value;
+    uint8_t size;
+
+    /* 0, -1, 1, -2, 2 ... to 0, 1, 2, 3, 4 ... */
+    value = ((uint16_t)delta << 1) ^ (uint16_t)(delta >> 15);
+
+    size = 0;
+
+    while(value >= 0x80){
+        p_buf[size++] = (uint8_t)value | 0x80;
+        value >>= 7;
+    }
+
+    p_buf[size++] = (uint8_t)value;
+
+    return size;
+}
+
+/**
+ * Blackbox_GetVarint - Function to decode one zig-zag varint of ring.
+ *
+ * @param   [in]        *p_bb       Blackbox.
+ * @param   [in/out]    *p_idx      Ring index, moved to next varint.
+ *
+ * @return  [int16_t]   Delta value.
+ *
+ */
+static int16_t Blackbox_GetVarint(BLACKBOX_DATA *p_bb, uint16_t *p_idx)
+{
+    uint16_t value;
+    uint8_t data_byte;
+    uint8_t shift;
+
+    value = 0;
+    shift = 0;
+
+    do{
+        data_byte = p_bb->buf[*p_idx];
+
+        (*p_idx)++;
+        if(*p_idx >= BLACKBOX_BUF_SIZE)
+            *p_idx = 0;
+
+        value |= (uint16_t)(data_byte & 0x7F) << shift;
+        shift += 7;
+    }while(data_byte & 0x80);
+
+    return (int16_t)((value >> 1) ^ (0 - (value & 1)));
+}
+
+/**
+ * Blackbox_DropOldest - Function to drop oldest sample, the sample is added
+ *                       to base values.
+ *
+ * @param   [in/out]    *p_bb       Blackbox.
+ *
+ * @return  [none]
+ *
+ */
+static void Blackbox_DropOldest(BLACKBOX_DATA *p_bb)
+{
+    uint16_t idx;
+    uint16_t drop_size;
+    uint8_t field_idx;
+
+    idx = p_bb->tail;
+
+    for(field_idx = 0; field_idx < p_bb->window.field_num; field_idx++){
+        p_bb->base_val[field_idx] = (int16_t)((uint16_t)p_bb->base_val[field_idx]
+                                              + (uint16_t)Blackbox_GetVarint(p_bb, &idx));
+    }
+
+    drop_size = (idx >= p_bb->tail) ? (idx - p_bb->tail) : (idx + BLACKBOX_BUF_SIZE - p_bb->tail);
+
+    p_bb->tail = idx;
+    p_bb->used -= drop_size;
+    p_bb->window.sample_cnt--;
+}
+
+/**
+ * Blackbox_GetWindowByte - Function to get one byte of window, the window is
+ *                          header, base values and ring from oldest sample.
+ *
+ * @param   [in]        *p_bb       Blackbox.
+ * @param   [in]        offset      Window offset.
+ *
+ * @return  [uint8_t]   Window byte.
+ *
+ */
+static uint8_t Blackbox_GetWindowByte(BLACKBOX_DATA *p_bb, uint16_t offset)
+{
+    uint16_t base_size;
+
+    if(offset < sizeof(BLACKBOX_WINDOW_HDR))
+        return ((uint8_t *)&p_bb->window)[offset];
+
+    offset -= sizeof(BLACKBOX_WINDOW_HDR);
+    base_size = p_bb->window.field_num * sizeof(p_bb->base_val[0]);
+
+    if(offset < base_size)
+        return ((uint8_t *)p_bb->base_val)[offset];
+
+    offset = p_bb->tail + (offset - base_size);
+    if(offset >= BLACKBOX_BUF_SIZE)
+        offset -= BLACKBOX_BUF_SIZE;
+
+    return p_bb->buf[offset];
+}
+
+/**
+ * Blackbox_GetWindowSize - Function to get total bytes of window.
+ *
+ * @param   [in]        *p_bb       Blackbox.
+ *
+ * @return  [uint16_t]  Window bytes.
+ *
+ */
+static uint16_t Blackbox_GetWindowSize(BLACKBOX_DATA *p_bb)
+{
+    return sizeof(BLACKBOX_WINDOW_HDR) + p_bb->window.field_num * sizeof(p_bb->base_val[0]) + p_bb->used;
+}
+
+/**
+ * Blackbox_Rearm - Function to clear the ring and restart recording, the
+ *                  next sample is delta of last recorded sample.
+ *
+ * @param   [in/out]    *p_bb       Blackbox.
+ *
+ * @return  [none]
+ *
+ */
+static void Blackbox_Rearm(BLACKBOX_DATA *p_bb)
+{
+    memcpy((void *)p_bb->base_val, (void *)p_bb->last_val, sizeof(p_bb->base_val));
+
+    p_bb->head = 0;
+    p_bb->tail = 0;
+    p_bb->used = 0;
+
+    p_bb->window.trigger = 0;
+    p_bb->window.sample_cnt = 0;
+    p_bb->window.post_cnt = 0;
+
+    p_bb->state = BLACKBOX_RECORD;
+}
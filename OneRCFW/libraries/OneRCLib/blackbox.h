@@ -0,0 +1,129 @@
+/**
+ *******************************************************************************
+ *      ______  _   __  ______  ____     ______        ___    ______   ____
+ *     / __  / / \ / / / ____/ / __ \   /  ___/       /  /   /_   _/  / __ \
+ *    / /_/ / /   \ / / ____/ /  -- /  /  /__   __   /  /__  _/  /_  / __ <
+ *   /_____/ /_/ \_/ /_____/ /__/ \_\ /_____/  /_/  /_____/ /_____/ /_____/
+ *
+ *     An amateur remote control software library. Use at your own risk.
+ *
+ * @file    blackbox.h
+ * @brief   RAM blackbox, a ring of delta encoded samples which is frozen around
+ *          a trigger event and read out in chunks.
+ * @author  Y.S.Kuo in Hsinchu
+ *******************************************************************************
+ */
+
+#ifndef BLACKBOX_H_
+#define BLACKBOX_H_
+
+#include <stdint.h>
+
+
+/*
+ *******************************************************************************
+ * Constant value definition
+ *******************************************************************************
+ */
+
+#define BLACKBOX_BUF_SIZE               256     /* Encoded samples, about 10 samples of 23 fields */
+#define BLACKBOX_FIELD_MAX              24      /* Max int16 fields per sample */
+#define BLACKBOX_CHUNK_SIZE             32      /* Max window bytes per chunk */
+
+/* Zig-zag varint of int16 delta */
+#define BLACKBOX_VARINT_MAX_SIZE        3
+#define BLACKBOX_SAMPLE_MAX_SIZE        (BLACKBOX_FIELD_MAX * BLACKBOX_VARINT_MAX_SIZE)
+
+
+/*
+ *******************************************************************************
+ * Data type definition
+ *******************************************************************************
+ */
+
+typedef enum blackbox_state{
+    BLACKBOX_RECORD                             = 0,    /* Keep latest samples */
+    BLACKBOX_POST_TRIGGER,                              /* Record samples after trigger */
+    BLACKBOX_FROZEN,                                    /* Window is being read out */
+}__attribute__((packed)) BLACKBOX_STATE;
+
+/*
+ * Window header, followed by base values (int16 of each field) and encoded
+ * samples. The first sample is delta of base values, each later sample is
+ * delta of previous sample. The trigger is found at sample
+ * (sample_cnt - post_cnt - 1).
+ */
+typedef struct blackbox_window_hdr{
+    uint8_t field_num;
+    uint8_t trigger;                    /* Trigger flags of caller */
+    uint16_t sample_cnt;
+    uint8_t post_cnt;                   /* Samples after trigger */
+}__attribute__((packed)) BLACKBOX_WINDOW_HDR;
+
+/* Chunk header, followed by up to BLACKBOX_CHUNK_SIZE window bytes */
+typedef struct blackbox_chunk_hdr{
+    uint8_t window_id;                  /* Increased per window */
+    uint16_t window_size;
+    uint16_t offset;                    /* Window offset of chunk data */
+}__attribute__((packed)) BLACKBOX_CHUNK_HDR;
+
+typedef struct blackbox_data{
+    uint8_t buf[BLACKBOX_BUF_SIZE];     /* Encoded samples ring */
+    uint16_t head;                      /* Write index */
+    uint16_t tail;                      /* Oldest sample index */
+    uint16_t used;                      /* Used bytes */
+
+    int16_t base_val[BLACKBOX_FIELD_MAX];   /* Values before oldest sample */
+    int16_t last_val[BLACKBOX_FIELD_MAX];   /* Values of newest sample */
+
+    BLACKBOX_WINDOW_HDR window;
+    BLACKBOX_STATE state;
+    uint8_t post_max;                   /* Samples to record after trigger */
+    uint8_t window_id;
+    uint16_t read_offset;               /* Next chunk offset of frozen window */
+}BLACKBOX_DATA;
+
+
+/*
+ *******************************************************************************
+ * Global variables
+ *******************************************************************************
+ */
+
+
+/*
+ *******************************************************************************
+ * Public functions declaration
+ *******************************************************************************
+ */
+
+
+/*
+ *******************************************************************************
+ * Private functions declaration
+ *******************************************************************************
+ */
+
+
+/*
+ *******************************************************************************
+ * Public functions
+ *******************************************************************************
+ */
+
+int8_t Blackbox_Init(BLACKBOX_DATA *p_bb, uint8_t field_num, uint8_t post_max);
+void Blackbox_Record(BLACKBOX_DATA *p_bb, int16_t *p_val);
+void Blackbox_Trigger(BLACKBOX_DATA *p_bb, uint8_t trigger);
+bool Blackbox_IsFrozen(BLACKBOX_DATA *p_bb);
+uint8_t Blackbox_GetChunk(BLACKBOX_DATA *p_bb, uint8_t *p_buf);
+void Blackbox_NextChunk(BLACKBOX_DATA *p_bb);
+
+
+/*
+ *******************************************************************************
+ * Private functions
+ *******************************************************************************
+ */
+
+
+#endif // BLACKBOX_H_
@@ -27,6 +27,12 @@
 
 #define CRC_INIT_VAL    0xFFFF
 
+/*
+ * Use 256 entries lookup table (512 bytes flash) instead of shift/xor method
+ * in CRC_Update(). Measure both on target before enabling it.
+ */
+#define CRC_TABLE_EN    false
+
 
 /*
  *******************************************************************************
@@ -64,7 +70,8 @@
 
 uint16_t CRC_Accumulate(uint8_t data, uint16_t accum_crc);
 uint16_t CRC_AccumulateLoop(uint8_t *p_data, uint8_t data_size, uint16_t accum_crc);
-uint16_t CRC_Calculate(uint8_t *p_data, uint8_t data_size);
+uint16_t CRC_Update(uint8_t *p_data, uint16_t data_size, uint16_t accum_crc);
+uint16_t CRC_Calculate(uint8_t *p_data, uint16_t data_size);
 
 
 
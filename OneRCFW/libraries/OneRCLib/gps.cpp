@@ -120,6 +120,17 @@
 #define GPS_NMEA_GPGGA(field)           ((uint8_t)(GPS_RX_NMEA_TYPE_GGA | field))
 #define GPS_NMEA_GPRMC(field)           ((uint8_t)(GPS_RX_NMEA_TYPE_RMC | field))
 
+/* NMEA byte source, contiguous bytes are processed in place then consumed */
+#if GPS_BENCH_EN
+    #define GPS_READ_PEEK(pp_data)          GPS_BenchReadPeek(pp_data)
+    #define GPS_READ_CONSUME(bytes)         GPS_BenchReadConsume(bytes)
+    #define GPS_READ_START_TIME(p_ticks)    (-1)
+#else
+    #define GPS_READ_PEEK(pp_data)          UartS_ReadPeek(pp_data)
+    #define GPS_READ_CONSUME(bytes)         UartS_ReadConsume(bytes)
+    #define GPS_READ_START_TIME(p_ticks)    UartS_ReadRxMarkTime(p_ticks)
+#endif
+
 
 /*
  *******************************************************************************
@@ -197,9 +208,21 @@ static uint8_t GPS_RxNMEAChkSum;
 static uint8_t GPS_RxChkSumBuf[GPS_NMEA_CHECKSUM_SIZE + 1];
 static uint8_t GPS_RxChkSumBufIdx;
 static GPS_NMEA_REPORT GPS_RxNMEAPrivate;
+static uint32_t GPS_RxNMEASofTicks;             /* Start bit time-stamp of current NMEA frame */
+static uint32_t GPS_RxNMEAUtcMillis;            /* GPGGA UTC time in milliseconds of day */
+
+static uint32_t GPS_GGASofTicks;                /* Start bit time-stamp of latest GPGGA frame */
+static int32_t GPS_FixOffsetRef;                /* Minimum offset between local clock and UTC */
+static bool GPS_FixOffsetIsSet;
 
 GPS_ERROR_LOG GPS_ErrorLog;
 
+#if GPS_BENCH_EN
+static uint8_t *p_GPS_BenchData;                /* Fed NMEA stream */
+static uint8_t GPS_BenchBytes;                  /* Remaining bytes of fed NMEA stream */
+static GPS_BENCH_STAT GPS_BenchStat;
+#endif
+
 
 /*
  *******************************************************************************
@@ -220,11 +243,19 @@ static uint8_t GPS_RecvNMEA(uint8_t *p_frm_buf, uint8_t frm_buf_size,
 static int8_t GPS_DecodeNMEA_Filed(uint8_t *p_field_start, uint8_t nmea_type,
                                    uint8_t field_idx, GPS_NMEA_REPORT *p_report);
 static int8_t GPS_UpdateWptRelativeBearing(GPS_DATA *p_gps_data, float *p_bearing);
+static void GPS_UpdateFixLatency(GPS_DATA *p_gps_data, uint32_t sof_ticks);
+static uint32_t GPS_TicksToMillis(uint32_t ticks);
+static uint32_t GPS_UtcToMillis(uint8_t *p_str);
 static float GPS_DM_TO_DD(float dm_val);
 static uint32_t GPS_FastHextoul(uint8_t *p_hex_str);
 static int32_t GPS_FastStrtoi(uint8_t *p_str, uint8_t **p_end);
 static float GPS_FastStrtof(uint8_t *p_str, uint8_t **p_end);
 
+#if GPS_BENCH_EN
+static uint8_t GPS_BenchReadPeek(const uint8_t **pp_data);
+static void GPS_BenchReadConsume(uint8_t bytes);
+#endif
+
 
 /*
  *******************************************************************************
@@ -247,6 +278,7 @@ int8_t GPS_Init(GPS_DATA *p_gps_data)
 {
     int8_t ret_val;
     const char *p_ret_msg[] = {"OK", "Fail"};
+    const uint8_t nmea_start_keys[] = {GPS_NMEA_START_KEY, GPS_NMEA_ENCAP_KEY};
 
     if(p_gps_data == NULL)
         return -1;
@@ -259,6 +291,8 @@ int8_t GPS_Init(GPS_DATA *p_gps_data)
     p_gps_data->general.rmc_timestamp = 0;
     p_gps_data->general.uknown_det_cnt = 0;
     p_gps_data->general.uknown_timestamp = 0;
+    p_gps_data->general.gga_rx_delay_ms = 0;
+    p_gps_data->general.gga_fix_delay_ms = 0;
 
     p_gps_data->nmea.gpgga.UTC = 0.0;
     p_gps_data->nmea.gpgga.coord.LAT_DD = 0.0;
@@ -304,6 +338,16 @@ int8_t GPS_Init(GPS_DATA *p_gps_data)
     GPS_RxNMEABufIdx = 0;
     GPS_RxNMEAType = GPS_RX_NMEA_TYPE_UNKNOWN;
     GPS_RxNMEAChkSum = 0;
+    GPS_RxNMEASofTicks = 0;
+    GPS_RxNMEAUtcMillis = 0;
+
+    /* Initialize for fix latency measurement */
+    GPS_GGASofTicks = 0;
+    GPS_FixOffsetRef = 0;
+    GPS_FixOffsetIsSet = false;
+
+    /* Time-stamp NMEA start delimiters at their start bit */
+    UartS_SetRxMarks(nmea_start_keys, sizeof(nmea_start_keys));
 
     /* Initialize GPS hardware module */
     ret_val = GPS_MODULE_INIT();
@@ -359,11 +403,14 @@ GPS_RX_NMEA_TYPE GPS_UpdateNMEA(GPS_DATA *p_gps_data)
         /* Received GPGGA message */
         if(nmea_type == GPS_RX_NMEA_TYPE_GGA){
             p_gps_data->general.gga_det_cnt++;
-            p_gps_data->general.gga_timestamp = nmea_timestamp;
+            p_gps_data->general.gga_timestamp = GPS_TicksToMillis(nmea_timestamp);
 
             if(GPS_RxNMEAPrivate.gpgga.fix_status == 0){
                 p_gps_data->general.gga_invalid_cnt++;
             }
+            else{
+                GPS_UpdateFixLatency(p_gps_data, nmea_timestamp);
+            }
 
             memcpy((void *)&p_gps_data->nmea.gpgga, (void *)&GPS_RxNMEAPrivate.gpgga,
                    sizeof(GPS_RxNMEAPrivate.gpgga));
@@ -371,7 +418,7 @@ GPS_RX_NMEA_TYPE GPS_UpdateNMEA(GPS_DATA *p_gps_data)
         /* Received GPRMC message */
         else if(nmea_type == GPS_RX_NMEA_TYPE_RMC){
             p_gps_data->general.rmc_det_cnt++;
-            p_gps_data->general.rmc_timestamp = nmea_timestamp;
+            p_gps_data->general.rmc_timestamp = GPS_TicksToMillis(nmea_timestamp);
 
             if((GPS_RxNMEAPrivate.gprmc.fix_status | GPS_RxNMEAPrivate.gprmc.nav_status) == 0){
                 p_gps_data->general.rmc_invalid_cnt++;
@@ -383,7 +430,7 @@ GPS_RX_NMEA_TYPE GPS_UpdateNMEA(GPS_DATA *p_gps_data)
         /* Received unknown type message */
         else{
             p_gps_data->general.uknown_det_cnt++;
-            p_gps_data->general.uknown_timestamp = nmea_timestamp;
+            p_gps_data->general.uknown_timestamp = GPS_TicksToMillis(nmea_timestamp);
         }
     }
 
@@ -406,6 +453,7 @@ int8_t GPS_UpdateNav(GPS_DATA *p_gps_data)
     GPS_WAYPOINT_DATA *p_waypoint;
     GPS_NMEA_REPORT *p_nmea;
     GPS_NAVIGATION_DATA *p_nav;
+    GPS_COORD_POINT nav_coord;
     float wpt_bearing;
     float wpt_distance;
     float move_distance;
@@ -461,7 +509,14 @@ int8_t GPS_UpdateNav(GPS_DATA *p_gps_data)
      */
     if(p_waypoint->is_set == true){
 
-        wpt_distance = GPS_CalApproxDistance(&p_nmea->gpgga.coord, &p_waypoint->coord);
+#if GPS_LATENCY_COMPENSATION_EN
+        /* Compensate GPS fix latency, fall back to reported position if fail */
+        GPS_GetExtrapolatedCoord(p_gps_data, &nav_coord);
+#else
+        nav_coord = p_nmea->gpgga.coord;
+#endif
+
+        wpt_distance = GPS_CalApproxDistance(&nav_coord, &p_waypoint->coord);
 
         /*
          * Only update navigation course when the distance between waypoint
@@ -470,7 +525,7 @@ int8_t GPS_UpdateNav(GPS_DATA *p_gps_data)
         if(wpt_distance >= haccy_meters){
 
             /* Calculate current moving course angle */
-            wpt_bearing = GPS_CalInitTrueBearingAngle(&p_nmea->gpgga.coord, &p_waypoint->coord);
+            wpt_bearing = GPS_CalInitTrueBearingAngle(&nav_coord, &p_waypoint->coord);
 
             /* Store current position and related information */
             p_waypoint->update_cycle++;
@@ -615,6 +670,87 @@ float GPS_GetWptRelativeBearing(GPS_DATA *p_gps_data)
     return p_gps_data->nav.relative_bearing_angle;
 }
 
+/**
+ * GPS_GetFixAge - Function to get the age of latest GPGGA position fix.
+ *
+ * Fix age = (Now - First byte of GPGGA frame) + Fix epoch to first byte delay.
+ *
+ * @param   [in]        *p_gps_data     Data structure contains latest GPS information.
+ *
+ * @return  [uint16_t]  Age of latest position fix in milliseconds.
+ * @retval  [0 ~ 65534] Fix age.
+ * @retval  [65535]     No valid fix or too old.
+ *
+ */
+uint16_t GPS_GetFixAge(GPS_DATA *p_gps_data)
+{
+    uint32_t delta_ticks;
+    uint32_t age;
+
+    if(p_gps_data == NULL || GPS_FixOffsetIsSet == false)
+        return 0xFFFF;
+
+    delta_ticks = Timer1_GetTicks32() - GPS_GGASofTicks;
+    age = TIMER1_TICKS_TO_MICROS(delta_ticks) / 1000;
+    age += p_gps_data->general.gga_fix_delay_ms;
+
+    return (age < 0xFFFF) ? (uint16_t)age : 0xFFFF;
+}
+
+/**
+ * GPS_GetExtrapolatedCoord - Function to extrapolate latest GPGGA position
+ *                            to current time by using fix age, ground speed
+ *                            and course over ground.
+ *
+ * Output coordinate is always set to reported GPGGA position first, so it
+ * can still be used by caller if the extrapolation is failed.
+ *
+ * @param   [in]        *p_gps_data     Data structure contains latest GPS information.
+ * @param   [out]       *p_coord        Extrapolated coordinate.
+ *
+ * @return  [int8_t]    Function executing result.
+ * @retval  [0]         Success.
+ * @retval  [-1]        Fail.
+ *
+ */
+int8_t GPS_GetExtrapolatedCoord(GPS_DATA *p_gps_data, GPS_COORD_POINT *p_coord)
+{
+    GPS_NMEA_REPORT *p_nmea;
+    uint16_t age_ms;
+    float distance;
+    float cog_rad;
+    float lat_rad;
+
+    if(p_gps_data == NULL || p_coord == NULL)
+        return -1;
+
+    p_nmea = &p_gps_data->nmea;
+
+    p_coord->LAT_DD = p_nmea->gpgga.coord.LAT_DD;
+    p_coord->LONG_DD = p_nmea->gpgga.coord.LONG_DD;
+
+    if(p_nmea->gpgga.fix_status == 0
+       || (p_nmea->gprmc.fix_status | p_nmea->gprmc.nav_status) == 0){
+        return -1;
+    }
+
+    age_ms = GPS_GetFixAge(p_gps_data);
+    if(age_ms > GPS_LATENCY_MAX_EXTRAPOLATE_MS)
+        return -1;
+
+    /* Moving distance since the fix epoch */
+    distance = p_nmea->gprmc.gnd_speed_MS * (age_ms * 0.001);
+
+    cog_rad = MATH_DEG2RAD(p_nmea->gprmc.COG_degrees);
+    lat_rad = MATH_DEG2RAD(p_nmea->gpgga.coord.LAT_DD);
+
+    p_coord->LAT_DD += MATH_RAD2DEG(distance * cos(cog_rad) / GPS_EARTH_RADIUS_METERS);
+    p_coord->LONG_DD += MATH_RAD2DEG(distance * sin(cog_rad)
+                                     / (GPS_EARTH_RADIUS_METERS * cos(lat_rad)));
+
+    return 0;
+}
+
 /**
  * GPS_CalInitTrueBearingAngle - Function to calculate the initial true
  *                               bearing angle from point A to B.
@@ -712,6 +848,130 @@ float GPS_CalApproxDistance(GPS_COORD_POINT *p_src, GPS_COORD_POINT *p_dest)
     return Math_FastSqrt((x * x + y * y)) * GPS_EARTH_RADIUS_METERS;
 }
 
+#if GPS_BENCH_EN
+
+/**
+ * GPS_BenchReset - Function to reset NMEA parser, GPS counters and
+ *                  benchmark statistic before feeding a new NMEA stream.
+ *
+ * @param   [in/out]    *p_gps_data     Data structure for storing latest GPS information.
+ *
+ * @return  [int8_t]    Function executing result.
+ * @retval  [0]         Success.
+ * @retval  [-1]        Fail.
+ *
+ */
+int8_t GPS_BenchReset(GPS_DATA *p_gps_data)
+{
+    if(p_gps_data == NULL)
+        return -1;
+
+    p_gps_data->general.gga_det_cnt = 0;
+    p_gps_data->general.gga_invalid_cnt = 0;
+    p_gps_data->general.rmc_det_cnt = 0;
+    p_gps_data->general.rmc_invalid_cnt = 0;
+    p_gps_data->general.uknown_det_cnt = 0;
+
+    memset((void *)&GPS_ErrorLog, 0, sizeof(GPS_ErrorLog));
+    memset((void *)&GPS_BenchStat, 0, sizeof(GPS_BenchStat));
+
+    GPS_RxNMEAState = GPS_RX_NMEA_WAIT_START;
+    GPS_RxNMEABufIdx = 0;
+
+    p_GPS_BenchData = NULL;
+    GPS_BenchBytes = 0;
+
+    return 0;
+}
+
+/**
+ * GPS_BenchFeed - Function to feed a piece of NMEA stream to the parser and
+ *                 measure how many timer 1 ticks are spent by GPS_UpdateNMEA.
+ *
+ * Interrupts are kept enabled during measurement, so the result includes
+ * ISR overhead just like the real flight loop does.
+ *
+ * @param   [in/out]    *p_gps_data     Data structure for storing latest GPS information.
+ * @param   [in]        *p_data         NMEA stream.
+ * @param   [in]        bytes           Size of NMEA stream.
+ *
+ * @return  [uint8_t]   Total number of decoded NMEA frames.
+ * @retval  [0~255]     Frames.
+ *
+ */
+uint8_t GPS_BenchFeed(GPS_DATA *p_gps_data, uint8_t *p_data, uint8_t bytes)
+{
+    uint16_t start_ticks;
+    uint16_t delta_ticks;
+    uint8_t uknown_det_cnt;
+    uint8_t frm_cnt;
+
+    frm_cnt = 0;
+
+    if(p_gps_data == NULL || p_data == NULL)
+        return 0;
+
+    uknown_det_cnt = p_gps_data->general.uknown_det_cnt;
+
+    p_GPS_BenchData = p_data;
+    GPS_BenchBytes = bytes;
+
+    GPS_BenchStat.rx_bytes += bytes;
+
+    while(GPS_BenchBytes != 0){
+
+        start_ticks = Timer1_GetTicks16();
+
+        switch(GPS_UpdateNMEA(p_gps_data)){
+
+            case GPS_RX_NMEA_TYPE_GGA:
+                GPS_BenchStat.gga_cnt++;
+                frm_cnt++;
+                break;
+
+            case GPS_RX_NMEA_TYPE_RMC:
+                GPS_BenchStat.rmc_cnt++;
+                frm_cnt++;
+                break;
+
+            default:
+                break;
+        }
+
+        delta_ticks = Timer1_GetTicks16() - start_ticks;
+
+        GPS_BenchStat.parse_ticks += delta_ticks;
+        if(delta_ticks > GPS_BenchStat.parse_max_ticks)
+            GPS_BenchStat.parse_max_ticks = delta_ticks;
+    }
+
+    /* Unknown frames can't be told from return type, count them from general info */
+    uknown_det_cnt = p_gps_data->general.uknown_det_cnt - uknown_det_cnt;
+    GPS_BenchStat.uknown_cnt += uknown_det_cnt;
+    frm_cnt += uknown_det_cnt;
+
+    return frm_cnt;
+}
+
+/**
+ * GPS_BenchGetStat - Function to get current benchmark statistic.
+ *
+ * @param   [out]       *p_stat     Benchmark statistic.
+ *
+ * @return  [none]
+ *
+ */
+void GPS_BenchGetStat(GPS_BENCH_STAT *p_stat)
+{
+    if(p_stat == NULL)
+        return;
+
+    memcpy((void *)&GPS_BenchStat.err_log, (void *)&GPS_ErrorLog, sizeof(GPS_ErrorLog));
+    memcpy((void *)p_stat, (void *)&GPS_BenchStat, sizeof(GPS_BenchStat));
+}
+
+#endif // GPS_BENCH_EN
+
 
 /*
  *******************************************************************************
@@ -754,7 +1014,8 @@ static uint8_t GPS_SendNMEA()
  *
  * @param   [out]       *p_report       Data structure to store NMEA report information.
  *
- * @param   [out]       *p_recv_time    Timestamp when detected NMEA start flag.
+ * @param   [out]       *p_recv_time    Timer 1 ticks when NMEA start flag's
+ *                                      start bit is received.
  *
  * @param   [out]       *p_nmea_type    Type of received NMEA frame.
  *
@@ -767,15 +1028,22 @@ static uint8_t GPS_RecvNMEA(uint8_t *p_frm_buf, uint8_t frm_buf_size,
                             GPS_NMEA_REPORT *p_report, uint32_t *p_recv_time,
                             GPS_RX_NMEA_TYPE *p_nmea_type)
 {
+    const uint8_t *p_span;
+    uint8_t span_size;
+    uint8_t span_idx;
     uint8_t current_rx_cnt;
     uint8_t total_frm_size;
     uint8_t data_byte;
     uint8_t checksum;
     int8_t decode_result;
+    uint32_t sof_ticks;
     static uint32_t prev_update_time = Timer1_GetMillis();
 
     current_rx_cnt = 0;
     total_frm_size = 0;
+    sof_ticks = 0;
+    span_size = 0;
+    span_idx = 0;
 
     if(p_frm_buf == NULL || frm_buf_size == 0)
         return 0;
@@ -785,9 +1053,23 @@ static uint8_t GPS_RecvNMEA(uint8_t *p_frm_buf, uint8_t frm_buf_size,
 
     /*
      * Process received byte, but break this loop once we received numbers of
-     * frame data in case the keep comping data cause endless loop.
+     * frame data in case the keep comping data cause endless loop. Only the
+     * processed bytes are consumed, the rest are kept for next call.
      */
-    while(UartS_ReadByte(&data_byte) && current_rx_cnt < frm_buf_size){
+    while(current_rx_cnt < frm_buf_size){
+
+        /* Fetch next contiguous received bytes */
+        if(span_idx == span_size){
+            GPS_READ_CONSUME(span_idx);
+
+            span_idx = 0;
+            span_size = GPS_READ_PEEK(&p_span);
+            if(span_size == 0)
+                break;
+        }
+
+        data_byte = p_span[span_idx];
+        span_idx++;
 
         /*
          * Drop all collected frame data if the frame length is larger
@@ -802,6 +1084,16 @@ static uint8_t GPS_RecvNMEA(uint8_t *p_frm_buf, uint8_t frm_buf_size,
             GPS_RxNMEAState = GPS_RX_NMEA_WAIT_START;
         }
 
+        /*
+         * Fetch start bit time-stamp for every '$' or '!' we read out,
+         * keep the time-stamp queue aligned with RX FIFO even if the
+         * delimiter is dropped by state machine.
+         */
+        if(data_byte == GPS_NMEA_START_KEY || data_byte == GPS_NMEA_ENCAP_KEY){
+            if(GPS_READ_START_TIME(&sof_ticks) != 0)
+                sof_ticks = Timer1_GetTicks32();
+        }
+
         switch(GPS_RxNMEAState){
 
             /* Detecting NMEA start flag. */
@@ -813,6 +1105,7 @@ static uint8_t GPS_RecvNMEA(uint8_t *p_frm_buf, uint8_t frm_buf_size,
                 if(data_byte == GPS_NMEA_START_KEY || data_byte == GPS_NMEA_ENCAP_KEY){
 
                     prev_update_time = Timer1_GetMillis();
+                    GPS_RxNMEASofTicks = sof_ticks;
 
                     memset((void *)GPS_RxChkSumBuf, 0, sizeof(GPS_RxChkSumBuf));
                     GPS_RxNMEAFieldCnt = 0;
@@ -940,7 +1233,7 @@ static uint8_t GPS_RecvNMEA(uint8_t *p_frm_buf, uint8_t frm_buf_size,
                     p_frm_buf[GPS_RxNMEABufIdx] = '\0';
                     GPS_RxNMEABufIdx++;
 
-                    *p_recv_time = Timer1_GetMillis();
+                    *p_recv_time = GPS_RxNMEASofTicks;
                     *p_nmea_type = GPS_RxNMEAType;
 
                     total_frm_size = GPS_RxNMEABufIdx;
@@ -963,6 +1256,8 @@ static uint8_t GPS_RecvNMEA(uint8_t *p_frm_buf, uint8_t frm_buf_size,
         current_rx_cnt++;
     }
 
+    GPS_READ_CONSUME(span_idx);
+
     return total_frm_size;
 }
 
@@ -1009,6 +1304,9 @@ static int8_t GPS_DecodeNMEA_Filed(uint8_t *p_field_start, uint8_t nmea_type,
             if(p_field_end == NULL)
                 return -1;
 
+            /* Float UTC lacks milliseconds precision, decode it again */
+            GPS_RxNMEAUtcMillis = GPS_UtcToMillis(p_field_start);
+
             break;
 
         case GPS_NMEA_GPGGA(GPS_RX_GGA_FIELD_LAT):          /* ddmm.mmmm */
@@ -1220,6 +1518,155 @@ static int8_t GPS_UpdateWptRelativeBearing(GPS_DATA *p_gps_data, float *p_bearin
     return 0;
 }
 
+/**
+ * GPS_UpdateFixLatency - Function to measure GPGGA frame latency.
+ *
+ * Without 1PPS signal, the fix epoch can't be observed in local clock directly,
+ * so we track the offset between start bit time-stamp and UTC of the fix.
+ * The minimum offset (fastest delivered epoch) is used as reference, and
+ * the excess over it plus the module output delay is the fix to first byte
+ * delay. The reference slowly moves up to follow crystal drift.
+ *
+ * @param   [in/out]    *p_gps_data     Data structure for storing latest GPS information.
+ * @param   [in]        sof_ticks       Timer 1 ticks of GPGGA frame start bit.
+ *
+ * @return  [none]
+ *
+ */
+static void GPS_UpdateFixLatency(GPS_DATA *p_gps_data, uint32_t sof_ticks)
+{
+    uint32_t delta_ticks;
+    uint32_t sof_millis;
+    int32_t offset;
+    int32_t diff;
+
+    /* Transport and decoding delay */
+    delta_ticks = Timer1_GetTicks32() - sof_ticks;
+    p_gps_data->general.gga_rx_delay_ms = (uint16_t)(TIMER1_TICKS_TO_MICROS(delta_ticks) / 1000);
+
+    GPS_GGASofTicks = sof_ticks;
+
+    /* Offset between local clock and UTC */
+    sof_millis = GPS_TicksToMillis(sof_ticks);
+    offset = (int32_t)(sof_millis - GPS_RxNMEAUtcMillis);
+    diff = offset - GPS_FixOffsetRef;
+
+    /* Restart reference at first fix, timer wrap or UTC day rollover */
+    if(GPS_FixOffsetIsSet == false
+       || diff > GPS_LATENCY_RESEED_MS || diff < -GPS_LATENCY_RESEED_MS){
+        GPS_FixOffsetRef = offset;
+        GPS_FixOffsetIsSet = true;
+        diff = 0;
+    }
+    else if(diff < 0){
+        GPS_FixOffsetRef = offset;
+        diff = 0;
+    }
+    else{
+        GPS_FixOffsetRef++;
+    }
+
+    p_gps_data->general.gga_fix_delay_ms = (uint16_t)diff + GPS_MODULE_FIX_OUTPUT_MS;
+}
+
+/**
+ * GPS_TicksToMillis - Function to convert Timer1 ticks time-stamp to
+ *                     Timer1_GetMillis() time.
+ *
+ * 32 bits ticks wrap every 35.8 minutes, so only the elapsed ticks (unsigned
+ * wrap) are converted and taken from current milliseconds.
+ *
+ * @param   [in]        ticks       Timer1 ticks time-stamp (Timer1_GetTicks32()).
+ *
+ * @return  [uint32_t]  Milliseconds time-stamp.
+ *
+ */
+static uint32_t GPS_TicksToMillis(uint32_t ticks)
+{
+    uint32_t delta_ticks;
+
+    delta_ticks = Timer1_GetTicks32() - ticks;
+
+    return Timer1_GetMillis() - TIMER1_TICKS_TO_MILLIS(delta_ticks);
+}
+
+/**
+ * GPS_UtcToMillis - Function to convert NMEA UTC string to milliseconds of day.
+ *
+ * hhmmss.sss -> milliseconds
+ *
+ * @param   [in]        *p_str      Input string.
+ *
+ * @return  [uint32_t]  Converted milliseconds.
+ * @retval  [0 ~ 86399999]
+ *
+ */
+static uint32_t GPS_UtcToMillis(uint8_t *p_str)
+{
+    uint8_t digits[6];
+    uint8_t idx;
+    uint16_t scale;
+    uint32_t millis;
+
+    for(idx = 0; idx < sizeof(digits); idx++){
+        if(p_str[idx] < '0' || p_str[idx] > '9')
+            return 0;
+
+        digits[idx] = p_str[idx] - '0';
+    }
+
+    millis = (uint32_t)(digits[0] * 10 + digits[1]) * 3600
+           + (uint32_t)(digits[2] * 10 + digits[3]) * 60
+           + (digits[4] * 10 + digits[5]);
+    millis *= 1000;
+
+    p_str += sizeof(digits);
+
+    if(*p_str == '.'){
+        p_str++;
+
+        for(scale = 100; scale != 0 && *p_str >= '0' && *p_str <= '9'; scale /= 10){
+            millis += (*p_str - '0') * scale;
+            p_str++;
+        }
+    }
+
+    return millis;
+}
+
+#if GPS_BENCH_EN
+/**
+ * GPS_BenchReadPeek - Function to get remaining bytes of fed NMEA stream.
+ *
+ * @param   [out]       **pp_data   Start of remaining NMEA data.
+ *
+ * @return  [uint8_t]   Number of remaining bytes
+ * @retval  [0]         No data.
+ * @retval  [1~255]     Byte size.
+ *
+ */
+static uint8_t GPS_BenchReadPeek(const uint8_t **pp_data)
+{
+    *pp_data = p_GPS_BenchData;
+
+    return GPS_BenchBytes;
+}
+
+/**
+ * GPS_BenchReadConsume - Function to drop processed bytes of fed NMEA stream.
+ *
+ * @param   [in]        bytes       Number of processed bytes.
+ *
+ * @return  [none]
+ *
+ */
+static void GPS_BenchReadConsume(uint8_t bytes)
+{
+    p_GPS_BenchData += bytes;
+    GPS_BenchBytes -= bytes;
+}
+#endif
+
 /**
  * GPS_DM_TO_DD - Function to degrees/minutes(DM) coordinate
  *                to decimal degrees(DD) format.
@@ -34,12 +34,14 @@
     #define GPS_MODULE_NAME                     UBLOX6M_DEV_NAME
     #define GPS_MODULE_INIT()                   ublox6m_Init()
     #define GPS_MODULE_CEP_METERS               UBLOX6M_CEP_METERS
+    #define GPS_MODULE_FIX_OUTPUT_MS            UBLOX6M_FIX_OUTPUT_MS
 
 /* Get GPS information from FlightGear FDM. */
 #elif defined(GPS_MODULE_FG)
     #define GPS_MODULE_NAME                     "UNKNOWN"
     #define GPS_MODULE_INIT()                   (0)
     #define GPS_MODULE_CEP_METERS               (2.5)
+    #define GPS_MODULE_FIX_OUTPUT_MS            (0)
 
 #else
     #error "Incorrect GPS module setting"
@@ -68,6 +70,17 @@
 
 #define GPS_FRM_TIMEOUT_MS                      2000
 
+/* Fix latency measurement and compensation */
+#define GPS_LATENCY_COMPENSATION_EN             true
+#define GPS_LATENCY_RESEED_MS                   1000    /* Restart latency reference if offset jumps over this value */
+#define GPS_LATENCY_MAX_EXTRAPOLATE_MS          1000    /* Don't extrapolate position over this fix age */
+
+/*
+ * NMEA parser benchmark, parser reads NMEA stream fed by external tool
+ * (OneRCGUI/MP_nmea_bench.py) instead of GPS module when it is enabled.
+ */
+#define GPS_BENCH_EN                            false
+
 
 /*
  *******************************************************************************
@@ -152,14 +165,17 @@ typedef struct gps_data{
 
         uint8_t gga_det_cnt;            /* NMEA GPGGA frame detected count */
         uint8_t gga_invalid_cnt;        /* NMEA GPGGA frame invalid count */
-        uint32_t gga_timestamp;         /* NMEA GPGGA frame RX timestamp */
+        uint32_t gga_timestamp;         /* NMEA GPGGA frame RX timestamp (first byte) */
 
         uint8_t rmc_det_cnt;            /* NMEA GPRMC frame detected count */
         uint8_t rmc_invalid_cnt;        /* NMEA GPRMC frame invalid count */
-        uint32_t rmc_timestamp;         /* NMEA GPRMC frame RX timestamp */
+        uint32_t rmc_timestamp;         /* NMEA GPRMC frame RX timestamp (first byte) */
 
         uint8_t uknown_det_cnt;         /* NMEA unknown frame detected count */
-        uint32_t uknown_timestamp;      /* NMEA unknown frame RX timestamp */
+        uint32_t uknown_timestamp;      /* NMEA unknown frame RX timestamp (first byte) */
+
+        uint16_t gga_rx_delay_ms;       /* NMEA GPGGA frame first byte to decoded delay */
+        uint16_t gga_fix_delay_ms;      /* Estimated GPGGA fix epoch to first byte delay */
 
     }general;
 
@@ -179,6 +195,19 @@ typedef struct gps_error_log{
     uint8_t rx_timeout_cnt;
 }GPS_ERROR_LOG;
 
+#if GPS_BENCH_EN
+/* NMEA parser benchmark statistic */
+typedef struct gps_bench_stat{
+    uint32_t rx_bytes;                  /* Total fed bytes */
+    uint32_t parse_ticks;               /* Total timer 1 ticks spent in parser */
+    uint16_t parse_max_ticks;           /* Maximum timer 1 ticks of single parser call */
+    uint16_t gga_cnt;                   /* Total decoded GPGGA frames */
+    uint16_t rmc_cnt;                   /* Total decoded GPRMC frames */
+    uint16_t uknown_cnt;                /* Total decoded unknown frames */
+    GPS_ERROR_LOG err_log;              /* Snapshot of GPS error log */
+}GPS_BENCH_STAT;
+#endif
+
 
 /*
  *******************************************************************************
@@ -218,10 +247,18 @@ int8_t GPS_ClrWpt(GPS_DATA *p_gps_data);
 int8_t GPS_GetWptDistance(GPS_DATA *p_gps_data, float *p_distance);
 int8_t GPS_GetWptTrueBearing(GPS_DATA *p_gps_data, float *p_bearing);
 float GPS_GetWptRelativeBearing(GPS_DATA *p_gps_data);
+uint16_t GPS_GetFixAge(GPS_DATA *p_gps_data);
+int8_t GPS_GetExtrapolatedCoord(GPS_DATA *p_gps_data, GPS_COORD_POINT *p_coord);
 
 float GPS_CalInitTrueBearingAngle(GPS_COORD_POINT *p_src, GPS_COORD_POINT *p_dest);
 float GPS_CalApproxDistance(GPS_COORD_POINT *p_src, GPS_COORD_POINT *p_dest);
 
+#if GPS_BENCH_EN
+int8_t GPS_BenchReset(GPS_DATA *p_gps_data);
+uint8_t GPS_BenchFeed(GPS_DATA *p_gps_data, uint8_t *p_data, uint8_t bytes);
+void GPS_BenchGetStat(GPS_BENCH_STAT *p_stat);
+#endif
+
 
 /*
  *******************************************************************************
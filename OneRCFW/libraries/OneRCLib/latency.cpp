@@ -0,0 +1,441 @@
+/**
+ *******************************************************************************
+ *      ______  _   __  ______  ____     ______        ___    ______   ____
+ *     / __  / / \ / / / ____/ / __ \   /  ___/       /  /   /_   _/  / __ \
+ *    / /_/ / /   \ / / ____/ /  -- /  /  /__   __   /  /__  _/  /_  / __ <
+ *   /_____/ /_/ \_/ /_____/ /__/ \_\ /_____/  /_/  /_____/ /_____/ /_____/
+ *
+ *     An amateur remote control software library. Use at your own risk.
+ *
+ * @file    latency.cpp
+ * @brief   Stick-to-servo latency profiler.
+ *
+ *          A sample follows one RC input pulse of the probe channel to the
+ *          servo pulse of the probe channel, each stage is time-stamped by
+ *          Timer1 ticks:
+ *
+ *              RC input edge   RCIN_ReadChannels()     RCOUT_SetServoPWM()
+ *                  |----------------|-----------------------|
+ *                  Latency_RcInEdge Latency_RcInRead        Latency_CtrlDone
+ *
+ *              RCOUT cycle start       Servo output falling edge
+ *                  |-----------------------|
+ *                  Latency_RcOutLoad       Latency_RcOutEdge
+ *
+ *          Only one sample is in flight. A sample is started by the first
+ *          control cycle which reads a new RC input pulse, and is replaced
+ *          (dropped) if a newer pulse is read before the sample is loaded
+ *          by RCOUT. The RC input LPF delay is not a time-stamp, it lags
+ *          (2^RCIN_LPF_BETA - 1) input frames and is reported with the
+ *          measured input frame period.
+ *
+ *          Time-stamps are 16 bits, every stage must be shorter than 32 ms.
+ * @author  Y.S.Kuo in Hsinchu
+ *******************************************************************************
+ */
+
+#include <Arduino.h>
+#include <stdint.h>
+#include <string.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include "latency.h"
+#include "timers_drv.h"
+
+#if LATENCY_EN
+
+
+/*
+ *******************************************************************************
+ * Constant value definition
+ *******************************************************************************
+ */
+
+/* Time-stamps of a sample, stage N is from stamp N to stamp N + 1 */
+#define LATENCY_STAMP_IN_EDGE       0
+#define LATENCY_STAMP_READ          1
+#define LATENCY_STAMP_CTRL          2
+#define LATENCY_STAMP_LOAD          3
+#define LATENCY_STAMP_OUT_EDGE      4
+#define LATENCY_STAMP_TOTAL         5
+
+
+/*
+ *******************************************************************************
+ * Data type definition
+ *******************************************************************************
+ */
+
+/* State of the sample in flight */
+typedef enum latency_state{
+    LATENCY_STATE_IDLE                          = 0,
+    LATENCY_STATE_READ,                                 /* Read by control cycle */
+    LATENCY_STATE_CTRL,                                 /* Servo PWM is set, waiting RCOUT cycle */
+    LATENCY_STATE_LOAD,                                 /* Loaded by RCOUT, waiting servo edge */
+    LATENCY_STATE_DONE,                                 /* Waiting Latency_RcInRead() */
+}__attribute__((packed)) LATENCY_STATE;
+
+typedef struct latency_stage_acc{
+    uint16_t min_us;
+    uint16_t max_us;
+    uint32_t sum_us;
+    uint8_t hist[LATENCY_HIST_BINS];
+}LATENCY_STAGE_ACC;
+
+
+/*
+ *******************************************************************************
+ * Global variables
+ *******************************************************************************
+ */
+
+/* Sample in flight, time-stamps are owned by ISR in LOAD state */
+static volatile LATENCY_STATE Latency_State;
+static uint16_t Latency_Stamps[LATENCY_STAMP_TOTAL];
+
+/* Latest RC input edge of probe channel, may be written by ISR */
+static volatile uint16_t Latency_InEdge;
+static volatile bool Latency_IsInNew;
+static uint32_t Latency_InPeriodSum;
+static uint16_t Latency_InPeriodCnt;
+
+/* Statistics since last report */
+static LATENCY_STAGE_ACC Latency_Acc[LATENCY_STAGE_TOTAL];
+static uint16_t Latency_SampleCnt;
+static uint16_t Latency_DropCnt;
+
+
+/*
+ *******************************************************************************
+ * Public functions declaration
+ *******************************************************************************
+ */
+
+
+/*
+ *******************************************************************************
+ * Private functions declaration
+ *******************************************************************************
+ */
+
+static void Latency_Reset();
+static void Latency_Accumulate(uint16_t *p_stamps);
+static void Latency_AddStage(LATENCY_STAGE_ACC *p_acc, uint16_t delay_us);
+
+
+/*
+ *******************************************************************************
+ * Public functions
+ *******************************************************************************
+ */
+
+/**
+ * Latency_Init - Function to initialize latency profiler.
+ *
+ * @param   [none]
+ *
+ * @return  [none]
+ *
+ */
+void Latency_Init()
+{
+    uint8_t old_SREG;
+
+    old_SREG = SREG;
+    cli();
+
+    Latency_State = LATENCY_STATE_IDLE;
+    Latency_IsInNew = false;
+
+    Latency_Reset();
+
+    SREG = old_SREG;
+}
+
+/**
+ * Latency_RcInEdge - Function to stamp the end of a probe channel pulse,
+ *                    can be called in ISR.
+ *
+ * @param   [in]        edge_ticks  Timer1 ticks of the edge which completes
+ *                                  the pulse (or frame of serial receiver).
+ *
+ * @return  [none]
+ *
+ */
+void Latency_RcInEdge(uint16_t edge_ticks)
+{
+    uint16_t period;
+
+    period = edge_ticks - Latency_InEdge;
+
+    /* Period of continuous input, 16 bits time-stamps */
+    if(period < TIMER1_MICROS_TO_TICKS(30000)){
+        Latency_InPeriodSum += period;
+        Latency_InPeriodCnt++;
+    }
+
+    Latency_InEdge = edge_ticks;
+    Latency_IsInNew = true;
+}
+
+/**
+ * Latency_RcInRead - Function to stamp RC input read by control cycle, it
+ *                    should be called after RCIN_ReadChannels(). Finished
+ *                    sample is also accumulated here.
+ *
+ * @param   [none]
+ *
+ * @return  [none]
+ *
+ */
+void Latency_RcInRead()
+{
+    uint8_t old_SREG;
+    uint16_t now_ticks;
+    uint16_t done_stamps[LATENCY_STAMP_TOTAL];
+    bool is_done;
+
+    now_ticks = Timer1_GetTicks16();
+    is_done = false;
+
+    old_SREG = SREG;
+    cli();
+
+    if(Latency_State == LATENCY_STATE_DONE){
+        memcpy((void *)done_stamps, (void *)Latency_Stamps, sizeof(done_stamps));
+        Latency_State = LATENCY_STATE_IDLE;
+        is_done = true;
+    }
+
+    if(Latency_IsInNew){
+        Latency_IsInNew = false;
+
+        /* Newer input replaces the sample which is not loaded yet */
+        if(Latency_State == LATENCY_STATE_READ || Latency_State == LATENCY_STATE_CTRL){
+            Latency_DropCnt++;
+            Latency_State = LATENCY_STATE_IDLE;
+        }
+
+        if(Latency_State == LATENCY_STATE_IDLE){
+            Latency_Stamps[LATENCY_STAMP_IN_EDGE] = Latency_InEdge;
+            Latency_Stamps[LATENCY_STAMP_READ] = now_ticks;
+            Latency_State = LATENCY_STATE_READ;
+        }
+        else{
+            Latency_DropCnt++;
+        }
+    }
+
+    SREG = old_SREG;
+
+    if(is_done)
+        Latency_Accumulate(done_stamps);
+}
+
+/**
+ * Latency_CtrlDone - Function to stamp new servo pulse setting, it is
+ *                    called by RCOUT_SetServoPWM().
+ *
+ * @param   [none]
+ *
+ * @return  [none]
+ *
+ */
+void Latency_CtrlDone()
+{
+    uint8_t old_SREG;
+
+    old_SREG = SREG;
+    cli();
+
+    if(Latency_State == LATENCY_STATE_READ){
+        Latency_Stamps[LATENCY_STAMP_CTRL] = Timer1_GetTicks16();
+        Latency_State = LATENCY_STATE_CTRL;
+    }
+
+    SREG = old_SREG;
+}
+
+/**
+ * Latency_RcOutLoad - Function to stamp servo pulse setting loaded by RCOUT
+ *                     cycle, it should be called in RCOUT ISR (or by
+ *                     RCOUT_SetServoPWM() with interrupts disabled).
+ *
+ * @param   [none]
+ *
+ * @return  [none]
+ *
+ */
+void Latency_RcOutLoad()
+{
+    if(Latency_State == LATENCY_STATE_CTRL){
+        Latency_Stamps[LATENCY_STAMP_LOAD] = Timer1_GetTicks16();
+        Latency_State = LATENCY_STATE_LOAD;
+    }
+}
+
+/**
+ * Latency_RcOutEdge - Function to stamp servo output falling edge, it should
+ *                     be called in RCOUT ISR.
+ *
+ * @param   [in]        ch_idx      RC output channel of the edge.
+ * @param   [in]        edge_ticks  Timer1 ticks of the edge.
+ *
+ * @return  [none]
+ *
+ */
+void Latency_RcOutEdge(uint8_t ch_idx, uint16_t edge_ticks)
+{
+    if(ch_idx == LATENCY_RCOUT_CH && Latency_State == LATENCY_STATE_LOAD){
+        Latency_Stamps[LATENCY_STAMP_OUT_EDGE] = edge_ticks;
+        Latency_State = LATENCY_STATE_DONE;
+    }
+}
+
+/**
+ * Latency_GetReport - Function to get statistics since last report, the
+ *                     statistics are cleared.
+ *
+ * @param   [out]       *p_report   Statistics.
+ *
+ * @return  [none]
+ *
+ */
+void Latency_GetReport(LATENCY_REPORT *p_report)
+{
+    uint8_t old_SREG;
+    uint8_t stage_idx;
+    uint32_t period_sum;
+    uint16_t period_cnt;
+
+    old_SREG = SREG;
+    cli();
+
+    period_sum = Latency_InPeriodSum;
+    period_cnt = Latency_InPeriodCnt;
+
+    Latency_InPeriodSum = 0;
+    Latency_InPeriodCnt = 0;
+
+    SREG = old_SREG;
+
+    memset((void *)p_report, 0, sizeof(LATENCY_REPORT));
+
+    p_report->sample_cnt = Latency_SampleCnt;
+    p_report->drop_cnt = Latency_DropCnt;
+    p_report->rcin_lpf_beta = RCIN_LPF_BETA;
+
+    if(period_cnt != 0)
+        p_report->rcin_period_us = period_sum / period_cnt / TIMER1_MICROS_TO_TICKS(1);
+
+    for(stage_idx = 0; stage_idx < LATENCY_STAGE_TOTAL; stage_idx++){
+
+        if(Latency_SampleCnt != 0){
+            p_report->stage[stage_idx].min_us = Latency_Acc[stage_idx].min_us;
+            p_report->stage[stage_idx].max_us = Latency_Acc[stage_idx].max_us;
+            p_report->stage[stage_idx].avg_us = Latency_Acc[stage_idx].sum_us / Latency_SampleCnt;
+        }
+
+        memcpy((void *)p_report->stage[stage_idx].hist, (void *)Latency_Acc[stage_idx].hist,
+               sizeof(p_report->stage[stage_idx].hist));
+    }
+
+    Latency_Reset();
+}
+
+
+/*
+ *******************************************************************************
+ * Private functions
+ *******************************************************************************
+ */
+
+/**
+ * Latency_Reset - Function to clear statistics.
+ *
+ * @param   [none]
+ *
+ * @return  [none]
+ *
+ */
+static void Latency_Reset()
+{
+    uint8_t stage_idx;
+
+    memset((void *)Latency_Acc, 0, sizeof(Latency_Acc));
+
+    for(stage_idx = 0; stage_idx < LATENCY_STAGE_TOTAL; stage_idx++)
+        Latency_Acc[stage_idx].min_us = UINT16_MAX;
+
+    Latency_SampleCnt = 0;
+    Latency_DropCnt = 0;
+}
+
+/**
+ * Latency_Accumulate - Function to add a finished sample to statistics.
+ *
+ * @param   [in]        *p_stamps   Time-stamps of the sample.
+ *
+ * @return  [none]
+ *
+ */
+static void Latency_Accumulate(uint16_t *p_stamps)
+{
+    uint8_t stage_idx;
+    uint16_t delay_us;
+    uint32_t total_us;
+
+    total_us = 0;
+
+    for(stage_idx = 0; stage_idx < LATENCY_STAGE_END_TO_END; stage_idx++){
+        delay_us = (uint16_t)(p_stamps[stage_idx + 1] - p_stamps[stage_idx]) / TIMER1_MICROS_TO_TICKS(1);
+        total_us += delay_us;
+
+        Latency_AddStage(&Latency_Acc[stage_idx], delay_us);
+    }
+
+    if(total_us > UINT16_MAX)
+        total_us = UINT16_MAX;
+
+    Latency_AddStage(&Latency_Acc[LATENCY_STAGE_END_TO_END], total_us);
+
+    Latency_SampleCnt++;
+}
+
+/**
+ * Latency_AddStage - Function to add stage delay to statistics.
+ *
+ * @param   [in/out]    *p_acc      Statistics of the stage.
+ * @param   [in]        delay_us    Stage delay.
+ *
+ * @return  [none]
+ *
+ */
+static void Latency_AddStage(LATENCY_STAGE_ACC *p_acc, uint16_t delay_us)
+{
+    uint8_t bin_idx;
+    uint16_t bin_range;
+
+    if(delay_us < p_acc->min_us)
+        p_acc->min_us = delay_us;
+
+    if(delay_us > p_acc->max_us)
+        p_acc->max_us = delay_us;
+
+    p_acc->sum_us += delay_us;
+
+    /* Bin 0 < 0.5 ms, bin 1 < 1 ms, bin 2 < 2 ms ... */
+    bin_idx = 0;
+    bin_range = LATENCY_HIST_BIN0_US;
+
+    while(bin_idx < LATENCY_HIST_BINS - 1 && delay_us >= bin_range){
+        bin_idx++;
+        bin_range <<= 1;
+    }
+
+    if(p_acc->hist[bin_idx] != UINT8_MAX)
+        p_acc->hist[bin_idx]++;
+}
+
+#endif // LATENCY_EN
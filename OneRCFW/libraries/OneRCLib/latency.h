@@ -0,0 +1,120 @@
+/**
+ *******************************************************************************
+ *      ______  _   __  ______  ____     ______        ___    ______   ____
+ *     / __  / / \ / / / ____/ / __ \   /  ___/       /  /   /_   _/  / __ \
+ *    / /_/ / /   \ / / ____/ /  -- /  /  /__   __   /  /__  _/  /_  / __ <
+ *   /_____/ /_/ \_/ /_____/ /__/ \_\ /_____/  /_/  /_____/ /_____/ /_____/
+ *
+ *     An amateur remote control software library. Use at your own risk.
+ *
+ * @file    latency.h
+ * @brief   Stick-to-servo latency profiler.
+ * @author  Y.S.Kuo in Hsinchu
+ *******************************************************************************
+ */
+
+#ifndef LATENCY_H_
+#define LATENCY_H_
+
+#include <stdint.h>
+
+#include "rc_in.h"
+#include "rc_out.h"
+
+
+/*
+ *******************************************************************************
+ * Constant value definition
+ *******************************************************************************
+ */
+
+#define LATENCY_EN                  false
+
+/* Probe channels, aileron stick to aileron servo */
+#define LATENCY_RCIN_CH             RCIN_AILE_IDX
+#define LATENCY_RCOUT_CH            RCOUT_AILE_IDX
+
+/* Histogram bins, bin 0 is below 0.5 ms, each next bin doubles the range */
+#define LATENCY_HIST_BINS           8
+#define LATENCY_HIST_BIN0_US        500
+
+
+/*
+ *******************************************************************************
+ * Data type definition
+ *******************************************************************************
+ */
+
+/* Stages of a sample, each stage ends at next time-stamp */
+typedef enum latency_stage{
+    LATENCY_STAGE_IN_READ                       = 0,    /* RC input edge -> read by control cycle */
+    LATENCY_STAGE_READ_CTRL,                            /* Read -> RCOUT_SetServoPWM() */
+    LATENCY_STAGE_CTRL_LOAD,                            /* RCOUT_SetServoPWM() -> loaded by RCOUT cycle */
+    LATENCY_STAGE_LOAD_OUT,                             /* Loaded -> servo output falling edge */
+    LATENCY_STAGE_END_TO_END,                           /* RC input edge -> servo output falling edge */
+    LATENCY_STAGE_TOTAL,
+}__attribute__((packed)) LATENCY_STAGE;
+
+typedef struct latency_stage_stat{
+    uint16_t min_us;
+    uint16_t max_us;
+    uint16_t avg_us;
+    uint8_t hist[LATENCY_HIST_BINS];            /* Samples of each bin, saturated at 255 */
+}LATENCY_STAGE_STAT;
+
+/* Statistics since last report */
+typedef struct latency_report{
+    uint16_t sample_cnt;                        /* Samples reached servo output */
+    uint16_t drop_cnt;                          /* Samples replaced by newer RC input */
+    uint16_t rcin_period_us;                    /* Average RC input frame period */
+    uint8_t rcin_lpf_beta;                      /* RC input LPF lags (2^beta - 1) frames */
+    LATENCY_STAGE_STAT stage[LATENCY_STAGE_TOTAL];
+}LATENCY_REPORT;
+
+
+/*
+ *******************************************************************************
+ * Global variables
+ *******************************************************************************
+ */
+
+
+/*
+ *******************************************************************************
+ * Public functions declaration
+ *******************************************************************************
+ */
+
+
+/*
+ *******************************************************************************
+ * Private functions declaration
+ *******************************************************************************
+ */
+
+
+/*
+ *******************************************************************************
+ * Public functions
+ *******************************************************************************
+ */
+
+#if LATENCY_EN
+void Latency_Init();
+void Latency_RcInEdge(uint16_t edge_ticks);
+void Latency_RcInRead();
+void Latency_CtrlDone();
+void Latency_RcOutLoad();
+void Latency_RcOutEdge(uint8_t ch_idx, uint16_t edge_ticks);
+void Latency_GetReport(LATENCY_REPORT *p_report);
+#endif
+
+
+/*
+ *******************************************************************************
+ * Private functions
+ *******************************************************************************
+ */
+
+
+#endif // LATENCY_H_
@@ -14,6 +14,7 @@
  */
 
 #include <string.h>
+#include <stdarg.h>
 
 #include "mcu_protocol.h"
 #include "uart_drv.h"
@@ -57,16 +58,29 @@ typedef enum mp_rx_frm_state{
  */
 
 static uint8_t MP_TxSequence;
+static uint16_t MP_TxDropCnt;                   /* Frames dropped because TX FIFO is full */
+static uint16_t MP_TxCrc16;                     /* CRC of current TX frame */
 
 /* The following variables are created for storing information of receiving frame */
 static MP_RX_FRM_STATE MP_RxFrmState;           /* Current RX frame function state */
-static uint8_t MP_RxSequence;                   /* Current RX frame sequence */
+static uint8_t MP_RxSequence;                   /* Sequence of last valid RX frame */
 static uint8_t MP_RxFrmBufIdx;                  /* Current write index of RX buffer */
 static uint8_t MP_RxFrmBuf[MP_RX_FRM_BUF_SIZE]; /* RX frame buffer */
 static uint8_t MP_RxFrmPayloadLen;              /* Expected payload length of RX frame */
 static uint8_t MP_RxFrmCrcIdx;                  /* Total collected CRC byte */
 static uint16_t MP_RxFrmCrc16;                  /* Expected RX frame checksum */
-static bool MP_RXFrmIsLost;                     /* Frame lost indicator */
+static bool MP_RxSeqIsValid;                    /* MP_RxSequence is received from peer */
+static MP_RX_STATS MP_RxStats;                  /* RX frame statistics */
+
+#if MP_FRM_COBS_EN
+static uint8_t MP_TxCobsMark;                   /* Position of current TX code byte */
+static uint8_t MP_TxCobsCode;                   /* Current TX code byte */
+
+static bool MP_RxFrmIsCobs;                     /* Current RX frame is COBS frame */
+static bool MP_RxPeerIsCobs;                    /* Valid COBS frame is received, ignore 0x7E frame */
+static uint8_t MP_RxCobsCode;                   /* Current RX code byte, 0 for first block */
+static uint8_t MP_RxCobsRemain;                 /* Data bytes left in current RX block */
+#endif
 
 
 /*
@@ -82,6 +96,12 @@ static bool MP_RXFrmIsLost;                     /* Frame lost indicator */
  *******************************************************************************
  */
 
+static bool MP_TxBegin(uint8_t cmd, uint8_t data_size);
+static void MP_TxData(uint8_t *p_data, uint8_t data_size);
+static void MP_TxEnd();
+static void MP_TxPut(uint8_t data_byte);
+static uint8_t MP_RecvByte(uint8_t data_byte, uint8_t *p_frm_buf, uint8_t frm_buf_size);
+
 
 /*
  *******************************************************************************
@@ -102,6 +122,7 @@ static bool MP_RXFrmIsLost;                     /* Frame lost indicator */
 int8_t MP_Init()
 {
     MP_TxSequence = 0;
+    MP_TxDropCnt = 0;
 
     MP_RxSequence = 0;
     MP_RxFrmBufIdx = 0;
@@ -109,9 +130,17 @@ int8_t MP_Init()
     MP_RxFrmCrcIdx = 0;
     MP_RxFrmCrc16 = CRC_INIT_VAL;
     MP_RxFrmState = MP_RX_FRM_WAIT_SFLAG;
-    MP_RXFrmIsLost = false;
+    MP_RxSeqIsValid = false;
+    memset((void *)&MP_RxStats, 0, sizeof(MP_RxStats));
     memset((void *)MP_RxFrmBuf, 0, sizeof(MP_RxFrmBuf));
 
+#if MP_FRM_COBS_EN
+    MP_RxFrmIsCobs = false;
+    MP_RxPeerIsCobs = false;
+    MP_RxCobsCode = 0;
+    MP_RxCobsRemain = 0;
+#endif
+
     Uart0_Println(PSTR("[MP] OK"));
 
     return 0;
@@ -120,47 +149,257 @@ int8_t MP_Init()
 /**
  * MP_Send - Function to send MP frame.
  *
+ * This function never waits for UART, the whole frame is reserved in UART TX
+ * FIFO first, then the frame is copied to TX FIFO byte by byte and the CRC is
+ * calculated during copying. The frame is dropped if TX FIFO doesn't have
+ * enough space, the sequence number is still increased so the receiver can
+ * detect the lost frame.
+ *
+ * In COBS mode, each code byte is patched in TX FIFO when the next zero byte
+ * (or the end of frame) is reached, so the frame is still encoded in one pass.
+ *
  * @param   [in]        cmd         MP command ID (Refer to enum mp_rsp_cmd).
  * @param   [in]        *p_data     Frame data buffer.
  * @param   [in]        data_size   Size of frame data.
  *
  * @return  [uint8_t]   Transmitted data size.
- * @retval  [0]         Fail.
+ * @retval  [0]         Fail, or TX FIFO is full (would block).
  * @retval  [1~255]     Transmitted bytes.
  *
  */
 uint8_t MP_Send(uint8_t cmd, uint8_t *p_data, uint8_t data_size)
 {
-    uint16_t tx_bytes;
-    uint16_t crc;
-    MP_FRAME_HDR hdr;
-    MP_FRAME_TAIL tail;
-
     if(p_data == NULL || data_size == 0)
         return 0;
 
-    if(sizeof(hdr) + data_size + sizeof(tail) > 255)
+    if(MP_TxBegin(cmd, data_size) == false)
+        return 0;
+
+    MP_TxData(p_data, data_size);
+    MP_TxEnd();
+
+    return MP_FRM_SIZE(data_size);
+}
+
+/**
+ * MP_SendRecords - Function to send several records in one container frame.
+ *
+ * Each record is sent as tag (MP response command of the record), length and
+ * record data, so small records share one frame header and CRC. Records are
+ * copied to TX FIFO directly, same as MP_Send(), no extra frame buffer is
+ * needed.
+ *
+ * @param   [in]        *p_records  Record list.
+ * @param   [in]        record_num  Total records in the list.
+ *
+ * @return  [uint8_t]   Transmitted data size.
+ * @retval  [0]         Fail, or TX FIFO is full (would block).
+ * @retval  [1~255]     Transmitted bytes.
+ *
+ */
+uint8_t MP_SendRecords(MP_RECORD *p_records, uint8_t record_num)
+{
+    MP_RECORD_HDR record_hdr;
+    uint16_t data_size;
+    uint8_t idx;
+
+    data_size = MP_GetRecordsSize(p_records, record_num);
+
+    if(data_size == 0 || data_size > MP_FRM_DATA_MAX)
+        return 0;
+
+    if(MP_TxBegin(MP_RSP_SYS_CONTAINER, data_size) == false)
         return 0;
 
-    /* Header */
-    hdr.s_flag = MP_FRM_SFLAG;
-    hdr.cmd = cmd;
-    hdr.sequence = MP_TxSequence++;
-    hdr.len = data_size;
+    for(idx = 0; idx < record_num; idx++){
+        record_hdr.tag = p_records[idx].cmd;
+        record_hdr.len = p_records[idx].size;
+
+        MP_TxData((uint8_t *)&record_hdr, sizeof(record_hdr));
+        MP_TxData((uint8_t *)p_records[idx].p_data, p_records[idx].size);
+    }
+
+    MP_TxEnd();
+
+    return MP_FRM_SIZE(data_size);
+}
+
+/**
+ * MP_GetRecordsSize - Function to get container payload size of record list.
+ *
+ * @param   [in]        *p_records  Record list.
+ * @param   [in]        record_num  Total records in the list.
+ *
+ * @return  [uint16_t]  Container payload size, the frame size is
+ *                      MP_FRM_SIZE(payload size).
+ * @retval  [0]         Invalid record list.
+ *
+ */
+uint16_t MP_GetRecordsSize(MP_RECORD *p_records, uint8_t record_num)
+{
+    uint16_t data_size;
+    uint8_t idx;
+
+    if(p_records == NULL || record_num == 0)
+        return 0;
+
+    data_size = 0;
+
+    for(idx = 0; idx < record_num; idx++){
+        if(p_records[idx].p_data == NULL || p_records[idx].size == 0)
+            return 0;
+
+        data_size += MP_RECORD_SIZE(p_records[idx].size);
+    }
+
+    return data_size;
+}
+
+/**
+ * MP_GetTxDropCnt - Function to get total frames dropped by MP_Send() because
+ *                   UART TX FIFO is full.
+ *
+ * @param   [none]
+ *
+ * @return  [uint16_t]  Total dropped frames.
+ *
+ */
+uint16_t MP_GetTxDropCnt()
+{
+    return MP_TxDropCnt;
+}
+
+/**
+ * MP_GetRxStats - Function to get RX frame statistics.
+ *
+ * @param   [out]       *p_stats    RX frame statistics.
+ *
+ * @return  [none]
+ *
+ */
+void MP_GetRxStats(MP_RX_STATS *p_stats)
+{
+    *p_stats = MP_RxStats;
+}
+
+/**
+ * MP_PutVarint - Function to encode unsigned value as varint, 7 bits per byte
+ *                from LSB, MSB of each byte is set if more bytes follow.
+ *
+ * @param   [out]       *p_buf      Output buffer, at least MP_VARINT_MAX_SIZE
+ *                                  bytes.
+ * @param   [in]        value       Unsigned value.
+ *
+ * @return  [uint8_t]   Encoded bytes (1 ~ MP_VARINT_MAX_SIZE).
+ *
+ */
+uint8_t MP_PutVarint(uint8_t *p_buf, uint32_t value)
+{
+    uint8_t bytes;
 
-    /* Tail */
-    crc = CRC_INIT_VAL;
-    crc = CRC_AccumulateLoop(&hdr.cmd, sizeof(hdr) - sizeof(hdr.s_flag), crc);
-    crc = CRC_AccumulateLoop(p_data, data_size, crc);
-    tail.CRC16 = crc;
+    bytes = 0;
 
-    tx_bytes = 0;
+    while(value >= 0x80){
+        p_buf[bytes++] = (uint8_t)value | 0x80;
+        value >>= 7;
+    }
 
-    tx_bytes += Uart0_WriteBytes((uint8_t *)&hdr, sizeof(hdr));
-    tx_bytes += Uart0_WriteBytes(p_data, data_size);
-    tx_bytes += Uart0_WriteBytes((uint8_t *)&tail, sizeof(tail));
+    p_buf[bytes++] = (uint8_t)value;
 
-    return tx_bytes;
+    return bytes;
+}
+
+/**
+ * MP_SendLog - Function to send binary log frame, use MP_LOG() instead of
+ *              calling this function directly.
+ *
+ * Arguments are copied as raw bytes (little endian) by signature, the log is
+ * dropped if TX FIFO is full, same as other frames.
+ *
+ * @param   [in]        log_id      ID of format string, MP_LogId().
+ * @param   [in]        arg_sig     Argument types, MP_LogArgSig().
+ * @param   [in]        ...         Arguments of format string.
+ *
+ * @return  [none]
+ *
+ */
+void MP_SendLog(uint16_t log_id, uint16_t arg_sig, ...)
+{
+    uint8_t log_buf[MP_LOG_DATA_MAX];
+    uint8_t log_size;
+    uint16_t value16;
+    uint32_t value32;
+    float value_float;
+    const char *p_str;
+    va_list args;
+
+    memcpy(log_buf, &log_id, sizeof(log_id));
+    log_size = sizeof(log_id);
+
+    va_start(args, arg_sig);
+
+    while(arg_sig != 0 && log_size < sizeof(log_buf)){
+
+        switch(arg_sig & ((1 << MP_LOG_ARG_BITS) - 1)){
+
+            case MP_LOG_ARG_8BITS:
+                log_buf[log_size++] = (uint8_t)va_arg(args, int);
+                break;
+
+            case MP_LOG_ARG_16BITS:
+                if(log_size + sizeof(value16) > sizeof(log_buf)){
+                    arg_sig = 0;
+                    break;
+                }
+
+                value16 = (uint16_t)va_arg(args, int);
+                memcpy(&log_buf[log_size], &value16, sizeof(value16));
+                log_size += sizeof(value16);
+                break;
+
+            case MP_LOG_ARG_32BITS:
+                if(log_size + sizeof(value32) > sizeof(log_buf)){
+                    arg_sig = 0;
+                    break;
+                }
+
+                value32 = va_arg(args, uint32_t);
+                memcpy(&log_buf[log_size], &value32, sizeof(value32));
+                log_size += sizeof(value32);
+                break;
+
+            case MP_LOG_ARG_FLOAT:
+                if(log_size + sizeof(value_float) > sizeof(log_buf)){
+                    arg_sig = 0;
+                    break;
+                }
+
+                value_float = (float)va_arg(args, double);
+                memcpy(&log_buf[log_size], &value_float, sizeof(value_float));
+                log_size += sizeof(value_float);
+                break;
+
+            /* Null terminated, truncated if buffer is full */
+            case MP_LOG_ARG_STR:
+                p_str = va_arg(args, const char *);
+
+                while(*p_str != 0 && log_size < sizeof(log_buf) - 1)
+                    log_buf[log_size++] = *p_str++;
+
+                log_buf[log_size++] = 0;
+                break;
+
+            default:
+                arg_sig = 0;
+                break;
+        }
+
+        arg_sig >>= MP_LOG_ARG_BITS;
+    }
+
+    va_end(args);
+
+    MP_Send(MP_RSP_SYS_LOG, log_buf, log_size);
 }
 
 /**
@@ -178,132 +417,363 @@ uint8_t MP_Send(uint8_t cmd, uint8_t *p_data, uint8_t data_size)
  */
 uint8_t MP_Recv(uint8_t *p_frm_buf, uint8_t frm_buf_size)
 {
+    const uint8_t *p_span;
+    uint8_t span_size;
+    uint8_t span_idx;
     uint8_t current_rx_cnt;
     uint8_t total_frm_size;
     uint8_t data_byte;
-    MP_FRAME_HDR *p_frm_hdr;
-    MP_FRAME_TAIL *p_frm_tail;
 
     current_rx_cnt = 0;
     total_frm_size = 0;
+    span_size = 0;
+    span_idx = 0;
 
     /*
      * Process received byte, but break this loop once we received numbers of
-     * frame data in case the keep comping data cause endless loop.
+     * frame data in case the keep comping data cause endless loop. Bytes are
+     * processed in place in RX FIFO and only the processed bytes are consumed,
+     * the rest are kept for next call.
      */
-    while(Uart0_ReadByte(&data_byte) && current_rx_cnt < MP_RX_FRM_BUF_SIZE){
+    while(current_rx_cnt < MP_RX_FRM_BUF_SIZE){
 
-        /* Drop all collected frame data if the frame length is larger than our local buffer size */
-        if(MP_RxFrmBufIdx == MP_RX_FRM_BUF_SIZE)
+        /* Fetch next contiguous received bytes */
+        if(span_idx == span_size){
+            Uart0_ReadConsume(span_idx);
+
+            span_idx = 0;
+            span_size = Uart0_ReadPeek(&p_span);
+            if(span_size == 0)
+                break;
+        }
+
+        data_byte = p_span[span_idx];
+        span_idx++;
+
+#if MP_FRM_COBS_EN
+        /* Delimiter always starts a new frame, drop the collecting COBS frame */
+        if(data_byte == MP_FRM_DELIM
+        && (MP_RxFrmIsCobs == true || MP_RxFrmState == MP_RX_FRM_WAIT_SFLAG)){
+            MP_RxFrmIsCobs = true;
+            MP_RxCobsCode = 0;
+            MP_RxCobsRemain = 0;
             MP_RxFrmState = MP_RX_FRM_WAIT_SFLAG;
+            MP_RecvByte(MP_FRM_SFLAG, p_frm_buf, frm_buf_size);
+        }
+        /* Decoding COBS frame */
+        else if(MP_RxFrmIsCobs == true && MP_RxFrmState != MP_RX_FRM_WAIT_SFLAG){
+
+            if(MP_RxCobsRemain == 0){
+                /* Code byte, previous block (if any) is ended by a zero byte */
+                if(MP_RxCobsCode != 0 && MP_RxCobsCode != 0xFF)
+                    total_frm_size = MP_RecvByte(0, p_frm_buf, frm_buf_size);
+
+                MP_RxCobsCode = data_byte;
+                MP_RxCobsRemain = data_byte - 1;
+            }
+            else{
+                MP_RxCobsRemain--;
+                total_frm_size = MP_RecvByte(data_byte, p_frm_buf, frm_buf_size);
+            }
+        }
+        /*
+         * Legacy 0x7E frame, until peer sends valid COBS frame. Otherwise the
+         * bytes are dropped until next delimiter.
+         */
+        else if(MP_RxPeerIsCobs == false){
+            MP_RxFrmIsCobs = false;
+            total_frm_size = MP_RecvByte(data_byte, p_frm_buf, frm_buf_size);
+        }
+#else
+        total_frm_size = MP_RecvByte(data_byte, p_frm_buf, frm_buf_size);
+#endif
 
-        switch(MP_RxFrmState){
+        if(total_frm_size != 0)
+            break;
 
-            /* Detecting frame state flag */
-            case MP_RX_FRM_WAIT_SFLAG:
+        current_rx_cnt++;
+    }
 
-                MP_RxFrmBufIdx = 0;
-                MP_RxFrmPayloadLen = 0;
-                MP_RxFrmCrcIdx = 0;
-                MP_RxFrmCrc16 = CRC_INIT_VAL;
+    Uart0_ReadConsume(span_idx);
 
-                if(data_byte == MP_FRM_SFLAG){
+    return total_frm_size;
+}
 
-                    /* Store frame data in local buffer */
-                    MP_RxFrmBuf[MP_RxFrmBufIdx] = data_byte;
-                    MP_RxFrmBufIdx++;
+/*
+ *******************************************************************************
+ * Private functions
+ *******************************************************************************
+ */
 
-                    MP_RxFrmState = MP_RX_FRM_WAIT_HDR;
-                }
+/**
+ * MP_TxBegin - Function to reserve UART TX FIFO space of a frame and put the
+ *              frame header.
+ *
+ * @param   [in]        cmd         MP command ID (Refer to enum mp_rsp_cmd).
+ * @param   [in]        data_size   Size of frame data.
+ *
+ * @return  [bool]      Frame is started.
+ * @retval  [true]      Frame header is put, continue with MP_TxData().
+ * @retval  [false]     Payload is too long, or TX FIFO is full (frame dropped).
+ *
+ */
+static bool MP_TxBegin(uint8_t cmd, uint8_t data_size)
+{
+    uint8_t sequence;
+    uint8_t len;
 
-                break;
+    if(data_size > MP_FRM_DATA_MAX)
+        return false;
 
-            /* Collecting frame header */
-            case MP_RX_FRM_WAIT_HDR:
+#if MP_FRM_COBS_EN
+    len = data_size | MP_FRM_LEN_COBS_BIT;
+#else
+    len = data_size;
+#endif
 
-                /* Store frame data in local buffer */
-                MP_RxFrmBuf[MP_RxFrmBufIdx] = data_byte;
-                MP_RxFrmBufIdx++;
+    sequence = MP_TxSequence++;
 
-                MP_RxFrmCrc16 = CRC_Accumulate(data_byte, MP_RxFrmCrc16);
+    if(Uart0_TxReserve(MP_FRM_SIZE(data_size)) == false){
+        MP_TxDropCnt++;
+        return false;
+    }
 
-                if(MP_RxFrmBufIdx == sizeof(MP_FRAME_HDR)){
-                    p_frm_hdr = (MP_FRAME_HDR *)MP_RxFrmBuf;
+    /* Header, start flag (delimiter) is not included in CRC */
+#if MP_FRM_COBS_EN
+    Uart0_TxPut(MP_FRM_DELIM);
 
-                    MP_RxFrmPayloadLen = p_frm_hdr->len;
+    /* Code byte of first block, patched later */
+    MP_TxCobsMark = Uart0_TxMark();
+    MP_TxCobsCode = 1;
+    Uart0_TxPut(0);
+#else
+    Uart0_TxPut(MP_FRM_SFLAG);
+#endif
 
-                    if(MP_RxSequence != p_frm_hdr->sequence)
-                        MP_RXFrmIsLost = true;
+    MP_TxCrc16 = CRC_INIT_VAL;
 
-                    MP_RxSequence = p_frm_hdr->sequence;
+    MP_TxData(&cmd, 1);
+    MP_TxData(&sequence, 1);
+    MP_TxData(&len, 1);
 
-                    if(p_frm_hdr->len == 0)
-                        MP_RxFrmState = MP_RX_FRM_WAIT_CRC;
-                    else
-                        MP_RxFrmState = MP_RX_FRM_WAIT_PAYLOAD;
-                }
+    return true;
+}
 
-                break;
+/**
+ * MP_TxData - Function to put frame data to reserved UART TX FIFO space, the
+ *             CRC is calculated during copying.
+ *
+ * @param   [in]        *p_data     Frame data buffer.
+ * @param   [in]        data_size   Size of frame data.
+ *
+ * @return  [none]
+ *
+ */
+static void MP_TxData(uint8_t *p_data, uint8_t data_size)
+{
+    uint8_t idx;
 
-            /* Collecting frame payload */
-            case MP_RX_FRM_WAIT_PAYLOAD:
+    for(idx = 0; idx < data_size; idx++){
+        MP_TxPut(p_data[idx]);
+        MP_TxCrc16 = CRC_Accumulate(p_data[idx], MP_TxCrc16);
+    }
+}
 
-                /* Store frame data in local buffer */
-                MP_RxFrmBuf[MP_RxFrmBufIdx] = data_byte;
-                MP_RxFrmBufIdx++;
-                MP_RxFrmPayloadLen--;
+/**
+ * MP_TxEnd - Function to put frame tail and commit the frame to UART.
+ *
+ * @param   [none]
+ *
+ * @return  [none]
+ *
+ */
+static void MP_TxEnd()
+{
+    /* Tail, little endian */
+    MP_TxPut((uint8_t)MP_TxCrc16);
+    MP_TxPut((uint8_t)(MP_TxCrc16 >> 8));
 
-                MP_RxFrmCrc16 = CRC_Accumulate(data_byte, MP_RxFrmCrc16);
+#if MP_FRM_COBS_EN
+    Uart0_TxPatch(MP_TxCobsMark, MP_TxCobsCode);
+#endif
 
-                if(MP_RxFrmPayloadLen == 0){
-                    MP_RxFrmState = MP_RX_FRM_WAIT_CRC;
-                }
+    Uart0_TxCommit();
+}
 
-                break;
+/**
+ * MP_TxPut - Function to put one frame byte to reserved UART TX FIFO space,
+ *            the byte is COBS encoded in COBS mode.
+ *
+ * @param   [in]        data_byte   Frame byte.
+ *
+ * @return  [none]
+ *
+ */
+static void MP_TxPut(uint8_t data_byte)
+{
+#if MP_FRM_COBS_EN
+    /* Zero byte ends current block, its code byte is known now */
+    if(data_byte == 0){
+        Uart0_TxPatch(MP_TxCobsMark, MP_TxCobsCode);
+
+        MP_TxCobsMark = Uart0_TxMark();
+        MP_TxCobsCode = 1;
+        Uart0_TxPut(0);
+
+        return;
+    }
 
-            case MP_RX_FRM_WAIT_CRC:
+    /* Frame is always shorter than 254 bytes, no 0xFF code block */
+    MP_TxCobsCode++;
+#endif
+
+    Uart0_TxPut(data_byte);
+}
+
+/**
+ * MP_RecvByte - Function to collect one (decoded) byte of RX frame.
+ *
+ * @param   [in]        data_byte       Frame byte.
+ * @param   [in/out]    *p_frm_buf      A buffer to store received MP frame content.
+ * @param   [in]        frm_buf_size    Byte size of input frame buffer.
+ *
+ * @return  [uint8_t]   Total received frame size.
+ * @retval  [0]         Frame is not completed.
+ * @retval  [1~N]       Byte size of received MP frame (Header + Payload + Checksum).
+ *
+ */
+static uint8_t MP_RecvByte(uint8_t data_byte, uint8_t *p_frm_buf, uint8_t frm_buf_size)
+{
+    uint8_t total_frm_size;
+    MP_FRAME_HDR *p_frm_hdr;
+    MP_FRAME_TAIL *p_frm_tail;
+
+    total_frm_size = 0;
+
+    /* Drop all collected frame data if the frame length is larger than our local buffer size */
+    if(MP_RxFrmBufIdx == MP_RX_FRM_BUF_SIZE)
+        MP_RxFrmState = MP_RX_FRM_WAIT_SFLAG;
+
+    switch(MP_RxFrmState){
+
+        /* Detecting frame state flag */
+        case MP_RX_FRM_WAIT_SFLAG:
+
+            MP_RxFrmBufIdx = 0;
+            MP_RxFrmPayloadLen = 0;
+            MP_RxFrmCrcIdx = 0;
+            MP_RxFrmCrc16 = CRC_INIT_VAL;
+
+            if(data_byte == MP_FRM_SFLAG){
 
                 /* Store frame data in local buffer */
                 MP_RxFrmBuf[MP_RxFrmBufIdx] = data_byte;
                 MP_RxFrmBufIdx++;
-                MP_RxFrmCrcIdx++;
 
-                if(MP_RxFrmCrcIdx == sizeof(((MP_FRAME_TAIL *)0)->CRC16)){
+                MP_RxFrmState = MP_RX_FRM_WAIT_HDR;
+            }
 
-                    p_frm_tail = (MP_FRAME_TAIL *)&MP_RxFrmBuf[MP_RxFrmBufIdx - MP_RxFrmCrcIdx];
+            break;
 
-                    if(p_frm_tail->CRC16 == MP_RxFrmCrc16){
+        /* Collecting frame header */
+        case MP_RX_FRM_WAIT_HDR:
 
-                        /* Copy frame data to external buffer */
-                        if(p_frm_buf != NULL && frm_buf_size >= MP_RxFrmBufIdx){
-                            total_frm_size = MP_RxFrmBufIdx;
-                            memcpy((void *)p_frm_buf, MP_RxFrmBuf, total_frm_size);
-                        }
+            /* Store frame data in local buffer */
+            MP_RxFrmBuf[MP_RxFrmBufIdx] = data_byte;
+            MP_RxFrmBufIdx++;
 
-                    }
+            MP_RxFrmCrc16 = CRC_Accumulate(data_byte, MP_RxFrmCrc16);
+
+            if(MP_RxFrmBufIdx == sizeof(MP_FRAME_HDR)){
+                p_frm_hdr = (MP_FRAME_HDR *)MP_RxFrmBuf;
+
+#if MP_FRM_COBS_EN
+                /* Version bit is included in CRC, but not in payload length */
+                p_frm_hdr->len &= MP_FRM_LEN_MASK;
+#endif
 
+                /* Drop it now if it can't fit in local buffer, don't wait for bogus length */
+                if(sizeof(MP_FRAME_HDR) + p_frm_hdr->len + sizeof(MP_FRAME_TAIL) > MP_RX_FRM_BUF_SIZE){
+                    MP_RxStats.oversize_cnt++;
                     MP_RxFrmState = MP_RX_FRM_WAIT_SFLAG;
+                    break;
                 }
 
-                break;
+                MP_RxFrmPayloadLen = p_frm_hdr->len;
 
-            default:
-                break;
-        }
+                if(p_frm_hdr->len == 0)
+                    MP_RxFrmState = MP_RX_FRM_WAIT_CRC;
+                else
+                    MP_RxFrmState = MP_RX_FRM_WAIT_PAYLOAD;
+            }
 
-        if(total_frm_size != 0)
             break;
 
-        current_rx_cnt++;
-    }
+        /* Collecting frame payload */
+        case MP_RX_FRM_WAIT_PAYLOAD:
 
-    return total_frm_size;
-}
+            /* Store frame data in local buffer */
+            MP_RxFrmBuf[MP_RxFrmBufIdx] = data_byte;
+            MP_RxFrmBufIdx++;
+            MP_RxFrmPayloadLen--;
 
+            MP_RxFrmCrc16 = CRC_Accumulate(data_byte, MP_RxFrmCrc16);
 
-/*
- *******************************************************************************
- * Private functions
- *******************************************************************************
- */
+            if(MP_RxFrmPayloadLen == 0){
+                MP_RxFrmState = MP_RX_FRM_WAIT_CRC;
+            }
+
+            break;
+
+        case MP_RX_FRM_WAIT_CRC:
+
+            /* Store frame data in local buffer */
+            MP_RxFrmBuf[MP_RxFrmBufIdx] = data_byte;
+            MP_RxFrmBufIdx++;
+            MP_RxFrmCrcIdx++;
 
+            if(MP_RxFrmCrcIdx == sizeof(((MP_FRAME_TAIL *)0)->CRC16)){
+
+                p_frm_tail = (MP_FRAME_TAIL *)&MP_RxFrmBuf[MP_RxFrmBufIdx - MP_RxFrmCrcIdx];
+
+                if(p_frm_tail->CRC16 == MP_RxFrmCrc16){
+
+                    p_frm_hdr = (MP_FRAME_HDR *)MP_RxFrmBuf;
+
+                    /* Sequence is only trusted after CRC check, gap is the number of lost frames */
+                    if(MP_RxSeqIsValid == true
+                    && p_frm_hdr->sequence != (uint8_t)(MP_RxSequence + 1)){
+                        MP_RxStats.seq_lost_cnt += (uint8_t)(p_frm_hdr->sequence - MP_RxSequence - 1);
+                    }
+
+                    MP_RxSequence = p_frm_hdr->sequence;
+                    MP_RxSeqIsValid = true;
+                    MP_RxStats.frm_cnt++;
+
+                    /* Copy frame data to external buffer */
+                    if(p_frm_buf != NULL && frm_buf_size >= MP_RxFrmBufIdx){
+                        total_frm_size = MP_RxFrmBufIdx;
+                        memcpy((void *)p_frm_buf, MP_RxFrmBuf, total_frm_size);
+                    }
+
+#if MP_FRM_COBS_EN
+                    if(MP_RxFrmIsCobs)
+                        MP_RxPeerIsCobs = true;
+#endif
+
+                }
+                else{
+                    MP_RxStats.crc_err_cnt++;
+                }
+
+                MP_RxFrmState = MP_RX_FRM_WAIT_SFLAG;
+            }
+
+            break;
+
+        default:
+            break;
+    }
+
+    return total_frm_size;
+}
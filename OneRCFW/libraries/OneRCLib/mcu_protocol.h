@@ -27,9 +27,52 @@
 
 #define MP_FRM_SFLAG            0x7E    /* Frame start flag */
 
+/*
+ * COBS framing, the frame after delimiter is COBS encoded so the delimiter
+ * never appears inside a frame, the receiver resyncs at the next delimiter.
+ * Frames are 1 byte longer, the start flag is replaced by the delimiter.
+ *
+ * Bit 7 of len field is set in COBS frame (protocol version bit), payload
+ * must not exceed 127 bytes. Legacy 0x7E frames are still accepted until a
+ * COBS frame is received.
+ */
+#define MP_FRM_COBS_EN          true
+#define MP_FRM_DELIM            0x00    /* COBS frame delimiter */
+#define MP_FRM_LEN_COBS_BIT     0x80    /* Version bit in len field */
+#define MP_FRM_LEN_MASK         0x7F
+
 #define MP_TX_FRM_BUF_SIZE      128
 #define MP_RX_FRM_BUF_SIZE      64
 
+#define MP_VARINT_MAX_SIZE      5       /* Max bytes of 32 bits varint */
+
+/*
+ * Binary log, MP_LOG() sends the ID of format string (CRC16 of the string,
+ * calculated by compiler) and raw arguments in MP_RSP_SYS_LOG frame, the
+ * format string is not stored in flash. The ground tool finds the format
+ * string by scanning MP_LOG() calls in source code.
+ *
+ * Arguments are same as Uart0_Println(), %s is sent as null terminated
+ * string and truncated if log frame is full. Messages are printed by
+ * Uart0_Println() if it is disabled.
+ */
+#define MP_LOG_EN               true
+#define MP_LOG_DATA_MAX         32      /* Max payload bytes of log frame */
+#define MP_LOG_ARG_MAX          5       /* Max arguments of MP_LOG() */
+#define MP_LOG_ARG_BITS         3       /* Bits of each argument type in signature */
+
+/* Container payload bytes of one record */
+#define MP_RECORD_SIZE(data_size)   (sizeof(MP_RECORD_HDR) + (data_size))
+
+/* Total frame bytes of payload size, and max payload size */
+#if MP_FRM_COBS_EN
+#define MP_FRM_SIZE(data_size)  (sizeof(MP_FRAME_HDR) + (data_size) + sizeof(MP_FRAME_TAIL) + 1)
+#define MP_FRM_DATA_MAX         MP_FRM_LEN_MASK
+#else
+#define MP_FRM_SIZE(data_size)  (sizeof(MP_FRAME_HDR) + (data_size) + sizeof(MP_FRAME_TAIL))
+#define MP_FRM_DATA_MAX         (255 - sizeof(MP_FRAME_HDR) - sizeof(MP_FRAME_TAIL))
+#endif
+
 
 /*
  *******************************************************************************
@@ -44,6 +87,30 @@ typedef enum mp_req_cmd{
     MP_REQ_SYS_GENERAL,
     MP_REQ_SYS_SETPOINT,
     MP_REQ_SYS_CRUISE_STATE,
+    MP_REQ_SYS_TLM_COMPACT,
+    MP_REQ_SYS_CONTAINER,
+    MP_REQ_SYS_LOG,
+    MP_REQ_SYS_BLACKBOX,
+
+    /* Configuration */
+    MP_REQ_CFG_PARAM_READ   = 8,
+    MP_REQ_CFG_PARAM_WRITE,
+    MP_REQ_CFG_PID_READ,
+    MP_REQ_CFG_PID_WRITE,
+    MP_REQ_CFG_WPT_READ,
+    MP_REQ_CFG_WPT_WRITE,
+    MP_REQ_CFG_MISSION_BEGIN,
+    MP_REQ_CFG_MISSION_END,
+    MP_REQ_CFG_SAVE,
+    MP_REQ_CFG_TLM_RATE_READ,
+    MP_REQ_CFG_TLM_RATE_WRITE,
+    MP_REQ_CFG_BAUD,
+    MP_REQ_CFG_MISSION_START,
+
+    /* Diagnostics */
+    MP_REQ_SYS_LINK_STATS   = 24,
+    MP_REQ_SYS_LATENCY,
+
     MP_REQ_SYS_RESERVED     = 31,
 
     /* GPS */
@@ -55,6 +122,8 @@ typedef enum mp_req_cmd{
     MP_REQ_GPS_WAYPOINT,
     MP_REQ_GPS_NAVIGATION,
     MP_REQ_GPS_ERR_LOG,
+    MP_REQ_GPS_BENCH_RESET,
+    MP_REQ_GPS_BENCH_FEED,
 
     /* IMU and AHRS */
     MP_REQ_IMU_SENSOR_DATA  = 64,
@@ -98,6 +167,30 @@ typedef enum mp_rsp_cmd{
     MP_RSP_SYS_GENERAL      = MP_REQ_SYS_GENERAL + 128,
     MP_RSP_SYS_SETPOINT     = MP_REQ_SYS_SETPOINT + 128,
     MP_RSP_SYS_CRUISE_STATE = MP_REQ_SYS_CRUISE_STATE + 128,
+    MP_RSP_SYS_TLM_COMPACT  = MP_REQ_SYS_TLM_COMPACT + 128,
+    MP_RSP_SYS_CONTAINER    = MP_REQ_SYS_CONTAINER + 128,
+    MP_RSP_SYS_LOG          = MP_REQ_SYS_LOG + 128,
+    MP_RSP_SYS_BLACKBOX     = MP_REQ_SYS_BLACKBOX + 128,
+
+    /* Configuration */
+    MP_RSP_CFG_PARAM_READ   = MP_REQ_CFG_PARAM_READ + 128,
+    MP_RSP_CFG_PARAM_WRITE  = MP_REQ_CFG_PARAM_WRITE + 128,
+    MP_RSP_CFG_PID_READ     = MP_REQ_CFG_PID_READ + 128,
+    MP_RSP_CFG_PID_WRITE    = MP_REQ_CFG_PID_WRITE + 128,
+    MP_RSP_CFG_WPT_READ     = MP_REQ_CFG_WPT_READ + 128,
+    MP_RSP_CFG_WPT_WRITE    = MP_REQ_CFG_WPT_WRITE + 128,
+    MP_RSP_CFG_MISSION_BEGIN = MP_REQ_CFG_MISSION_BEGIN + 128,
+    MP_RSP_CFG_MISSION_END  = MP_REQ_CFG_MISSION_END + 128,
+    MP_RSP_CFG_SAVE         = MP_REQ_CFG_SAVE + 128,
+    MP_RSP_CFG_TLM_RATE_READ = MP_REQ_CFG_TLM_RATE_READ + 128,
+    MP_RSP_CFG_TLM_RATE_WRITE = MP_REQ_CFG_TLM_RATE_WRITE + 128,
+    MP_RSP_CFG_BAUD         = MP_REQ_CFG_BAUD + 128,
+    MP_RSP_CFG_MISSION_START = MP_REQ_CFG_MISSION_START + 128,
+
+    /* Diagnostics */
+    MP_RSP_SYS_LINK_STATS   = MP_REQ_SYS_LINK_STATS + 128,
+    MP_RSP_SYS_LATENCY      = MP_REQ_SYS_LATENCY + 128,
+
     MP_RSP_SYS_RESERVED     = MP_REQ_SYS_RESERVED + 128,
 
     /* GPS */
@@ -109,6 +202,8 @@ typedef enum mp_rsp_cmd{
     MP_RSP_GPS_WAYPOINT     = MP_REQ_GPS_WAYPOINT + 128,
     MP_RSP_GPS_NAVIGATION   = MP_REQ_GPS_NAVIGATION + 128,
     MP_RSP_GPS_ERR_LOG      = MP_REQ_GPS_ERR_LOG + 128,
+    MP_RSP_GPS_BENCH_RESET  = MP_REQ_GPS_BENCH_RESET + 128,
+    MP_RSP_GPS_BENCH_FEED   = MP_REQ_GPS_BENCH_FEED + 128,
 
     /* IMU */
     MP_RSP_IMU_SENSOR_DATA  = MP_REQ_IMU_SENSOR_DATA + 128,
@@ -148,18 +243,50 @@ typedef enum mp_rsp_cmd{
 
 /* Frame header of MCU protocol */
 typedef struct mp_frame_hdr{
-    uint8_t s_flag;         /* 0x7E */
+    uint8_t s_flag;         /* 0x7E, also for received COBS frame */
     uint8_t cmd;            /* Command */
     uint8_t sequence;       /* Sequence number */
-    uint8_t len;            /* Length of payload not including checksum */
+    uint8_t len;            /* Length of payload not including checksum, version bit is cleared in received frame */
     uint8_t payload[0];     /* Payload */
 }__attribute__((packed)) MP_FRAME_HDR;
 
+/* Record header in container frame payload */
+typedef struct mp_record_hdr{
+    uint8_t tag;            /* MP response command of record data */
+    uint8_t len;            /* Length of record data */
+}__attribute__((packed)) MP_RECORD_HDR;
+
+/* Record to be sent in container frame */
+typedef struct mp_record{
+    uint8_t cmd;            /* MP response command (Refer to enum mp_rsp_cmd) */
+    uint8_t size;           /* Size of record data */
+    void *p_data;           /* Record data buffer */
+}MP_RECORD;
+
 /* Frame tail of MCU protocol */
 typedef struct mp_frame_tail{
     uint16_t CRC16;         /* 16 bits CRC (CRC-16-CCITT) appended after data */
 }__attribute__((packed)) MP_FRAME_TAIL;
 
+/* RX frame statistics */
+typedef struct mp_rx_stats{
+    uint16_t frm_cnt;       /* Total frames with valid CRC */
+    uint16_t crc_err_cnt;   /* Total frames dropped by CRC mismatch */
+    uint16_t oversize_cnt;  /* Total frames dropped because they can't fit in RX buffer */
+    uint16_t seq_lost_cnt;  /* Total frames lost according to sequence gaps */
+}MP_RX_STATS;
+
+
+/* MP_LOG() argument type in signature, 0 for end of arguments */
+typedef enum mp_log_arg{
+    MP_LOG_ARG_END          = 0,
+    MP_LOG_ARG_8BITS,               /* %hhu, %hhd, %hhx, %c */
+    MP_LOG_ARG_16BITS,              /* %hu, %hd, %hx */
+    MP_LOG_ARG_32BITS,              /* %u, %d, %x, %o */
+    MP_LOG_ARG_FLOAT,               /* %f */
+    MP_LOG_ARG_STR,                 /* %s */
+}__attribute__((packed)) MP_LOG_ARG;
+
 
 /*
  *******************************************************************************
@@ -190,6 +317,12 @@ typedef struct mp_frame_tail{
 
 int8_t MP_Init();
 uint8_t MP_Send(uint8_t cmd, uint8_t *p_data, uint8_t data_size);
+uint8_t MP_SendRecords(MP_RECORD *p_records, uint8_t record_num);
+uint16_t MP_GetRecordsSize(MP_RECORD *p_records, uint8_t record_num);
+uint16_t MP_GetTxDropCnt();
+void MP_GetRxStats(MP_RX_STATS *p_stats);
+uint8_t MP_PutVarint(uint8_t *p_buf, uint32_t value);
+void MP_SendLog(uint16_t log_id, uint16_t arg_sig, ...);
 uint8_t MP_Recv(uint8_t *p_frm_buf, uint8_t frm_buf_size);
 
 
@@ -199,5 +332,79 @@ uint8_t MP_Recv(uint8_t *p_frm_buf, uint8_t frm_buf_size);
  *******************************************************************************
  */
 
+/*
+ * Compile time helpers of MP_LOG(), only used in constant expressions so the
+ * format string is never stored in flash.
+ */
+
+/* CRC16 of format string, same as CRC_Accumulate() */
+static constexpr uint8_t MP_LogCrcTmp(uint8_t tmp)
+{
+    return tmp ^ (uint8_t)(tmp << 4);
+}
+
+static constexpr uint16_t MP_LogCrcStep(uint8_t tmp, uint16_t crc)
+{
+    return (crc >> 8) ^ ((uint16_t)tmp << 8) ^ ((uint16_t)tmp << 3) ^ (tmp >> 4);
+}
+
+static constexpr uint16_t MP_LogId(const char *p_fmt, uint16_t crc = 0xFFFF)
+{
+    return (*p_fmt == 0) ? crc :
+           MP_LogId(p_fmt + 1, MP_LogCrcStep(MP_LogCrcTmp((uint8_t)*p_fmt ^ (uint8_t)crc), crc));
+}
+
+/* Argument type of conversion specifier (after '%') */
+static constexpr uint8_t MP_LogArgType(const char *p_spec)
+{
+    return (p_spec[0] == 'h' && p_spec[1] == 'h') ? MP_LOG_ARG_8BITS :
+           (p_spec[0] == 'h') ? MP_LOG_ARG_16BITS :
+           (p_spec[0] == 'c') ? MP_LOG_ARG_8BITS :
+           (p_spec[0] == 'f') ? MP_LOG_ARG_FLOAT :
+           (p_spec[0] == 's') ? MP_LOG_ARG_STR :
+           (p_spec[0] == 'u' || p_spec[0] == 'd' || p_spec[0] == 'x' ||
+            p_spec[0] == 'X' || p_spec[0] == 'o') ? MP_LOG_ARG_32BITS : MP_LOG_ARG_END;
+}
+
+/* Length of conversion specifier (after '%') */
+static constexpr uint8_t MP_LogSpecLen(const char *p_spec)
+{
+    return (p_spec[0] == 0) ? 0 :
+           (p_spec[0] == 'h' && p_spec[1] == 'h' && p_spec[2] != 0) ? 3 :
+           (p_spec[0] == 'h' && p_spec[1] != 0) ? 2 : 1;
+}
+
+/* Argument types of format string, MP_LOG_ARG_BITS bits per argument from LSB */
+static constexpr uint16_t MP_LogArgSig(const char *p_fmt, uint8_t shift = 0)
+{
+    return (*p_fmt == 0) ? 0 :
+           (*p_fmt != '%') ? MP_LogArgSig(p_fmt + 1, shift) :
+           (MP_LogArgType(p_fmt + 1) == MP_LOG_ARG_END) ? MP_LogArgSig(p_fmt + 1 + MP_LogSpecLen(p_fmt + 1), shift) :
+           ((uint16_t)MP_LogArgType(p_fmt + 1) << shift)
+               | MP_LogArgSig(p_fmt + 1 + MP_LogSpecLen(p_fmt + 1), shift + MP_LOG_ARG_BITS);
+}
+
+/* Total arguments of format string */
+static constexpr uint8_t MP_LogArgNum(const char *p_fmt)
+{
+    return (*p_fmt == 0) ? 0 :
+           (*p_fmt != '%') ? MP_LogArgNum(p_fmt + 1) :
+           (MP_LogArgType(p_fmt + 1) != MP_LOG_ARG_END) + MP_LogArgNum(p_fmt + 1 + MP_LogSpecLen(p_fmt + 1));
+}
+
+#if MP_LOG_EN
+#define MP_LOG(fmt, ...)                                                            \
+    do{                                                                             \
+        enum : uint16_t{                                                            \
+            MP_LOG_ID = MP_LogId(fmt),                                              \
+            MP_LOG_SIG = MP_LogArgSig(fmt)                                          \
+        };                                                                          \
+        static_assert(MP_LogArgNum(fmt) <= MP_LOG_ARG_MAX, "Too many MP_LOG() arguments"); \
+        MP_SendLog(MP_LOG_ID, MP_LOG_SIG, ##__VA_ARGS__);                           \
+    }while(0)
+#else
+#define MP_LOG(fmt, ...)        Uart0_Println(PSTR(fmt), ##__VA_ARGS__)
+#endif
+
 
 #endif // MCU_PROTOCOL_H_
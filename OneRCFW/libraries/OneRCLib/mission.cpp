@@ -0,0 +1,938 @@
+/**
+ *******************************************************************************
+ *      ______  _   __  ______  ____     ______        ___    ______   ____
+ *     / __  / / \ / / / ____/ / __ \   /  ___/       /  /   /_   _/  / __ \
+ *    / /_/ / /   \ / / ____/ /  -- /  /  /__   __   /  /__  _/  /_  / __ <
+ *   /_____/ /_/ \_/ /_____/ /__/ \_\ /_____/  /_/  /_____/ /_____/ /_____/
+ *
+ *     An amateur remote control software library. Use at your own risk.
+ *
+ * @file    mission.cpp
+ * @brief   Waypoint mission store.
+ *
+ *          The mission is stored in its own ROM region as one header and
+ *          fixed size pages, each page holds MISSION_PAGE_WPT_NUM compact
+ *          waypoints (north/east offset in meters to mission origin) and
+ *          has its own CRC16, so updating one waypoint only rewrites and
+ *          re-CRCs one page.
+ *
+ *          Only the active and next waypoint and one page cache are kept in
+ *          RAM. When a waypoint is reached, the page of the waypoint after the
+ *          next one is prefetched, so a corrupted page is found one leg ahead.
+ *
+ *          Mission editing never waits for the ROM. Mission_SetWpt() and
+ *          Mission_Commit() only update the page cache and header in RAM, and
+ *          Mission_Task() writes them to ROM one byte per call, so a mission
+ *          can be uploaded while the control loop is running. A new mission
+ *          erases the ID of stored header before any page is written, and
+ *          the header is written last, so a reset during upload never loads
+ *          the old header with new pages.
+ *
+ *          Guidance works in the same local north/east frame. The leg unit
+ *          vector and length are computed once when the active waypoint
+ *          changes, and every control tick only projects the extrapolated
+ *          position onto the leg to get cross-track/along-track error and
+ *          the L1 lateral acceleration (no trigonometric function per tick).
+ *
+ *          ROM layout:
+ *              MISSION_ROM_ADDR    MISSION_HEADER
+ *                                  MISSION_PAGE 0
+ *                                  MISSION_PAGE 1
+ *                                  ...
+ *
+ *          Abbreviations:
+ *              WPT     - Waypoint.
+ *              L1      - L1 nonlinear path following guidance.
+ *
+ *          Reference:
+ *
+ *              S. Park, J. Deyst, J. How, "A New Nonlinear Guidance Logic
+ *              for Trajectory Tracking", AIAA GNC Conference, 2004.
+ *
+ * @author  Y.S.Kuo in Hsinchu
+ *******************************************************************************
+ */
+
+#include <Arduino.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include "mission.h"
+#include "gps.h"
+#include "rom_drv.h"
+#include "crc_ccitt.h"
+#include "math_lib.h"
+#include "uart_stream.h"
+#include "mcu_protocol.h"
+
+
+/*
+ *******************************************************************************
+ * Constant value definition
+ *******************************************************************************
+ */
+
+#define MISSION_PAGE_INVALID            0xFF
+
+/* Stored header is invalidated by erasing its mission ID */
+#define MISSION_ERASED_ID               0x00000000
+
+/* Degree of latitude per meter */
+#define MISSION_METERS_TO_LAT_DD        MATH_RAD2DEG(1.0 / GPS_EARTH_RADIUS_METERS)
+#define MISSION_LAT_DD_TO_METERS        (1.0 / MISSION_METERS_TO_LAT_DD)
+
+
+/*
+ *******************************************************************************
+ * Data type definition
+ *******************************************************************************
+ */
+
+
+/*
+ *******************************************************************************
+ * Global variables
+ *******************************************************************************
+ */
+
+static MISSION_HEADER Mission_Header;
+static bool Mission_IsLoaded = false;
+
+static MISSION_PAGE Mission_PageCache;
+static uint8_t Mission_CachedPage = MISSION_PAGE_INVALID;
+
+/* Pending ROM update */
+static uint8_t Mission_DirtyPage = MISSION_PAGE_INVALID;
+static bool Mission_IsHeaderDirty = false;
+static bool Mission_IsHeaderErase = false;
+static uint16_t Mission_RomOffset = 0;
+
+/* Pages (one bit per page, MISSION_PAGE_NUM <= 16) and waypoints set since Mission_Create() */
+static uint16_t Mission_EditPages = 0;
+static uint8_t Mission_EditWpts[(MISSION_WPT_MAX + 7) / 8];
+
+static float Mission_MetersToLongDD;
+static float Mission_LongDDToMeters;
+
+/* Active and next legs */
+static bool Mission_ActiveFlag = false;
+static bool Mission_HasNext = false;
+static uint16_t Mission_ActiveIdx = 0;
+static MISSION_WPT Mission_ActiveWpt;
+static MISSION_WPT Mission_NextWpt;
+static MISSION_LEG Mission_Leg;
+
+/* Latest position fix and velocity in local frame */
+static bool Mission_FixIsSet = false;
+static float Mission_FixN;
+static float Mission_FixE;
+static float Mission_VelN;
+static float Mission_VelE;
+
+
+/*
+ *******************************************************************************
+ * Public functions declaration
+ *******************************************************************************
+ */
+
+
+/*
+ *******************************************************************************
+ * Private functions declaration
+ *******************************************************************************
+ */
+
+static int8_t Mission_LoadHeader();
+static int8_t Mission_LoadPage(uint8_t page_idx);
+static int8_t Mission_ReadWpt(uint16_t wpt_idx, MISSION_WPT *p_wpt);
+static void Mission_DecodeWpt(MISSION_WPT *p_wpt, GPS_COORD_POINT *p_coord);
+static void Mission_UpdateLeg(MISSION_WPT *p_from, MISSION_WPT *p_to);
+static void Mission_Prefetch(uint16_t wpt_idx);
+
+
+/*
+ *******************************************************************************
+ * Public functions
+ *******************************************************************************
+ */
+
+/**
+ * Mission_Init - Function to load mission header from ROM.
+ *
+ * @param   [none]
+ *
+ * @return  [int8_t]    Function executing result.
+ * @retval  [0]         Success, a valid mission is stored in ROM.
+ * @retval  [-1]        Fail, no valid mission.
+ *
+ */
+int8_t Mission_Init()
+{
+    int8_t ret_val;
+
+    Mission_ActiveFlag = false;
+    Mission_HasNext = false;
+    Mission_ActiveIdx = 0;
+    Mission_CachedPage = MISSION_PAGE_INVALID;
+
+    ret_val = Mission_LoadHeader();
+
+    Uart0_Println(PSTR("[Mission] WPT: %hu / %hu"), Mission_GetTotalWpt(), (uint16_t)MISSION_WPT_MAX);
+
+    return ret_val;
+}
+
+/**
+ * Mission_GetTotalWpt - Function to get total waypoints of stored mission.
+ *
+ * @param   [none]
+ *
+ * @return  [uint16_t]  Total waypoints, 0 if there is no valid mission.
+ *
+ */
+uint16_t Mission_GetTotalWpt()
+{
+    if(Mission_IsLoaded == false)
+        return 0;
+
+    return Mission_Header.total_wpt;
+}
+
+/**
+ * Mission_Start - Function to start mission from specific waypoint.
+ *
+ * @param   [in]        wpt_idx         Index of the first active waypoint.
+ *
+ * @return  [int8_t]    Function executing result.
+ * @retval  [0]         Success.
+ * @retval  [-1]        Fail.
+ *
+ */
+int8_t Mission_Start(uint16_t wpt_idx)
+{
+    MISSION_WPT leg_start = {0, 0};
+
+    Mission_ActiveFlag = false;
+    Mission_HasNext = false;
+
+    if(wpt_idx >= Mission_GetTotalWpt())
+        return -1;
+
+    /* The first leg starts from mission origin */
+    if(wpt_idx > 0 && Mission_ReadWpt(wpt_idx - 1, &leg_start) != 0)
+        return -1;
+
+    if(Mission_ReadWpt(wpt_idx, &Mission_ActiveWpt) != 0)
+        return -1;
+
+    Mission_UpdateLeg(&leg_start, &Mission_ActiveWpt);
+
+    Mission_ActiveIdx = wpt_idx;
+    Mission_ActiveFlag = true;
+
+    if(wpt_idx + 1 < Mission_Header.total_wpt){
+        if(Mission_ReadWpt(wpt_idx + 1, &Mission_NextWpt) == 0)
+            Mission_HasNext = true;
+    }
+
+    Mission_Prefetch(wpt_idx + 2);
+
+    return 0;
+}
+
+/**
+ * Mission_Stop - Function to stop flying mission, the stored mission is kept
+ *                and can be started again.
+ *
+ * @param   [none]
+ *
+ * @return  [none]
+ *
+ */
+void Mission_Stop()
+{
+    Mission_ActiveFlag = false;
+    Mission_HasNext = false;
+}
+
+/**
+ * Mission_Advance - Function to switch to next leg when the active waypoint is
+ *                   reached.
+ *
+ * The next waypoint becomes active, the new leg geometry is computed and the
+ * page of the waypoint after the new next one is prefetched into page cache.
+ *
+ * @param   [none]
+ *
+ * @return  [int8_t]    Function executing result.
+ * @retval  [0]         Success, new active waypoint is available.
+ * @retval  [-1]        Fail, mission is completed or next page is corrupted.
+ *
+ */
+int8_t Mission_Advance()
+{
+    if(Mission_ActiveFlag == false)
+        return -1;
+
+    if(Mission_HasNext == false){
+        Mission_ActiveFlag = false;
+        return -1;
+    }
+
+    Mission_ActiveIdx++;
+    Mission_UpdateLeg(&Mission_ActiveWpt, &Mission_NextWpt);
+    Mission_ActiveWpt = Mission_NextWpt;
+
+    Mission_HasNext = false;
+    if(Mission_ActiveIdx + 1 < Mission_Header.total_wpt){
+        if(Mission_ReadWpt(Mission_ActiveIdx + 1, &Mission_NextWpt) == 0)
+            Mission_HasNext = true;
+        else
+            MP_LOG("[Mission] WPT %hu: CRC error", (uint16_t)(Mission_ActiveIdx + 1));
+    }
+
+    Mission_Prefetch(Mission_ActiveIdx + 2);
+
+    return 0;
+}
+
+/**
+ * Mission_IsActive - Function to check whether mission is flying or not.
+ *
+ * @param   [none]
+ *
+ * @return  [bool]      Mission state.
+ * @retval  [true]      Mission is active.
+ * @retval  [false]     Mission is not started or has been completed.
+ *
+ */
+bool Mission_IsActive()
+{
+    return Mission_ActiveFlag;
+}
+
+/**
+ * Mission_GetActiveIdx - Function to get index of active waypoint.
+ *
+ * @param   [none]
+ *
+ * @return  [uint16_t]  Index of active waypoint.
+ *
+ */
+uint16_t Mission_GetActiveIdx()
+{
+    return Mission_ActiveIdx;
+}
+
+/**
+ * Mission_GetActiveWpt - Function to get coordinate of active waypoint.
+ *
+ * @param   [out]       *p_coord        Coordinate of active waypoint.
+ *
+ * @return  [int8_t]    Function executing result.
+ * @retval  [0]         Success.
+ * @retval  [-1]        Fail.
+ *
+ */
+int8_t Mission_GetActiveWpt(GPS_COORD_POINT *p_coord)
+{
+    if(p_coord == NULL || Mission_ActiveFlag == false)
+        return -1;
+
+    Mission_DecodeWpt(&Mission_ActiveWpt, p_coord);
+
+    return 0;
+}
+
+/**
+ * Mission_GetNextWpt - Function to get coordinate of next waypoint.
+ *
+ * @param   [out]       *p_coord        Coordinate of next waypoint.
+ *
+ * @return  [int8_t]    Function executing result.
+ * @retval  [0]         Success.
+ * @retval  [-1]        Fail, no next waypoint.
+ *
+ */
+int8_t Mission_GetNextWpt(GPS_COORD_POINT *p_coord)
+{
+    if(p_coord == NULL || Mission_ActiveFlag == false || Mission_HasNext == false)
+        return -1;
+
+    Mission_DecodeWpt(&Mission_NextWpt, p_coord);
+
+    return 0;
+}
+
+/**
+ * Mission_UpdateFix - Function to convert latest GPS fix to local frame.
+ *
+ * Call this function once per new GPGGA frame, the course over ground
+ * trigonometric functions are only calculated here.
+ *
+ * @param   [in]        *p_nmea         Latest NMEA report.
+ *
+ * @return  [int8_t]    Function executing result.
+ * @retval  [0]         Success.
+ * @retval  [-1]        Fail.
+ *
+ */
+int8_t Mission_UpdateFix(GPS_NMEA_REPORT *p_nmea)
+{
+    float cog_rad;
+
+    if(p_nmea == NULL || Mission_IsLoaded == false)
+        return -1;
+
+    if(p_nmea->gpgga.fix_status == 0
+       || (p_nmea->gprmc.fix_status | p_nmea->gprmc.nav_status) == 0){
+        Mission_FixIsSet = false;
+        return -1;
+    }
+
+    Mission_FixN = (p_nmea->gpgga.coord.LAT_DD - Mission_Header.origin.LAT_DD) * MISSION_LAT_DD_TO_METERS;
+    Mission_FixE = (p_nmea->gpgga.coord.LONG_DD - Mission_Header.origin.LONG_DD) * Mission_LongDDToMeters;
+
+    cog_rad = MATH_DEG2RAD(p_nmea->gprmc.COG_degrees);
+    Mission_VelN = p_nmea->gprmc.gnd_speed_MS * cos(cog_rad);
+    Mission_VelE = p_nmea->gprmc.gnd_speed_MS * sin(cog_rad);
+
+    Mission_FixIsSet = true;
+
+    return 0;
+}
+
+/**
+ * Mission_UpdateGuidance - Function to update L1 guidance of active leg.
+ *
+ * Position is extrapolated from latest fix by fix age, then projected onto
+ * precomputed leg unit vector. The L1 reference point is on the leg, L1
+ * distance ahead of current position, and the lateral acceleration command
+ * is 2 * V^2 * sin(eta) / L1, eta is the angle between velocity and the
+ * line of sight to reference point.
+ *
+ * @param   [in]        fix_age_ms      Age of latest fix, see GPS_GetFixAge().
+ * @param   [out]       *p_guide        Guidance output.
+ *
+ * @return  [int8_t]    Function executing result.
+ * @retval  [0]         Success.
+ * @retval  [-1]        Fail, no active leg, valid fix or enough ground speed.
+ *
+ */
+int8_t Mission_UpdateGuidance(uint16_t fix_age_ms, MISSION_GUIDANCE *p_guide)
+{
+    float age_s;
+    float rel_n;
+    float rel_e;
+    float vel_along;
+    float vel_cross;
+    float speed_sq;
+    float l1_dist;
+    float los_along;
+    float los_cross;
+    float inv_norm;
+    float sin_eta;
+    float accel_ratio;
+
+    if(p_guide == NULL || Mission_ActiveFlag == false || Mission_FixIsSet == false)
+        return -1;
+
+    if(fix_age_ms > GPS_LATENCY_MAX_EXTRAPOLATE_MS)
+        return -1;
+
+    /* Velocity in leg frame (along, cross to right) */
+    vel_along = Mission_VelN * Mission_Leg.unit_n + Mission_VelE * Mission_Leg.unit_e;
+    vel_cross = Mission_VelE * Mission_Leg.unit_n - Mission_VelN * Mission_Leg.unit_e;
+    speed_sq = vel_along * vel_along + vel_cross * vel_cross;
+
+    if(speed_sq < (MISSION_L1_MIN_SPEED_MS * MISSION_L1_MIN_SPEED_MS))
+        return -1;
+
+    /* Extrapolated position relative to leg start */
+    age_s = fix_age_ms * 0.001;
+    rel_n = Mission_FixN + Mission_VelN * age_s - Mission_Leg.start_n;
+    rel_e = Mission_FixE + Mission_VelE * age_s - Mission_Leg.start_e;
+
+    p_guide->along_m = rel_n * Mission_Leg.unit_n + rel_e * Mission_Leg.unit_e;
+    p_guide->xtrack_m = rel_e * Mission_Leg.unit_n - rel_n * Mission_Leg.unit_e;
+    p_guide->is_leg_done = (p_guide->along_m >= Mission_Leg.length) ? true : false;
+
+    /* L1 distance grows with ground speed */
+    l1_dist = MISSION_L1_SPEED_RATIO * Math_FastSqrt(speed_sq);
+    if(l1_dist < MISSION_L1_MIN_METERS)
+        l1_dist = MISSION_L1_MIN_METERS;
+
+    /*
+     * Line of sight to L1 reference point in leg frame, point to the
+     * closest point of the leg if we are more than L1 away from the leg.
+     */
+    los_cross = -p_guide->xtrack_m;
+    if(fabs(p_guide->xtrack_m) < l1_dist)
+        los_along = Math_FastSqrt(l1_dist * l1_dist - p_guide->xtrack_m * p_guide->xtrack_m);
+    else
+        los_along = 0.0;
+
+    /* sin(eta) = (V x LOS) / (|V| * |LOS|) */
+    inv_norm = Math_FastInvSqrt(speed_sq * (los_along * los_along + los_cross * los_cross));
+    sin_eta = (vel_along * los_cross - vel_cross * los_along) * inv_norm;
+
+    /* Reference point is behind us, turn as hard as we can */
+    if(vel_along * los_along + vel_cross * los_cross < 0)
+        sin_eta = (sin_eta >= 0) ? 1.0 : -1.0;
+
+    p_guide->lat_accel = 2.0 * speed_sq * sin_eta / l1_dist;
+
+    /* Coordinated turn bank angle, atan(a / g) */
+    accel_ratio = p_guide->lat_accel * (1.0 / MISSION_GRAVITY_MS2);
+    p_guide->bank_angle = MATH_RAD2DEG(Math_Atan2Approx1(accel_ratio, 1.0));
+    p_guide->bank_angle = constrain(p_guide->bank_angle,
+                                    -MISSION_L1_MAX_BANK_ANGLE,
+                                    MISSION_L1_MAX_BANK_ANGLE);
+
+    return 0;
+}
+
+/**
+ * Mission_Create - Function to start editing a new mission.
+ *
+ * The stored mission is invalidated in RAM until Mission_Commit() is called,
+ * waypoints must be set by Mission_SetWpt() before committing.
+ *
+ * @param   [in]        *p_origin       Mission origin, all waypoints must be
+ *                                      within +- 32 km to the origin.
+ *
+ * @return  [int8_t]    Function executing result.
+ * @retval  [0]         Success.
+ * @retval  [-1]        Fail.
+ *
+ */
+int8_t Mission_Create(GPS_COORD_POINT *p_origin)
+{
+    if(p_origin == NULL)
+        return -1;
+
+    Mission_IsLoaded = false;
+    Mission_ActiveFlag = false;
+    Mission_HasNext = false;
+    Mission_CachedPage = MISSION_PAGE_INVALID;
+
+    /* Drop unfinished ROM update of previous mission */
+    Mission_DirtyPage = MISSION_PAGE_INVALID;
+    Mission_IsHeaderDirty = false;
+    Mission_RomOffset = 0;
+
+    /* Stored header must be invalid before the first page is written */
+    Mission_IsHeaderErase = true;
+
+    /* Pages of stored mission are not reused, every waypoint must be set again */
+    Mission_EditPages = 0;
+    memset((void *)Mission_EditWpts, 0, sizeof(Mission_EditWpts));
+
+    Mission_Header.mission_ID = MISSION_ID;
+    Mission_Header.total_wpt = 0;
+    Mission_Header.origin = *p_origin;
+
+    Mission_MetersToLongDD = MISSION_METERS_TO_LAT_DD / cos(MATH_DEG2RAD(p_origin->LAT_DD));
+    Mission_LongDDToMeters = 1.0 / Mission_MetersToLongDD;
+    Mission_FixIsSet = false;
+
+    return 0;
+}
+
+/**
+ * Mission_SetWpt - Function to update one waypoint.
+ *
+ * The waypoint is stored to page cache and the page is re-CRCed, then the page
+ * is written to ROM by Mission_Task() (bytes are compared before writing).
+ * Waypoints of another page can not be set until the dirty page is written,
+ * so upload waypoints in order to keep the busy time short.
+ *
+ * A page without waypoint of current mission is cleared when it's set the
+ * first time, so waypoints of an old mission are never reused.
+ *
+ * @param   [in]        wpt_idx         Waypoint index.
+ * @param   [in]        *p_coord        Waypoint coordinate.
+ *
+ * @return  [int8_t]    Function executing result.
+ * @retval  [1]         Busy, another page is still being written, retry later.
+ * @retval  [0]         Success.
+ * @retval  [-1]        Fail.
+ *
+ */
+int8_t Mission_SetWpt(uint16_t wpt_idx, GPS_COORD_POINT *p_coord)
+{
+    uint8_t page_idx;
+    uint8_t slot;
+    float north_m;
+    float east_m;
+
+    if(p_coord == NULL || wpt_idx >= MISSION_WPT_MAX)
+        return -1;
+
+    /* The page cache is in use by the flying mission */
+    if(Mission_Header.mission_ID != MISSION_ID || Mission_ActiveFlag == true)
+        return -1;
+
+    north_m = (p_coord->LAT_DD - Mission_Header.origin.LAT_DD) * MISSION_LAT_DD_TO_METERS;
+    east_m = (p_coord->LONG_DD - Mission_Header.origin.LONG_DD) * Mission_LongDDToMeters;
+
+    if(fabs(north_m) > MISSION_WPT_OFFSET_MAX || fabs(east_m) > MISSION_WPT_OFFSET_MAX)
+        return -1;
+
+    page_idx = wpt_idx / MISSION_PAGE_WPT_NUM;
+    slot = wpt_idx % MISSION_PAGE_WPT_NUM;
+
+    if(Mission_DirtyPage != MISSION_PAGE_INVALID && Mission_DirtyPage != page_idx)
+        return 1;
+
+    /*
+     * Start with an empty page if it has no waypoint of this mission yet, stored
+     * waypoints after total_wpt are left by an old mission with another origin.
+     */
+    if((Mission_EditPages & ((uint16_t)1 << page_idx)) == 0
+       && (uint16_t)page_idx * MISSION_PAGE_WPT_NUM >= Mission_Header.total_wpt){
+        Mission_CachedPage = MISSION_PAGE_INVALID;
+        memset((void *)&Mission_PageCache, 0, sizeof(Mission_PageCache));
+        Mission_PageCache.page_idx = page_idx;
+    }
+    else if(Mission_LoadPage(page_idx) != 0){
+        return -1;
+    }
+
+    Mission_PageCache.wpt[slot].north_m = (int16_t)lround(north_m);
+    Mission_PageCache.wpt[slot].east_m = (int16_t)lround(east_m);
+
+    if(slot >= Mission_PageCache.wpt_cnt)
+        Mission_PageCache.wpt_cnt = slot + 1;
+
+    Mission_PageCache.rom_crc16 = CRC_Calculate((uint8_t *)&Mission_PageCache,
+                                                (sizeof(MISSION_PAGE) - sizeof(Mission_PageCache.rom_crc16)));
+
+    Mission_CachedPage = page_idx;
+
+    Mission_EditPages |= ((uint16_t)1 << page_idx);
+    Mission_EditWpts[wpt_idx / 8] |= (1 << (wpt_idx % 8));
+
+    /* Compare the whole page again, bytes before current offset may be changed */
+    Mission_DirtyPage = page_idx;
+    Mission_RomOffset = 0;
+
+    return 0;
+}
+
+/**
+ * Mission_GetWpt - Function to read one waypoint from ROM.
+ *
+ * @param   [in]        wpt_idx         Waypoint index.
+ * @param   [out]       *p_coord        Waypoint coordinate.
+ *
+ * @return  [int8_t]    Function executing result.
+ * @retval  [0]         Success.
+ * @retval  [-1]        Fail.
+ *
+ */
+int8_t Mission_GetWpt(uint16_t wpt_idx, GPS_COORD_POINT *p_coord)
+{
+    MISSION_WPT wpt;
+
+    if(p_coord == NULL || Mission_Header.mission_ID != MISSION_ID)
+        return -1;
+
+    if(Mission_ReadWpt(wpt_idx, &wpt) != 0)
+        return -1;
+
+    Mission_DecodeWpt(&wpt, p_coord);
+
+    return 0;
+}
+
+/**
+ * Mission_Commit - Function to store mission header to ROM.
+ *
+ * The header is written by Mission_Task() after the dirty page, the mission
+ * can be started once Mission_Task() returns 0. All waypoints of a new
+ * mission must be set by Mission_SetWpt() after Mission_Create().
+ *
+ * @param   [in]        total_wpt       Total waypoints of the mission.
+ *
+ * @return  [int8_t]    Function executing result.
+ * @retval  [0]         Success.
+ * @retval  [-1]        Fail.
+ *
+ */
+int8_t Mission_Commit(uint16_t total_wpt)
+{
+    uint16_t wpt_idx;
+
+    if(total_wpt > MISSION_WPT_MAX || Mission_Header.mission_ID != MISSION_ID)
+        return -1;
+
+    /* Waypoints after stored total_wpt (0 for new mission) must be set */
+    for(wpt_idx = Mission_Header.total_wpt; wpt_idx < total_wpt; wpt_idx++){
+        if((Mission_EditWpts[wpt_idx / 8] & (1 << (wpt_idx % 8))) == 0)
+            return -1;
+    }
+
+    Mission_Header.total_wpt = total_wpt;
+    Mission_Header.rom_crc16 = CRC_Calculate((uint8_t *)&Mission_Header,
+                                             (sizeof(MISSION_HEADER) - sizeof(Mission_Header.rom_crc16)));
+
+    if(Mission_DirtyPage == MISSION_PAGE_INVALID)
+        Mission_RomOffset = 0;
+
+    Mission_IsHeaderDirty = true;
+
+    return 0;
+}
+
+/**
+ * Mission_Task - Function to write dirty page and header to ROM.
+ *
+ * Call this function once per control cycle, at most one ROM byte write is
+ * started per call. The ID of stored header is erased first (new mission),
+ * then dirty page and header are written. Each page and the header are read
+ * back and checked after they are written.
+ *
+ * @param   [none]
+ *
+ * @return  [int8_t]    Function executing result.
+ * @retval  [1]         Busy, ROM update is in progress.
+ * @retval  [0]         Idle, all changes are stored.
+ * @retval  [-1]        Fail, read after write check is failed.
+ *
+ */
+int8_t Mission_Task()
+{
+    static uint32_t erased_ID = MISSION_ERASED_ID;
+    uint8_t page_idx;
+
+    if(Mission_IsHeaderErase == true){
+
+        if(ROM_UpdateStep(MISSION_ROM_ADDR, (uint8_t *)&erased_ID,
+                          sizeof(erased_ID), &Mission_RomOffset) != 0)
+            return 1;
+
+        Mission_IsHeaderErase = false;
+        Mission_RomOffset = 0;
+
+        return (Mission_DirtyPage != MISSION_PAGE_INVALID || Mission_IsHeaderDirty == true) ? 1 : 0;
+    }
+
+    if(Mission_DirtyPage != MISSION_PAGE_INVALID){
+
+        if(ROM_UpdateStep(MISSION_PAGE_ROM_ADDR(Mission_DirtyPage), (uint8_t *)&Mission_PageCache,
+                          sizeof(MISSION_PAGE), &Mission_RomOffset) != 0)
+            return 1;
+
+        page_idx = Mission_DirtyPage;
+        Mission_DirtyPage = MISSION_PAGE_INVALID;
+        Mission_RomOffset = 0;
+
+        /* Read after write, make sure the page is saved correctly */
+        Mission_CachedPage = MISSION_PAGE_INVALID;
+        if(Mission_LoadPage(page_idx) != 0){
+            MP_LOG("[Mission] page %hhu: write error", page_idx);
+            Mission_IsHeaderDirty = false;
+            return -1;
+        }
+
+        return (Mission_IsHeaderDirty == true) ? 1 : 0;
+    }
+
+    if(Mission_IsHeaderDirty == true){
+
+        if(ROM_UpdateStep(MISSION_ROM_ADDR, (uint8_t *)&Mission_Header,
+                          sizeof(MISSION_HEADER), &Mission_RomOffset) != 0)
+            return 1;
+
+        Mission_IsHeaderDirty = false;
+        Mission_RomOffset = 0;
+
+        /* Read after write, make sure the header is saved correctly */
+        if(Mission_LoadHeader() != 0){
+            MP_LOG("[Mission] header: write error");
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+
+/*
+ *******************************************************************************
+ * Private functions
+ *******************************************************************************
+ */
+
+/**
+ * Mission_LoadHeader - Function to load and check mission header.
+ *
+ * @param   [none]
+ *
+ * @return  [int8_t]    Function executing result.
+ * @retval  [0]         Success.
+ * @retval  [-1]        Fail.
+ *
+ */
+static int8_t Mission_LoadHeader()
+{
+    uint16_t rom_crc;
+
+    Mission_IsLoaded = false;
+
+    ROM_ReadBytes(MISSION_ROM_ADDR, (uint8_t *)&Mission_Header, sizeof(MISSION_HEADER));
+
+    rom_crc = CRC_Calculate((uint8_t *)&Mission_Header,
+                            (sizeof(MISSION_HEADER) - sizeof(Mission_Header.rom_crc16)));
+
+    if(Mission_Header.rom_crc16 != rom_crc || Mission_Header.mission_ID != MISSION_ID
+       || Mission_Header.total_wpt > MISSION_WPT_MAX){
+        Mission_Header.mission_ID = 0;
+        return -1;
+    }
+
+    Mission_MetersToLongDD = MISSION_METERS_TO_LAT_DD / cos(MATH_DEG2RAD(Mission_Header.origin.LAT_DD));
+    Mission_LongDDToMeters = 1.0 / Mission_MetersToLongDD;
+
+    Mission_IsLoaded = true;
+
+    return 0;
+}
+
+/**
+ * Mission_LoadPage - Function to load and check one page into page cache.
+ *
+ * @param   [in]        page_idx        Page index.
+ *
+ * @return  [int8_t]    Function executing result.
+ * @retval  [0]         Success.
+ * @retval  [-1]        Fail, page is corrupted or not initialized.
+ *
+ */
+static int8_t Mission_LoadPage(uint8_t page_idx)
+{
+    uint16_t rom_crc;
+
+    if(page_idx >= MISSION_PAGE_NUM)
+        return -1;
+
+    if(Mission_CachedPage == page_idx)
+        return 0;
+
+    /* Dirty page is not written yet */
+    if(Mission_DirtyPage != MISSION_PAGE_INVALID)
+        return -1;
+
+    Mission_CachedPage = MISSION_PAGE_INVALID;
+
+    ROM_ReadBytes(MISSION_PAGE_ROM_ADDR(page_idx), (uint8_t *)&Mission_PageCache, sizeof(MISSION_PAGE));
+
+    rom_crc = CRC_Calculate((uint8_t *)&Mission_PageCache,
+                            (sizeof(MISSION_PAGE) - sizeof(Mission_PageCache.rom_crc16)));
+
+    if(Mission_PageCache.rom_crc16 != rom_crc || Mission_PageCache.page_idx != page_idx
+       || Mission_PageCache.wpt_cnt > MISSION_PAGE_WPT_NUM)
+        return -1;
+
+    Mission_CachedPage = page_idx;
+
+    return 0;
+}
+
+/**
+ * Mission_ReadWpt - Function to read one compact waypoint via page cache.
+ *
+ * @param   [in]        wpt_idx         Waypoint index.
+ * @param   [out]       *p_wpt          Compact waypoint.
+ *
+ * @return  [int8_t]    Function executing result.
+ * @retval  [0]         Success.
+ * @retval  [-1]        Fail.
+ *
+ */
+static int8_t Mission_ReadWpt(uint16_t wpt_idx, MISSION_WPT *p_wpt)
+{
+    uint8_t slot;
+
+    if(p_wpt == NULL || wpt_idx >= MISSION_WPT_MAX)
+        return -1;
+
+    if(Mission_LoadPage(wpt_idx / MISSION_PAGE_WPT_NUM) != 0)
+        return -1;
+
+    slot = wpt_idx % MISSION_PAGE_WPT_NUM;
+    if(slot >= Mission_PageCache.wpt_cnt)
+        return -1;
+
+    *p_wpt = Mission_PageCache.wpt[slot];
+
+    return 0;
+}
+
+/**
+ * Mission_DecodeWpt - Function to convert compact waypoint to coordinate.
+ *
+ * @param   [in]        *p_wpt          Compact waypoint.
+ * @param   [out]       *p_coord        Waypoint coordinate.
+ *
+ * @return  [none]
+ *
+ */
+static void Mission_DecodeWpt(MISSION_WPT *p_wpt, GPS_COORD_POINT *p_coord)
+{
+    p_coord->LAT_DD = Mission_Header.origin.LAT_DD + p_wpt->north_m * MISSION_METERS_TO_LAT_DD;
+    p_coord->LONG_DD = Mission_Header.origin.LONG_DD + p_wpt->east_m * Mission_MetersToLongDD;
+}
+
+/**
+ * Mission_UpdateLeg - Function to precompute leg geometry.
+ *
+ * @param   [in]        *p_from         Leg start waypoint.
+ * @param   [in]        *p_to           Leg end waypoint.
+ *
+ * @return  [none]
+ *
+ */
+static void Mission_UpdateLeg(MISSION_WPT *p_from, MISSION_WPT *p_to)
+{
+    float delta_n;
+    float delta_e;
+
+    delta_n = (float)(p_to->north_m - p_from->north_m);
+    delta_e = (float)(p_to->east_m - p_from->east_m);
+
+    Mission_Leg.start_n = p_from->north_m;
+    Mission_Leg.start_e = p_from->east_m;
+    Mission_Leg.length = sqrt(delta_n * delta_n + delta_e * delta_e);
+
+    /* Zero length leg is passed immediately */
+    if(Mission_Leg.length < 1.0){
+        Mission_Leg.unit_n = 1.0;
+        Mission_Leg.unit_e = 0.0;
+        Mission_Leg.length = -1.0;
+    }
+    else{
+        Mission_Leg.unit_n = delta_n / Mission_Leg.length;
+        Mission_Leg.unit_e = delta_e / Mission_Leg.length;
+    }
+}
+
+/**
+ * Mission_Prefetch - Function to prefetch the page containing a waypoint.
+ *
+ * @param   [in]        wpt_idx         Waypoint index.
+ *
+ * @return  [none]
+ *
+ */
+static void Mission_Prefetch(uint16_t wpt_idx)
+{
+    if(wpt_idx >= Mission_Header.total_wpt)
+        return;
+
+    if(Mission_LoadPage(wpt_idx / MISSION_PAGE_WPT_NUM) != 0)
+        MP_LOG("[Mission] WPT %hu: CRC error", wpt_idx);
+}
@@ -0,0 +1,159 @@
+/**
+ *******************************************************************************
+ *      ______  _   __  ______  ____     ______        ___    ______   ____
+ *     / __  / / \ / / / ____/ / __ \   /  ___/       /  /   /_   _/  / __ \
+ *    / /_/ / /   \ / / ____/ /  -- /  /  /__   __   /  /__  _/  /_  / __ <
+ *   /_____/ /_/ \_/ /_____/ /__/ \_\ /_____/  /_/  /_____/ /_____/ /_____/
+ *
+ *     An amateur remote control software library. Use at your own risk.
+ *
+ * @file    mission.h
+ * @brief   Waypoint mission store, the mission is kept in its own ROM region
+ *          and only the active and next legs are kept in RAM.
+ * @author  Y.S.Kuo in Hsinchu
+ *******************************************************************************
+ */
+
+#ifndef MISSION_H_
+#define MISSION_H_
+
+#include <stdint.h>
+
+#include "gps.h"
+
+
+/*
+ *******************************************************************************
+ * Constant value definition
+ *******************************************************************************
+ */
+
+#define MISSION_ID                      0x534d5f31  /* "1_MS" */
+
+/* Mission ROM region, must not overlap with the airplane configuration */
+#define MISSION_ROM_ADDR                0x100
+#define MISSION_ROM_SIZE                0x300       /* 0x100 ~ 0x3FF */
+
+#define MISSION_PAGE_SIZE               64          /* Bytes per ROM page */
+#define MISSION_PAGE_WPT_NUM            15          /* Waypoints per ROM page */
+
+#define MISSION_PAGE_ROM_ADDR(page)     (MISSION_ROM_ADDR + sizeof(MISSION_HEADER)  \
+                                         + (uint16_t)(page) * MISSION_PAGE_SIZE)
+
+#define MISSION_PAGE_NUM                ((MISSION_ROM_SIZE - sizeof(MISSION_HEADER)) / MISSION_PAGE_SIZE)
+#define MISSION_WPT_MAX                 (MISSION_PAGE_NUM * MISSION_PAGE_WPT_NUM)
+
+/* Waypoint offset range from mission origin, +- 32767 meters */
+#define MISSION_WPT_OFFSET_MAX          32767.0
+
+/* L1 guidance */
+#define MISSION_L1_SPEED_RATIO          3.0     /* L1 distance = ratio * ground speed (seconds) */
+#define MISSION_L1_MIN_METERS           20.0    /* Minimum L1 distance */
+#define MISSION_L1_MIN_SPEED_MS         3.0     /* Course over ground is not reliable below this speed */
+#define MISSION_L1_MAX_BANK_ANGLE       30.0    /* +- 30 degree */
+#define MISSION_GRAVITY_MS2             9.80665
+
+
+/*
+ *******************************************************************************
+ * Data type definition
+ *******************************************************************************
+ */
+
+/* Compact waypoint, offset to mission origin in meters */
+typedef struct mission_wpt{
+    int16_t north_m;
+    int16_t east_m;
+}MISSION_WPT;
+
+/* Mission ROM header */
+typedef struct mission_header{
+    uint32_t mission_ID;
+    uint16_t total_wpt;
+    GPS_COORD_POINT origin;             /* Mission origin in decimal degrees format. */
+    uint16_t rom_crc16;
+}MISSION_HEADER;
+
+/* Precomputed leg geometry in local north/east frame of mission origin */
+typedef struct mission_leg{
+    float start_n;                      /* Leg start point, meters */
+    float start_e;
+    float unit_n;                       /* Leg unit vector */
+    float unit_e;
+    float length;                       /* Leg length, meters */
+}MISSION_LEG;
+
+/* L1 guidance output */
+typedef struct mission_guidance{
+    float xtrack_m;                     /* Cross-track error, positive if we are right of the leg */
+    float along_m;                      /* Along-track distance from leg start */
+    float lat_accel;                    /* Lateral acceleration command, m/s^2, positive to right */
+    float bank_angle;                   /* Bank angle command, degrees, positive to right */
+    bool is_leg_done;                   /* Active waypoint is passed */
+}MISSION_GUIDANCE;
+
+/* Mission ROM page */
+typedef struct mission_page{
+    uint8_t page_idx;                   /* Page index, detect misplaced page */
+    uint8_t wpt_cnt;                    /* Total used waypoints in this page */
+    MISSION_WPT wpt[MISSION_PAGE_WPT_NUM];
+    uint16_t rom_crc16;
+}MISSION_PAGE;
+
+
+/*
+ *******************************************************************************
+ * Global variables
+ *******************************************************************************
+ */
+
+
+/*
+ *******************************************************************************
+ * Public functions declaration
+ *******************************************************************************
+ */
+
+
+/*
+ *******************************************************************************
+ * Private functions declaration
+ *******************************************************************************
+ */
+
+
+/*
+ *******************************************************************************
+ * Public functions
+ *******************************************************************************
+ */
+
+int8_t Mission_Init();
+uint16_t Mission_GetTotalWpt();
+
+int8_t Mission_Start(uint16_t wpt_idx);
+void Mission_Stop();
+int8_t Mission_Advance();
+bool Mission_IsActive();
+uint16_t Mission_GetActiveIdx();
+int8_t Mission_GetActiveWpt(GPS_COORD_POINT *p_coord);
+int8_t Mission_GetNextWpt(GPS_COORD_POINT *p_coord);
+
+int8_t Mission_UpdateFix(GPS_NMEA_REPORT *p_nmea);
+int8_t Mission_UpdateGuidance(uint16_t fix_age_ms, MISSION_GUIDANCE *p_guide);
+
+int8_t Mission_Create(GPS_COORD_POINT *p_origin);
+int8_t Mission_SetWpt(uint16_t wpt_idx, GPS_COORD_POINT *p_coord);
+int8_t Mission_GetWpt(uint16_t wpt_idx, GPS_COORD_POINT *p_coord);
+int8_t Mission_Commit(uint16_t total_wpt);
+int8_t Mission_Task();
+
+
+/*
+ *******************************************************************************
+ * Private functions
+ *******************************************************************************
+ */
+
+
+#endif // MISSION_H_
@@ -279,8 +279,10 @@ ISR(PCINT0_vect)
 
     PC_PrevPinState[grp_idx] = pin_status;
 
-    /* Be carefully, we will enable interrupt temporarily inside RCIN_PulseHandler function. */
+#if RCIN_PWM_EN
+    /* Queue RC input edges, pulses are measured by RCIN_ReadChannels() */
     RCIN_PulseHandler(grp_idx, trig_time, pin_status, pin_change);
+#endif
 
     DEBUG_ISR_END(PCINT0_vect_num);
 }
@@ -333,12 +335,21 @@ ISR(PCINT2_vect)
     PC_PrevPinState[grp_idx] = pin_status;
 
 #if UARTS_FUNCTION_EN
-    /* Check simulated UART RX pin */
-    UartS_RxPulseHandler(grp_idx, trig_time, pin_status, pin_change);
+    /*
+     * Check simulated UART RX pin first, its bit timing starts from here.
+     * RX pin interrupt is disabled during a byte while RC edges keep updating
+     * PC_PrevPinState, so pin_change may miss the next start bit. Check RX
+     * pin level instead, UartS_RxPulseHandler() also checks if RX pin
+     * interrupt is enabled.
+     */
+    if((pin_status & UARTS_RX_PC_MASK) == 0)
+        UartS_RxPulseHandler(grp_idx, trig_time, pin_status, pin_change);
 #endif
 
-    /* Be carefully, we will enable interrupt temporarily inside RCIN_PulseHandler function. */
+#if RCIN_PWM_EN
+    /* Queue RC input edges, pulses are measured by RCIN_ReadChannels() */
     RCIN_PulseHandler(grp_idx, trig_time, pin_status, pin_change);
+#endif
 
     DEBUG_ISR_END(PCINT2_vect_num);
 }
@@ -24,8 +24,16 @@
  *              Logic CH 3 = Arduino D12 / AVR PB4 / PCINT 4 (PC group 0)
  *              Logic CH 4 = Arduino D08 / AVR PB0 / PCINT 0 (PC group 0)
  *
+ *          PPM-sum mode (RCIN_PPM_EN):
+ *              All channels = Arduino D08 / AVR PB0 / ICP1, AETR order
+ *
+ *          Serial receiver mode (RCIN_SERIAL_EN):
+ *              All channels = Arduino D00 / AVR PD0 / RXD, AETR order
+ *
  *          Hardware:
  *              Pin change detector.
+ *              Timer1 input capture (PPM-sum mode).
+ *              UART0 RX (Serial receiver mode).
  *
  *          Interrupts:
  *              ISR(PCINT0_vect)
@@ -43,6 +51,10 @@
 #include "timers_drv.h"
 #include "uart_stream.h"
 #include "pin_change.h"
+#include "uart_drv.h"
+#include "rc_serial.h"
+#include "ring_buffer.h"
+#include "latency.h"
 
 
 /*
@@ -51,8 +63,14 @@
  *******************************************************************************
  */
 
-/* RX signal LPF ratio, give 0 to disable LPF */
-#define RCIN_LPF_BETA               2
+/* Queued pin change edges of PWM input, power of two */
+#define RCIN_EDGE_QUEUE_SIZE        32
+#define RCIN_EDGE_RISING            0x80    /* ch_edge flag, rising edge */
+#define RCIN_EDGE_CH_MASK           0x7F    /* ch_edge logic channel index */
+#define RCIN_EDGE_LOST              0x7F    /* ch_edge of marker, following edges are dropped */
+
+/* PPM channel index when sync gap is not found yet */
+#define RCIN_PPM_SLOT_NO_SYNC       (RCIN_PPM_CH_MAX + 1)
 
 
 /*
@@ -76,7 +94,7 @@ typedef struct rcin_channel{
     PC_PIN_IDX pc_pin_idx;			/* PC pin index 0~23 */
     PC_GRP_IDX pc_grp_idx;			/* PC group index 0~2 */
     uint8_t update_sequence;        /* Pulse update count of this channel */
-    uint32_t pulse_start;           /* 32 bits */
+    uint16_t pulse_start;           /* Timer1 ticks, lower 16 bits */
     uint16_t pulse_smooth_width;    /* 16 bits, with low pass filter */
     uint16_t neutral_ticks;         /* Default neutral ticks */
     uint16_t max_ticks;             /* To store maximum detected RC input ticks */
@@ -85,6 +103,12 @@ typedef struct rcin_channel{
     bool is_reversed;
 }RCIN_CHANNEL;
 
+/* Pin change edge of a RC input channel, queued by ISR */
+typedef struct rcin_edge{
+    uint16_t trig_time;             /* Timer1 ticks, lower 16 bits */
+    uint8_t ch_edge;                /* Logic channel index | RCIN_EDGE_RISING */
+}RCIN_EDGE;
+
 
 /*
  *******************************************************************************
@@ -95,6 +119,40 @@ typedef struct rcin_channel{
 static uint8_t RCIN_ChannelStatus; /* Status of channels, for fail safe, use 32 bits */
 static uint8_t RCIN_LatestPinValue; /* Previous value of channel pins */
 static uint8_t RCIN_CycUpdateCnt;
+static volatile uint8_t RCIN_FailCnt;   /* Checks with missing channel */
+
+#if RCIN_PWM_EN
+/* Pin change bits to logic channels lookup, built by RCIN_Init() */
+static uint8_t RCIN_PcGrpMask[PC_GRP_TOTAL];        /* RC input pins of each PC group */
+static uint8_t RCIN_PcBitMap[PC_GRP_TOTAL][8];      /* Logic channel of each PC pin bit */
+
+static RingBuffer<RCIN_EDGE, RCIN_EDGE_QUEUE_SIZE> RCIN_EdgeQueue;
+static uint8_t RCIN_PulseStartMask;     /* Channels with rising edge, waiting falling edge */
+#endif
+
+#if RCIN_PPM_EN
+static uint16_t RCIN_PpmLastCapture;    /* Time-stamp of previous PPM edge */
+static uint8_t RCIN_PpmSlotIdx;         /* Index of next PPM channel */
+#endif
+
+#if RCIN_SERIAL_EN
+static RCSER_DATA RCIN_Serial;          /* Serial receiver frame decoder */
+#endif
+
+#if !RCIN_PWM_EN
+/* Logic channel of each PPM or serial frame channel, AETR order */
+static const uint8_t RCIN_SlotMap[RCIN_SLOT_MAX] =
+{
+    RCIN_AILE_IDX,
+    RCIN_ELEV_IDX,
+    RCIN_THRO_IDX,
+    RCIN_RUDD_IDX,
+    RCIN_AUX1_IDX,
+    RCIN_SLOT_UNUSED,
+    RCIN_SLOT_UNUSED,
+    RCIN_SLOT_UNUSED,
+};
+#endif
 
 /* logic RX channel, Arduino PIN, AVR PC PIN mapping and initialization */
 static RCIN_CHANNEL RCIN_Channels[RCIN_CH_TOTAL] =
@@ -188,6 +246,14 @@ static RCIN_CHANNEL RCIN_Channels[RCIN_CH_TOTAL] =
  *******************************************************************************
  */
 
+static void RCIN_UpdatePulse(RCIN_CHANNEL *p_channel, uint16_t pulse_width);
+#if RCIN_PWM_EN
+static void RCIN_ProcessEdges();
+#endif
+#if RCIN_SERIAL_EN
+static uint8_t RCIN_SerialTask();
+static void RCIN_SerialUpdate();
+#endif
 
 /*
  *******************************************************************************
@@ -208,12 +274,42 @@ static RCIN_CHANNEL RCIN_Channels[RCIN_CH_TOTAL] =
  */
 int8_t RCIN_Init()
 {
+#if RCIN_PWM_EN
     uint8_t ch_idx;
+    uint8_t grp_idx;
+    RCIN_CHANNEL *p_channel;
+#endif
 
     RCIN_ChannelStatus = 0;
     RCIN_LatestPinValue = 0;
     RCIN_CycUpdateCnt = 0;
+    RCIN_FailCnt = 0;
+
+#if RCIN_PPM_EN
+    RCIN_PpmLastCapture = 0;
+    RCIN_PpmSlotIdx = RCIN_PPM_SLOT_NO_SYNC;
+
+    pinMode(RCIN_PPM_ARDU_PIN, INPUT);
+
+    Uart0_Println(PSTR("[RCIN] PPM pin: %hhu"), RCIN_PPM_ARDU_PIN);
+
+    /* Capture one edge per channel, noise canceler delays all edges equally */
+    Timer1_SetInputCapture(RCIN_PPM_IS_RISING_EDGE, true, true);
+#elif RCIN_SERIAL_EN
+    RCSER_Init(&RCIN_Serial, RCIN_SERIAL_PROTOCOL);
 
+    Uart0_Println(PSTR("[RCIN] Serial protocol: %hhu"), RCIN_SERIAL_PROTOCOL);
+
+    /* UART0 is shared with telemetry, switch it to receiver setting */
+    if(RCIN_SERIAL_PROTOCOL == RCSER_PROTO_SBUS){
+        Uart0_SetBaud(RCSER_SBUS_BAUD);
+        Uart0_SetFrameFormat(true, true);
+    }
+    else{
+        Uart0_SetBaud(RCSER_IBUS_BAUD);
+        Uart0_SetFrameFormat(false, false);
+    }
+#else
     Uart0_Printf(PSTR("[RCIN] Pins:"));
 
     /* Initial ports */
@@ -225,10 +321,25 @@ int8_t RCIN_Init()
 
     Uart0_Println(PSTR(""));
 
+    RCIN_EdgeQueue.Init();
+    RCIN_PulseStartMask = 0;
+
+    /* Build pin change lookup before the interrupts are enabled */
+    for(grp_idx = 0; grp_idx < PC_GRP_TOTAL; grp_idx++)
+        RCIN_PcGrpMask[grp_idx] = 0;
+
+    for(ch_idx = 0; ch_idx < RCIN_CH_TOTAL; ch_idx++){
+        p_channel = &RCIN_Channels[ch_idx];
+
+        RCIN_PcGrpMask[p_channel->pc_grp_idx] |= p_channel->mask;
+        RCIN_PcBitMap[p_channel->pc_grp_idx][p_channel->pc_pin_idx & 0x07] = ch_idx;
+    }
+
     /* Enable corresponding pin change interrupt for specific RCIN channel */
     for(ch_idx = 0; ch_idx < RCIN_CH_TOTAL; ch_idx++){
         PC_Setup(RCIN_Channels[ch_idx].pc_grp_idx, RCIN_Channels[ch_idx].mask, true);
     }
+#endif
 
     return 0;
 }
@@ -368,6 +479,9 @@ void RCIN_SetFailsafe(uint16_t *p_channel_failsafe_ticks)
  * RCIN_ReadChannels - Function to read current detected pulse width
  *                     of each RC channels.
  *
+ * In PWM input mode, edges queued by pin change ISR are measured here, so
+ * this function should be called periodically (Eg. every control cycle).
+ *
  * @param   [out]       *p_channels     uint16_t array[RCIN_CH_TOTAL] buffer
  *                                      for storing current detected pulse
  *                                      width of RC channels.
@@ -381,6 +495,16 @@ uint8_t RCIN_ReadChannels(uint16_t *p_channels)
     uint8_t old_SREG;
     uint8_t ch_idx;
 
+#if RCIN_PWM_EN
+    /* Measure pulses of edges queued by pin change ISR */
+    RCIN_ProcessEdges();
+#endif
+
+#if RCIN_SERIAL_EN
+    /* Decode frames received since last read */
+    RCIN_SerialTask();
+#endif
+
     /* Store current AVR Status register then disable global interrupt */
     old_SREG = SREG;
     cli();
@@ -513,6 +637,9 @@ bool RCIN_FailChk()
         }
     }
 
+    if(is_error == true)
+        RCIN_FailCnt++;
+
     /* Clear current channel status */
     RCIN_ChannelStatus = 0;
 
@@ -523,13 +650,31 @@ bool RCIN_FailChk()
 }
 
 /**
- * RCIN_PulseHandler - Function to monitor and decode RC input pulse signal.
+ * RCIN_GetFailCnt - Function to get total RCIN_FailChk() calls which found
+ *                   missing channel (failsafe applied), wraps around at 255.
+ *
+ * @param   [none]
  *
- * This function should be called in corresponding "Pin change" ISR.
+ * @return  [uint8_t]   Fail count.
  *
+ */
+uint8_t RCIN_GetFailCnt()
+{
+    return RCIN_FailCnt;
+}
+
+#if RCIN_PWM_EN
+/**
+ * RCIN_PulseHandler - Function to queue edges of RC input pulse signal.
+ *
+ * This function should be called in corresponding "Pin change" ISR, the
+ * global interrupt is kept disabled. Pulses are measured later by
+ * RCIN_ReadChannels(), the ISR only time-stamps the edges. If the queue is
+ * full, the last slot is used by a RCIN_EDGE_LOST marker and the following
+ * edges are dropped.
  *
  * @param   [input]     pc_grp_idx      Index of triggered pin change group.
- * @param   [input]     trig_time       Timestamp when interrupt is triggered (microsecond).
+ * @param   [input]     trig_time       Timestamp when interrupt is triggered (Timer1 ticks).
  * @param   [input]     pin_status      Current IO pin value (High/Low).
  * @param   [input]     pin_change      Pin change status.
  *
@@ -539,85 +684,296 @@ bool RCIN_FailChk()
 void RCIN_PulseHandler(PC_GRP_IDX pc_grp_idx, uint32_t trig_time,
                        uint8_t pin_status, uint8_t pin_change)
 {
+    uint8_t bit_idx;
+    RCIN_EDGE edge;
+
+    /* Only the changed RC input pins of this group */
+    pin_change &= RCIN_PcGrpMask[pc_grp_idx];
+
+    edge.trig_time = (uint16_t)trig_time;
+
+    /* pin_change and pin_status are shifted to bit 0 */
+    for(bit_idx = 0; pin_change != 0; bit_idx++, pin_change >>= 1, pin_status >>= 1){
+
+        if((pin_change & 0x01) == 0)
+            continue;
+
+        edge.ch_edge = RCIN_PcBitMap[pc_grp_idx][bit_idx];
+
+        if(pin_status & 0x01)
+            edge.ch_edge |= RCIN_EDGE_RISING;
+
+        if(RCIN_EdgeQueue.GetFree() > 1){
+            RCIN_EdgeQueue.Put(edge);
+        }
+        else{
+            edge.ch_edge = RCIN_EDGE_LOST;
+            RCIN_EdgeQueue.Put(edge);
+            break;
+        }
+    }
+}
+#endif
+
+#if RCIN_PPM_EN
+/**
+ * RCIN_PpmHandler - Function to decode PPM-sum signal, one edge per channel.
+ *
+ * This function should be called in Timer1 input capture ISR, the global
+ * interrupt is kept disabled.
+ *
+ * The time between two edges is the pulse width of a channel, or the sync
+ * gap before the first channel. Channels are ignored until next sync gap if
+ * an invalid pulse is found. Timer1 is 16 bits, so the edge time-stamps are
+ * compared in 16 bits (32.7 ms).
+ *
+ * @param   [input]     capture_time    Captured Timer1 ticks of the edge.
+ *
+ * @return  [none]
+ *
+ */
+void RCIN_PpmHandler(uint16_t capture_time)
+{
+    uint16_t pulse_width;
     uint8_t ch_idx;
-    uint32_t pulse_width;
-    RCIN_CHANNEL *p_channel;
 
-    /* Enable (nested) interrupt for reducing measurement delay of other channels */
-    sei();
+    pulse_width = capture_time - RCIN_PpmLastCapture;
+    RCIN_PpmLastCapture = capture_time;
 
-    /*
-     * Notice! The global interrupt is already enabled.
-     */
+    /* Sync gap, next edge ends the first channel */
+    if(pulse_width >= RCIN_PPM_SYNC_MIN_TICKS){
 
-    /* Measure channel pulse only if pin value is changed */
-    if(pin_change){
+        /* Increase cycle counter if the last frame is received */
+        if(RCIN_PpmSlotIdx != RCIN_PPM_SLOT_NO_SYNC && RCIN_PpmSlotIdx != 0)
+            RCIN_CycUpdateCnt++;
 
-        /* Scan and compare all channel status, update related information
-         * if the status of specific channel/pin is changed.
-         */
-        for(ch_idx = 0; ch_idx < RCIN_CH_TOTAL; ch_idx++){
+        RCIN_PpmSlotIdx = 0;
+        return;
+    }
 
-            p_channel = &RCIN_Channels[ch_idx];
+    /* Too many channels or invalid pulse, wait for next sync gap */
+    if(RCIN_PpmSlotIdx >= RCIN_PPM_CH_MAX || RCIN_IS_PULSE_VALID(pulse_width) == false){
+        RCIN_PpmSlotIdx = RCIN_PPM_SLOT_NO_SYNC;
+        return;
+    }
 
-            if((pin_change & p_channel->mask) && (pc_grp_idx == p_channel->pc_grp_idx)){
+    ch_idx = RCIN_SlotMap[RCIN_PpmSlotIdx];
+    RCIN_PpmSlotIdx++;
 
-                /* Rising edge, record pulse start time */
-                if(pin_status & p_channel->mask){
-                    p_channel->pulse_start = trig_time;
+    if(ch_idx == RCIN_SLOT_UNUSED)
+        return;
 
-                    /* Disable global interrupt temporarily */
-                    cli();
+    RCIN_UpdatePulse(&RCIN_Channels[ch_idx], pulse_width);
 
-                    /* Increase cycle counter if this is the first pulse in new cycle */
-                    if((uint8_t)(RCIN_CycUpdateCnt + 1) == p_channel->update_sequence)
-                        RCIN_CycUpdateCnt++;
-                    else
-                        p_channel->update_sequence = RCIN_CycUpdateCnt;
+    RCIN_ChannelStatus |= (1 << ch_idx);
 
-                    /* Enable interrupt again */
-                    sei();
-                }
-                /* Falling edge, update detected pulse width */
-                else{
+#if LATENCY_EN
+    if(ch_idx == LATENCY_RCIN_CH)
+        Latency_RcInEdge(capture_time);
+#endif
+}
+#endif
 
-                    pulse_width = trig_time - p_channel->pulse_start;
 
-                    /* Only update pulse value when it is valid */
-                    if(RCIN_IS_PULSE_VALID(pulse_width)){
+/*
+ *******************************************************************************
+ * Private functions
+ *******************************************************************************
+ */
 
-                        /* Disable global interrupt temporarily */
-                        cli();
+#if RCIN_PWM_EN
+/**
+ * RCIN_ProcessEdges - Function to measure pulses of queued edges, this
+ *                     function must not be called in ISR.
+ *
+ * Pulse width is the time between rising and falling edge of a channel, a
+ * falling edge without queued rising edge (Eg. dropped) is ignored.
+ * Time-stamps are 16 bits, so all started pulses are dropped after a
+ * RCIN_EDGE_LOST marker, otherwise a late falling edge may wrap around to
+ * a valid width.
+ *
+ * @param   [none]
+ *
+ * @return  [none]
+ *
+ */
+static void RCIN_ProcessEdges()
+{
+    uint8_t old_SREG;
+    uint8_t ch_idx;
+    uint8_t ch_mask;
+    uint16_t pulse_width;
+    RCIN_EDGE edge;
+    RCIN_CHANNEL *p_channel;
+
+    while(RCIN_EdgeQueue.Get(&edge)){
+
+        if(edge.ch_edge == RCIN_EDGE_LOST){
+            RCIN_PulseStartMask = 0;
+            continue;
+        }
+
+        ch_idx = edge.ch_edge & RCIN_EDGE_CH_MASK;
+        ch_mask = (1 << ch_idx);
+        p_channel = &RCIN_Channels[ch_idx];
 
-                        /* Apply low-pass filter */
-                        if(p_channel->pulse_smooth_width == 0){
-                            p_channel->pulse_smooth_width = (int16_t)pulse_width;
-                        }
-                        else{
-                            p_channel->pulse_smooth_width -= ((int16_t)(p_channel->pulse_smooth_width
-                                                                        - pulse_width) >> RCIN_LPF_BETA);
-                        }
+        /* Rising edge, record pulse start time */
+        if(edge.ch_edge & RCIN_EDGE_RISING){
+            p_channel->pulse_start = edge.trig_time;
+            RCIN_PulseStartMask |= ch_mask;
 
-                        p_channel->update_sequence++;
+            /* Increase cycle counter if this is the first pulse in new cycle */
+            if((uint8_t)(RCIN_CycUpdateCnt + 1) == p_channel->update_sequence)
+                RCIN_CycUpdateCnt++;
+            else
+                p_channel->update_sequence = RCIN_CycUpdateCnt;
 
-                        /* Enable interrupt again */
-                        sei();
+            continue;
+        }
+
+        /* Falling edge, update detected pulse width */
+        if((RCIN_PulseStartMask & ch_mask) == 0)
+            continue;
+
+        RCIN_PulseStartMask &= ~ch_mask;
+
+        pulse_width = edge.trig_time - p_channel->pulse_start;
+
+        /* Only update pulse value when it is valid */
+        if(RCIN_IS_PULSE_VALID(pulse_width)){
 
-                        RCIN_ChannelStatus |= (1 << ch_idx);
+            /* Channel is also updated by RCIN_FailChk() in ISR */
+            old_SREG = SREG;
+            cli();
 
-                    }
-                }
+            RCIN_UpdatePulse(p_channel, pulse_width);
 
-            }
+            RCIN_ChannelStatus |= ch_mask;
+
+            SREG = old_SREG;
+
+#if LATENCY_EN
+            if(ch_idx == LATENCY_RCIN_CH)
+                Latency_RcInEdge(edge.trig_time);
+#endif
         }
     }
+}
+#endif
 
-    /* Disable global interrupt before we return to ISR */
-    cli();
+/**
+ * RCIN_UpdatePulse - Function to update smoothed pulse width of a channel,
+ *                    global interrupt must be disabled.
+ *
+ * @param   [in/out]    *p_channel      RC input channel.
+ * @param   [input]     pulse_width     Valid pulse width (ticks).
+ *
+ * @return  [none]
+ *
+ */
+static void RCIN_UpdatePulse(RCIN_CHANNEL *p_channel, uint16_t pulse_width)
+{
+    /* Apply low-pass filter */
+    if(p_channel->pulse_smooth_width == 0){
+        p_channel->pulse_smooth_width = (int16_t)pulse_width;
+    }
+    else{
+        p_channel->pulse_smooth_width -= ((int16_t)(p_channel->pulse_smooth_width
+                                                    - pulse_width) >> RCIN_LPF_BETA);
+    }
+
+    p_channel->update_sequence++;
 }
 
-/*
- *******************************************************************************
- * Private functions
- *******************************************************************************
+#if RCIN_SERIAL_EN
+/**
+ * RCIN_SerialTask - Function to decode serial receiver frames in UART0 RX
+ *                   FIFO, it's called by RCIN_ReadChannels(), which should
+ *                   be called periodically (at least once per 5 frames,
+ *                   before RX FIFO is full).
+ *
+ * Only channels of the latest frame are applied. Channels are not updated
+ * by frames with frame lost or failsafe flag, so RCIN_FailChk() applies
+ * failsafe setting if the receiver keeps reporting them.
+ *
+ * @param   [none]
+ *
+ * @return  [uint8_t]   Number of decoded frames.
+ *
  */
+static uint8_t RCIN_SerialTask()
+{
+    const uint8_t *p_data;
+    uint8_t bytes;
+    uint8_t peek_cnt;
+    uint8_t frm_cnt;
+
+    frm_cnt = 0;
+
+    /* Received data may wrap around the end of RX FIFO */
+    for(peek_cnt = 0; peek_cnt < 2; peek_cnt++){
+
+        bytes = Uart0_ReadPeek(&p_data);
+
+        if(bytes == 0)
+            break;
+
+        frm_cnt += RCSER_Parse(&RCIN_Serial, p_data, bytes);
+
+        Uart0_ReadConsume(bytes);
+    }
+
+    if(frm_cnt != 0)
+        RCIN_SerialUpdate();
+
+    return frm_cnt;
+}
+
+/**
+ * RCIN_SerialUpdate - Function to apply channels of the latest serial
+ *                     receiver frame.
+ *
+ * @param   [none]
+ *
+ * @return  [none]
+ *
+ */
+static void RCIN_SerialUpdate()
+{
+    uint8_t old_SREG;
+    uint8_t slot_idx;
+    uint8_t ch_idx;
+    uint16_t pulse_width;
+
+    /* Keep old channels, RCIN_FailChk() takes care of it */
+    if(RCIN_Serial.flags & (RCSER_FLAG_FRAME_LOST | RCSER_FLAG_FAILSAFE))
+        return;
+
+    /* Store current AVR Status register then disable global interrupt */
+    old_SREG = SREG;
+    cli();
+
+    for(slot_idx = 0; slot_idx < RCIN_SLOT_MAX && slot_idx < RCIN_Serial.ch_num; slot_idx++){
+
+        ch_idx = RCIN_SlotMap[slot_idx];
+        pulse_width = RCIN_Serial.ch_ticks[slot_idx];
+
+        if(ch_idx == RCIN_SLOT_UNUSED || RCIN_IS_PULSE_VALID(pulse_width) == false)
+            continue;
+
+        RCIN_UpdatePulse(&RCIN_Channels[ch_idx], pulse_width);
+
+        RCIN_ChannelStatus |= (1 << ch_idx);
+    }
+
+    RCIN_CycUpdateCnt++;
+
+    /* Enable global interrupt */
+    SREG = old_SREG;
+
+#if LATENCY_EN
+    /* No edge time-stamp, the frame is just decoded */
+    Latency_RcInEdge(Timer1_GetTicks16());
+#endif
+}
+#endif
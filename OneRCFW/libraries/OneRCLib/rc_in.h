@@ -18,6 +18,7 @@
 #define RC_IN_H_
 
 #include "pin_change.h"
+#include "rc_serial.h"
 
 
 /*
@@ -39,6 +40,52 @@
 /* Channel and pin change definition */
 #define RCIN_CH_TOTAL   5
 
+/*
+ * PPM-sum input, all channels are sent in one pulse train on ICP1 (Arduino
+ * D08 / AVR PB0, the pin of logic CH 4). Each edge is time-stamped by Timer1
+ * input capture hardware, so there is one short ISR per channel and the
+ * pulse width is not affected by ISR latency. Pin change interrupt is not
+ * used for RC input in this mode.
+ */
+#define RCIN_PPM_EN                 false
+#define RCIN_PPM_ARDU_PIN           8
+#define RCIN_PPM_CH_MAX             RCIN_SLOT_MAX
+#define RCIN_PPM_IS_RISING_EDGE     true    /* Set false for inverted PPM signal */
+
+/* Gap between channel pulses longer than this is the frame sync gap */
+#define RCIN_PPM_SYNC_MIN_TICKS     TIMER1_MICROS_TO_TICKS(3000)
+
+/*
+ * Serial receiver input (SBUS or IBUS, see rc_serial.h) on UART0 RX (Arduino
+ * D00). The ATmega328P has only one hardware UART, so the protocol uplink
+ * is disabled and UART0 TX keeps sending telemetry with the baud rate and
+ * frame format of the receiver. SBUS signal must be inverted by hardware.
+ * Frames are decoded by RCIN_ReadChannels(), pin change interrupt is not
+ * used for RC input in this mode.
+ *
+ * Without uplink, these are not available (ground tool requests are never
+ * received):
+ *      - Baud rate switching (MP_REQ_CFG_BAUD).
+ *      - Parameter, PID, waypoint and ROM mission upload, configuration
+ *        saving, telemetry rate setting and mission start (MP_REQ_CFG_*).
+ *      - Link statistics and latency requests (MP_REQ_SYS_*).
+ *      - FlightGear HIL (IMU_SENSOR_FG_SIM) and NMEA parser benchmark
+ *        (GPS_BENCH_EN), build fails if they are enabled.
+ */
+#define RCIN_SERIAL_EN              false
+#define RCIN_SERIAL_PROTOCOL        RCSER_PROTO_SBUS
+
+#if RCIN_PPM_EN && RCIN_SERIAL_EN
+    #error "RCIN_PPM_EN and RCIN_SERIAL_EN can not be enabled together."
+#endif
+
+/* One PWM pulse per channel pin */
+#define RCIN_PWM_EN                 (!RCIN_PPM_EN && !RCIN_SERIAL_EN)
+
+/* Channels of PPM or serial frame are mapped to logic channels, AETR order */
+#define RCIN_SLOT_MAX               8       /* Max mapped channels in one frame */
+#define RCIN_SLOT_UNUSED            0xFF    /* Channel is not mapped to logic channel */
+
 /* Fail safe check */
 #define RCIN_FAIL_COND  (                               \
                             (1 << RCIN_THRO_IDX)        \
@@ -47,6 +94,9 @@
                             | (1 << RCIN_RUDD_IDX)      \
                         )
 
+/* RX signal LPF ratio, give 0 to disable LPF */
+#define RCIN_LPF_BETA               2
+
 #define RCIN_PULSE_MIN_TICKS        TIMER1_MICROS_TO_TICKS(900)     /* 900 us */
 #define RCIN_PULSE_MAX_TICKS        TIMER1_MICROS_TO_TICKS(2100)    /* 2100 us */
 
@@ -94,6 +144,7 @@
 
 int8_t RCIN_Init();
 bool RCIN_FailChk();
+uint8_t RCIN_GetFailCnt();
 void RCIN_SetDirection(bool *p_channel_is_reversed);
 void RCIN_SetNeutral(uint16_t *p_channel_neutral_ticks);
 void RCIN_SetMaxMinStick(uint16_t *p_max, uint16_t *p_min);
@@ -101,8 +152,13 @@ void RCIN_SetFailsafe(uint16_t *p_channel_failsafe_ticks);
 uint8_t RCIN_ReadChannels(uint16_t *p_channels);
 void RCIN_GetChannelsDiff(uint16_t *p_pulse_in, int16_t *p_pulse_diff);
 
+#if RCIN_PWM_EN
 void RCIN_PulseHandler(PC_GRP_IDX pc_grp_idx, uint32_t trig_time,
                        uint8_t pin_status, uint8_t pin_change);
+#endif
+#if RCIN_PPM_EN
+void RCIN_PpmHandler(uint16_t capture_time);
+#endif
 
 
 /*
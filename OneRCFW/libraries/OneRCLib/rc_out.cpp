@@ -29,6 +29,12 @@
  *          Interrupt:
  *              ISR(TIMER1_COMPA_vect)
  *
+ *          Servo frame:
+ *              RCOUT cycle is free-running every 20 ms by default, it loads
+ *              the pulse widths of last RCOUT_SetServoPWM(). In RCOUT_SYNC_EN
+ *              mode, the frame is started by RCOUT_SetServoPWM() and the
+ *              RCOUT cycle goes idle after the last pulse.
+ *
  * @author  Y.S.Kuo in Hsinchu
  *******************************************************************************
  */
@@ -40,6 +46,7 @@
 #include "rc_out.h"
 #include "timers_drv.h"
 #include "uart_stream.h"
+#include "latency.h"
 
 
 /*
@@ -104,6 +111,10 @@ static uint16_t RCOUT_ServoPWMCycleShiftTime;       /* Shift time of current cyc
 static uint8_t RCOUT_ServoPWMUpdateCnt;             /* Total updated PPM/PWM cycles */
 static uint8_t RCOUT_CurrentChannelIdx;             /* Current working output channel */
 
+#if RCOUT_SYNC_EN
+static uint8_t RCOUT_SyncCtrlCycles;                /* Control cycles since last frame start */
+#endif
+
 /* Data structure for storing RC output channel/pin information */
 static RCOUT_CHANNEL RCOUT_Channels[RCOUT_CH_TOTAL] =
 {
@@ -137,6 +148,9 @@ static RCOUT_CHANNEL RCOUT_Channels[RCOUT_CH_TOTAL] =
  */
 
 static void RCOUT_LoadNewPWMPulse();
+#if RCOUT_SYNC_EN
+static void RCOUT_StartSyncFrame();
+#endif
 static void RCOUT_SetOutputCompare(intptr_t oc_register_addr, RCOUT_OC_MODE mode);
 
 
@@ -175,6 +189,10 @@ int8_t RCOUT_Init()
 
     Uart0_Println(PSTR(""));
 
+#if RCOUT_SYNC_EN
+    /* The first frame is started by the first RCOUT_SetServoPWM() */
+    RCOUT_SyncCtrlCycles = RCOUT_SYNC_CTRL_CYCLES - 1;
+#else
     /* Set OC1A compare timer to launch the PPM cycle if need */
     if(RCOUT_ServoPWMCycleStat == RCOUT_PULSE_IDLE){
 
@@ -193,6 +211,7 @@ int8_t RCOUT_Init()
         /* Enable timer 1A compare interrupt and just waiting for trigger */
         TIMSK1 |= _BV(OCIE1A);
     }
+#endif
 
     return 0;
 }
@@ -217,6 +236,9 @@ uint8_t RCOUT_GetCycUpdateCnt()
  * RCOUT_SetServoPWM - A public function for adjusting width of
  *                     output PWM signals.
  *
+ * In RCOUT_SYNC_EN mode, it should be called once per control cycle, the
+ * servo frame is started every RCOUT_SYNC_CTRL_CYCLES calls.
+ *
  * @param   [in]        *p_channels_width   uint16_t array[] contains
  *                                          new pulse width setting.
  *                                          (The unit is timer1 ticks).
@@ -249,6 +271,18 @@ int8_t RCOUT_SetServoPWM(uint16_t *p_channels_width, uint8_t channel_total)
         RCOUT_Channels[ch_idx].set_pwm_width = p_channels_width[ch_idx];
     }
 
+#if LATENCY_EN
+    Latency_CtrlDone();
+#endif
+
+#if RCOUT_SYNC_EN
+    /* Retry next control cycle if previous frame is not finished */
+    if(RCOUT_SyncCtrlCycles < RCOUT_SYNC_CTRL_CYCLES - 1)
+        RCOUT_SyncCtrlCycles++;
+    else if(RCOUT_ServoPWMCycleStat == RCOUT_PULSE_IDLE)
+        RCOUT_StartSyncFrame();
+#endif
+
     SREG = old_SREG;
 
     return 0;
@@ -276,7 +310,41 @@ static void RCOUT_LoadNewPWMPulse()
         RCOUT_Channels[ch_idx].now_pwm_width = RCOUT_Channels[ch_idx].set_pwm_width;
 
     RCOUT_ServoPWMUpdateCnt++;
+
+#if LATENCY_EN
+    Latency_RcOutLoad();
+#endif
+}
+
+#if RCOUT_SYNC_EN
+/**
+ * RCOUT_StartSyncFrame - Function to start servo frame with new PWM pulse
+ *                        width setting, interrupts must be disabled.
+ *
+ * @param   [none]
+ *
+ * @return  [none]
+ */
+static void RCOUT_StartSyncFrame()
+{
+    RCOUT_SyncCtrlCycles = 0;
+    RCOUT_CurrentChannelIdx = 0;
+
+    RCOUT_LoadNewPWMPulse();
+
+    /* Same as RCOUT_PULSE_ALL_FINISH, first pulse starts 2 margins later */
+    RCOUT_ServoPWMCycleStartTime = TCNT1 + (RCOUT_PREPARE_MARGIN * 2);
+    RCOUT_ServoPWMCycleShiftTime = RCOUT_ServoPWMCycleStartTime - RCOUT_PREPARE_MARGIN;
+
+    OCR1A = RCOUT_ServoPWMCycleShiftTime;
+
+    RCOUT_ServoPWMCycleStat = RCOUT_PULSE_START;
+
+    /* Clear OC1A interrupt flag of the idle compare chain and enable it */
+    TIFR1 |= _BV(OCF1A);
+    TIMSK1 |= _BV(OCIE1A);
 }
+#endif
 
 /**
  * RCOUT_SetOutputCompare - Function to switch AVR OC1A, OC1B, OC2A, OC2B
@@ -448,6 +516,11 @@ void RCOUT_GenServoPWM()
 
                 RCOUT_SetOutputCompare((intptr_t)p_channel->p_oc_register,
                                        RCOUT_OC_CLEAR);
+
+#if LATENCY_EN
+                /* The falling edge is at the compare time */
+                Latency_RcOutEdge(RCOUT_CurrentChannelIdx, RCOUT_ServoPWMCycleShiftTime);
+#endif
             }
             /* Software based servo PWM signal*/
             else{
@@ -467,6 +540,11 @@ void RCOUT_GenServoPWM()
         /* Already complete all pulse and wait for next cycle */
         case RCOUT_PULSE_ALL_FINISH:
 
+#if RCOUT_SYNC_EN
+            /* Wait for RCOUT_SetServoPWM() to start next frame */
+            TIMSK1 &= ~_BV(OCIE1A);
+            RCOUT_ServoPWMCycleStat = RCOUT_PULSE_IDLE;
+#else
             RCOUT_LoadNewPWMPulse();
             RCOUT_ServoPWMCycleStartTime += RCOUT_CYC_PERIOD_TICKS;
             RCOUT_ServoPWMCycleShiftTime = RCOUT_ServoPWMCycleStartTime - RCOUT_PREPARE_MARGIN;
@@ -474,6 +552,7 @@ void RCOUT_GenServoPWM()
             OCR1A = RCOUT_ServoPWMCycleShiftTime;
 
             RCOUT_ServoPWMCycleStat = RCOUT_PULSE_START;
+#endif
 
             break;
         default:
@@ -32,6 +32,18 @@
 #define RCOUT_ELEV_IDX  2
 #define RCOUT_RUDD_IDX  3
 
+/*
+ * Control synchronous servo frame. A servo frame is started by
+ * RCOUT_SetServoPWM() of every RCOUT_SYNC_CTRL_CYCLES control cycles, new
+ * pulse widths are output right away instead of waiting for the free-running
+ * 20 ms RCOUT cycle, and the frame period is locked to the control cycle.
+ * Frame of 4 channels is up to 10.5 ms, control cycle of a new frame is
+ * skipped if the previous frame is not finished. Servo pulses stop if control
+ * cycles stop.
+ */
+#define RCOUT_SYNC_EN               false
+#define RCOUT_SYNC_CTRL_CYCLES      4       /* 4 x 5 ms = 20 ms frame for analog servos */
+
 
 /*
  *******************************************************************************
@@ -0,0 +1,346 @@
+/**
+ *******************************************************************************
+ *      ______  _   __  ______  ____     ______        ___    ______   ____
+ *     / __  / / \ / / / ____/ / __ \   /  ___/       /  /   /_   _/  / __ \
+ *    / /_/ / /   \ / / ____/ /  -- /  /  /__   __   /  /__  _/  /_  / __ <
+ *   /_____/ /_/ \_/ /_____/ /__/ \_\ /_____/  /_/  /_____/ /_____/ /_____/
+ *
+ *     An amateur remote control software library. Use at your own risk.
+ *
+ * @file    rc_serial.cpp
+ * @brief   Serial RC receiver (SBUS / IBUS) frame decoder.
+ *
+ *          The decoder is fed with received bytes only and has no hardware
+ *          dependency, so recorded byte streams can be decoded on host.
+ *          Channels are converted to Timer1 ticks, same as the values of
+ *          RCIN_ReadChannels().
+ *
+ *          Frames are found by header and checked by end byte (SBUS) or
+ *          checksum (IBUS). If a frame is invalid, the decoder resyncs at
+ *          the next header in the collected bytes.
+ * @author  Y.S.Kuo in Hsinchu
+ *******************************************************************************
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "rc_serial.h"
+#include "timers_drv.h"
+
+
+/*
+ *******************************************************************************
+ * Constant value definition
+ *******************************************************************************
+ */
+
+/* SBUS channel value 0 ~ 2047 is 880 ~ 2159 us, 0.625 us per step */
+#define RCSER_SBUS_BASE_TICKS       TIMER1_MICROS_TO_TICKS(880)
+
+#define RCSER_SBUS_CH_BITS          11
+#define RCSER_SBUS_CH_MASK          0x7FF
+
+/* IBUS channel value is microseconds, upper 4 bits are used by extra channels */
+#define RCSER_IBUS_CH_MASK          0x0FFF
+
+
+/*
+ *******************************************************************************
+ * Data type definition
+ *******************************************************************************
+ */
+
+
+/*
+ *******************************************************************************
+ * Global variables
+ *******************************************************************************
+ */
+
+
+/*
+ *******************************************************************************
+ * Public functions declaration
+ *******************************************************************************
+ */
+
+
+/*
+ *******************************************************************************
+ * Private functions declaration
+ *******************************************************************************
+ */
+
+static uint8_t RCSER_GetFrameSize(RCSER_DATA *p_rs);
+static bool RCSER_IsHeader(RCSER_DATA *p_rs, uint8_t *p_buf, uint8_t bytes);
+static bool RCSER_DecodeSbus(RCSER_DATA *p_rs);
+static bool RCSER_DecodeIbus(RCSER_DATA *p_rs);
+static void RCSER_Resync(RCSER_DATA *p_rs);
+
+
+/*
+ *******************************************************************************
+ * Public functions
+ *******************************************************************************
+ */
+
+/**
+ * RCSER_Init - Function to initialize serial RC decoder.
+ *
+ * @param   [out]       *p_rs       Decoder.
+ * @param   [in]        protocol    Receiver protocol.
+ *
+ * @return  [int8_t]    Function executing result.
+ * @retval  [0]         Success.
+ * @retval  [-1]        Fail.
+ *
+ */
+int8_t RCSER_Init(RCSER_DATA *p_rs, RCSER_PROTOCOL protocol)
+{
+    memset((void *)p_rs, 0, sizeof(RCSER_DATA));
+
+    p_rs->protocol = protocol;
+
+    if(protocol == RCSER_PROTO_SBUS)
+        p_rs->ch_num = RCSER_SBUS_CH_NUM;
+    else if(protocol == RCSER_PROTO_IBUS)
+        p_rs->ch_num = RCSER_IBUS_CH_NUM;
+    else
+        return -1;
+
+    return 0;
+}
+
+/**
+ * RCSER_ParseByte - Function to collect one received byte.
+ *
+ * @param   [in/out]    *p_rs       Decoder.
+ * @param   [in]        data_byte   Received byte.
+ *
+ * @return  [bool]      A frame is decoded, channels and flags are updated.
+ *                      Frame with RCSER_FLAG_FRAME_LOST or RCSER_FLAG_FAILSAFE
+ *                      is also reported, caller must check p_rs->flags.
+ *
+ */
+bool RCSER_ParseByte(RCSER_DATA *p_rs, uint8_t data_byte)
+{
+    bool is_decoded;
+
+    p_rs->buf[p_rs->buf_idx] = data_byte;
+    p_rs->buf_idx++;
+
+    /* Wait for header */
+    if(RCSER_IsHeader(p_rs, p_rs->buf, p_rs->buf_idx) == false){
+        RCSER_Resync(p_rs);
+        return false;
+    }
+
+    if(p_rs->buf_idx < RCSER_GetFrameSize(p_rs))
+        return false;
+
+    if(p_rs->protocol == RCSER_PROTO_SBUS)
+        is_decoded = RCSER_DecodeSbus(p_rs);
+    else
+        is_decoded = RCSER_DecodeIbus(p_rs);
+
+    if(is_decoded == false){
+        p_rs->err_cnt++;
+        RCSER_Resync(p_rs);
+        return false;
+    }
+
+    p_rs->buf_idx = 0;
+    p_rs->frm_cnt++;
+
+    if(p_rs->flags & RCSER_FLAG_FRAME_LOST)
+        p_rs->lost_cnt++;
+
+    if(p_rs->flags & RCSER_FLAG_FAILSAFE)
+        p_rs->failsafe_cnt++;
+
+    return true;
+}
+
+/**
+ * RCSER_Parse - Function to collect received bytes.
+ *
+ * @param   [in/out]    *p_rs       Decoder.
+ * @param   [in]        *p_data     Received bytes.
+ * @param   [in]        bytes       Number of received bytes.
+ *
+ * @return  [uint8_t]   Number of decoded frames, channels and flags are
+ *                      of the last one.
+ *
+ */
+uint8_t RCSER_Parse(RCSER_DATA *p_rs, const uint8_t *p_data, uint8_t bytes)
+{
+    uint8_t idx;
+    uint8_t frm_cnt;
+
+    frm_cnt = 0;
+
+    for(idx = 0; idx < bytes; idx++){
+        if(RCSER_ParseByte(p_rs, p_data[idx]))
+            frm_cnt++;
+    }
+
+    return frm_cnt;
+}
+
+
+/*
+ *******************************************************************************
+ * Private functions
+ *******************************************************************************
+ */
+
+/**
+ * RCSER_GetFrameSize - Function to get frame size of receiver protocol.
+ *
+ * @param   [in]        *p_rs       Decoder.
+ *
+ * @return  [uint8_t]   Frame bytes.
+ *
+ */
+static uint8_t RCSER_GetFrameSize(RCSER_DATA *p_rs)
+{
+    if(p_rs->protocol == RCSER_PROTO_SBUS)
+        return RCSER_SBUS_FRM_SIZE;
+
+    return RCSER_IBUS_FRM_SIZE;
+}
+
+/**
+ * RCSER_IsHeader - Function to check if collected bytes can be start of
+ *                  a frame.
+ *
+ * @param   [in]        *p_rs       Decoder.
+ * @param   [in]        *p_buf      Collected bytes.
+ * @param   [in]        bytes       Number of collected bytes, at least 1.
+ *
+ * @return  [bool]      The bytes match frame header.
+ *
+ */
+static bool RCSER_IsHeader(RCSER_DATA *p_rs, uint8_t *p_buf, uint8_t bytes)
+{
+    if(p_rs->protocol == RCSER_PROTO_SBUS)
+        return (p_buf[0] == RCSER_SBUS_HDR);
+
+    if(p_buf[0] != RCSER_IBUS_HDR)
+        return false;
+
+    return (bytes < 2 || p_buf[1] == RCSER_IBUS_CMD);
+}
+
+/**
+ * RCSER_DecodeSbus - Function to decode collected SBUS frame.
+ *
+ * Frame: header, 16 channels of 11 bits (LSB first, 22 bytes), flags and
+ * end byte (0x00, or 0x04/0x14/0x24/0x34 of SBUS2).
+ *
+ * @param   [in/out]    *p_rs       Decoder.
+ *
+ * @return  [bool]      Frame is valid.
+ *
+ */
+static bool RCSER_DecodeSbus(RCSER_DATA *p_rs)
+{
+    uint8_t end_byte;
+    uint8_t ch_idx;
+    uint8_t byte_idx;
+    uint8_t bit_shift;
+    uint32_t bits;
+    uint16_t value;
+
+    end_byte = p_rs->buf[RCSER_SBUS_FRM_SIZE - 1];
+
+    if(end_byte != 0x00 && (end_byte & 0xCF) != 0x04)
+        return false;
+
+    for(ch_idx = 0; ch_idx < RCSER_SBUS_CH_NUM; ch_idx++){
+
+        byte_idx = 1 + ((uint16_t)ch_idx * RCSER_SBUS_CH_BITS) / 8;
+        bit_shift = ((uint16_t)ch_idx * RCSER_SBUS_CH_BITS) % 8;
+
+        /* 11 bits always fit in 3 bytes */
+        bits = (uint32_t)p_rs->buf[byte_idx]
+               | ((uint32_t)p_rs->buf[byte_idx + 1] << 8)
+               | ((uint32_t)p_rs->buf[byte_idx + 2] << 16);
+
+        value = (bits >> bit_shift) & RCSER_SBUS_CH_MASK;
+
+        /* 0.625 us = 1.25 ticks */
+        p_rs->ch_ticks[ch_idx] = RCSER_SBUS_BASE_TICKS + value + (value >> 2);
+    }
+
+    p_rs->flags = p_rs->buf[RCSER_SBUS_FLAGS_IDX] & (RCSER_FLAG_FRAME_LOST | RCSER_FLAG_FAILSAFE);
+
+    return true;
+}
+
+/**
+ * RCSER_DecodeIbus - Function to decode collected IBUS frame.
+ *
+ * Frame: length (0x20), command (0x40), 14 channels of uint16 in
+ * microseconds and checksum (0xFFFF - sum of previous bytes), little endian.
+ * IBUS has no failsafe flag, the receiver stops sending frames instead.
+ *
+ * @param   [in/out]    *p_rs       Decoder.
+ *
+ * @return  [bool]      Frame is valid.
+ *
+ */
+static bool RCSER_DecodeIbus(RCSER_DATA *p_rs)
+{
+    uint16_t chksum;
+    uint16_t value;
+    uint8_t idx;
+    uint8_t ch_idx;
+
+    chksum = 0xFFFF;
+
+    for(idx = 0; idx < RCSER_IBUS_FRM_SIZE - 2; idx++)
+        chksum -= p_rs->buf[idx];
+
+    if(chksum != (p_rs->buf[RCSER_IBUS_FRM_SIZE - 2]
+                  | ((uint16_t)p_rs->buf[RCSER_IBUS_FRM_SIZE - 1] << 8)))
+        return false;
+
+    for(ch_idx = 0; ch_idx < RCSER_IBUS_CH_NUM; ch_idx++){
+
+        value = p_rs->buf[2 + ch_idx * 2] | ((uint16_t)p_rs->buf[3 + ch_idx * 2] << 8);
+        value &= RCSER_IBUS_CH_MASK;
+
+        p_rs->ch_ticks[ch_idx] = TIMER1_MICROS_TO_TICKS(value);
+    }
+
+    p_rs->flags = 0;
+
+    return true;
+}
+
+/**
+ * RCSER_Resync - Function to drop collected bytes until next possible
+ *                frame header.
+ *
+ * @param   [in/out]    *p_rs       Decoder.
+ *
+ * @return  [none]
+ *
+ */
+static void RCSER_Resync(RCSER_DATA *p_rs)
+{
+    uint8_t idx;
+
+    for(idx = 1; idx < p_rs->buf_idx; idx++){
+
+        if(RCSER_IsHeader(p_rs, &p_rs->buf[idx], p_rs->buf_idx - idx)){
+            p_rs->buf_idx -= idx;
+            memmove((void *)p_rs->buf, (void *)&p_rs->buf[idx], p_rs->buf_idx);
+            return;
+        }
+    }
+
+    p_rs->buf_idx = 0;
+}
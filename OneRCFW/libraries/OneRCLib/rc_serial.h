@@ -0,0 +1,116 @@
+/**
+ *******************************************************************************
+ *      ______  _   __  ______  ____     ______        ___    ______   ____
+ *     / __  / / \ / / / ____/ / __ \   /  ___/       /  /   /_   _/  / __ \
+ *    / /_/ / /   \ / / ____/ /  -- /  /  /__   __   /  /__  _/  /_  / __ <
+ *   /_____/ /_/ \_/ /_____/ /__/ \_\ /_____/  /_/  /_____/ /_____/ /_____/
+ *
+ *     An amateur remote control software library. Use at your own risk.
+ *
+ * @file    rc_serial.h
+ * @brief   Serial RC receiver (SBUS / IBUS) frame decoder.
+ * @author  Y.S.Kuo in Hsinchu
+ *******************************************************************************
+ */
+
+#ifndef RC_SERIAL_H_
+#define RC_SERIAL_H_
+
+#include <stdint.h>
+
+
+/*
+ *******************************************************************************
+ * Constant value definition
+ *******************************************************************************
+ */
+
+#define RCSER_CH_MAX                16      /* Max channels per frame */
+#define RCSER_FRM_MAX_SIZE          32      /* Max frame bytes of all protocols */
+
+/* SBUS, 100000 baud, 8E2, inverted signal, 25 bytes frame every 7 or 14 ms */
+#define RCSER_SBUS_BAUD             100000UL
+#define RCSER_SBUS_FRM_SIZE         25
+#define RCSER_SBUS_HDR              0x0F
+#define RCSER_SBUS_CH_NUM           16
+#define RCSER_SBUS_FLAGS_IDX        23
+
+/* IBUS, 115200 baud, 8N1, 32 bytes frame every 7 ms */
+#define RCSER_IBUS_BAUD             115200UL
+#define RCSER_IBUS_FRM_SIZE         32
+#define RCSER_IBUS_HDR              0x20    /* Frame length */
+#define RCSER_IBUS_CMD              0x40    /* Channel data command */
+#define RCSER_IBUS_CH_NUM           14
+
+/* Frame flags, same bits as SBUS flags byte */
+#define RCSER_FLAG_FRAME_LOST       0x04    /* Receiver missed a frame, channels are old */
+#define RCSER_FLAG_FAILSAFE         0x08    /* Receiver is in failsafe */
+
+
+/*
+ *******************************************************************************
+ * Data type definition
+ *******************************************************************************
+ */
+
+typedef enum rcser_protocol{
+    RCSER_PROTO_SBUS                            = 0,
+    RCSER_PROTO_IBUS,
+}__attribute__((packed)) RCSER_PROTOCOL;
+
+typedef struct rcser_data{
+    RCSER_PROTOCOL protocol;
+    uint8_t buf[RCSER_FRM_MAX_SIZE];    /* Collecting frame */
+    uint8_t buf_idx;                    /* Collected frame bytes */
+
+    uint16_t ch_ticks[RCSER_CH_MAX];    /* Channels of last frame, Timer1 ticks */
+    uint8_t ch_num;                     /* Channels per frame */
+    uint8_t flags;                      /* RCSER_FLAG_* of last frame */
+
+    uint16_t frm_cnt;                   /* Total decoded frames */
+    uint16_t err_cnt;                   /* Total dropped frames, Eg. checksum error */
+    uint16_t lost_cnt;                  /* Total frames with RCSER_FLAG_FRAME_LOST */
+    uint16_t failsafe_cnt;              /* Total frames with RCSER_FLAG_FAILSAFE */
+}RCSER_DATA;
+
+
+/*
+ *******************************************************************************
+ * Global variables
+ *******************************************************************************
+ */
+
+
+/*
+ *******************************************************************************
+ * Public functions declaration
+ *******************************************************************************
+ */
+
+
+/*
+ *******************************************************************************
+ * Private functions declaration
+ *******************************************************************************
+ */
+
+
+/*
+ *******************************************************************************
+ * Public functions
+ *******************************************************************************
+ */
+
+int8_t RCSER_Init(RCSER_DATA *p_rs, RCSER_PROTOCOL protocol);
+bool RCSER_ParseByte(RCSER_DATA *p_rs, uint8_t data_byte);
+uint8_t RCSER_Parse(RCSER_DATA *p_rs, const uint8_t *p_data, uint8_t bytes);
+
+
+/*
+ *******************************************************************************
+ * Private functions
+ *******************************************************************************
+ */
+
+
+#endif // RC_SERIAL_H_
@@ -0,0 +1,318 @@
+/**
+ *******************************************************************************
+ *      ______  _   __  ______  ____     ______        ___    ______   ____
+ *     / __  / / \ / / / ____/ / __ \   /  ___/       /  /   /_   _/  / __ \
+ *    / /_/ / /   \ / / ____/ /  -- /  /  /__   __   /  /__  _/  /_  / __ <
+ *   /_____/ /_/ \_/ /_____/ /__/ \_\ /_____/  /_/  /_____/ /_____/ /_____/
+ *
+ *     An amateur remote control software library. Use at your own risk.
+ *
+ * @file    ring_buffer.h
+ * @brief   Power-of-two single producer single consumer ring buffer
+ *          shared by serial FIFOs.
+ * @author  Y.S.Kuo in Hsinchu
+ *******************************************************************************
+ */
+
+#ifndef RING_BUFFER_H_
+#define RING_BUFFER_H_
+
+#include <stdint.h>
+#include <string.h>
+
+
+/*
+ *******************************************************************************
+ * Constant value definition
+ *******************************************************************************
+ */
+
+
+/*
+ *******************************************************************************
+ * Data type definition
+ *******************************************************************************
+ */
+
+/**
+ * RingBuffer - Single producer single consumer FIFO of N elements.
+ *
+ * N must be power of two (2 ~ 256), index is wrapped by mask and one slot is
+ * always kept empty for detecting full FIFO, so N - 1 elements can be stored.
+ *
+ * Producer only changes tail index and consumer only changes head index, both
+ * are single byte which is accessed atomically on AVR, so one side can be an
+ * ISR without disabling interrupt. Element is written or read before the index
+ * is moved, the compiler barrier keeps that order.
+ *
+ * Consumer:    GetUsed(), IsEmpty(), Get(), Read(), Peek(), Consume()
+ * Producer:    GetFree(), Put(), Write(), GetTail(), Poke(), Publish()
+ */
+template <typename T, uint16_t N>
+class RingBuffer{
+
+    static_assert(N >= 2 && N <= 256 && (N & (N - 1)) == 0,
+                  "RingBuffer size must be power of two (2 ~ 256)");
+
+public:
+
+    static const uint8_t MASK = (uint8_t)(N - 1);
+
+    /**
+     * Init - Function to clear FIFO and high-water mark, should not be
+     *        called while the other side is running.
+     */
+    void Init()
+    {
+        head = 0;
+        tail = 0;
+        high_water = 0;
+    }
+
+    /**
+     * GetUsed - Function to get number of elements in FIFO.
+     */
+    uint8_t GetUsed() const
+    {
+        return (uint8_t)(tail - head) & MASK;
+    }
+
+    /**
+     * GetFree - Function to get number of elements can be written to FIFO.
+     */
+    uint8_t GetFree() const
+    {
+        return MASK - GetUsed();
+    }
+
+    bool IsEmpty() const
+    {
+        return (head == tail);
+    }
+
+    /**
+     * GetHighWater - Function to get maximum number of elements which have
+     *                been stored in FIFO since Init().
+     */
+    uint8_t GetHighWater() const
+    {
+        return high_water;
+    }
+
+    /**
+     * Put - Function to write single element to FIFO.
+     *
+     * @return  [bool]      Writing result.
+     * @retval  [true]      Success.
+     * @retval  [false]     FIFO is full.
+     */
+    bool Put(const T &data)
+    {
+        uint8_t tail_next;
+
+        tail_next = (uint8_t)(tail + 1) & MASK;
+        if(tail_next == head)
+            return false;
+
+        buf[tail] = data;
+        Publish(tail_next);
+
+        return true;
+    }
+
+    /**
+     * Write - Function to write elements to FIFO, up to the free space.
+     *
+     * @return  [uint8_t]   Number of written elements.
+     */
+    uint8_t Write(const T *p_data, uint8_t num)
+    {
+        uint8_t tail_idx;
+        uint8_t span;
+        uint8_t free_num;
+
+        free_num = GetFree();
+        if(num > free_num)
+            num = free_num;
+
+        if(num == 0)
+            return 0;
+
+        /* Copy in up to two contiguous parts */
+        tail_idx = tail;
+        span = num;
+        if(span > N - tail_idx)
+            span = (uint8_t)(N - tail_idx);
+
+        memcpy(&buf[tail_idx], p_data, span * sizeof(T));
+        memcpy(&buf[0], &p_data[span], (num - span) * sizeof(T));
+
+        Publish((uint8_t)(tail_idx + num) & MASK);
+
+        return num;
+    }
+
+    /**
+     * GetTail - Function to get index of next written element, the elements
+     *           can be written by Poke() and sent to consumer by Publish(),
+     *           Eg. reserve space for a whole message. Check GetFree() first.
+     */
+    uint8_t GetTail() const
+    {
+        return tail;
+    }
+
+    /**
+     * Next - Function to get index after the index.
+     */
+    static uint8_t Next(uint8_t idx)
+    {
+        return (uint8_t)(idx + 1) & MASK;
+    }
+
+    /**
+     * Poke - Function to write element at index which is not published yet.
+     */
+    void Poke(uint8_t idx, const T &data)
+    {
+        buf[idx & MASK] = data;
+    }
+
+    /**
+     * Publish - Function to move tail index, all the elements before the index
+     *           can be read by consumer.
+     */
+    void Publish(uint8_t tail_idx)
+    {
+        uint8_t used;
+
+        Barrier();
+        tail = tail_idx & MASK;
+
+        used = GetUsed();
+        if(used > high_water)
+            high_water = used;
+    }
+
+    /**
+     * Get - Function to read single element from FIFO.
+     *
+     * @return  [bool]      Reading result.
+     * @retval  [true]      Success.
+     * @retval  [false]     FIFO is empty.
+     */
+    bool Get(T *p_data)
+    {
+        uint8_t head_idx;
+
+        head_idx = head;
+        if(head_idx == tail)
+            return false;
+
+        *p_data = buf[head_idx];
+
+        Barrier();
+        head = (uint8_t)(head_idx + 1) & MASK;
+
+        return true;
+    }
+
+    /**
+     * Read - Function to read elements from FIFO, up to the stored elements.
+     *
+     * @return  [uint8_t]   Number of read elements.
+     */
+    uint8_t Read(T *p_data, uint8_t num)
+    {
+        const T *p_span;
+        uint8_t span;
+        uint8_t cnt;
+
+        /* Copy in up to two contiguous parts */
+        for(cnt = 0; cnt < num; cnt += span){
+
+            span = Peek(&p_span);
+            if(span == 0)
+                break;
+
+            if(span > num - cnt)
+                span = num - cnt;
+
+            memcpy(&p_data[cnt], p_span, span * sizeof(T));
+            Consume(span);
+        }
+
+        return cnt;
+    }
+
+    /**
+     * Peek - Function to get contiguous stored elements without reading them
+     *        out, call Consume() after they are processed.
+     *
+     * @return  [uint8_t]   Number of contiguous elements from *pp_data.
+     */
+    uint8_t Peek(const T **pp_data) const
+    {
+        uint8_t head_idx;
+        uint8_t tail_idx;
+
+        head_idx = head;
+        tail_idx = tail;
+
+        *pp_data = &buf[head_idx];
+
+        if(tail_idx >= head_idx)
+            return tail_idx - head_idx;
+
+        return (uint8_t)(N - head_idx);
+    }
+
+    /**
+     * Consume - Function to drop elements from FIFO, Eg. elements which have
+     *           been processed after Peek().
+     */
+    void Consume(uint8_t num)
+    {
+        if(num > GetUsed())
+            num = GetUsed();
+
+        Barrier();
+        head = (uint8_t)(head + num) & MASK;
+    }
+
+private:
+
+    static void Barrier()
+    {
+        __asm__ __volatile__("" ::: "memory");
+    }
+
+    T buf[N];
+    volatile uint8_t head;              /* Index of next read element */
+    volatile uint8_t tail;              /* Index of next written element */
+    uint8_t high_water;                 /* Maximum number of stored elements */
+};
+
+
+/*
+ *******************************************************************************
+ * Global variables
+ *******************************************************************************
+ */
+
+
+/*
+ *******************************************************************************
+ * Public functions declaration
+ *******************************************************************************
+ */
+
+
+/*
+ *******************************************************************************
+ * Private functions
+ *******************************************************************************
+ */
+
+
+#endif // RING_BUFFER_H_
@@ -79,6 +79,21 @@
  *******************************************************************************
  */
 
+/**
+ * ROM_IsBusy - Function to check whether ROM write procedure is in progress.
+ *
+ * @param   [none]
+ *
+ * @return  [bool]      ROM state.
+ * @retval  [true]      ROM is busy, read or write function will wait for it.
+ * @retval  [false]     ROM is ready.
+ *
+ */
+bool ROM_IsBusy()
+{
+    return (EECR & _BV(EEPE)) ? true : false;
+}
+
 /**
  * ROM_ReadBytes - Function to read ROM data.
  *
@@ -178,6 +193,70 @@ int8_t ROM_UpdateBytes(uint16_t rom_addr, uint8_t *p_data, uint16_t data_size)
     return 0;
 }
 
+/**
+ * ROM_UpdateStep - Function to update ROM data without waiting for the ROM.
+ *
+ * Unchanged bytes are skipped, and at most one byte write is started per call,
+ * so the caller can spread a long update over several control cycles. The
+ * function returns immediately if previous write procedure is not completed.
+ *
+ * @param   [in]        rom_addr        Write ROM address.
+ * @param   [in]        *p_data         Buffer contains new data.
+ * @param   [in]        data_size       Byte size of input buffer.
+ * @param   [in/out]    *p_offset       Offset of next byte to be compared,
+ *                                      set to 0 before the first call.
+ *
+ * @return  [int8_t]    Function executing result.
+ * @retval  [1]         ROM is busy or there are bytes still to be updated.
+ * @retval  [0]         All bytes are updated.
+ * @retval  [-1]        Fail.
+ *
+ */
+int8_t ROM_UpdateStep(uint16_t rom_addr, uint8_t *p_data, uint16_t data_size,
+                      uint16_t *p_offset)
+{
+    uint16_t offset;
+
+    if(p_data == NULL || p_offset == NULL)
+        return -1;
+    if(data_size > ROM_SPACE_SIZE)
+        return -1;
+    if(rom_addr > ROM_SPACE_SIZE - data_size)   /* Boundary check */
+        return -1;
+
+    /* Previous write procedure is not completed yet */
+    if(EECR & _BV(EEPE))
+        return 1;
+
+    offset = *p_offset;
+
+    while(offset < data_size){
+
+        /* Setup read address */
+        EEAR = rom_addr + offset;
+
+        /* Start read procedure */
+        EECR = _BV(EERE);
+
+        /*  Compare and start only one write procedure */
+        if(EEDR != p_data[offset]){
+            EEDR = p_data[offset];
+            EECR = _BV(EEMPE);  /* Ready to erase and write */
+            EECR |= _BV(EEPE);  /* Start procedure */
+
+            *p_offset = offset + 1;
+
+            return 1;
+        }
+
+        offset++;
+    }
+
+    *p_offset = offset;
+
+    return 0;
+}
+
 
 /*
  *******************************************************************************
@@ -61,8 +61,11 @@
  *******************************************************************************
  */
 
+bool ROM_IsBusy();
 int8_t ROM_ReadBytes(uint16_t rom_addr, uint8_t *p_data, uint16_t data_size);
 int8_t ROM_UpdateBytes(uint16_t rom_addr, uint8_t *p_data, uint16_t data_size);
+int8_t ROM_UpdateStep(uint16_t rom_addr, uint8_t *p_data, uint16_t data_size,
+                      uint16_t *p_offset);
 
 
 /*
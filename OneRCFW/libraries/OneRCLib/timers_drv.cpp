@@ -19,6 +19,7 @@
  *          Interrupt:
  *              ISR(TIMER1_OVF_vect)
  *              ISR(TIMER1_COMPA_vect)
+ *              ISR(TIMER1_CAPT_vect) (RCIN_PPM_EN)
  *
  * @author  Y.S.Kuo in Hsinchu
  *******************************************************************************
@@ -31,6 +32,7 @@
 
 #include "timers_drv.h"
 #include "rc_out.h"
+#include "rc_in.h"
 #include "uart_stream.h"
 #include "uart_sim.h"
 #include "debug.h"
@@ -549,6 +551,27 @@ ISR(TIMER1_COMPA_vect)
     DEBUG_ISR_END(TIMER1_COMPA_vect_num);
 }
 
+#if RCIN_PPM_EN
+/**
+ * ISR(TIMER1_CAPT_vect) - Timer/Counter1 Input Capture ISR.
+ *
+ * Called on each edge of PPM-sum signal.
+ *
+ * @param   [none]
+ *
+ * @return  [none]
+ *
+ */
+ISR(TIMER1_CAPT_vect)
+{
+    DEBUG_ISR_START(TIMER1_CAPT_vect_num);
+
+    RCIN_PpmHandler(Timer1_ReadInputCaptureTime());
+
+    DEBUG_ISR_END(TIMER1_CAPT_vect_num);
+}
+#endif
+
 
 /*
  *******************************************************************************
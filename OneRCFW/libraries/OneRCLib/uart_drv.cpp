@@ -27,6 +27,7 @@
 
 #include "uart_drv.h"
 #include "uart_stream.h"
+#include "ring_buffer.h"
 #include "debug.h"
 
 
@@ -36,8 +37,9 @@
  *******************************************************************************
  */
 
-#define UART0_TX_FIFO_SIZE  128     /* TX FIFO size, should not exceed 255 bytes */
-#define UART0_RX_FIFO_SIZE  128     /* RX FIFO size, should not exceed 255 bytes */
+/* Baud setting of double UART speed mode, rounded to nearest */
+#define UART0_BAUD_SETTING(baud)    ((((F_CPU) / 4 / (baud)) - 1) / 2)
+#define UART0_BAUD_SETTING_MAX      0xFFF   /* 12 bits UBRR0 */
 
 
 /*
@@ -53,13 +55,18 @@
  *******************************************************************************
  */
 
-static uint8_t Uart0_TxFifo[UART0_TX_FIFO_SIZE];    /* TX FIFO */
-static volatile uint8_t Uart0_TxFifoHdrIdx;         /* TX FIFO header index */
-static volatile uint8_t Uart0_TxFifoTailIdx;        /* TX FIFO tail index */
+static RingBuffer<uint8_t, UART0_TX_FIFO_SIZE> Uart0_TxFifo;   /* TX FIFO */
+static uint8_t Uart0_TxFifoResvIdx;                 /* TX FIFO write index of reserved space */
 
-static uint8_t Uart0_RxFifo[UART0_RX_FIFO_SIZE];    /* RX FIFO */
-static volatile uint8_t Uart0_RxFifoHdrIdx;         /* RX FIFO header index */
-static volatile uint8_t Uart0_RxFifoTailIdx;        /* RX FIFO tail index */
+static RingBuffer<uint8_t, UART0_RX_FIFO_SIZE> Uart0_RxFifo;   /* RX FIFO */
+
+static uint32_t Uart0_TxBytes;                      /* Total bytes put to TX FIFO */
+static uint32_t Uart0_RxBytes;                      /* Total bytes read from RX FIFO */
+static volatile uint16_t Uart0_RxOverrunCnt;        /* Total data overrun detected in RX ISR */
+static volatile uint16_t Uart0_RxDropCnt;           /* Total bytes dropped because RX FIFO is full */
+
+static uint32_t Uart0_BaudRate;                     /* Current baud rate */
+static bool Uart0_IsTxUsed;                         /* Any data has been sent */
 
 
 /*
@@ -100,27 +107,26 @@ static void Uart0_RecvDataISR();
  */
 int8_t Uart0_Init(uint32_t baud_rate)
 {
-    uint16_t baud_setting;
-
     if(baud_rate == 0)
         return -1;
 
     /* Disable all interrupts */
     cli();
 
-    memset((void *)Uart0_TxFifo, 0, sizeof(Uart0_TxFifo));
-    memset((void *)Uart0_RxFifo, 0, sizeof(Uart0_RxFifo));
+    Uart0_TxFifo.Init();
+    Uart0_RxFifo.Init();
 
-    Uart0_TxFifoHdrIdx = 0;
-    Uart0_TxFifoTailIdx = 0;
-    Uart0_RxFifoHdrIdx = 0;
-    Uart0_RxFifoTailIdx = 0;
+    Uart0_TxFifoResvIdx = 0;
+    Uart0_IsTxUsed = false;
 
-    /* Calculate baud setting based on double UART speed mode */
-    baud_setting = (F_CPU / baud_rate / 8) - 1;
+    Uart0_TxBytes = 0;
+    Uart0_RxBytes = 0;
+    Uart0_RxOverrunCnt = 0;
+    Uart0_RxDropCnt = 0;
 
-    /* Apply baud setting, 12 bits */
-    UBRR0 = (baud_setting & 0xFFF);
+    /* Apply baud setting based on double UART speed mode, 12 bits */
+    Uart0_BaudRate = baud_rate;
+    UBRR0 = (UART0_BAUD_SETTING(baud_rate) & 0xFFF);
 
     /* Enable double UART speed mode */
     UCSR0A |= _BV(U2X0);
@@ -139,6 +145,109 @@ int8_t Uart0_Init(uint32_t baud_rate)
     return 0;
 }
 
+/**
+ * Uart0_SetBaud - Function to change baud rate after all data in TX FIFO are
+ *                 sent out, this function is blocked until TX is done.
+ *
+ *                 Data in RX FIFO are kept.
+ *
+ * @param   [in]        baud_rate   Baud rate setting, Eg. 57600, 250000.
+ *
+ * @return  [int8_t]    Function executing result.
+ * @retval  [0]         Success.
+ * @retval  [-1]        Fail.
+ *
+ */
+int8_t Uart0_SetBaud(uint32_t baud_rate)
+{
+    uint8_t old_SREG;
+
+    if(baud_rate == 0)
+        return -1;
+
+    /* Wait until TX FIFO is empty and the last byte is shifted out */
+    while(Uart0_TxFifo.IsEmpty() == false);
+
+    if(Uart0_IsTxUsed){
+        while((UCSR0A & _BV(TXC0)) == 0);
+    }
+
+    old_SREG = SREG;
+    cli();
+
+    Uart0_BaudRate = baud_rate;
+    UBRR0 = (UART0_BAUD_SETTING(baud_rate) & 0xFFF);
+
+    SREG = old_SREG;
+
+    return 0;
+}
+
+/**
+ * Uart0_SetFrameFormat - Function to change character frame format, call it
+ *                        after Uart0_SetBaud() so TX is already done.
+ *
+ * @param   [in]        is_even_parity      Enable even parity bit.
+ * @param   [in]        is_two_stop_bits    2 stop bits, otherwise 1.
+ *
+ * @return  [int8_t]    Function executing result.
+ * @retval  [0]         Success.
+ *
+ */
+int8_t Uart0_SetFrameFormat(bool is_even_parity, bool is_two_stop_bits)
+{
+    uint8_t ucsr0c;
+
+    /* 8 Bits Character, Asynchronous USART */
+    ucsr0c = (_BV(UCSZ01) | _BV(UCSZ00));
+
+    if(is_even_parity)
+        ucsr0c |= _BV(UPM01);
+
+    if(is_two_stop_bits)
+        ucsr0c |= _BV(USBS0);
+
+    UCSR0C = ucsr0c;
+
+    return 0;
+}
+
+/**
+ * Uart0_GetBaud - Function to get current baud rate.
+ *
+ * @param   [none]
+ *
+ * @return  [uint32_t]  Baud rate.
+ *
+ */
+uint32_t Uart0_GetBaud()
+{
+    return Uart0_BaudRate;
+}
+
+/**
+ * Uart0_IsExactBaud - Function to check whether the baud rate can be generated
+ *                     without error, Eg. 250k, 500k and 1M at 16MHz.
+ *
+ * @param   [in]        baud_rate   Baud rate.
+ *
+ * @return  [bool]      Checking result.
+ * @retval  [true]      No baud rate error.
+ * @retval  [false]     Has baud rate error or not supported (UBRR0 out of
+ *                      12 bits range).
+ *
+ */
+bool Uart0_IsExactBaud(uint32_t baud_rate)
+{
+    if(baud_rate == 0 || baud_rate > F_CPU / 8)
+        return false;
+
+    if(UART0_BAUD_SETTING(baud_rate) > UART0_BAUD_SETTING_MAX)
+        return false;
+
+    return ((F_CPU / 8) % baud_rate == 0);
+}
+
 /**
  * Uart0_ReadBytes - Function to read UART0 data from RX FIFO.
  *
@@ -152,27 +261,12 @@ int8_t Uart0_Init(uint32_t baud_rate)
  */
 uint8_t Uart0_ReadBytes(uint8_t *p_data, uint8_t bytes)
 {
-    uint8_t rx_idx;
-
-    rx_idx = 0;
-
-    while(bytes != 0){
-
-        /* Read buffered data from RX FIFO */
-        if(Uart0_RxFifoHdrIdx != Uart0_RxFifoTailIdx){
-            p_data[rx_idx] = Uart0_RxFifo[Uart0_RxFifoHdrIdx];
-            rx_idx++;
-
-            Uart0_RxFifoHdrIdx = (Uart0_RxFifoHdrIdx + 1) % UART0_RX_FIFO_SIZE;
-        }
-        /* Stop this loop when FIFO is empty */
-        else
-            break;
+    uint8_t cnt;
 
-        bytes--;
-    }
+    cnt = Uart0_RxFifo.Read(p_data, bytes);
+    Uart0_RxBytes += cnt;
 
-    return rx_idx;
+    return cnt;
 }
 
 /**
@@ -187,7 +281,12 @@ uint8_t Uart0_ReadBytes(uint8_t *p_data, uint8_t bytes)
  */
 uint8_t Uart0_ReadByte(uint8_t *p_data)
 {
-    return Uart0_ReadBytes(p_data, 1);
+    if(Uart0_RxFifo.Get(p_data) == false)
+        return 0;
+
+    Uart0_RxBytes++;
+
+    return 1;
 }
 
 /**
@@ -203,12 +302,93 @@ uint8_t Uart0_ReadByte(uint8_t *p_data)
  */
 uint8_t Uart0_ReadAvailable()
 {
-    uint8_t cnt;
+    return Uart0_RxFifo.GetUsed();
+}
 
-    cnt = (uint8_t)(UART0_RX_FIFO_SIZE + Uart0_RxFifoHdrIdx - Uart0_RxFifoTailIdx)
-        % UART0_RX_FIFO_SIZE;
+/**
+ * Uart0_ReadPeek - Function to get contiguous received data in RX FIFO
+ *                  without reading them out, so caller can process them
+ *                  in place and call Uart0_ReadConsume() afterwards.
+ *
+ * @param   [out]       **pp_data   Start of received data.
+ *
+ * @return  [uint8_t]   Number of contiguous received data.
+ * @retval  [0]         No RX data.
+ * @retval  [1~255]     Received Byte size.
+ *
+ */
+uint8_t Uart0_ReadPeek(const uint8_t **pp_data)
+{
+    return Uart0_RxFifo.Peek(pp_data);
+}
 
-    return cnt;
+/**
+ * Uart0_ReadConsume - Function to drop processed data from RX FIFO.
+ *
+ * @param   [in]        bytes       Number of processed bytes.
+ *
+ * @return  [none]
+ *
+ */
+void Uart0_ReadConsume(uint8_t bytes)
+{
+    Uart0_RxFifo.Consume(bytes);
+    Uart0_RxBytes += bytes;
+}
+
+/**
+ * Uart0_GetTxHighWater - Function to get maximum bytes stored in TX FIFO
+ *                        since initialization.
+ *
+ * @param   [none]
+ *
+ * @return  [uint8_t]   Bytes.
+ *
+ */
+uint8_t Uart0_GetTxHighWater()
+{
+    return Uart0_TxFifo.GetHighWater();
+}
+
+/**
+ * Uart0_GetRxHighWater - Function to get maximum bytes stored in RX FIFO
+ *                        since initialization.
+ *
+ * @param   [none]
+ *
+ * @return  [uint8_t]   Bytes.
+ *
+ */
+uint8_t Uart0_GetRxHighWater()
+{
+    return Uart0_RxFifo.GetHighWater();
+}
+
+/**
+ * Uart0_GetStats - Function to get link statistics since initialization.
+ *
+ * @param   [out]       *p_stats    Link statistics.
+ *
+ * @return  [none]
+ *
+ */
+void Uart0_GetStats(UART_STATS *p_stats)
+{
+    uint8_t old_SREG;
+
+    p_stats->tx_bytes = Uart0_TxBytes;
+    p_stats->rx_bytes = Uart0_RxBytes;
+    p_stats->tx_high_water = Uart0_TxFifo.GetHighWater();
+    p_stats->rx_high_water = Uart0_RxFifo.GetHighWater();
+
+    /* Counters of RX ISR */
+    old_SREG = SREG;
+    cli();
+
+    p_stats->rx_err_cnt = Uart0_RxOverrunCnt;
+    p_stats->rx_drop_cnt = Uart0_RxDropCnt;
+
+    SREG = old_SREG;
 }
 
 /**
@@ -282,6 +462,111 @@ uint8_t Uart0_WriteByteNB(uint8_t data)
     return Uart0_WBytes(&data, 1, false);
 }
 
+/**
+ * Uart0_GetTxFree - Function to check free space of TX FIFO.
+ *
+ * @param   [none]
+ *
+ * @return  [uint8_t]   Bytes can be written to TX FIFO without blocking.
+ *
+ */
+uint8_t Uart0_GetTxFree()
+{
+    /* One byte is always kept empty for detecting full FIFO */
+    return Uart0_TxFifo.GetFree();
+}
+
+/**
+ * Uart0_TxReserve - Function to reserve TX FIFO space for a whole message in
+ *                   NON-blocking mode.
+ *
+ *                   The reserved space is filled by Uart0_TxPut(), and the
+ *                   message is sent out after Uart0_TxCommit() is called, so
+ *                   the message is either sent completely or not at all.
+ *
+ * @param   [in]        bytes       Total bytes of the message.
+ *
+ * @return  [bool]      Reserving result.
+ * @retval  [true]      Success.
+ * @retval  [false]     Not enough space in TX FIFO, nothing is reserved.
+ *
+ */
+bool Uart0_TxReserve(uint8_t bytes)
+{
+    if(bytes > Uart0_GetTxFree())
+        return false;
+
+    Uart0_TxFifoResvIdx = Uart0_TxFifo.GetTail();
+
+    return true;
+}
+
+/**
+ * Uart0_TxPut - Function to put one byte to the space reserved by
+ *               Uart0_TxReserve().
+ *
+ *               The FIFO space is not checked here, never put more bytes
+ *               than reserved.
+ *
+ * @param   [in]        data    TX data.
+ *
+ * @return  [none]
+ *
+ */
+void Uart0_TxPut(uint8_t data)
+{
+    Uart0_TxFifo.Poke(Uart0_TxFifoResvIdx, data);
+    Uart0_TxFifoResvIdx = Uart0_TxFifo.Next(Uart0_TxFifoResvIdx);
+}
+
+/**
+ * Uart0_TxMark - Function to get position of next byte put to reserved space,
+ *                the byte can be changed by Uart0_TxPatch() before commit.
+ *
+ * @param   [none]
+ *
+ * @return  [uint8_t]   Position in TX FIFO.
+ *
+ */
+uint8_t Uart0_TxMark()
+{
+    return Uart0_TxFifoResvIdx;
+}
+
+/**
+ * Uart0_TxPatch - Function to change a byte already put to reserved space,
+ *                 Eg. length or code byte which is known after the data.
+ *
+ * @param   [in]        mark    Position returned by Uart0_TxMark().
+ * @param   [in]        data    TX data.
+ *
+ * @return  [none]
+ *
+ */
+void Uart0_TxPatch(uint8_t mark, uint8_t data)
+{
+    Uart0_TxFifo.Poke(mark, data);
+}
+
+/**
+ * Uart0_TxCommit - Function to send out all the bytes put to reserved space.
+ *
+ * @param   [none]
+ *
+ * @return  [none]
+ *
+ */
+void Uart0_TxCommit()
+{
+    Uart0_TxBytes += (uint8_t)(Uart0_TxFifoResvIdx - Uart0_TxFifo.GetTail()) & Uart0_TxFifo.MASK;
+
+    Uart0_TxFifo.Publish(Uart0_TxFifoResvIdx);
+    Uart0_IsTxUsed = true;
+
+    /* Enable data register empty interrupt */
+    UCSR0B |= _BV(UDRIE0);
+}
+
 /**
  * ISR(USART_UDRE_vect) - USART TX data register empty ISR.
  *
@@ -351,26 +636,24 @@ ISR(USART_RX_vect)
 static uint8_t Uart0_WBytes(uint8_t *p_data, uint8_t bytes, bool is_blocking)
 {
     uint8_t cnt;
-    uint8_t tail_next;
+    uint8_t written;
 
-    for(cnt = 0; cnt < bytes; cnt++){
+    cnt = 0;
 
-        tail_next = (Uart0_TxFifoTailIdx + 1) % UART0_TX_FIFO_SIZE;
+    do{
+        /* Put as many data as FIFO space allows, wait for more space if blocking */
+        written = Uart0_TxFifo.Write(&p_data[cnt], bytes - cnt);
 
-        /* Wait if FIFO is full */
-        while(tail_next == Uart0_TxFifoHdrIdx){
-            if(is_blocking == false){
-                return cnt;
-            }
-        }
+        if(written != 0){
+            cnt += written;
+            Uart0_TxBytes += written;
+            Uart0_IsTxUsed = true;
 
-        /* Put data to FIFO */
-        Uart0_TxFifo[Uart0_TxFifoTailIdx] = p_data[cnt];
-        Uart0_TxFifoTailIdx = tail_next;
+            /* Enable data register empty interrupt */
+            UCSR0B |= _BV(UDRIE0);
+        }
 
-        /* Enable data register empty interrupt */
-        UCSR0B |= _BV(UDRIE0);
-    }
+    }while(cnt < bytes && is_blocking == true);
 
     return cnt;
 }
@@ -388,14 +671,16 @@ static uint8_t Uart0_WBytes(uint8_t *p_data, uint8_t bytes, bool is_blocking)
  */
 static void Uart0_SendDataISR()
 {
-    /* Assign new TX data to TX register */
-    UDR0 = Uart0_TxFifo[Uart0_TxFifoHdrIdx];
+    uint8_t tx_data;
 
-    /* Shift FIFO header index */
-    Uart0_TxFifoHdrIdx = (Uart0_TxFifoHdrIdx + 1) % UART0_TX_FIFO_SIZE;
+    /* Assign new TX data to TX register, clear TX complete flag (write 1) */
+    if(Uart0_TxFifo.Get(&tx_data)){
+        UDR0 = tx_data;
+        UCSR0A |= _BV(TXC0);
+    }
 
     /* Disable data register empty interrupt if FIFO is empty */
-    if(Uart0_TxFifoHdrIdx == Uart0_TxFifoTailIdx)
+    if(Uart0_TxFifo.IsEmpty())
         UCSR0B &= ~(_BV(UDRIE0));
 }
 
@@ -412,17 +697,16 @@ static void Uart0_SendDataISR()
  */
 static void Uart0_RecvDataISR()
 {
-    uint8_t tail_next;
     uint8_t rx_data;
 
+    /* Data overrun flag is only valid before UDR0 is read */
+    if(UCSR0A & _BV(DOR0))
+        Uart0_RxOverrunCnt++;
+
     /* Take out new incoming data from register */
     rx_data = UDR0;
 
-    tail_next = (Uart0_RxFifoTailIdx + 1) % UART0_RX_FIFO_SIZE;
-
     /* Store incoming data if there is space in FIFO */
-    if(tail_next != Uart0_RxFifoHdrIdx){
-        Uart0_RxFifo[Uart0_RxFifoTailIdx] = rx_data;
-        Uart0_RxFifoTailIdx = tail_next;
-    }
+    if(Uart0_RxFifo.Put(rx_data) == false)
+        Uart0_RxDropCnt++;
 }
@@ -25,6 +25,13 @@
  *******************************************************************************
  */
 
+/*
+ * FIFO size must be power of two (2 ~ 256), see RingBuffer.
+ * 128 bytes TX FIFO is drained in 5.1 ms at 250k baud, about one control cycle.
+ */
+#define UART0_TX_FIFO_SIZE  128     /* TX FIFO size */
+#define UART0_RX_FIFO_SIZE  128     /* RX FIFO size */
+
 
 /*
  *******************************************************************************
@@ -32,6 +39,15 @@
  *******************************************************************************
  */
 
+/* Link statistics of UART port, byte counters are counted in main loop */
+typedef struct uart_stats{
+    uint32_t tx_bytes;                  /* Total bytes put to TX FIFO */
+    uint32_t rx_bytes;                  /* Total bytes read from RX FIFO */
+    uint16_t rx_err_cnt;                /* Total bytes lost in receiver, UART0: data overrun, UartS: frame error */
+    uint16_t rx_drop_cnt;               /* Total bytes dropped because RX FIFO is full */
+    uint8_t tx_high_water;              /* Max bytes stored in TX FIFO */
+    uint8_t rx_high_water;              /* Max bytes stored in RX FIFO */
+}UART_STATS;
 
 /*
  *******************************************************************************
@@ -47,13 +63,28 @@
  */
 
 int8_t Uart0_Init(uint32_t baud_rate);
+int8_t Uart0_SetBaud(uint32_t baud_rate);
+int8_t Uart0_SetFrameFormat(bool is_even_parity, bool is_two_stop_bits);
+uint32_t Uart0_GetBaud();
+bool Uart0_IsExactBaud(uint32_t baud_rate);
 uint8_t Uart0_WriteBytes(uint8_t *p_data, uint8_t bytes);
 uint8_t Uart0_WriteBytesNB(uint8_t *p_data, uint8_t bytes);
 uint8_t Uart0_WriteByte(uint8_t data);
 uint8_t Uart0_WriteByteNB(uint8_t data);
+uint8_t Uart0_GetTxFree();
+bool Uart0_TxReserve(uint8_t bytes);
+void Uart0_TxPut(uint8_t data);
+uint8_t Uart0_TxMark();
+void Uart0_TxPatch(uint8_t mark, uint8_t data);
+void Uart0_TxCommit();
 uint8_t Uart0_ReadBytes(uint8_t *p_data, uint8_t bytes);
 uint8_t Uart0_ReadByte(uint8_t *p_data);
 uint8_t Uart0_ReadAvailable();
+uint8_t Uart0_ReadPeek(const uint8_t **pp_data);
+void Uart0_ReadConsume(uint8_t bytes);
+uint8_t Uart0_GetTxHighWater();
+uint8_t Uart0_GetRxHighWater();
+void Uart0_GetStats(UART_STATS *p_stats);
 
 
 /*
@@ -41,6 +41,7 @@
 #include "pin_change.h"
 #include "uart_stream.h"
 #include "uart_drv.h"
+#include "ring_buffer.h"
 #include "debug.h"
 
 #if UARTS_FUNCTION_EN
@@ -54,8 +55,10 @@
 
 #define UARTS_LIMIT_BAUD_RATE       9600
 
-#define UARTS_TX_FIFO_SIZE          32      /* TX FIFO size, should not exceed 255 bytes */
-#define UARTS_RX_FIFO_SIZE          32      /* RX FIFO size, should not exceed 255 bytes */
+/* FIFO size must be power of two (2 ~ 256), see RingBuffer */
+#define UARTS_TX_FIFO_SIZE          32      /* TX FIFO size */
+#define UARTS_RX_FIFO_SIZE          32      /* RX FIFO size */
+#define UARTS_RX_MARK_FIFO_SIZE     4       /* RX mark time-stamp FIFO size */
 
 #define UARTS_TX_HIGH               1
 #define UARTS_TX_LOW                0
@@ -103,7 +106,7 @@ typedef enum uarts_oc_mode{
 
 /* Simulated UART TX and RX pin configuration */
 static UARTS_PIN UartS_TxPin = {5, PC_PIN_MASK_21, PC_PIN_IDX_21, PC_GRP_IDX_2};
-static UARTS_PIN UartS_RxPin = {6, PC_PIN_MASK_22, PC_PIN_IDX_22, PC_GRP_IDX_2};
+static UARTS_PIN UartS_RxPin = {UARTS_RX_ARDU_PIN, UARTS_RX_PC_MASK, UARTS_RX_PC_IDX, UARTS_RX_PC_GRP_IDX};
 
 static uint8_t UartS_OnePulseTicks;
 
@@ -111,20 +114,23 @@ static bool UartS_IsTXIdle;                         /* TX idle status */
 static uint8_t UartS_TxPulseCnt;
 static uint8_t UartS_TxStartTicks;
 static uint8_t UartS_TxDataByte;
-static uint8_t UartS_TxFifo[UARTS_TX_FIFO_SIZE];    /* TX FIFO */
-static volatile uint8_t UartS_TxFifoHdrIdx;         /* TX FIFO header index */
-static volatile uint8_t UartS_TxFifoTailIdx;        /* TX FIFO tail index */
+static uint32_t UartS_TxBytes;                      /* Total bytes put to TX FIFO */
+static RingBuffer<uint8_t, UARTS_TX_FIFO_SIZE> UartS_TxFifo;   /* TX FIFO */
 
 static bool UartS_IsRxPinChgInterruptEn;
 static uint8_t UartS_RxPulseCnt;
 
 static uint8_t UartS_RxPulseStartTicks;
 static uint8_t UartS_RxDataByte;
-static uint8_t UartS_RxErrCnt;
-static uint8_t UartS_RxDropCnt;
-static uint8_t UartS_RxFifo[UARTS_RX_FIFO_SIZE];    /* RX FIFO */
-static volatile uint8_t UartS_RxFifoHdrIdx;         /* RX FIFO header index */
-static volatile uint8_t UartS_RxFifoTailIdx;        /* RX FIFO tail index */
+static volatile uint16_t UartS_RxErrCnt;            /* Total bytes with frame error */
+static volatile uint16_t UartS_RxDropCnt;           /* Total bytes dropped because RX FIFO is full */
+static uint32_t UartS_RxBytes;                      /* Total bytes read from RX FIFO */
+static RingBuffer<uint8_t, UARTS_RX_FIFO_SIZE> UartS_RxFifo;   /* RX FIFO */
+
+static uint32_t UartS_RxStartTicks;                         /* Start bit time-stamp of current RX byte */
+static uint8_t UartS_RxMarks[UARTS_RX_MARK_MAX];            /* Byte values need to be time-stamped */
+static uint8_t UartS_RxMarkNum;
+static RingBuffer<uint32_t, UARTS_RX_MARK_FIFO_SIZE> UartS_RxMarkFifo;    /* Start bit time-stamp of received marks */
 
 
 /*
@@ -170,8 +176,8 @@ int8_t UartS_Init(uint32_t baud_rate)
     if(baud_rate != UARTS_LIMIT_BAUD_RATE)
         return -1;
 
-    memset((void *)UartS_TxFifo, 0, sizeof(UartS_TxFifo));
-    memset((void *)UartS_RxFifo, 0, sizeof(UartS_RxFifo));
+    UartS_TxFifo.Init();
+    UartS_RxFifo.Init();
 
     /* Initialize basic parameters */
     UartS_OnePulseTicks = (uint8_t)(TIMER0_MICROS_TO_TICKS(1000000) / baud_rate);
@@ -181,8 +187,7 @@ int8_t UartS_Init(uint32_t baud_rate)
     UartS_TxPulseCnt = 0;
     UartS_TxStartTicks = 0;
     UartS_TxDataByte = 0;
-    UartS_TxFifoHdrIdx = 0;
-    UartS_TxFifoTailIdx = 0;
+    UartS_TxBytes = 0;
 
     /* Initialize RX parameters */
     UartS_RxPulseCnt = 0;
@@ -190,9 +195,11 @@ int8_t UartS_Init(uint32_t baud_rate)
     UartS_RxDataByte = 0;
     UartS_RxErrCnt = 0;
     UartS_RxDropCnt = 0;
+    UartS_RxBytes = 0;
     UartS_IsRxPinChgInterruptEn = true;
-    UartS_RxFifoHdrIdx = 0;
-    UartS_RxFifoTailIdx = 0;
+    UartS_RxStartTicks = 0;
+    UartS_RxMarkNum = 0;
+    UartS_RxMarkFifo.Init();
 
     /* Initialize simulated UART TX pin to output mode and force OC0B output HIGH by default */
     pinMode(UartS_TxPin.ardu_pin, OUTPUT);
@@ -223,27 +230,12 @@ int8_t UartS_Init(uint32_t baud_rate)
  */
 uint8_t UartS_ReadBytes(uint8_t *p_data, uint8_t bytes)
 {
-    uint8_t rx_idx;
-
-    rx_idx = 0;
-
-    while(bytes != 0){
-
-        /* Read buffered data from RX FIFO */
-        if(UartS_RxFifoHdrIdx != UartS_RxFifoTailIdx){
-            p_data[rx_idx] = UartS_RxFifo[UartS_RxFifoHdrIdx];
-            rx_idx++;
-
-            UartS_RxFifoHdrIdx = (UartS_RxFifoHdrIdx + 1) % UARTS_RX_FIFO_SIZE;
-        }
-        /* Stop this loop when FIFO is empty */
-        else
-            break;
+    uint8_t cnt;
 
-        bytes--;
-    }
+    cnt = UartS_RxFifo.Read(p_data, bytes);
+    UartS_RxBytes += cnt;
 
-    return rx_idx;
+    return cnt;
 }
 
 /**
@@ -259,7 +251,12 @@ uint8_t UartS_ReadBytes(uint8_t *p_data, uint8_t bytes)
  */
 uint8_t UartS_ReadByte(uint8_t *p_data)
 {
-    return UartS_ReadBytes(p_data, 1);
+    if(UartS_RxFifo.Get(p_data) == false)
+        return 0;
+
+    UartS_RxBytes++;
+
+    return 1;
 }
 
 /**
@@ -275,13 +272,95 @@ uint8_t UartS_ReadByte(uint8_t *p_data)
  */
 uint8_t UartS_ReadAvailable()
 {
+    return UartS_RxFifo.GetUsed();
+}
 
-    uint8_t cnt;
+/**
+ * UartS_ReadPeek - Function to get contiguous received data in RX FIFO of
+ *                  simulated UART without reading them out, so caller can
+ *                  process them in place and call UartS_ReadConsume() afterwards.
+ *
+ * @param   [out]       **pp_data   Start of received data.
+ *
+ * @return  [uint8_t]   Number of contiguous received data.
+ * @retval  [0]         No RX data.
+ * @retval  [1~255]     Received Byte size.
+ *
+ */
+uint8_t UartS_ReadPeek(const uint8_t **pp_data)
+{
+    return UartS_RxFifo.Peek(pp_data);
+}
+
+/**
+ * UartS_ReadConsume - Function to drop processed data from RX FIFO of
+ *                     simulated UART.
+ *
+ * @param   [in]        bytes       Number of processed bytes.
+ *
+ * @return  [none]
+ *
+ */
+void UartS_ReadConsume(uint8_t bytes)
+{
+    UartS_RxFifo.Consume(bytes);
+    UartS_RxBytes += bytes;
+}
 
-    cnt = (uint8_t)(UARTS_RX_FIFO_SIZE + UartS_RxFifoHdrIdx - UartS_RxFifoTailIdx)
-        % UARTS_RX_FIFO_SIZE;
+/**
+ * UartS_GetTxHighWater - Function to get maximum bytes stored in TX FIFO of
+ *                        simulated UART since initialization.
+ *
+ * @param   [none]
+ *
+ * @return  [uint8_t]   Bytes.
+ *
+ */
+uint8_t UartS_GetTxHighWater()
+{
+    return UartS_TxFifo.GetHighWater();
+}
 
-    return cnt;
+/**
+ * UartS_GetRxHighWater - Function to get maximum bytes stored in RX FIFO of
+ *                        simulated UART since initialization.
+ *
+ * @param   [none]
+ *
+ * @return  [uint8_t]   Bytes.
+ *
+ */
+uint8_t UartS_GetRxHighWater()
+{
+    return UartS_RxFifo.GetHighWater();
+}
+
+/**
+ * UartS_GetStats - Function to get link statistics of simulated UART since
+ *                  initialization, receiver error is frame error.
+ *
+ * @param   [out]       *p_stats    Link statistics.
+ *
+ * @return  [none]
+ *
+ */
+void UartS_GetStats(UART_STATS *p_stats)
+{
+    uint8_t old_SREG;
+
+    p_stats->tx_bytes = UartS_TxBytes;
+    p_stats->rx_bytes = UartS_RxBytes;
+    p_stats->tx_high_water = UartS_TxFifo.GetHighWater();
+    p_stats->rx_high_water = UartS_RxFifo.GetHighWater();
+
+    /* Counters of RX pin change ISR */
+    old_SREG = SREG;
+    cli();
+
+    p_stats->rx_err_cnt = UartS_RxErrCnt;
+    p_stats->rx_drop_cnt = UartS_RxDropCnt;
+
+    SREG = old_SREG;
 }
 
 /**
@@ -358,6 +437,71 @@ uint8_t UartS_WriteByteNB(uint8_t data)
     return UartS_WBytes(&data, 1, false);
 }
 
+/**
+ * UartS_SetRxMarks - Function to setup the RX byte values (Eg. frame start
+ *                    delimiters) whose start bit time-stamp should be recorded.
+ *
+ * The time-stamp is captured by the pin change ISR at the falling edge of
+ * the start bit, so it is not affected by how late the RX FIFO is drained.
+ *
+ * @param   [in]        *p_marks    Array of mark byte values.
+ * @param   [in]        num         Number of mark bytes, 0 ~ UARTS_RX_MARK_MAX.
+ *
+ * @return  [int8_t]    Function executing result.
+ * @retval  [0]         Success.
+ * @retval  [-1]        Fail.
+ *
+ */
+int8_t UartS_SetRxMarks(const uint8_t *p_marks, uint8_t num)
+{
+    uint8_t old_SREG;
+    uint8_t idx;
+
+    if(num > UARTS_RX_MARK_MAX || (p_marks == NULL && num != 0))
+        return -1;
+
+    /* Store current AVR Status register then disable global interrupt */
+    old_SREG = SREG;
+    cli();
+
+    for(idx = 0; idx < num; idx++)
+        UartS_RxMarks[idx] = p_marks[idx];
+
+    UartS_RxMarkNum = num;
+    UartS_RxMarkFifo.Init();
+
+    /* Enable global interrupt */
+    SREG = old_SREG;
+
+    return 0;
+}
+
+/**
+ * UartS_ReadRxMarkTime - Function to read the start bit time-stamp of
+ *                        the oldest received mark byte.
+ *
+ * Time-stamps are queued in the same order as mark bytes are pushed to
+ * RX FIFO, so caller should read one time-stamp each time it reads a
+ * mark byte from RX FIFO.
+ *
+ * @param   [out]       *p_ticks    Timer 1 ticks (32 bits) of start bit edge.
+ *
+ * @return  [int8_t]    Function executing result.
+ * @retval  [0]         Success.
+ * @retval  [-1]        Fail, no time-stamp available.
+ *
+ */
+int8_t UartS_ReadRxMarkTime(uint32_t *p_ticks)
+{
+    if(p_ticks == NULL)
+        return -1;
+
+    if(UartS_RxMarkFifo.Get(p_ticks) == false)
+        return -1;
+
+    return 0;
+}
+
 /**
  * UartS_RxPulseHandler - Simulated UART RX pulse signal handler.
  *
@@ -382,6 +526,7 @@ void UartS_RxPulseHandler(PC_GRP_IDX pc_grp_idx, uint32_t trig_time,
             /* Reset data before we collect new data */
             UartS_RxDataByte = 0;
             UartS_RxPulseCnt = 1;   /* We've collected start bit */
+            UartS_RxStartTicks = trig_time;
 
             /* Shift to first data bit start position with some delay */
             UartS_RxPulseStartTicks = Timer0_GetTicks8()
@@ -412,7 +557,7 @@ void UartS_RxPulseHandler(PC_GRP_IDX pc_grp_idx, uint32_t trig_time,
 ISR(TIMER0_COMPA_vect)
 {
     uint8_t data_bit;
-    uint8_t tail_next;
+    uint8_t idx;
 
     DEBUG_ISR_START(TIMER0_COMPA_vect_num);
 
@@ -429,12 +574,16 @@ ISR(TIMER0_COMPA_vect)
         /* Make sure the stop bit is valid then process RX data */
         if(data_bit == UARTS_RX_HIGH){
 
-            tail_next = (UartS_RxFifoTailIdx + 1) % UARTS_RX_FIFO_SIZE;
-
             /* Store incoming data if there is space in FIFO */
-            if(tail_next != UartS_RxFifoHdrIdx){
-                UartS_RxFifo[UartS_RxFifoTailIdx] = UartS_RxDataByte;
-                UartS_RxFifoTailIdx = tail_next;
+            if(UartS_RxFifo.Put(UartS_RxDataByte)){
+
+                /* Record start bit time-stamp of mark byte */
+                for(idx = 0; idx < UartS_RxMarkNum; idx++){
+                    if(UartS_RxDataByte == UartS_RxMarks[idx]){
+                        UartS_RxMarkFifo.Put(UartS_RxStartTicks);
+                        break;
+                    }
+                }
             }
             else
                 UartS_RxDropCnt++;
@@ -484,22 +633,16 @@ ISR(TIMER0_COMPB_vect)
     /* Transmit start pulse, signal low */
     if(UartS_TxPulseCnt == 0){
 
+        /* Assign new TX data to TX register, generate low pulse */
+        if(UartS_TxFifo.Get(&UartS_TxDataByte)){
+            UartS_SetTxOutputCompare(UartS_TxStartTicks, UARTS_OC_CLEAR);
+            UartS_TxPulseCnt++;
+        }
         /* There is no data, keep idle high signal */
-        if(UartS_TxFifoHdrIdx == UartS_TxFifoTailIdx){
+        else{
             Timer0_SetTimerCompB(UartS_TxStartTicks, false);
             UartS_IsTXIdle = true;
         }
-        /* Generate low pulse */
-        else{
-            UartS_SetTxOutputCompare(UartS_TxStartTicks, UARTS_OC_CLEAR);
-            UartS_TxPulseCnt++;
-
-            /* Assign new TX data to TX register */
-            UartS_TxDataByte = UartS_TxFifo[UartS_TxFifoHdrIdx];
-
-            /* Shift FIFO header index */
-            UartS_TxFifoHdrIdx = (UartS_TxFifoHdrIdx + 1) % UARTS_TX_FIFO_SIZE;
-        }
     }
     /* Transmit stop pulse, signal high */
     else if(UartS_TxPulseCnt == 9){
@@ -583,25 +726,18 @@ static uint8_t UartS_WBytes(uint8_t *p_data, uint8_t bytes, bool is_blocking)
 {
     uint8_t old_SREG;
     uint8_t cnt;
-    uint8_t tail_next;
-
-    for(cnt = 0; cnt < bytes; cnt++){
+    uint8_t written;
 
-        tail_next = (UartS_TxFifoTailIdx + 1) % UARTS_TX_FIFO_SIZE;
+    cnt = 0;
 
-        /* Wait if FIFO is full */
-        while(tail_next == UartS_TxFifoHdrIdx){
-            if(is_blocking == false){
-                return cnt;
-            }
-        }
-
-        /* Put data to FIFO */
-        UartS_TxFifo[UartS_TxFifoTailIdx] = p_data[cnt];
-        UartS_TxFifoTailIdx = tail_next;
+    do{
+        /* Put as many data as FIFO space allows, wait for more space if blocking */
+        written = UartS_TxFifo.Write(&p_data[cnt], bytes - cnt);
+        cnt += written;
+        UartS_TxBytes += written;
 
         /* Enable TX data timer if needed */
-        if(UartS_IsTXIdle == true){
+        if(written != 0 && UartS_IsTXIdle == true){
 
             /* Store current AVR Status register then disable global interrupt */
             old_SREG = SREG;
@@ -616,7 +752,8 @@ static uint8_t UartS_WBytes(uint8_t *p_data, uint8_t bytes, bool is_blocking)
             /* Enable global interrupt */
             SREG = old_SREG;
         }
-    }
+
+    }while(cnt < bytes && is_blocking == true);
 
     return cnt;
 }
@@ -22,6 +22,7 @@
 #include <stdint.h>
 
 #include "pin_change.h"
+#include "uart_drv.h"
 
 
 /*
@@ -32,6 +33,14 @@
 
 #define UARTS_FUNCTION_EN   true
 
+#define UARTS_RX_MARK_MAX   3       /* Maximum number of time-stamped RX mark bytes */
+
+/* RX pin, Arduino D06 / AVR PD6 / PCINT 22 (PC group 2) */
+#define UARTS_RX_ARDU_PIN   6
+#define UARTS_RX_PC_MASK    PC_PIN_MASK_22
+#define UARTS_RX_PC_IDX     PC_PIN_IDX_22
+#define UARTS_RX_PC_GRP_IDX PC_GRP_IDX_2
+
 
 /*
  *******************************************************************************
@@ -57,10 +66,17 @@ int8_t UartS_Init(uint32_t baud_rate);
 uint8_t UartS_ReadBytes(uint8_t *p_data, uint8_t bytes);
 uint8_t UartS_ReadByte(uint8_t *p_data);
 uint8_t UartS_ReadAvailable();
+uint8_t UartS_ReadPeek(const uint8_t **pp_data);
+void UartS_ReadConsume(uint8_t bytes);
+uint8_t UartS_GetTxHighWater();
+uint8_t UartS_GetRxHighWater();
+void UartS_GetStats(UART_STATS *p_stats);
 uint8_t UartS_WriteBytes(uint8_t *p_data, uint8_t bytes);
 uint8_t UartS_WriteBytesNB(uint8_t *p_data, uint8_t bytes);
 uint8_t UartS_WriteByte(uint8_t data);
 uint8_t UartS_WriteByteNB(uint8_t data);
+int8_t UartS_SetRxMarks(const uint8_t *p_marks, uint8_t num);
+int8_t UartS_ReadRxMarkTime(uint32_t *p_ticks);
 void UartS_RxPulseHandler(PC_GRP_IDX pc_grp_idx, uint32_t trig_time,
                           uint8_t pin_status, uint8_t pin_change);
 
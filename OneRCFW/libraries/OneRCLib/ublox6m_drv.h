@@ -84,6 +84,12 @@
 
 #define UBLOX6M_MEAS_TIME_REF   1           /* 0 = UTC time, 1 = GPS time */
 
+#define UBLOX6M_FIX_OUTPUT_MS   40          /*
+                                             * Approximate delay between measurement
+                                             * epoch and the first NMEA byte of the
+                                             * epoch, tune it with 1PPS if available.
+                                             */
+
 /* UBX protocol header ID */
 #define UBLOX6M_UBX_HDR_SYNC1   0xB5
 #define UBLOX6M_UBX_HDR_SYNC2   0x62
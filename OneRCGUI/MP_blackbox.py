@@ -0,0 +1,191 @@
+#!/usr/bin/python
+# -*- coding: UTF-8 -*-
+
+"""
+Blackbox window reader.
+
+The FC records every control cycle to a RAM blackbox and freezes it around a
+trigger (IMU/AHRS error, RCIN failsafe, fly mode change). The frozen window
+is sent in chunks (MP_BLACKBOX_ID) when the link has bandwidth. This tool
+collects the chunks, decodes the samples and writes one CSV file per window.
+
+Usage:
+    python MP_blackbox.py -p COM3                   Write bb_<n>.csv per window
+    python MP_blackbox.py -p COM3 -b 500000 -o flight1
+
+Window format (blackbox.h):
+    field_num (B), trigger (B), sample_cnt (H), post_cnt (B),
+    base value of each field (h), zig-zag varint delta of each field per sample
+"""
+
+import time
+import argparse
+import Queue
+
+from struct import *
+
+from MP_frames import *
+from MP_handler import MP_handler
+
+
+# Same as AIRPLANE_BB_FIELD, (name, scale, is_unsigned)
+BB_FIELDS               = [('accel_x', 1.0, False), ('accel_y', 1.0, False), ('accel_z', 1.0, False),
+                           ('gyro_x', 1.0, False), ('gyro_y', 1.0, False), ('gyro_z', 1.0, False),
+                           ('ned_roll', 100.0, False), ('ned_pitch', 100.0, False), ('ned_head', 100.0, True)] \
+                        + [(p + '_output', 10.0, False) for p in ['roll', 'pitch', 'yaw', 'bank']] \
+                        + [('rc_in_%d' % ch, 2.0, True) for ch in range(5)] \
+                        + [('rc_out_%d' % ch, 2.0, True) for ch in range(4)] \
+                        + [('ctrl_time', 1.0, True)]
+
+# Same as AIRPLANE_BB_TRIGGER, bit n
+BB_TRIGGERS             = ['IMU_FAIL', 'AHRS_DELAY', 'ACCEL_EXCEED', 'RCIN_FAIL', 'MODE_CHANGE']
+
+BB_WINDOW_HDR_FORMAT    = '<BBHB'
+
+
+""" Decode window bytes, return (trigger, post_cnt, [sample values])
+
+"""
+def bb_decode_window(window):
+
+    (field_num, trigger, sample_cnt, post_cnt) = unpack(BB_WINDOW_HDR_FORMAT, window[:calcsize(BB_WINDOW_HDR_FORMAT)])
+    offset = calcsize(BB_WINDOW_HDR_FORMAT)
+
+    values = list(unpack('<%dh' % field_num, window[offset:offset + field_num * 2]))
+    offset += field_num * 2
+
+    samples = []
+
+    for sample_idx in range(sample_cnt):
+        for field_idx in range(field_num):
+            zz = 0
+            shift = 0
+            while(True):
+                byte = ord(window[offset])
+                offset += 1
+                zz |= (byte & 0x7F) << shift
+                shift += 7
+                if((byte & 0x80) == 0):
+                    break
+
+            # Zig-zag to signed delta, int16 wrap around
+            delta = (zz >> 1) ^ -(zz & 1)
+            values[field_idx] = ((values[field_idx] + delta + 0x8000) & 0xFFFF) - 0x8000
+
+        samples.append(list(values))
+
+    return (trigger, post_cnt, samples)
+
+
+""" Convert raw field values to scaled values
+
+"""
+def bb_scale_sample(sample):
+
+    scaled = []
+
+    for field_idx, value in enumerate(sample):
+        if(field_idx < len(BB_FIELDS)):
+            (name, scale, is_unsigned) = BB_FIELDS[field_idx]
+            if(is_unsigned):
+                value &= 0xFFFF
+            scaled.append(value / scale)
+        else:
+            scaled.append(value)
+
+    return scaled
+
+
+class MP_blackbox(object):
+
+    def __init__(self):
+
+        self.window_id = None
+        self.window = None
+        self.received = 0
+
+    """ Collect one chunk frame, return window bytes once it is completed
+
+    """
+    def put(self, frame):
+
+        # New window, chunks of previous window are dropped
+        if(frame.window_id != self.window_id or self.window == None or len(self.window) != frame.window_size):
+            self.window_id = frame.window_id
+            self.window = bytearray(frame.window_size)
+            self.received = 0
+
+        # Chunks are sent in order, a dropped chunk is sent again
+        if(frame.offset != self.received or frame.offset + len(frame.data) > frame.window_size):
+            return None
+
+        self.window[frame.offset:frame.offset + len(frame.data)] = frame.data
+        self.received += len(frame.data)
+
+        if(self.received < frame.window_size):
+            return None
+
+        self.received = 0
+        return str(self.window)
+
+
+def bb_write_csv(file_name, trigger, post_cnt, samples):
+
+    trigger_idx = len(samples) - post_cnt - 1
+
+    with open(file_name, 'w') as csv_file:
+        csv_file.write('# trigger: %s\n' % ' '.join(name for bit, name in enumerate(BB_TRIGGERS) if trigger & (1 << bit)))
+        csv_file.write('tick,' + ','.join(field[0] for field in BB_FIELDS) + '\n')
+
+        for sample_idx, sample in enumerate(samples):
+            csv_file.write('%d,' % (sample_idx - trigger_idx) + ','.join('%g' % v for v in bb_scale_sample(sample)) + '\n')
+
+
+def main():
+
+    parser = argparse.ArgumentParser(description = 'OneRC blackbox window reader')
+    parser.add_argument('-p', '--port', required = True, help = 'FC serial port')
+    parser.add_argument('-b', '--baud', type = int, default = 57600)
+    parser.add_argument('-o', '--output', default = 'bb', help = 'Output file prefix')
+    args = parser.parse_args()
+
+    rx_queue = Queue.Queue(0)
+    mp_handler = MP_handler()
+    mp_handler.set_rx_frame_queue(rx_queue)
+    mp_handler.open_serial(args.port, args.baud)
+    mp_handler.thread_start()
+
+    mp_blackbox = MP_blackbox()
+    window_cnt = 0
+
+    try:
+        while(True):
+            try:
+                rx_frame = rx_queue.get(True, 0.1)
+            except Queue.Empty:
+                continue
+
+            if(rx_frame["data"].cmd != MP_BLACKBOX_ID):
+                continue
+
+            window = mp_blackbox.put(rx_frame["data"])
+            if(window == None):
+                continue
+
+            (trigger, post_cnt, samples) = bb_decode_window(window)
+            file_name = '%s_%d.csv' % (args.output, window_cnt)
+            bb_write_csv(file_name, trigger, post_cnt, samples)
+            window_cnt += 1
+
+            print "%s %s: %d samples, trigger 0x%02X" % (rx_frame["rx_time"], file_name, len(samples), trigger)
+
+    except KeyboardInterrupt:
+        pass
+
+    finally:
+        mp_handler.thread_stop()
+        mp_handler.close_serial()
+
+
+if __name__ == '__main__':
+    main()
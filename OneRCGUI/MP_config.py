@@ -0,0 +1,337 @@
+#!/usr/bin/python
+# -*- coding: UTF-8 -*-
+
+"""
+Live configuration upload.
+
+Read/write FC parameters, the whole PID set and waypoints through MP protocol
+while the FC is running, upload a ROM mission and save configuration to ROM
+in background (no reboot is needed). Telemetry stream periods can be changed
+to focus the link bandwidth on what is being debugged, and the link can be
+switched to a faster baud rate until next boot.
+
+Usage:
+    python MP_config.py -p COM3 param 3             Read roll PID scale
+    python MP_config.py -p COM3 param 0 22.5        Write roll KP
+    python MP_config.py -p COM3 pid 0               Read roll PID set
+    python MP_config.py -p COM3 pid 0 21 7.1 0.8 1 5 1000
+    python MP_config.py -p COM3 wpt nav 0 24.79 121.03
+    python MP_config.py -p COM3 mission route.txt   One "LAT_DD, LONG_DD" per line
+    python MP_config.py -p COM3 start 0             Fly stored mission from WPT 0 in RTH mode
+    python MP_config.py -p COM3 stop                Stop mission, RTH mode returns to home
+    python MP_config.py -p COM3 save
+    python MP_config.py -p COM3 rate                Read all telemetry stream periods
+    python MP_config.py -p COM3 rate PID_VAL 50     Send PID values every 50 ms, 0 to disable
+    python MP_config.py -p COM3 baud 500000         Switch link rate, use "-b 500000" afterwards
+    python MP_config.py -p COM3 link                Link bytes/s and error counters
+    python MP_config.py -p COM3 latency 10          Stick-to-servo latency of LATENCY stream in 10 s
+"""
+
+import sys
+import time
+import argparse
+import Queue
+
+from struct import *
+
+from MP_frames import *
+from MP_handler import MP_handler
+
+
+MP_CFG_RSP_TIMEOUT      = 2.0       # seconds
+MP_CFG_BUSY_RETRY       = 0.05      # seconds
+MP_CFG_COMMIT_TIMEOUT   = 20.0      # seconds, whole mission is written one byte per control cycle
+MP_CFG_BAUD_SETTLE      = 0.1       # seconds, FC drains its TX FIFO before switching
+MP_CFG_LINK_INTERVAL    = 1.0       # seconds, rates are calculated between two requests
+MP_CFG_LATENCY_PERIOD   = 10.0      # seconds, LATENCY reports are merged over the period
+
+# Same as AIRPLANE_PID_IDX and AIRPLANE_PARAM_ID
+PID_NAMES               = ['ROLL', 'PITCH', 'YAW', 'BANK']
+PID_PARAM_NAMES         = ['KP', 'KI', 'KD', 'SCALE', 'INTEGRAL_MAX', 'OUTPUT_MAX']
+PARAM_NAMES             = [p + '_' + f for p in PID_NAMES for f in PID_PARAM_NAMES] + ['LOITER_RADIUS']
+
+# Same as AIRPLANE_WPT_TYPE
+WPT_TYPES               = {'nav': 0, 'mission': 1}
+
+# Same as AIRPLANE_SAVE_STATE
+SAVE_STATES             = ['IDLE', 'BODY', 'CRC_CALC', 'CRC_WRITE']
+
+# Same as AIRPLANE_TLM_STREAM_ID
+TLM_STREAM_NAMES        = ['HEARTBEAT', 'COMPACT', 'AHRS', 'SETPOINT', 'RC', 'PID_VAL', 'PID_CFG',
+                           'GPS_FIX', 'GPS_NAV', 'ERR_LOG', 'BLACKBOX', 'LINK', 'LATENCY']
+
+# Link statistics counters, printed as total and increment between two frames
+LINK_PORTS              = ['uart0', 'uarts']
+LINK_PORT_COUNTERS      = ['rx_err', 'rx_drop']
+LINK_COUNTERS           = ['mp_rx_frm', 'mp_crc_err', 'mp_oversize', 'mp_seq_lost', 'mp_tx_drop',
+                           'gps_field_err', 'gps_chksum_err', 'gps_end_err', 'gps_rx_timeout']
+
+
+class MP_config(object):
+
+    def __init__(self, port_name, baud_rate):
+
+        self.rx_queue = Queue.Queue(0)
+        self.mp_handler = MP_handler()
+        self.mp_handler.set_rx_frame_queue(self.rx_queue)
+        self.mp_handler.open_serial(port_name, baud_rate)
+        self.mp_handler.thread_start()
+
+    def close(self):
+
+        self.mp_handler.thread_stop()
+        self.mp_handler.close_serial()
+
+    def request(self, tx_id, payload_struct, values, timeout = MP_CFG_RSP_TIMEOUT):
+
+        # Drop old frames, response ID = request ID + 128
+        while(not self.rx_queue.empty()):
+            self.rx_queue.get()
+
+        self.mp_handler.transmit_frame(tx_id, pack('=' + payload_struct[2], *values))
+
+        deadline = time.time() + timeout
+        while(time.time() < deadline):
+            try:
+                rx_frame = self.rx_queue.get(True, 0.1)
+            except:
+                continue
+            if(rx_frame["data"].cmd == tx_id + 128):
+                return rx_frame["data"]
+
+        raise IOError("No response for request %d" % tx_id)
+
+    def request_retry(self, tx_id, payload_struct, values):
+
+        # Retry while the FC is saving configuration or writing mission page to ROM
+        while(True):
+            rsp = self.request(tx_id, payload_struct, values)
+            if(rsp.result != 1):
+                return rsp
+            time.sleep(MP_CFG_BUSY_RETRY)
+
+    def param(self, param_id, value = None):
+
+        if(value == None):
+            return self.request(MP_TX_CFG_PARAM_READ_ID, MP_CFG_PARAM_STRUCT, (param_id, 0, 0.0))
+
+        return self.request_retry(MP_TX_CFG_PARAM_WRITE_ID, MP_CFG_PARAM_STRUCT, (param_id, 0, value))
+
+    def pid(self, pid_idx, pid_cfg = None):
+
+        if(pid_cfg == None):
+            return self.request(MP_TX_CFG_PID_READ_ID, MP_CFG_PID_STRUCT, [pid_idx, 0] + [0.0] * 6)
+
+        return self.request_retry(MP_TX_CFG_PID_WRITE_ID, MP_CFG_PID_STRUCT, [pid_idx, 0] + list(pid_cfg))
+
+    def wpt(self, wpt_type, wpt_idx, coord = None):
+
+        if(coord == None):
+            return self.request(MP_TX_CFG_WPT_READ_ID, MP_CFG_WPT_STRUCT, (wpt_type, 0, wpt_idx, 0.0, 0.0))
+
+        return self.request_retry(MP_TX_CFG_WPT_WRITE_ID, MP_CFG_WPT_STRUCT,
+                                  (wpt_type, 0, wpt_idx, coord[0], coord[1]))
+
+    def mission(self, coords):
+
+        # First waypoint is the mission origin
+        rsp = self.request(MP_TX_CFG_MISSION_BEGIN_ID, MP_CFG_MISSION_STRUCT,
+                           (0, 0, coords[0][0], coords[0][1]))
+        if(rsp.result != 0):
+            return rsp
+
+        for wpt_idx, coord in enumerate(coords):
+            rsp = self.wpt(WPT_TYPES['mission'], wpt_idx, coord)
+            if(rsp.result != 0):
+                print "WPT %d: fail" % wpt_idx
+                return rsp
+
+        # The FC responds once the mission is stored, it's flown after mission_start()
+        return self.request(MP_TX_CFG_MISSION_END_ID, MP_CFG_MISSION_STRUCT,
+                            (len(coords), 0, 0.0, 0.0), MP_CFG_COMMIT_TIMEOUT)
+
+    def mission_start(self, wpt_idx = None):
+
+        # Started mission is flown in RTH mode until it's completed, stopped or RC failsafe
+        if(wpt_idx == None):
+            return self.request(MP_TX_CFG_MISSION_START_ID, MP_CFG_MISSION_START_STRUCT, (0, 0, 0))
+
+        return self.request(MP_TX_CFG_MISSION_START_ID, MP_CFG_MISSION_START_STRUCT, (1, 0, wpt_idx))
+
+    def tlm_rate(self, stream_id, period_ms = None):
+
+        if(period_ms == None):
+            return self.request(MP_TX_CFG_TLM_RATE_READ_ID, MP_CFG_TLM_RATE_STRUCT, (stream_id, 0, 0))
+
+        return self.request(MP_TX_CFG_TLM_RATE_WRITE_ID, MP_CFG_TLM_RATE_STRUCT, (stream_id, 0, period_ms))
+
+    def baud(self, baud_rate):
+
+        rsp = self.request(MP_TX_CFG_BAUD_ID, MP_CFG_BAUD_STRUCT, (baud_rate, 0))
+        if(rsp.result != 0):
+            return rsp
+
+        # The FC falls back to default rate if no frame is received at new rate
+        time.sleep(MP_CFG_BAUD_SETTLE)
+        self.mp_handler.set_baud_rate(baud_rate)
+
+        return self.request(MP_TX_CFG_BAUD_ID, MP_CFG_BAUD_STRUCT, (baud_rate, 0))
+
+    def link_stats(self):
+
+        return self.request(MP_TX_LINK_STATS_ID, MP_SYS_REQ_STRUCT, ())
+
+    def link(self):
+
+        # Counters are totals since boot, rates are calculated between two frames
+        first = self.link_stats()
+        time.sleep(MP_CFG_LINK_INTERVAL)
+        last = self.link_stats()
+
+        return (first, last)
+
+    def latency(self, period = MP_CFG_LATENCY_PERIOD):
+
+        # Each report covers the samples since previous one, merge all reports of the period
+        while(not self.rx_queue.empty()):
+            self.rx_queue.get()
+
+        reports = []
+        deadline = time.time() + period
+        while(time.time() < deadline):
+            try:
+                rx_frame = self.rx_queue.get(True, 0.1)
+            except:
+                continue
+            if(rx_frame["data"].cmd == MP_LATENCY_ID):
+                reports.append(rx_frame["data"])
+
+        if(len(reports) == 0):
+            raise IOError("No latency report, build FC with LATENCY_EN and enable stream by \"rate LATENCY 1000\"")
+
+        return reports
+
+    def save(self):
+
+        rsp = self.request(MP_TX_CFG_SAVE_ID, MP_CFG_SAVE_STRUCT, (1, 0, 0))
+
+        while(rsp.state != 0):
+            time.sleep(0.2)
+            rsp = self.request(MP_TX_CFG_SAVE_ID, MP_CFG_SAVE_STRUCT, (0, 0, 0))
+
+        return rsp
+
+
+def load_mission(file_name):
+
+    coords = []
+
+    for line in open(file_name):
+        line = line.split('#')[0].strip()
+        if(line):
+            coords.append(tuple(float(v) for v in line.replace(',', ' ').split()[:2]))
+
+    return coords
+
+
+def main():
+
+    parser = argparse.ArgumentParser(description = 'OneRC live configuration upload')
+    parser.add_argument('-p', '--port', required = True, help = 'FC serial port')
+    parser.add_argument('-b', '--baud', type = int, default = 57600)
+    parser.add_argument('command', choices = ['param', 'pid', 'wpt', 'mission', 'start', 'stop', 'save', 'rate',
+                                              'baud', 'link', 'latency'])
+    parser.add_argument('args', nargs = '*')
+    args = parser.parse_args()
+
+    mp_config = MP_config(args.port, args.baud)
+
+    try:
+        if(args.command == 'param'):
+            value = float(args.args[1]) if len(args.args) > 1 else None
+            rsp = mp_config.param(int(args.args[0]), value)
+            print "%s = %f, result %d" % (PARAM_NAMES[rsp.param_id] if rsp.param_id < len(PARAM_NAMES) else rsp.param_id,
+                                          rsp.value, rsp.result)
+
+        elif(args.command == 'pid'):
+            pid_cfg = [float(v) for v in args.args[1:7]] if len(args.args) >= 7 else None
+            rsp = mp_config.pid(int(args.args[0]), pid_cfg)
+            print rsp
+
+        elif(args.command == 'wpt'):
+            coord = (float(args.args[2]), float(args.args[3])) if len(args.args) >= 4 else None
+            rsp = mp_config.wpt(WPT_TYPES[args.args[0]], int(args.args[1]), coord)
+            print rsp
+
+        elif(args.command == 'mission'):
+            coords = load_mission(args.args[0])
+            start_time = time.time()
+            rsp = mp_config.mission(coords)
+            print "%d waypoints, result %d, %.1f s" % (len(coords), rsp.result, time.time() - start_time)
+
+        elif(args.command == 'start'):
+            rsp = mp_config.mission_start(int(args.args[0]) if len(args.args) > 0 else 0)
+            print "Mission start: %s" % ('OK' if rsp.result == 0 else 'Fail')
+
+        elif(args.command == 'stop'):
+            rsp = mp_config.mission_start()
+            print "Mission stop: %s" % ('OK' if rsp.result == 0 else 'Fail')
+
+        elif(args.command == 'save'):
+            rsp = mp_config.save()
+            print "Save: %s, %s" % (SAVE_STATES[rsp.state], 'OK' if rsp.result == 0 else 'Fail')
+
+        elif(args.command == 'rate'):
+            if(len(args.args) == 0):
+                stream_ids = range(len(TLM_STREAM_NAMES))
+            else:
+                stream_ids = [TLM_STREAM_NAMES.index(args.args[0].upper())]
+            period_ms = int(args.args[1]) if len(args.args) > 1 else None
+            for stream_id in stream_ids:
+                rsp = mp_config.tlm_rate(stream_id, period_ms)
+                print "%-10s %5d ms, result %d" % (TLM_STREAM_NAMES[stream_id], rsp.period_ms, rsp.result)
+
+        elif(args.command == 'baud'):
+            rsp = mp_config.baud(int(args.args[0]))
+            print "Baud: %d, %s" % (rsp.baud_rate, 'OK' if rsp.result == 0 else 'Fail')
+
+        elif(args.command == 'link'):
+            (first, last) = mp_config.link()
+            period = ((last.time_ms - first.time_ms) & 0xFFFFFFFF) / 1000.0
+            for port in LINK_PORTS:
+                tx_rate = ((getattr(last, port + '_tx_bytes') - getattr(first, port + '_tx_bytes')) & 0xFFFFFFFF) / period
+                rx_rate = ((getattr(last, port + '_rx_bytes') - getattr(first, port + '_rx_bytes')) & 0xFFFFFFFF) / period
+                print "%-6s TX %7.0f B/s, RX %7.0f B/s, high water TX %3d, RX %3d" % (
+                      port.upper(), tx_rate, rx_rate,
+                      getattr(last, port + '_tx_high_water'), getattr(last, port + '_rx_high_water'))
+                for counter in LINK_PORT_COUNTERS:
+                    name = port + '_' + counter
+                    print "    %-16s %6d (+%d)" % (counter, getattr(last, name), getattr(last, name) - getattr(first, name))
+            for counter in LINK_COUNTERS:
+                print "%-20s %6d (+%d)" % (counter, getattr(last, counter), getattr(last, counter) - getattr(first, counter))
+
+        elif(args.command == 'latency'):
+            reports = mp_config.latency(float(args.args[0]) if len(args.args) > 0 else MP_CFG_LATENCY_PERIOD)
+            samples = sum(r.sample_cnt for r in reports)
+            print "%d samples, %d dropped, %d reports" % (samples, sum(r.drop_cnt for r in reports), len(reports))
+            valid = [r for r in reports if r.sample_cnt > 0]
+            for stage in (MP_LATENCY_STAGES if len(valid) > 0 else []):
+                avg = sum(getattr(r, stage + '_avg_us') * r.sample_cnt for r in valid) / float(samples)
+                hist = [sum(getattr(r, stage + '_hist%d' % bin_idx) for r in reports)
+                        for bin_idx in range(MP_LATENCY_HIST_BINS)]
+                print "%-11s min %5d, avg %7.0f, max %5d us, hist %s" % (
+                      stage, min(getattr(r, stage + '_min_us') for r in valid), avg,
+                      max(getattr(r, stage + '_max_us') for r in valid), ' '.join('%4d' % h for h in hist))
+            print "Histogram bins: <%s, >=%d us" % (', <'.join(str(us) for us in MP_LATENCY_HIST_BOUNDS),
+                                                    MP_LATENCY_HIST_BOUNDS[-1])
+            # First order IIR y += (x - y) >> beta, the step response delay is about (2^beta - 1) input periods
+            last = reports[-1]
+            print "RC input LPF lag: %d us (period %d us, beta %d)" % (
+                  ((1 << last.rcin_lpf_beta) - 1) * last.rcin_period_us, last.rcin_period_us, last.rcin_lpf_beta)
+
+    finally:
+        mp_config.close()
+
+
+if __name__ == '__main__':
+    main()
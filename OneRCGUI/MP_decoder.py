@@ -2,6 +2,7 @@
 # -*- coding: UTF-8 -*-
 
 from MP_frames import *
+from MP_log import *
 from struct import *
 from collections import namedtuple
 import numpy as np
@@ -18,7 +19,10 @@ class MP_decoder():
     
     """
     def __init__(self):
-        pass
+        # Last field values of compact telemetry, None until first keyframe
+        self.__tlm_compact_val = [None] * len(MP_TLM_COMPACT_DEFINE)
+        # Format strings of binary log, scanned from firmware source code
+        self.__log_table = mp_log_scan()
       
       
     """ Decode MP frame raw bytes and convert to completed frame structure
@@ -42,10 +46,26 @@ class MP_decoder():
         if(hdr.len !=  len(raw_bytes) - int(MP_FRM_HDR_STRUCT[1]) - int(MP_FRM_TAIL_STRUCT[1])):
             return None
             
+        # Binary log, expanded to text
+        if(hdr.cmd == MP_LOG_ID):
+            return self.decode_log(raw_bytes)
+
+        # Blackbox window chunk, variable length
+        if(hdr.cmd == MP_BLACKBOX_ID):
+            return self.decode_blackbox(raw_bytes)
+
+        # Container frame, records are decoded as frames
+        if(hdr.cmd == MP_CONTAINER_ID):
+            return self.decode_container(raw_bytes)
+
         try:
             payload_struct = MP_FRM_TABLES[hdr.cmd]
         except:
             return None
+
+        # Variable length frame
+        if(hdr.cmd == MP_TLM_COMPACT_ID):
+            return self.decode_tlm_compact(raw_bytes)
             
         if(int(payload_struct[1]) != hdr.len):
             return None
@@ -75,6 +95,140 @@ class MP_decoder():
         pass
        
        
+    """ Decode unsigned varint, return (value, next offset)
+    
+    """
+    def decode_varint(self, raw_bytes, offset):
+    
+        value = 0
+        shift = 0
+        
+        while(True):
+            byte = ord(raw_bytes[offset])
+            offset += 1
+            value |= (byte & 0x7F) << shift
+            shift += 7
+            if((byte & 0x80) == 0):
+                return (value, offset)
+
+
+    """ Decode compact telemetry frame, fields not present in the frame keep
+        the value of previous frames.
+    
+    """
+    def decode_tlm_compact(self, raw_bytes):
+    
+        hdr_size = int(MP_FRM_HDR_STRUCT[1])
+        tail_size = int(MP_FRM_TAIL_STRUCT[1])
+        
+        try:
+            (heartbeat, offset) = self.decode_varint(raw_bytes, hdr_size)
+            (field_mask, offset) = self.decode_varint(raw_bytes, offset)
+            
+            for idx, field in enumerate(MP_TLM_COMPACT_DEFINE):
+                if(field_mask & (1 << idx)):
+                    self.__tlm_compact_val[idx] = unpack('=' + field[0], raw_bytes[offset:offset + 2])[0] / float(field[2])
+                    offset += 2
+        except:
+            return None
+
+        if(offset != len(raw_bytes) - tail_size):
+            return None
+            
+        mp_frame_format = '=' + MP_FRM_HDR_STRUCT[2] + MP_FRM_TAIL_STRUCT[2]
+        (s_f, cmd, seq, length, crc16) = unpack(mp_frame_format, raw_bytes[:hdr_size] + raw_bytes[-tail_size:])
+        
+        mp_frame_fields = MP_FRM_HDR_STRUCT[3] + ', ' + MP_TLM_COMPACT_STRUCT[3] + ', ' + MP_FRM_TAIL_STRUCT[3]
+        mp_frame_struct = namedtuple('MP_FRM', mp_frame_fields)
+        
+        return mp_frame_struct._make([s_f, cmd, seq, length, heartbeat, field_mask] + self.__tlm_compact_val + [crc16])
+
+       
+    """ Decode binary log frame, the message is expanded with format string
+        of the same ID.
+    
+    """
+    def decode_log(self, raw_bytes):
+    
+        hdr_size = int(MP_FRM_HDR_STRUCT[1])
+        tail_size = int(MP_FRM_TAIL_STRUCT[1])
+        
+        payload = raw_bytes[hdr_size:-tail_size]
+        if(len(payload) < 2):
+            return None
+        
+        mp_frame_format = '=' + MP_FRM_HDR_STRUCT[2] + MP_FRM_TAIL_STRUCT[2]
+        (s_f, cmd, seq, length, crc16) = unpack(mp_frame_format, raw_bytes[:hdr_size] + raw_bytes[-tail_size:])
+        (log_id,) = unpack('<H', payload[:2])
+        
+        mp_frame_fields = MP_FRM_HDR_STRUCT[3] + ', log_id, text, ' + MP_FRM_TAIL_STRUCT[3]
+        mp_frame_struct = namedtuple('MP_FRM', mp_frame_fields)
+        
+        return mp_frame_struct._make([s_f, cmd, seq, length, log_id, mp_log_expand(self.__log_table, payload), crc16])
+
+       
+    """ Decode blackbox window chunk, window bytes are kept in data field.
+    
+    """
+    def decode_blackbox(self, raw_bytes):
+    
+        hdr_size = int(MP_FRM_HDR_STRUCT[1])
+        tail_size = int(MP_FRM_TAIL_STRUCT[1])
+        
+        payload = raw_bytes[hdr_size:-tail_size]
+        if(len(payload) < 5):
+            return None
+        
+        mp_frame_format = '=' + MP_FRM_HDR_STRUCT[2] + MP_FRM_TAIL_STRUCT[2]
+        (s_f, cmd, seq, length, crc16) = unpack(mp_frame_format, raw_bytes[:hdr_size] + raw_bytes[-tail_size:])
+        (window_id, window_size, offset) = unpack('<BHH', payload[:5])
+        
+        mp_frame_fields = MP_FRM_HDR_STRUCT[3] + ', window_id, window_size, offset, data, ' + MP_FRM_TAIL_STRUCT[3]
+        mp_frame_struct = namedtuple('MP_FRM', mp_frame_fields)
+        
+        return mp_frame_struct._make([s_f, cmd, seq, length, window_id, window_size, offset, payload[5:], crc16])
+
+       
+    """ Decode container frame, each record is decoded as a frame with the
+        sequence and CRC of container. Unknown records are skipped.
+    
+    """
+    def decode_container(self, raw_bytes):
+    
+        hdr_size = int(MP_FRM_HDR_STRUCT[1])
+        tail_size = int(MP_FRM_TAIL_STRUCT[1])
+        
+        mp_frame_format = '=' + MP_FRM_HDR_STRUCT[2] + MP_FRM_TAIL_STRUCT[2]
+        (s_f, cmd, seq, length, crc16) = unpack(mp_frame_format, raw_bytes[:hdr_size] + raw_bytes[-tail_size:])
+        
+        records = []
+        offset = hdr_size
+        payload_end = len(raw_bytes) - tail_size
+        
+        while(offset < payload_end):
+            if(offset + 2 > payload_end):
+                return None
+                
+            (tag, record_len) = unpack('=BB', raw_bytes[offset:offset + 2])
+            offset += 2
+            
+            if(offset + record_len > payload_end):
+                return None
+            
+            if(tag != MP_CONTAINER_ID):
+                record = self.decode(pack('=BBBB', s_f, tag, seq, record_len) + raw_bytes[offset:offset + record_len]
+                                     + raw_bytes[-tail_size:])
+                if(record != None):
+                    records.append(record)
+                    
+            offset += record_len
+            
+        mp_frame_fields = MP_FRM_HDR_STRUCT[3] + ', records, ' + MP_FRM_TAIL_STRUCT[3]
+        mp_frame_struct = namedtuple('MP_FRM', mp_frame_fields)
+        
+        return mp_frame_struct._make([s_f, cmd, seq, length, records, crc16])
+
+       
     """ Decode MP frame raw bytes tail part
     
     """       
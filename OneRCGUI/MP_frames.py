@@ -10,7 +10,14 @@ import numpy as np
 # MP frame header
 #******************************************************************************
 """
+Legacy frame starts with 0x7E. COBS frame starts with delimiter 0x00, the rest
+of frame is COBS encoded, and bit 7 of len field (version bit) is set.
 """
+MP_FRM_SFLAG            = 0x7E
+MP_FRM_DELIM            = 0x00
+MP_FRM_LEN_COBS_BIT     = 0x80
+MP_FRM_LEN_MASK         = 0x7F
+
 MP_FRM_HDR_DEFINE    = np.array(
                         [
                             ['B', 's_f'],                                           # unsigned char
@@ -104,6 +111,41 @@ MP_CRUISE_STRUCT        = np.array(
                             
                         ])
 
+#******************************************************************************
+# Compact telemetry payload (variable length)
+#******************************************************************************
+""" Varint heartbeat, varint field mask, then int16 of each field present in
+    field mask, in field order (Same as AIRPLANE_TLM_FIELD). Fields not present
+    are unchanged since last frame.
+"""
+MP_TLM_COMPACT_DEFINE   = np.array(
+                        [
+                            ['h', 'ned_roll',       '100.0'],                       # centi-degree
+                            ['h', 'ned_pitch',      '100.0'],                       # centi-degree
+                            ['H', 'ned_head',       '100.0'],                       # centi-degree
+                            ['h', 'g_snr_x',        '1.0'],                         # raw
+                            ['h', 'g_snr_y',        '1.0'],                         # raw
+                            ['h', 'g_snr_z',        '1.0'],                         # raw
+                            ['h', 'sp_roll',        '100.0'],                       # centi-degree
+                            ['h', 'sp_pitch',       '100.0'],                       # centi-degree
+                            ['H', 'sp_head',        '100.0'],                       # centi-degree
+                            ['h', 'roll_output',    '10.0'],
+                            ['h', 'pitch_output',   '10.0'],
+                            ['h', 'yaw_output',     '10.0'],
+                            ['h', 'bank_output',    '10.0'],
+                            ['h', 'roll_integral',  '100.0'],
+                            ['h', 'pitch_integral', '100.0'],
+                            ['h', 'yaw_integral',   '100.0'],
+                            ['h', 'bank_integral',  '100.0'],
+                        ])
+MP_TLM_COMPACT_STRUCT   = np.array(
+                        [   
+                            0,                                                      # ID
+                            0,                                                      # Size, variable
+                            ''.join(MP_TLM_COMPACT_DEFINE[:, 0]),                   # Field data type
+                            'heartbeat, field_mask, ' + ', '.join(MP_TLM_COMPACT_DEFINE[:, 1]),  # Field name
+                        ])
+
 #******************************************************************************
 # IMU sensor information payload
 #******************************************************************************        
@@ -294,6 +336,8 @@ MP_GPS_GENERAL_DEFINE    = np.array(
                             ['I', 'rmc_timestamp'],                                         # 4 bytes
                             ['B', 'unknown_detect'],                                        # 1 bytes
                             ['I', 'unknown_timestamp'],                                     # 4 bytes                       
+                            ['H', 'gga_rx_delay_ms'],                                       # 2 bytes
+                            ['H', 'gga_fix_delay_ms'],                                      # 2 bytes
                         ])      
 MP_GPS_GENERAL_STRUCT   = np.array(     
                         [           
@@ -393,12 +437,235 @@ MP_GPS_ERR_LOG_STRUCT   = np.array(
                                 ', '.join(MP_GPS_ERR_LOG_DEFINE[:, 1]),                     # Field name
                             ])
 
+MP_GPS_BENCH_STAT_DEFINE    = np.array(
+                            [
+                                ['I', 'rx_bytes'],                                          # 4 bytes
+                                ['I', 'parse_ticks'],                                       # 4 bytes
+                                ['H', 'parse_max_ticks'],                                   # 2 bytes
+                                ['H', 'gga_cnt'],                                           # 2 bytes
+                                ['H', 'rmc_cnt'],                                           # 2 bytes
+                                ['H', 'unknown_cnt'],                                       # 2 bytes
+                                ['B', 'field_err'],                                         # 1 bytes
+                                ['B', 'chksum_err'],                                        # 1 bytes
+                                ['B', 'end_err'],                                           # 1 bytes
+                                ['B', 'rx_timeout'],                                        # 1 bytes
+                            ])
+MP_GPS_BENCH_STAT_STRUCT    = np.array(
+                            [   
+                                0,                                                          # ID
+                                calcsize('=' + ''.join(MP_GPS_BENCH_STAT_DEFINE[:, 0])),    # Size
+                                ''.join(MP_GPS_BENCH_STAT_DEFINE[:, 0]),                    # Field data type
+                                ', '.join(MP_GPS_BENCH_STAT_DEFINE[:, 1]),                  # Field name
+                            ])
+
+MP_CFG_PARAM_DEFINE     = np.array(
+                            [
+                                ['B', 'param_id'],                                          # 1 bytes
+                                ['b', 'result'],                                            # 1 bytes
+                                ['f', 'value'],                                             # 4 bytes
+                            ])
+MP_CFG_PARAM_STRUCT     = np.array(
+                            [   
+                                0,                                                          # ID
+                                calcsize('=' + ''.join(MP_CFG_PARAM_DEFINE[:, 0])),         # Size
+                                ''.join(MP_CFG_PARAM_DEFINE[:, 0]),                         # Field data type
+                                ', '.join(MP_CFG_PARAM_DEFINE[:, 1]),                       # Field name
+                            ])
+
+MP_CFG_PID_DEFINE       = np.array(
+                            [
+                                ['B', 'pid_idx'],                                           # 1 bytes
+                                ['b', 'result'],                                            # 1 bytes
+                                ['f', 'KP'],                                                # 4 bytes
+                                ['f', 'KI'],                                                # 4 bytes
+                                ['f', 'KD'],                                                # 4 bytes
+                                ['f', 'scale'],                                             # 4 bytes
+                                ['f', 'integral_max'],                                      # 4 bytes
+                                ['f', 'output_max'],                                        # 4 bytes
+                            ])
+MP_CFG_PID_STRUCT       = np.array(
+                            [   
+                                0,                                                          # ID
+                                calcsize('=' + ''.join(MP_CFG_PID_DEFINE[:, 0])),           # Size
+                                ''.join(MP_CFG_PID_DEFINE[:, 0]),                           # Field data type
+                                ', '.join(MP_CFG_PID_DEFINE[:, 1]),                         # Field name
+                            ])
+
+MP_CFG_WPT_DEFINE       = np.array(
+                            [
+                                ['B', 'wpt_type'],                                          # 1 bytes
+                                ['b', 'result'],                                            # 1 bytes
+                                ['H', 'wpt_idx'],                                           # 2 bytes
+                                ['f', 'LAT_DD'],                                            # 4 bytes
+                                ['f', 'LONG_DD'],                                           # 4 bytes
+                            ])
+MP_CFG_WPT_STRUCT       = np.array(
+                            [   
+                                0,                                                          # ID
+                                calcsize('=' + ''.join(MP_CFG_WPT_DEFINE[:, 0])),           # Size
+                                ''.join(MP_CFG_WPT_DEFINE[:, 0]),                           # Field data type
+                                ', '.join(MP_CFG_WPT_DEFINE[:, 1]),                         # Field name
+                            ])
+
+MP_CFG_MISSION_DEFINE   = np.array(
+                            [
+                                ['H', 'total_wpt'],                                         # 2 bytes
+                                ['b', 'result'],                                            # 1 bytes
+                                ['f', 'LAT_DD'],                                            # 4 bytes
+                                ['f', 'LONG_DD'],                                           # 4 bytes
+                            ])
+MP_CFG_MISSION_STRUCT   = np.array(
+                            [   
+                                0,                                                          # ID
+                                calcsize('=' + ''.join(MP_CFG_MISSION_DEFINE[:, 0])),       # Size
+                                ''.join(MP_CFG_MISSION_DEFINE[:, 0]),                       # Field data type
+                                ', '.join(MP_CFG_MISSION_DEFINE[:, 1]),                     # Field name
+                            ])
+
+MP_CFG_MISSION_START_DEFINE = np.array(
+                            [
+                                ['B', 'is_start'],                                          # 1 bytes
+                                ['b', 'result'],                                            # 1 bytes
+                                ['H', 'wpt_idx'],                                           # 2 bytes
+                            ])
+MP_CFG_MISSION_START_STRUCT = np.array(
+                            [   
+                                0,                                                          # ID
+                                calcsize('=' + ''.join(MP_CFG_MISSION_START_DEFINE[:, 0])), # Size
+                                ''.join(MP_CFG_MISSION_START_DEFINE[:, 0]),                 # Field data type
+                                ', '.join(MP_CFG_MISSION_START_DEFINE[:, 1]),               # Field name
+                            ])
+
+MP_CFG_SAVE_DEFINE      = np.array(
+                            [
+                                ['B', 'is_start'],                                          # 1 bytes
+                                ['B', 'state'],                                             # 1 bytes
+                                ['b', 'result'],                                            # 1 bytes
+                            ])
+MP_CFG_SAVE_STRUCT      = np.array(
+                            [   
+                                0,                                                          # ID
+                                calcsize('=' + ''.join(MP_CFG_SAVE_DEFINE[:, 0])),          # Size
+                                ''.join(MP_CFG_SAVE_DEFINE[:, 0]),                          # Field data type
+                                ', '.join(MP_CFG_SAVE_DEFINE[:, 1]),                        # Field name
+                            ])
+
+MP_CFG_TLM_RATE_DEFINE  = np.array(
+                            [
+                                ['B', 'stream_id'],                                         # 1 bytes
+                                ['b', 'result'],                                            # 1 bytes
+                                ['H', 'period_ms'],                                         # 2 bytes
+                            ])
+MP_CFG_TLM_RATE_STRUCT  = np.array(
+                            [   
+                                0,                                                          # ID
+                                calcsize('=' + ''.join(MP_CFG_TLM_RATE_DEFINE[:, 0])),      # Size
+                                ''.join(MP_CFG_TLM_RATE_DEFINE[:, 0]),                      # Field data type
+                                ', '.join(MP_CFG_TLM_RATE_DEFINE[:, 1]),                    # Field name
+                            ])
+
+MP_CFG_BAUD_DEFINE      = np.array(
+                            [
+                                ['I', 'baud_rate'],                                         # 4 bytes
+                                ['b', 'result'],                                            # 1 bytes
+                            ])
+MP_CFG_BAUD_STRUCT      = np.array(
+                            [   
+                                0,                                                          # ID
+                                calcsize('=' + ''.join(MP_CFG_BAUD_DEFINE[:, 0])),          # Size
+                                ''.join(MP_CFG_BAUD_DEFINE[:, 0]),                          # Field data type
+                                ', '.join(MP_CFG_BAUD_DEFINE[:, 1]),                        # Field name
+                            ])
+
+MP_LINK_STATS_DEFINE    = np.array(
+                            [
+                                ['I', 'time_ms'],                                           # 4 bytes
+                                ['I', 'uart0_tx_bytes'],                                    # 4 bytes
+                                ['I', 'uart0_rx_bytes'],                                    # 4 bytes
+                                ['H', 'uart0_rx_err'],                                      # 2 bytes
+                                ['H', 'uart0_rx_drop'],                                     # 2 bytes
+                                ['B', 'uart0_tx_high_water'],                               # 1 bytes
+                                ['B', 'uart0_rx_high_water'],                               # 1 bytes
+                                ['I', 'uarts_tx_bytes'],                                    # 4 bytes
+                                ['I', 'uarts_rx_bytes'],                                    # 4 bytes
+                                ['H', 'uarts_rx_err'],                                      # 2 bytes
+                                ['H', 'uarts_rx_drop'],                                     # 2 bytes
+                                ['B', 'uarts_tx_high_water'],                               # 1 bytes
+                                ['B', 'uarts_rx_high_water'],                               # 1 bytes
+                                ['H', 'mp_rx_frm'],                                         # 2 bytes
+                                ['H', 'mp_crc_err'],                                        # 2 bytes
+                                ['H', 'mp_oversize'],                                       # 2 bytes
+                                ['H', 'mp_seq_lost'],                                       # 2 bytes
+                                ['H', 'mp_tx_drop'],                                        # 2 bytes
+                                ['B', 'gps_field_err'],                                     # 1 bytes
+                                ['B', 'gps_chksum_err'],                                    # 1 bytes
+                                ['B', 'gps_end_err'],                                       # 1 bytes
+                                ['B', 'gps_rx_timeout'],                                    # 1 bytes
+                            ])
+# Request without payload
+MP_SYS_REQ_STRUCT       = np.array([0, 0, '', ''])
+
+MP_LINK_STATS_STRUCT    = np.array(
+                            [   
+                                0,                                                          # ID
+                                calcsize('=' + ''.join(MP_LINK_STATS_DEFINE[:, 0])),        # Size
+                                ''.join(MP_LINK_STATS_DEFINE[:, 0]),                        # Field data type
+                                ', '.join(MP_LINK_STATS_DEFINE[:, 1]),                      # Field name
+                            ])
+
+# Same as LATENCY_STAGE and LATENCY_HIST_BINS, every stage is min/max/avg and histogram
+MP_LATENCY_STAGES       = ['in_read', 'read_ctrl', 'ctrl_load', 'load_out', 'end_to_end']
+MP_LATENCY_HIST_BINS    = 8
+MP_LATENCY_HIST_BOUNDS  = [500 << bin_idx for bin_idx in range(MP_LATENCY_HIST_BINS - 1)]   # us, log2 bins
+
+MP_LATENCY_DEFINE       = np.array(
+                            [
+                                ['I', 'time_ms'],                                           # 4 bytes
+                                ['H', 'sample_cnt'],                                        # 2 bytes
+                                ['H', 'drop_cnt'],                                          # 2 bytes
+                                ['H', 'rcin_period_us'],                                    # 2 bytes
+                                ['B', 'rcin_lpf_beta'],                                     # 1 bytes
+                            ] +
+                            [
+                                field
+                                for stage in MP_LATENCY_STAGES
+                                for field in [['H', stage + '_min_us'],                     # 2 bytes
+                                              ['H', stage + '_max_us'],                     # 2 bytes
+                                              ['H', stage + '_avg_us']] +                   # 2 bytes
+                                             [['B', stage + '_hist%d' % bin_idx]            # 1 bytes
+                                              for bin_idx in range(MP_LATENCY_HIST_BINS)]
+                            ])
+MP_LATENCY_STRUCT       = np.array(
+                            [   
+                                0,                                                          # ID
+                                calcsize('=' + ''.join(MP_LATENCY_DEFINE[:, 0])),           # Size
+                                ''.join(MP_LATENCY_DEFINE[:, 0]),                           # Field data type
+                                ', '.join(MP_LATENCY_DEFINE[:, 1]),                         # Field name
+                            ])
+
 
 #******************************************************************************
 # Payload ID mapping table
 #******************************************************************************
 
 # TX
+MP_TX_CFG_PARAM_READ_ID     = 8
+MP_TX_CFG_PARAM_WRITE_ID    = 9
+MP_TX_CFG_PID_READ_ID       = 10
+MP_TX_CFG_PID_WRITE_ID      = 11
+MP_TX_CFG_WPT_READ_ID       = 12
+MP_TX_CFG_WPT_WRITE_ID      = 13
+MP_TX_CFG_MISSION_BEGIN_ID  = 14
+MP_TX_CFG_MISSION_END_ID    = 15
+MP_TX_CFG_SAVE_ID           = 16
+MP_TX_CFG_TLM_RATE_READ_ID  = 17
+MP_TX_CFG_TLM_RATE_WRITE_ID = 18
+MP_TX_CFG_BAUD_ID           = 19
+MP_TX_CFG_MISSION_START_ID  = 20
+MP_TX_LINK_STATS_ID         = 24     # No payload, see MP_SYS_REQ_STRUCT
+MP_TX_LATENCY_ID            = 25     # No payload, FC built with LATENCY_EN only
+MP_TX_GPS_BENCH_RESET_ID    = 40
+MP_TX_GPS_BENCH_FEED_ID     = 41
 MP_TX_IMU_SENSOR_DATA_ID    = 64
 
 # RX
@@ -406,6 +673,29 @@ MP_HEARTBEAT_ID             = 128
 MP_GENERAL_ID               = 129
 MP_SETPOINT_ID              = 130
 MP_CRUISE_ID                = 131
+MP_TLM_COMPACT_ID           = 132
+MP_CONTAINER_ID             = 133     # Records of other frames, each record is tag (frame ID), len and payload
+MP_LOG_ID                   = 134     # Binary log, format ID and raw arguments, see MP_log.py
+MP_BLACKBOX_ID              = 135     # Blackbox window chunk, see MP_blackbox.py
+
+# RX configuration
+MP_CFG_PARAM_READ_ID        = 136
+MP_CFG_PARAM_WRITE_ID       = 137
+MP_CFG_PID_READ_ID          = 138
+MP_CFG_PID_WRITE_ID         = 139
+MP_CFG_WPT_READ_ID          = 140
+MP_CFG_WPT_WRITE_ID         = 141
+MP_CFG_MISSION_BEGIN_ID     = 142
+MP_CFG_MISSION_END_ID       = 143
+MP_CFG_SAVE_ID              = 144
+MP_CFG_TLM_RATE_READ_ID     = 145
+MP_CFG_TLM_RATE_WRITE_ID    = 146
+MP_CFG_BAUD_ID              = 147
+MP_CFG_MISSION_START_ID     = 148
+
+# RX diagnostics
+MP_LINK_STATS_ID            = 152     # Link statistics, see MP_config.py link
+MP_LATENCY_ID               = 153     # Latency profiler, see MP_config.py latency
 
 # RX GPS
 MP_GPS_GENERAL_ID           = 161
@@ -415,6 +705,8 @@ MP_GPS_NMEA_RMC_ID          = 164
 MP_GPS_WAYPOINT_ID          = 165
 MP_GPS_NAVIGATION_ID        = 166
 MP_GPS_ERR_LOG_ID           = 167
+MP_GPS_BENCH_RESET_ID       = 168
+MP_GPS_BENCH_FEED_ID        = 169
 
 MP_RXIMU_SENSOR_DATA_ID     = 192
 
@@ -448,6 +740,24 @@ MP_FRM_TABLES               = {
                                 MP_GENERAL_ID:              MP_GENERAL_STRUCT,
                                 MP_SETPOINT_ID:             MP_SETPOINT_STRUCT,
                                 MP_CRUISE_ID:               MP_CRUISE_STRUCT,
+                                MP_TLM_COMPACT_ID:          MP_TLM_COMPACT_STRUCT,
+
+                                MP_CFG_PARAM_READ_ID:       MP_CFG_PARAM_STRUCT,
+                                MP_CFG_PARAM_WRITE_ID:      MP_CFG_PARAM_STRUCT,
+                                MP_CFG_PID_READ_ID:         MP_CFG_PID_STRUCT,
+                                MP_CFG_PID_WRITE_ID:        MP_CFG_PID_STRUCT,
+                                MP_CFG_WPT_READ_ID:         MP_CFG_WPT_STRUCT,
+                                MP_CFG_WPT_WRITE_ID:        MP_CFG_WPT_STRUCT,
+                                MP_CFG_MISSION_BEGIN_ID:    MP_CFG_MISSION_STRUCT,
+                                MP_CFG_MISSION_END_ID:      MP_CFG_MISSION_STRUCT,
+                                MP_CFG_SAVE_ID:             MP_CFG_SAVE_STRUCT,
+                                MP_CFG_TLM_RATE_READ_ID:    MP_CFG_TLM_RATE_STRUCT,
+                                MP_CFG_TLM_RATE_WRITE_ID:   MP_CFG_TLM_RATE_STRUCT,
+                                MP_CFG_BAUD_ID:             MP_CFG_BAUD_STRUCT,
+                                MP_CFG_MISSION_START_ID:    MP_CFG_MISSION_START_STRUCT,
+
+                                MP_LINK_STATS_ID:           MP_LINK_STATS_STRUCT,
+                                MP_LATENCY_ID:              MP_LATENCY_STRUCT,
                                 
                                 MP_GPS_GENERAL_ID:          MP_GPS_GENERAL_STRUCT,
                                 MP_GPS_NMEA_GGA_ID:         MP_GPS_GGA_NMEA_STRUCT,
@@ -455,6 +765,8 @@ MP_FRM_TABLES               = {
                                 MP_GPS_WAYPOINT_ID:         MP_GPS_WAYPOINT_STRUCT,
                                 MP_GPS_NAVIGATION_ID:       MP_GPS_NAVIGATION_STRUCT,
                                 MP_GPS_ERR_LOG_ID:          MP_GPS_ERR_LOG_STRUCT,
+                                MP_GPS_BENCH_RESET_ID:      MP_GPS_BENCH_STAT_STRUCT,
+                                MP_GPS_BENCH_FEED_ID:       MP_GPS_BENCH_STAT_STRUCT,
 
                                 MP_RXIMU_SENSOR_DATA_ID:    MP_IMU_SENSOR_STRUCT,
 
@@ -13,6 +13,15 @@ from MP_decoder import MP_decoder
 from MP_CRC import *
 import datetime
 
+
+def mp_cobs_encode(raw_bytes):
+    """ COBS encode frame bytes after start flag, MP frame is always shorter than 254 bytes """
+
+    blocks = raw_bytes.split(chr(0))
+
+    return ''.join(chr(len(block) + 1) + block for block in blocks)
+
+
 class MP_handler(MP_decoder):
 
     __port_name = None
@@ -32,6 +41,12 @@ class MP_handler(MP_decoder):
     
     __frame_rx_cmd = 0
     __frame_rx_sequence = 0
+    __frame_rx_seq_tmp = 0
+
+    __frame_is_cobs = False
+    __is_peer_cobs = False
+    __cobs_code = 0
+    __cobs_remain = 0
     
     __frame_tx_sequence = 0
    
@@ -63,6 +78,11 @@ class MP_handler(MP_decoder):
         self.__serial = serial.Serial(self.__port_name, self.__baud_rate,                       \
                                       timeout = 0.01,  bytesize = 8, parity = 'N', stopbits = 1)
                                       
+    def set_baud_rate(self, baud_rate):
+
+        self.__baud_rate = baud_rate
+        self.__serial.baudrate = baud_rate
+
     def close_serial(self):
     
         self.__serial.flush()
@@ -73,11 +93,15 @@ class MP_handler(MP_decoder):
       
     def transmit_frame(self, mp_command, tx_payload):
     
+        tx_len = len(tx_payload)
+        if(self.__is_peer_cobs):
+            tx_len |= MP_FRM_LEN_COBS_BIT
+
         tx_header = pack(MP_FRM_HDR_STRUCT[2],          # header structure definition
-                         0x7E,                          # header start flag
+                         MP_FRM_SFLAG,                  # header start flag
                          mp_command,                    # command
                          self.__frame_tx_sequence,      # sequence number
-                         len(tx_payload))               # length of payload
+                         tx_len)                        # length of payload
         
         tx_bytes = tx_header + tx_payload
         
@@ -87,6 +111,10 @@ class MP_handler(MP_decoder):
         tx_tail = pack(MP_FRM_TAIL_STRUCT[2], self.__tx_crc_object.crc)
         tx_frame = tx_header + tx_payload + tx_tail
 
+        # Same framing as FC, start flag is replaced by delimiter
+        if(self.__is_peer_cobs):
+            tx_frame = chr(MP_FRM_DELIM) + mp_cobs_encode(tx_frame[1:])
+
         self.__serial_tx_queue.put(tx_frame, True, None)
         
         self.__frame_tx_sequence += 1
@@ -133,82 +161,130 @@ class MP_handler(MP_decoder):
                 for byte in input:
                 
                     num = ord(byte)
+
+                    # COBS delimiter always starts a new frame, drop the collecting COBS frame
+                    if(num == MP_FRM_DELIM and (self.__frame_is_cobs or self.__frame_sflag != MP_FRM_SFLAG)):
+                        self.__frame_is_cobs = True
+                        self.__cobs_code = 0
+                        self.__cobs_remain = 0
+                        self.__frame_start()
+
+                    # Decode COBS frame, bytes after the frame are dropped until next delimiter
+                    elif(self.__frame_sflag == MP_FRM_SFLAG and self.__frame_is_cobs):
+
+                        # Code byte, previous block (if any) is ended by a zero byte
+                        if(self.__cobs_remain == 0):
+                            if(self.__cobs_code != 0 and self.__cobs_code != 0xFF):
+                                self.__frame_collect(chr(0))
+                            self.__cobs_code = num
+                            self.__cobs_remain = num - 1
+                        else:
+                            self.__cobs_remain -= 1
+                            self.__frame_collect(byte)
+
+                    # Collect legacy frame bytes
+                    elif(self.__frame_sflag == MP_FRM_SFLAG):
+                        self.__frame_collect(byte)
+
+                    # Detect legacy frame start flag, until FC sends COBS frame
+                    elif(num == MP_FRM_SFLAG and not self.__is_peer_cobs):
+                        self.__frame_is_cobs = False
+                        self.__frame_start()
+            except:    
+                pass
+
+    def __frame_start(self):
+
+        self.__frame_sflag = MP_FRM_SFLAG
+        self.__frame_rx_bytes = 1
+        self.__frame_checksum_offset = 0
+
+        self.__frame_string = chr(MP_FRM_SFLAG)
+
+        self.__rx_crc_object.crc = 0xFFFF
+
+    def __frame_collect(self, byte):
+
+        num = ord(byte)
+
+        self.__frame_string += byte
+        self.__frame_rx_bytes += 1
+
+        # Frame command field 
+        if(self.__frame_rx_bytes == 2):
+            self.__frame_rx_cmd = num
+        # Frame sequence filed
+        elif(self.__frame_rx_bytes == 3):
+            self.__frame_rx_seq_tmp = num
+        # Frame length field, version bit is set in COBS frame
+        elif(self.__frame_rx_bytes == 4):
+            self.__frame_checksum_offset = self.__frame_rx_bytes + (num & MP_FRM_LEN_MASK) + 1
+            
+        # Compare CRC 
+        if(self.__frame_rx_bytes == self.__frame_checksum_offset + 1):
+        
+            self.__rx_crc_object.accumulate_str(self.__frame_string[1:-2])
+
+            # Clear version bit before decoding
+            is_cobs_frame = (ord(self.__frame_string[3]) & MP_FRM_LEN_COBS_BIT) != 0
+            self.__frame_string = self.__frame_string[:3] + chr(ord(self.__frame_string[3]) & MP_FRM_LEN_MASK) \
+                                  + self.__frame_string[4:]
+            
+            # Put complete frame in the queue
+            frame_struct = self.decode(self.__frame_string)
+
+            if(frame_struct != None):
                 
-                    # Start to collect frame bytes
-                    if(self.__frame_sflag == 0x7E):
-                    
-                        self.__frame_string += byte
-                        self.__frame_rx_bytes += 1
+                # CRC pass
+                if(frame_struct.CRC16 == self.__rx_crc_object.crc):
                 
-                        # Frame command field 
-                        if(self.__frame_rx_bytes == 2):
-                            self.__frame_rx_cmd = num
-                        # Frame sequence filed
-                        elif(self.__frame_rx_bytes == 3):
-                            sequence_tmp = num
-                        # Frame length field
-                        elif(self.__frame_rx_bytes == 4):
-                            self.__frame_checksum_offset = self.__frame_rx_bytes + num + 1
-                            
-                        # Compare CRC 
-                        if(self.__frame_rx_bytes == self.__frame_checksum_offset + 1):
+                    self.__rx_frm_cnt += 1
+
+                    # Reply in the same framing as FC
+                    self.__is_peer_cobs = is_cobs_frame
                         
-                            self.__rx_crc_object.accumulate_str(self.__frame_string[1:-2])
-                            
-                            # Put complete frame in the queue
-                            frame_struct = self.decode(self.__frame_string)
-
-                            if(frame_struct != None):
-                                
-                                # CRC pass
-                                if(frame_struct.CRC16 == self.__rx_crc_object.crc):
-                                
-                                    self.__rx_frm_cnt += 1
-                                        
-                                    # Check frame sequence
-                                    self.__frame_rx_sequence += 1
-                                    if(self.__frame_rx_sequence > 255):
-                                        self.__frame_rx_sequence = 0
-                                    
-                                    # Increase frame drop counter if sequence is mismatched                               
-                                    if(self.__frame_rx_sequence != sequence_tmp):
-                                        self.__rx_seq_err_cnt += 1
-                                        self.__frame_drop += 1
-                                        self.__frame_rx_sequence = sequence_tmp
-                                
-                                    if(self.__frame_rx_queue != None):
-                                    
-                                        rx_time = datetime.datetime.now().strftime("%H:%M:%S.%f")
-                                        rx_frame = {"data" : frame_struct, "rx_time" : rx_time}
-                            
-                                        self.__frame_rx_queue.put(rx_frame, True, None)
-                                    else:
-                                        print frame_struct
-                                
-                                # Incorrect CRC 
-                                else:
-                                    self.__rx_crc_err_cnt += 1
-                                    print "Frm cnt, CRC err, seq err = ", self.__rx_frm_cnt, ", ", self.__rx_crc_err_cnt, ", ", self.__rx_seq_err_cnt
-                                    
-                            else:
-                                self.__rx_crc_err_cnt += 1
-                                print "Frm cnt, CRC err, seq err = ", self.__rx_frm_cnt, ", ", self.__rx_crc_err_cnt, ", ", self.__rx_seq_err_cnt
- 
-                                    
-                            # Reset RX frame status
-                            self.__frame_sflag = 0x00
+                    # Check frame sequence
+                    self.__frame_rx_sequence += 1
+                    if(self.__frame_rx_sequence > 255):
+                        self.__frame_rx_sequence = 0
+                    
+                    # Increase frame drop counter if sequence is mismatched                               
+                    if(self.__frame_rx_sequence != self.__frame_rx_seq_tmp):
+                        self.__rx_seq_err_cnt += 1
+                        self.__frame_drop += 1
+                        self.__frame_rx_sequence = self.__frame_rx_seq_tmp
                 
-                    # Detect frame start flag
-                    elif(num == 0x7E):
-                        self.__frame_sflag = 0x7E
-                        self.__frame_rx_bytes = 1
-                        self.__frame_checksum_offset = 0
-                        
-                        self.__frame_string = byte
+                    # Records of container frame are queued as frames
+                    if(frame_struct.cmd == MP_CONTAINER_ID):
+                        frame_structs = frame_struct.records
+                    else:
+                        frame_structs = [frame_struct]
+                
+                    for frame_struct in frame_structs:
+                        if(self.__frame_rx_queue != None):
                         
-                        self.__rx_crc_object.crc = 0xFFFF
-            except:    
-                pass
+                            rx_time = datetime.datetime.now().strftime("%H:%M:%S.%f")
+                            rx_frame = {"data" : frame_struct, "rx_time" : rx_time}
+                
+                            self.__frame_rx_queue.put(rx_frame, True, None)
+                        else:
+                            print frame_struct
+                
+                # Incorrect CRC 
+                else:
+                    self.__rx_crc_err_cnt += 1
+                    print "Frm cnt, CRC err, seq err = ", self.__rx_frm_cnt, ", ", self.__rx_crc_err_cnt, ", ", self.__rx_seq_err_cnt
+                    
+            else:
+                self.__rx_crc_err_cnt += 1
+                print "Frm cnt, CRC err, seq err = ", self.__rx_frm_cnt, ", ", self.__rx_crc_err_cnt, ", ", self.__rx_seq_err_cnt
+
+                    
+            # Reset RX frame status
+            self.__frame_sflag = 0x00
+
+    def is_peer_cobs(self):
+        return self.__is_peer_cobs
         
     def thread_start(self):
     
@@ -0,0 +1,243 @@
+#!/usr/bin/python
+# -*- coding: UTF-8 -*-
+
+"""
+Stick-to-servo latency from simavr VCD pin traces.
+
+Steps of RC input pulse width are found in the input trace, the latency of
+each step is measured from the falling edge of the first changed input pulse
+to the falling edge of the first servo output pulse which follows the step
+(response), and to the first output pulse of the settled width (settle, it
+includes RC input LPF lag). The histogram bins are the same as the on-device
+profiler (LATENCY_EN, see MP_config.py latency).
+
+Usage:
+    python MP_latency.py trace.vcd --in PIND:2 --out PINB:1
+    python MP_latency.py trace.vcd --in rc_aile --out servo_aile -t 20 -s 4
+
+Signal is the VCD reference name (scope name is optional), ":bit" selects one
+bit of a vector signal, such as an 8 bits port of simavr trace.
+"""
+
+import argparse
+
+from MP_frames import MP_LATENCY_HIST_BINS, MP_LATENCY_HIST_BOUNDS
+
+
+# $timescale unit to picoseconds
+VCD_TIME_UNITS          = {'s': 10 ** 12, 'ms': 10 ** 9, 'us': 10 ** 6, 'ns': 10 ** 3, 'ps': 1, 'fs': 10 ** -3}
+
+
+""" Parse signal argument "NAME[:bit]"
+
+"""
+def vcd_signal_arg(arg):
+
+    if(':' in arg):
+        (name, bit) = arg.rsplit(':', 1)
+        return (name, int(bit))
+
+    return (arg, None)
+
+
+""" Read level changes of signals from VCD file, {(NAME, bit): [(time_us, level)]}
+
+"""
+def vcd_read(file_name, signals):
+
+    timescale_ps = 1
+    id_signals = {}
+    changes = dict((signal, []) for signal in signals)
+    levels = {}
+    scopes = []
+    time_us = 0.0
+
+    tokens = open(file_name).read().split()
+    idx = 0
+
+    while(idx < len(tokens)):
+        token = tokens[idx]
+        idx += 1
+
+        if(token in ('$dumpvars', '$dumpall', '$dumpon', '$dumpoff', '$end')):
+            # Only markers of value changes
+            continue
+
+        if(token.startswith('$')):
+            # Section tokens until $end
+            end_idx = tokens.index('$end', idx)
+            section = tokens[idx:end_idx]
+            idx = end_idx + 1
+
+            if(token == '$timescale'):
+                text = ''.join(section)
+                digits = text.rstrip('abcdefghijklmnopqrstuvwxyz')
+                timescale_ps = int(digits) * VCD_TIME_UNITS[text[len(digits):]]
+
+            elif(token == '$scope'):
+                scopes.append(section[1])
+
+            elif(token == '$upscope'):
+                scopes.pop()
+
+            elif(token == '$var'):
+                # $var type size id reference [index] $end
+                (var_id, name) = (section[2], section[3])
+                for signal in signals:
+                    if(signal[0] in (name, '.'.join(scopes + [name]))):
+                        id_signals.setdefault(var_id, []).append(signal)
+
+        elif(token[0] == '#'):
+            time_us = int(token[1:]) * timescale_ps / 1000000.0
+
+        elif(token[0] in 'bBrR'):
+            (value, var_id) = (token[1:], tokens[idx])
+            idx += 1
+            for signal in id_signals.get(var_id, []):
+                bit = signal[1] if signal[1] is not None else 0
+                level = value[-1 - bit] == '1' if bit < len(value) else False
+                vcd_level_change(changes, levels, signal, time_us, level)
+
+        else:
+            (value, var_id) = (token[0], token[1:])
+            for signal in id_signals.get(var_id, []):
+                vcd_level_change(changes, levels, signal, time_us, value == '1')
+
+    for signal in signals:
+        if(len(changes[signal]) == 0):
+            raise ValueError("No level change of signal %s" % signal[0])
+
+    return changes
+
+
+""" Record level change, vector changes of other bits are filtered
+
+"""
+def vcd_level_change(changes, levels, signal, time_us, level):
+
+    if(levels.get(signal) != level):
+        levels[signal] = level
+        changes[signal].append((time_us, level))
+
+
+""" Get high pulses from level changes, [(rise_us, fall_us)]
+
+"""
+def pulses_get(changes):
+
+    pulses = []
+    rise_us = None
+
+    for (time_us, level) in changes:
+        if(level):
+            rise_us = time_us
+        elif(rise_us is not None):
+            pulses.append((rise_us, time_us))
+            rise_us = None
+
+    return pulses
+
+
+""" Measure latency of every input width step, [(step_us, response_us, settle_us)]
+
+"""
+def latency_measure(in_pulses, out_pulses, in_threshold_us, out_threshold_us):
+
+    steps = []
+
+    for idx in range(1, len(in_pulses)):
+        width = in_pulses[idx][1] - in_pulses[idx][0]
+        if(abs(width - (in_pulses[idx - 1][1] - in_pulses[idx - 1][0])) > in_threshold_us):
+            steps.append(idx)
+
+    results = []
+
+    for (step_idx, in_idx) in enumerate(steps):
+        step_us = in_pulses[in_idx][1]
+        end_us = in_pulses[steps[step_idx + 1]][1] if step_idx + 1 < len(steps) else None
+
+        before = [p for p in out_pulses if p[1] <= step_us]
+        after = [p for p in out_pulses if p[1] > step_us and (end_us is None or p[1] <= end_us)]
+        if(len(before) == 0 or len(after) == 0):
+            continue
+
+        base_width = before[-1][1] - before[-1][0]
+        final_width = after[-1][1] - after[-1][0]
+
+        response_us = None
+        for pulse in after:
+            if(abs((pulse[1] - pulse[0]) - base_width) > out_threshold_us):
+                response_us = pulse[1] - step_us
+                break
+
+        # Settled when all following pulses are within threshold of last width before next step
+        settle_us = None
+        for (idx, pulse) in enumerate(after):
+            if(all(abs((p[1] - p[0]) - final_width) <= out_threshold_us for p in after[idx:])):
+                settle_us = pulse[1] - step_us
+                break
+
+        if(response_us is not None):
+            results.append((step_us, response_us, settle_us))
+
+    return results
+
+
+""" Count latency samples of firmware histogram bins
+
+"""
+def latency_hist(latencies):
+
+    hist = [0] * MP_LATENCY_HIST_BINS
+
+    for latency_us in latencies:
+        bin_idx = 0
+        while(bin_idx < MP_LATENCY_HIST_BINS - 1 and latency_us >= MP_LATENCY_HIST_BOUNDS[bin_idx]):
+            bin_idx += 1
+        hist[bin_idx] += 1
+
+    return hist
+
+
+def main():
+
+    parser = argparse.ArgumentParser(description = 'OneRC stick-to-servo latency of simavr VCD trace')
+    parser.add_argument('vcd', help = 'VCD trace file')
+    parser.add_argument('--in', dest = 'in_signal', required = True, help = 'RC input signal, NAME[:bit]')
+    parser.add_argument('--out', dest = 'out_signal', required = True, help = 'Servo output signal, NAME[:bit]')
+    parser.add_argument('-t', '--threshold', type = float, default = 20.0, help = 'Input step threshold (us)')
+    parser.add_argument('-s', '--settle', type = float, default = 4.0, help = 'Output change threshold (us)')
+    parser.add_argument('-v', '--verbose', action = 'store_true', help = 'Print every step')
+    args = parser.parse_args()
+
+    in_signal = vcd_signal_arg(args.in_signal)
+    out_signal = vcd_signal_arg(args.out_signal)
+    changes = vcd_read(args.vcd, [in_signal, out_signal])
+
+    results = latency_measure(pulses_get(changes[in_signal]), pulses_get(changes[out_signal]),
+                              args.threshold, args.settle)
+
+    if(len(results) == 0):
+        print "No input step with output response"
+        return
+
+    if(args.verbose):
+        for (step_us, response_us, settle_us) in results:
+            print "%12.1f us: response %8.1f us, settle %s" % (
+                  step_us, response_us, '%8.1f us' % settle_us if settle_us is not None else '-')
+
+    print "%d steps" % len(results)
+    print "Histogram bins: <%s, >=%d us" % (', <'.join(str(us) for us in MP_LATENCY_HIST_BOUNDS),
+                                            MP_LATENCY_HIST_BOUNDS[-1])
+
+    for (name, col) in (('response', 1), ('settle', 2)):
+        latencies = [r[col] for r in results if r[col] is not None]
+        if(len(latencies) == 0):
+            continue
+        print "%-9s min %8.1f, avg %8.1f, max %8.1f us, hist %s" % (
+              name, min(latencies), sum(latencies) / len(latencies), max(latencies),
+              ' '.join('%4d' % h for h in latency_hist(latencies)))
+
+
+if __name__ == '__main__':
+    main()
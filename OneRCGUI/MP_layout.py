@@ -0,0 +1,81 @@
+#!/usr/bin/python
+# -*- coding: UTF-8 -*-
+
+"""
+Frame layout exporter.
+
+Write payload layouts of all FC frames (MP_FRM_TABLES) to a text table, so
+tools in other languages (OneRCDecoder) decode frames with the same layouts
+as MP_decoder.py.
+
+Usage:
+    python MP_layout.py -o mp_layout.txt
+
+Table format, one frame per line, tab separated:
+    ID  NAME  FORMAT  FIELDS  [SCALES]
+
+FORMAT is struct format string (little endian, packed). Compact telemetry
+format starts with '@', it is varint heartbeat, varint field mask and int16
+of each field present in field mask, SCALES are the field scales.
+"""
+
+import argparse
+
+import MP_frames
+from MP_frames import *
+
+
+""" Get frame names from MP_*_ID constants, {ID: NAME}
+
+"""
+def mp_layout_names():
+
+    names = {}
+
+    for var_name in sorted(dir(MP_frames)):
+        if(var_name.startswith('MP_TX_') or not var_name.startswith('MP_') or not var_name.endswith('_ID')):
+            continue
+
+        frame_id = getattr(MP_frames, var_name)
+        if(isinstance(frame_id, int) and frame_id >= 128):
+            names.setdefault(frame_id, var_name[len('MP_'):-len('_ID')])
+
+    return names
+
+
+""" Get layout lines of all FC frames
+
+"""
+def mp_layout_lines():
+
+    names = mp_layout_names()
+    lines = []
+
+    for frame_id in sorted(MP_FRM_TABLES):
+        if(frame_id < 128):
+            continue
+
+        payload_struct = MP_FRM_TABLES[frame_id]
+        fields = payload_struct[3].replace(' ', '')
+
+        if(frame_id == MP_TLM_COMPACT_ID):
+            lines.append('\t'.join([str(frame_id), names[frame_id], '@' + payload_struct[2], fields,
+                                    ','.join(MP_TLM_COMPACT_DEFINE[:, 2])]))
+        else:
+            lines.append('\t'.join([str(frame_id), names[frame_id], payload_struct[2], fields]))
+
+    return lines
+
+
+def main():
+
+    parser = argparse.ArgumentParser(description = 'OneRC frame layout exporter')
+    parser.add_argument('-o', '--output', required = True, help = 'Layout table file')
+    args = parser.parse_args()
+
+    with open(args.output, 'w') as layout_file:
+        layout_file.write('\n'.join(mp_layout_lines()) + '\n')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,145 @@
+#!/usr/bin/python
+# -*- coding: UTF-8 -*-
+
+"""
+Binary log expander.
+
+MP_LOG() in firmware sends only the ID of format string (CRC16 of the string)
+and raw arguments. The format strings are collected by scanning MP_LOG() calls
+in firmware source code, so the table always matches the source tree.
+
+Usage:
+    python MP_log.py                        List all log formats of ../OneRCFW
+    python MP_log.py -s src_dir -o table.txt
+                                            Write "ID<TAB>format" table, one per line
+"""
+
+import os
+import re
+import argparse
+
+from struct import *
+
+from MP_CRC import MP_crc
+
+
+MP_LOG_SRC_DIR          = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'OneRCFW')
+MP_LOG_SRC_EXTS         = ('.c', '.cpp', '.h', '.ino')
+
+# MP_LOG("format" "more format", ...)
+MP_LOG_CALL_RE          = re.compile(r'\bMP_LOG\s*\(\s*((?:"(?:\\.|[^"\\])*"\s*)+)')
+MP_LOG_STR_RE           = re.compile(r'"((?:\\.|[^"\\])*)"')
+
+# Same as UartStrm_PrintFormat(), specifier: (argument struct format, printf conversion)
+MP_LOG_SPEC_RE          = re.compile(r'%(hh[udxX]|h[udxX]|[udxXofcs%])')
+MP_LOG_SPECS            = {
+                            'hhu': ('B', '%u'), 'hhd': ('b', '%d'), 'hhx': ('B', '%X'), 'hhX': ('B', '%X'),
+                            'hu':  ('H', '%u'), 'hd':  ('h', '%d'), 'hx':  ('H', '%X'), 'hX':  ('H', '%X'),
+                            'u':   ('I', '%u'), 'd':   ('i', '%d'), 'x':   ('I', '%X'), 'X':   ('I', '%X'),
+                            'o':   ('I', '%o'), 'f':   ('f', '%.2f'), 'c': ('c', '%s'), 's':   ('s', '%s'),
+                          }
+
+
+""" Calculate log ID of format string, same as MP_LogId()
+
+"""
+def mp_log_id(fmt):
+
+    return MP_crc(fmt).crc
+
+
+""" Scan MP_LOG() calls of source tree, return {ID: (format, [locations])}
+
+"""
+def mp_log_scan(src_dir = MP_LOG_SRC_DIR):
+
+    table = {}
+
+    for root, dirs, files in os.walk(src_dir):
+        for file_name in sorted(files):
+            if(not file_name.endswith(MP_LOG_SRC_EXTS)):
+                continue
+
+            path = os.path.join(root, file_name)
+            text = open(path).read()
+
+            for match in MP_LOG_CALL_RE.finditer(text):
+                fmt = ''.join(s.decode('string_escape') for s in MP_LOG_STR_RE.findall(match.group(1)))
+                location = '%s:%d' % (os.path.relpath(path, src_dir), text.count('\n', 0, match.start()) + 1)
+
+                log_id = mp_log_id(fmt)
+                if(log_id in table and table[log_id][0] != fmt):
+                    print "ID collision 0x%04X: %s, %s" % (log_id, table[log_id][1][0], location)
+                    continue
+
+                table.setdefault(log_id, (fmt, []))[1].append(location)
+
+    return table
+
+
+""" Expand log frame payload (ID + raw arguments) to text
+
+"""
+def mp_log_expand(table, payload):
+
+    (log_id,) = unpack('<H', payload[:2])
+    args = payload[2:]
+
+    if(log_id not in table):
+        return "[LOG 0x%04X] %s" % (log_id, args.encode('hex'))
+
+    fmt = table[log_id][0]
+    text = ''
+    offset = 0
+    last = 0
+
+    for match in MP_LOG_SPEC_RE.finditer(fmt):
+        text += fmt[last:match.start()]
+        last = match.end()
+
+        spec = match.group(1)
+        if(spec == '%'):
+            text += '%'
+            continue
+
+        (arg_fmt, conversion) = MP_LOG_SPECS[spec]
+
+        # Arguments after truncated string are not sent
+        if(arg_fmt == 's'):
+            end = args.find('\0', offset)
+            if(end < 0):
+                end = len(args)
+            value = args[offset:end]
+            offset = end + 1
+        elif(offset + calcsize('<' + arg_fmt) <= len(args)):
+            (value,) = unpack('<' + arg_fmt, args[offset:offset + calcsize('<' + arg_fmt)])
+            offset += calcsize('<' + arg_fmt)
+        else:
+            value = '?'
+            conversion = '%s'
+
+        text += conversion % value
+
+    return text + fmt[last:]
+
+
+def main():
+
+    parser = argparse.ArgumentParser(description = 'OneRC binary log format table')
+    parser.add_argument('-s', '--src', default = MP_LOG_SRC_DIR, help = 'Firmware source directory')
+    parser.add_argument('-o', '--output', help = 'Write "ID<TAB>format" table file')
+    args = parser.parse_args()
+
+    table = mp_log_scan(args.src)
+
+    if(args.output):
+        with open(args.output, 'w') as table_file:
+            for log_id in sorted(table):
+                table_file.write("%04X\t%s\n" % (log_id, table[log_id][0].encode('string_escape')))
+
+    for log_id in sorted(table):
+        print "0x%04X  %-40s %s" % (log_id, table[log_id][0], ', '.join(table[log_id][1]))
+
+
+if __name__ == '__main__':
+    main()
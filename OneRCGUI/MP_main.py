@@ -16,6 +16,7 @@ class MainGUI(MP_GUI.frm_MPMain):
     __mp_handler = MP_handler()
     __mp_att_roll_plot = None
     __mp_att_pitch_plot = None
+    __mp_is_tlm_compact = False         # Attitude and gyro are plotted from compact telemetry
     
     __mp_frame_queue = Queue.Queue(0)
     __mp_console_message_queue = Queue.Queue(0)
@@ -44,7 +45,7 @@ class MainGUI(MP_GUI.frm_MPMain):
         
         # Initial baud rate options
         baud = ['600', '1200', '2400', '4800', '9600', '14400', '19200', '28800',       \
-                '38400', '56000', '57600', '115200', '128000', '256000']
+                '38400', '56000', '57600', '115200', '128000', '250000', '256000', '500000', '1000000']
         self.combo_BaudRate.SetItems(baud)
         self.combo_BaudRate.SetStringSelection('57600')
         
@@ -119,7 +120,23 @@ class MainGUI(MP_GUI.frm_MPMain):
         
     def __frame_plotter(self, rx_frame):
         if(rx_frame != None):
-            if(rx_frame.cmd == MP_AHRS_FULL_ID):
+            if(rx_frame.cmd == MP_TLM_COMPACT_ID):
+                self.__mp_is_tlm_compact = True
+                if(rx_frame.ned_roll == None):
+                    return
+                
+                if(self.__mp_att_roll_plot != None):
+                    self.__mp_att_roll_plot.add_data(float(rx_frame.ned_roll))
+                if(self.__mp_att_pitch_plot != None):
+                    self.__mp_att_pitch_plot.add_data(float(rx_frame.ned_pitch))
+                if(self.__mp_gyro_sensor_x != None):
+                    self.__mp_gyro_sensor_x.add_data(int(rx_frame.g_snr_x))
+                if(self.__mp_gyro_sensor_y != None):
+                    self.__mp_gyro_sensor_y.add_data(int(rx_frame.g_snr_y))
+                if(self.__mp_gyro_sensor_z != None):
+                    self.__mp_gyro_sensor_z.add_data(int(rx_frame.g_snr_z))
+                    
+            if(rx_frame.cmd == MP_AHRS_FULL_ID and self.__mp_is_tlm_compact == False):
                 if(self.__mp_att_roll_plot != None):
                     self.__mp_att_roll_plot.add_data(float(rx_frame.ned_roll))
                     
@@ -141,12 +158,13 @@ class MainGUI(MP_GUI.frm_MPMain):
                     self.__mp_accel_vector_z.add_data(int(rx_frame.a_vctr_z))
                     
             if(rx_frame.cmd == MP_AHRS_FULL_ID):        
-                if(self.__mp_gyro_sensor_x != None):
-                    self.__mp_gyro_sensor_x.add_data(int(rx_frame.g_snr_x))
-                if(self.__mp_gyro_sensor_y != None):
-                    self.__mp_gyro_sensor_y.add_data(int(rx_frame.g_snr_y))
-                if(self.__mp_gyro_sensor_z != None):
-                    self.__mp_gyro_sensor_z.add_data(int(rx_frame.g_snr_z))
+                if(self.__mp_is_tlm_compact == False):
+                    if(self.__mp_gyro_sensor_x != None):
+                        self.__mp_gyro_sensor_x.add_data(int(rx_frame.g_snr_x))
+                    if(self.__mp_gyro_sensor_y != None):
+                        self.__mp_gyro_sensor_y.add_data(int(rx_frame.g_snr_y))
+                    if(self.__mp_gyro_sensor_z != None):
+                        self.__mp_gyro_sensor_z.add_data(int(rx_frame.g_snr_z))
                 if(self.__mp_gyro_vector_x != None):
                     self.__mp_gyro_vector_x.add_data(int(rx_frame.level_vctr_x))
                 if(self.__mp_gyro_vector_y != None):
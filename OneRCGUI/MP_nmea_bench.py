@@ -0,0 +1,463 @@
+#!/usr/bin/python
+# -*- coding: UTF-8 -*-
+
+"""
+NMEA parser benchmark.
+
+Stream a recorded NMEA corpus (mixed with injected corruptions) to the FC
+through MP protocol, the FC feeds it to GPS_UpdateNMEA() instead of GPS module
+(GPS_BENCH_EN must be set to true in gps.h) and measures parser ticks.
+
+A reference model of GPS_RecvNMEA() runs on the same stream to get expected
+decoded frames and GPS_ErrorLog counters.
+
+Usage:
+    python MP_nmea_bench.py [-p COM3] [-b 57600] [--synth 3600] [--fault 0.02] [log1.nmea ...]
+
+    Without -p, only the reference model is run (corpus correctness yardstick).
+"""
+
+import sys
+import time
+import random
+import argparse
+from struct import *
+from MP_frames import *
+
+
+MP_BENCH_CHUNK_SIZE     = 56        # MP RX buffer is 64 bytes (header 4 + CRC 2)
+MP_BENCH_RSP_TIMEOUT    = 2.0       # seconds
+
+TIMER1_PRESCALER        = 8         # 1 tick = 8 CPU cycles
+TIMER1_FREQ             = 2000000.0
+
+NMEA_BUF_SIZE           = 96        # sizeof(GPS_RxNMEAMsgBuf)
+
+NMEA_TYPE_GGA           = 0x00
+NMEA_TYPE_RMC           = 0x40
+NMEA_TYPE_UNKNOWN       = 0xE0
+
+NMEA_WAIT_START         = 0
+NMEA_WAIT_FIELD         = 1
+NMEA_WAIT_CHKSUM        = 2
+NMEA_WAIT_END           = 3
+
+
+#******************************************************************************
+# Reference model of GPS_RecvNMEA() and GPS_DecodeNMEA_Filed()
+#******************************************************************************
+
+def c_str(field):
+    return field.split('\0')[0]
+
+def is_digits(field):
+    # Same as the FC parser, only ASCII '0' ~ '9' are accepted
+    return all('0' <= ch <= '9' for ch in field)
+
+def is_strtof(field):
+    field = c_str(field)
+    if(field == ''):
+        return False
+    if(field[0] == '-'):
+        field = field[1:]
+    integer, dot, fraction = field.partition('.')
+    if(integer and not is_digits(integer)):
+        return False
+    if(fraction and not is_digits(fraction)):
+        return False
+    return len(fraction) < 10
+
+def is_strtoi(field):
+    field = c_str(field)
+    if(field == ''):
+        return False
+    if(field[0] == '-'):
+        field = field[1:]
+    return is_digits(field)
+
+def int32(value):
+    value &= 0xFFFFFFFF
+    return value - 0x100000000 if value & 0x80000000 else value
+
+def int16(value):
+    value &= 0xFFFF
+    return value - 0x10000 if value & 0x8000 else value
+
+def fast_strtof(field):
+    # Same as GPS_FastStrtof(), integer part is accumulated in int32_t
+    field = c_str(field)
+    sign = 1
+    if(field[:1] == '-'):
+        sign = -1
+        field = field[1:]
+    integer, dot, fraction = field.partition('.')
+    tmp1 = 0
+    for ch in integer:
+        tmp1 = int32(tmp1 * 10 + ord(ch) - ord('0'))
+    tmp2 = int(fraction) if fraction else 0
+    return sign * (tmp1 + tmp2 * (0.1 ** len(fraction)))
+
+def dm_to_dd(field):
+    # Same as GPS_DM_TO_DD(), degree is 16 bits int on AVR
+    dm_val = fast_strtof(field)
+    degree = int16(int(dm_val * 0.01))
+    return degree + (dm_val - degree * 100) / 60.0
+
+def is_coord(field, limit):
+    return is_strtof(field) and dm_to_dd(field) <= limit
+
+# (type | field index) -> field checker, same switch cases as GPS_DecodeNMEA_Filed()
+NMEA_FIELD_CHECKER = {
+    NMEA_TYPE_GGA | 0x01:   is_strtof,                                  # UTC
+    NMEA_TYPE_GGA | 0x02:   lambda f: is_coord(f, 90.0),                # LAT
+    NMEA_TYPE_GGA | 0x03:   lambda f: c_str(f) in ('N', 'S'),           # N/S
+    NMEA_TYPE_GGA | 0x04:   lambda f: is_coord(f, 180.0),               # LONG
+    NMEA_TYPE_GGA | 0x05:   lambda f: c_str(f) in ('E', 'W'),           # E/W
+    NMEA_TYPE_GGA | 0x06:   is_strtoi,                                  # Fix status
+    NMEA_TYPE_GGA | 0x07:   is_strtoi,                                  # SV used
+    NMEA_TYPE_GGA | 0x08:   is_strtof,                                  # HDOP
+    NMEA_TYPE_GGA | 0x09:   is_strtof,                                  # ALT
+    NMEA_TYPE_GGA | 0x0A:   lambda f: c_str(f) == 'M',                  # ALT unit
+    NMEA_TYPE_RMC | 0x02:   lambda f: c_str(f) in ('V', 'A'),           # Nav status
+    NMEA_TYPE_RMC | 0x07:   is_strtof,                                  # Speed
+    NMEA_TYPE_RMC | 0x08:   is_strtof,                                  # COG
+    NMEA_TYPE_RMC | 0x09:   is_strtoi,                                  # Date
+    NMEA_TYPE_RMC | 0x0C:   lambda f: c_str(f) in ('N', 'A', 'D', 'E'), # Mode
+}
+
+def hextoul(hex_str):
+    value = 0
+    for ch in c_str(hex_str):
+        num = ord(ch)
+        if(ch >= '0' and ch <= '9'):
+            num = num - ord('0')
+        elif(ch >= 'a' and ch <= 'f'):
+            num = num - ord('a') + 10
+        elif(ch >= 'A' and ch <= 'F'):
+            num = num - ord('A') + 10
+        value = (value << 4) | (num & 0xF)
+    return value
+
+class NMEA_model(object):
+
+    def __init__(self):
+        self.state = NMEA_WAIT_START
+        self.buf_idx = 0
+        self.field = ''
+        self.field_cnt = 0
+        self.nmea_type = NMEA_TYPE_UNKNOWN
+        self.chksum = 0
+        self.chksum_buf = ''
+
+        self.gga_cnt = 0
+        self.rmc_cnt = 0
+        self.unknown_cnt = 0
+        self.field_err = 0
+        self.chksum_err = 0
+        self.end_err = 0
+
+    def decode(self):
+        checker = NMEA_FIELD_CHECKER.get((self.nmea_type | self.field_cnt) & 0xFF)
+        return checker is None or checker(self.field)
+
+    def feed(self, stream):
+        for ch in stream:
+            self.feed_byte(ch)
+
+    def feed_byte(self, ch):
+
+        if(self.buf_idx == NMEA_BUF_SIZE):
+            self.state = NMEA_WAIT_START
+
+        if(self.state == NMEA_WAIT_START):
+            self.buf_idx = 0
+            if(ch == '$' or ch == '!'):
+                self.buf_idx = 1
+                self.field = ''
+                self.field_cnt = 0
+                self.chksum = 0
+                self.chksum_buf = ''
+                self.nmea_type = NMEA_TYPE_UNKNOWN
+                self.state = NMEA_WAIT_FIELD
+
+        elif(self.state == NMEA_WAIT_FIELD):
+            self.buf_idx += 1
+            if(ch == ','):
+                self.chksum ^= ord(ch)
+                if(self.field_cnt == 0):
+                    if(c_str(self.field) == 'GPGGA'):
+                        self.nmea_type = NMEA_TYPE_GGA
+                    elif(c_str(self.field) == 'GPRMC'):
+                        self.nmea_type = NMEA_TYPE_RMC
+                    else:
+                        self.nmea_type = NMEA_TYPE_UNKNOWN
+                elif(not self.decode()):
+                    self.field_err += 1
+                    self.state = NMEA_WAIT_START
+                self.field = ''
+                self.field_cnt += 1
+            elif(ch == '*'):
+                if(self.decode()):
+                    self.state = NMEA_WAIT_CHKSUM
+                else:
+                    self.field_err += 1
+                    self.state = NMEA_WAIT_START
+            else:
+                self.chksum ^= ord(ch)
+                self.field += ch
+
+        elif(self.state == NMEA_WAIT_CHKSUM):
+            self.buf_idx += 1
+            self.chksum_buf += ch
+            if(len(self.chksum_buf) == 2):
+                if((hextoul(self.chksum_buf) & 0xFF) == self.chksum):
+                    self.state = NMEA_WAIT_END
+                else:
+                    self.chksum_err += 1
+                    self.state = NMEA_WAIT_START
+
+        elif(self.state == NMEA_WAIT_END):
+            if(ch == '\r' or ch == '\n'):
+                if(self.nmea_type == NMEA_TYPE_GGA):
+                    self.gga_cnt += 1
+                elif(self.nmea_type == NMEA_TYPE_RMC):
+                    self.rmc_cnt += 1
+                else:
+                    self.unknown_cnt += 1
+            else:
+                self.end_err += 1
+            self.state = NMEA_WAIT_START
+
+
+#******************************************************************************
+# Corpus generator and fault injection
+#******************************************************************************
+
+def nmea_sentence(body):
+    chksum = 0
+    for ch in body:
+        chksum ^= ord(ch)
+    return '$%s*%02X\r\n' % (body, chksum)
+
+def dd_to_dm(dd_val):
+    degree = int(dd_val)
+    return degree * 100 + (dd_val - degree) * 60.0
+
+def synth_corpus(seconds, rate_hz, rnd):
+    """ Synthesize u-blox 6 like GGA/RMC (+ some GSV/VTG) output """
+    sentences = []
+    lat = 24.7736
+    lon = 121.0453
+    cog = 0.0
+    speed = 15.0
+    alt = 100.0
+
+    for epoch in range(int(seconds * rate_hz)):
+
+        utc_ms = (epoch * 1000 // rate_hz) % 86400000
+        utc = '%02d%02d%02d.%02d' % (utc_ms // 3600000, (utc_ms // 60000) % 60,
+                                     (utc_ms // 1000) % 60, (utc_ms % 1000) // 10)
+        has_fix = (epoch % 600) >= 20     # First 20 epochs of every 600 without fix
+
+        cog = (cog + rnd.uniform(-5.0, 5.0)) % 360.0
+        speed = min(max(speed + rnd.uniform(-0.5, 0.5), 0.0), 30.0)
+        lat += speed / rate_hz * np.cos(np.radians(cog)) / 111320.0
+        lon += speed / rate_hz * np.sin(np.radians(cog)) / (111320.0 * np.cos(np.radians(lat)))
+        alt += rnd.uniform(-0.3, 0.3)
+
+        if(has_fix):
+            sentences.append(nmea_sentence('GPRMC,%s,A,%010.5f,N,%011.5f,E,%.3f,%.2f,180318,,,A'
+                                           % (utc, dd_to_dm(lat), dd_to_dm(lon), speed / 0.5144444, cog)))
+            sentences.append(nmea_sentence('GPGGA,%s,%010.5f,N,%011.5f,E,1,%02d,%.2f,%.1f,M,16.3,M,,'
+                                           % (utc, dd_to_dm(lat), dd_to_dm(lon), rnd.randint(5, 12),
+                                              rnd.uniform(0.7, 2.5), alt)))
+        else:
+            sentences.append(nmea_sentence('GPRMC,%s,V,,,,,,,180318,,,N' % utc))
+            sentences.append(nmea_sentence('GPGGA,%s,,,,,0,00,99.99,,,,,,' % utc))
+
+        if(epoch % rate_hz == 0):
+            sentences.append(nmea_sentence('GPVTG,%.2f,T,,M,%.3f,N,%.3f,K,A' % (cog, speed / 0.5144444, speed * 3.6)))
+            sentences.append(nmea_sentence('GPGSV,3,1,12,01,42,048,36,03,19,212,29,06,67,330,41,07,29,043,33'))
+
+    return sentences
+
+def load_corpus(file_names):
+    sentences = []
+    for file_name in file_names:
+        data = open(file_name, 'rb').read()
+        if(not isinstance(data, str)):
+            data = data.decode('latin-1')
+        sentences.extend([line + '\n' for line in data.split('\n') if line])
+    return sentences
+
+def inject_faults(sentences, fault_rate, rnd):
+    """ Return faulty stream and injected fault statistic """
+    faults = {'chksum': 0, 'byte': 0, 'truncate': 0, 'end': 0, 'garbage': 0}
+    stream = []
+
+    for sentence in sentences:
+
+        if(rnd.random() >= fault_rate or len(sentence) < 12):
+            stream.append(sentence)
+            continue
+
+        fault = rnd.choice(sorted(faults.keys()))
+        faults[fault] += 1
+        star = sentence.rfind('*')
+
+        if(fault == 'chksum' and star > 0):
+            digit = '0' if sentence[star + 1] != '0' else '1'
+            sentence = sentence[:star + 1] + digit + sentence[star + 2:]
+        elif(fault == 'byte'):
+            pos = rnd.randint(1, len(sentence) - 3)
+            sentence = sentence[:pos] + chr(rnd.randint(0, 255)) + sentence[pos + 1:]
+        elif(fault == 'truncate'):
+            sentence = sentence[:rnd.randint(1, len(sentence) - 3)]
+        elif(fault == 'end' and star > 0):
+            sentence = sentence[:star + 3] + 'X' + sentence[star + 3:]
+        else:
+            sentence = ''.join(chr(rnd.randint(0, 255)) for i in range(rnd.randint(1, 40))) + sentence
+
+        stream.append(sentence)
+
+    return ''.join(stream), faults
+
+
+#******************************************************************************
+# Benchmark on FC
+#******************************************************************************
+
+def wait_bench_rsp(rx_queue, rsp_id):
+    deadline = time.time() + MP_BENCH_RSP_TIMEOUT
+    while(time.time() < deadline):
+        try:
+            rx_frame = rx_queue.get(True, 0.1)
+        except:
+            continue
+        if(rx_frame["data"].cmd == rsp_id):
+            return rx_frame["data"]
+    return None
+
+def run_on_fc(port_name, baud_rate, stream):
+
+    import Queue
+    from MP_handler import MP_handler
+
+    rx_queue = Queue.Queue(0)
+    mp_handler = MP_handler()
+    mp_handler.set_rx_frame_queue(rx_queue)
+    mp_handler.open_serial(port_name, baud_rate)
+    mp_handler.thread_start()
+
+    stat = None
+
+    try:
+        mp_handler.transmit_frame(MP_TX_GPS_BENCH_RESET_ID, '')
+        stat = wait_bench_rsp(rx_queue, MP_GPS_BENCH_RESET_ID)
+        if(stat == None):
+            print "No response from FC, is GPS_BENCH_EN enabled?"
+            return None
+
+        start_time = time.time()
+
+        for offset in range(0, len(stream), MP_BENCH_CHUNK_SIZE):
+
+            mp_handler.transmit_frame(MP_TX_GPS_BENCH_FEED_ID,
+                                      stream[offset:offset + MP_BENCH_CHUNK_SIZE])
+
+            stat = wait_bench_rsp(rx_queue, MP_GPS_BENCH_FEED_ID)
+            if(stat == None):
+                print "Feed timeout at byte %d" % offset
+                return None
+
+            if(offset % (MP_BENCH_CHUNK_SIZE * 200) == 0):
+                sys.stdout.write("\r%d / %d bytes, %.1f s" % (offset, len(stream), time.time() - start_time))
+                sys.stdout.flush()
+
+        print ""
+
+    finally:
+        mp_handler.thread_stop()
+        mp_handler.close_serial()
+
+    return stat
+
+
+#******************************************************************************
+# Main
+#******************************************************************************
+
+def main():
+
+    parser = argparse.ArgumentParser(description = 'OneRC NMEA parser benchmark')
+    parser.add_argument('corpus', nargs = '*', help = 'Recorded NMEA log files')
+    parser.add_argument('-p', '--port', help = 'FC serial port, run reference model only if omitted')
+    parser.add_argument('-b', '--baud', type = int, default = 57600)
+    parser.add_argument('--synth', type = float, default = 0.0, help = 'Synthesize N seconds of GPS output')
+    parser.add_argument('--rate', type = int, default = 5, help = 'Synthetic navigation rate (Hz)')
+    parser.add_argument('--fault', type = float, default = 0.02, help = 'Fault injection rate per sentence')
+    parser.add_argument('--seed', type = int, default = 1)
+    args = parser.parse_args()
+
+    rnd = random.Random(args.seed)
+
+    sentences = load_corpus(args.corpus)
+    if(args.synth > 0 or len(sentences) == 0):
+        sentences.extend(synth_corpus(args.synth if args.synth > 0 else 600, args.rate, rnd))
+
+    stream, faults = inject_faults(sentences, args.fault, rnd)
+
+    # Expected result
+    model = NMEA_model()
+    start_time = time.time()
+    model.feed(stream)
+    model_time = time.time() - start_time
+
+    print "Corpus: %d sentences, %d bytes, seed %d" % (len(sentences), len(stream), args.seed)
+    print "Faults: " + ', '.join('%s %d' % (k, faults[k]) for k in sorted(faults.keys()))
+    print "Model : %.0f bytes/s on host" % (len(stream) / max(model_time, 1e-6))
+
+    expected = [
+        ('gga_cnt',     model.gga_cnt,      0xFFFF),
+        ('rmc_cnt',     model.rmc_cnt,      0xFFFF),
+        ('unknown_cnt', model.unknown_cnt,  0xFFFF),
+        ('field_err',   model.field_err,    0xFF),
+        ('chksum_err',  model.chksum_err,   0xFF),
+        ('end_err',     model.end_err,      0xFF),
+        ('rx_timeout',  0,                  0xFF),
+    ]
+
+    if(args.port == None):
+        for name, value, mask in expected:
+            print "    %-12s %8d" % (name, value)
+        return 0
+
+    stat = run_on_fc(args.port, args.baud, stream)
+    if(stat == None):
+        return 1
+
+    # Compare counters, FC counters are wrapped by their own size
+    result = 0
+    print "    %-12s %8s %8s" % ('counter', 'expected', 'FC')
+    for name, value, mask in expected:
+        fc_value = getattr(stat, name)
+        is_pass = (value & mask) == fc_value
+        result |= (not is_pass)
+        print "    %-12s %8d %8d  %s" % (name, value & mask, fc_value, 'PASS' if is_pass else 'FAIL')
+
+    if(stat.rx_bytes != len(stream)):
+        result = 1
+        print "Byte count mismatched: %d / %d" % (stat.rx_bytes, len(stream))
+
+    # Throughput, timer 1 ticks are 0.5 us (8 CPU cycles)
+    if(stat.parse_ticks):
+        print "Throughput: %.0f bytes/s, %.1f cycles/byte, %.0f cycles/sentence, max call %d cycles" % \
+              (stat.rx_bytes * TIMER1_FREQ / stat.parse_ticks,
+               stat.parse_ticks * TIMER1_PRESCALER / float(stat.rx_bytes),
+               stat.parse_ticks * TIMER1_PRESCALER / float(len(sentences)),
+               stat.parse_max_ticks * TIMER1_PRESCALER)
+
+    return result
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,15 @@
+/*
+ * Host build of OneRCLib sources for tools/l1_test, only what mission.cpp
+ * uses from Arduino core.
+ */
+
+#ifndef ARDUINO_H_
+#define ARDUINO_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+
+#define constrain(amt, low, high)   ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+#endif /* ARDUINO_H_ */
@@ -0,0 +1,16 @@
+/*
+ * Host build of OneRCLib sources for tools/l1_test, program memory is
+ * ordinary memory.
+ */
+
+#ifndef PGMSPACE_H_
+#define PGMSPACE_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PSTR(s)                     (s)
+#define pgm_read_word(addr)         (*(const uint16_t *)(addr))
+
+#endif /* PGMSPACE_H_ */
@@ -0,0 +1,533 @@
+/**
+ *******************************************************************************
+ *      ______  _   __  ______  ____     ______        ___    ______   ____
+ *     / __  / / \ / / / ____/ / __ \   /  ___/       /  /   /_   _/  / __ \
+ *    / /_/ / /   \ / / ____/ /  -- /  /  /__   __   /  /__  _/  /_  / __ <
+ *   /_____/ /_/ \_/ /_____/ /__/ \_\ /_____/  /_/  /_____/ /_____/ /_____/
+ *
+ *     An amateur remote control software library. Use at your own risk.
+ *
+ * @file    l1_test.cpp
+ * @brief   Host test of mission leg L1 guidance (mission.cpp).
+ *
+ *          Kinematic check:
+ *              A square mission is uploaded to a RAM ROM, then flown by a
+ *              point mass airplane in crosswind. Bank angle command of
+ *              Mission_UpdateGuidance() is followed with a limited roll
+ *              rate, heading changes as a coordinated turn. GPS fixes are
+ *              fed to Mission_UpdateFix() at GPS rate. Every leg must be
+ *              completed, and the cross-track error on straight segments
+ *              must stay within limits. Overshoot after each turn is
+ *              printed, legs are switched at the waypoint without turn
+ *              anticipation.
+ *
+ *          CPU check:
+ *              Host time per call of the waypoint bearing and distance
+ *              calculated by GPS_UpdateNav() on every fix (before), and of
+ *              Mission_UpdateFix() on every fix plus Mission_UpdateGuidance()
+ *              on every control cycle (after). Host has hardware floating
+ *              point, the numbers only compare the code paths, AVR cycles
+ *              must be measured on target.
+ * @author  Y.S.Kuo in Hsinchu
+ *******************************************************************************
+ */
+
+/*
+ * Structures are packed as on AVR, ROM mission header and pages are CRCed
+ * as a whole.
+ *
+ * Build:
+ *      g++ -std=gnu++11 -O2 -fno-strict-aliasing -fpack-struct=1 -Wall -Ihost \
+ *          -I../../OneRCFW/libraries/OneRCLib -o l1_test l1_test.cpp \
+ *          ../../OneRCFW/libraries/OneRCLib/mission.cpp \
+ *          ../../OneRCFW/libraries/OneRCLib/crc_ccitt.cpp \
+ *          ../../OneRCFW/libraries/OneRCLib/math_lib.cpp
+ *
+ * Usage:
+ *      l1_test
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+
+#include "mission.h"
+#include "gps.h"
+#include "math_lib.h"
+
+
+/*
+ *******************************************************************************
+ * Constant value definition
+ *******************************************************************************
+ */
+
+#define L1TEST_ROM_SIZE             1024    /* ATmega328P EEPROM */
+
+#define L1TEST_CTRL_PERIOD_MS       5       /* Control cycle */
+#define L1TEST_FIX_PERIOD_MS        200     /* GPS 5Hz, see UBLOX6M_CFG_MEAS_RATE */
+#define L1TEST_TIMEOUT_MS           600000
+
+#define L1TEST_ORIGIN_LAT_DD        24.79
+#define L1TEST_ORIGIN_LONG_DD       121.03
+#define L1TEST_SQUARE_METERS        400.0
+#define L1TEST_AIRSPEED_MS          15.0
+#define L1TEST_WIND_N_MS            0.0
+#define L1TEST_WIND_E_MS            (-5.0)  /* Blows to west, crosswind of north/south legs */
+#define L1TEST_ROLL_RATE_DPS        60.0    /* Max roll rate of the airplane */
+#define L1TEST_GRAVITY_MS2          9.80665
+
+/* Cross-track error is checked after the airplane is settled on the leg */
+#define L1TEST_SETTLE_METERS        200.0
+#define L1TEST_XTRACK_MEAN_MAX      2.0
+#define L1TEST_XTRACK_PEAK_MAX      5.0
+
+#define L1TEST_BENCH_LOOPS          1000000
+
+/* Degree of latitude per meter, same as mission.cpp */
+#define L1TEST_METERS_TO_LAT_DD     MATH_RAD2DEG(1.0 / GPS_EARTH_RADIUS_METERS)
+
+
+/*
+ *******************************************************************************
+ * Data type definition
+ *******************************************************************************
+ */
+
+typedef struct l1test_leg_stat{
+    double overshoot;                   /* Peak cross-track error of whole leg */
+    double xtrack_sum;
+    double xtrack_peak;
+    uint32_t sample_cnt;
+    uint32_t done_ms;
+}L1TEST_LEG_STAT;
+
+
+/*
+ *******************************************************************************
+ * Global variables
+ *******************************************************************************
+ */
+
+static uint8_t L1Test_Rom[L1TEST_ROM_SIZE];
+
+/* Mission legs, the first leg starts at mission origin */
+static const double L1Test_Square[][2] =
+{
+    {L1TEST_SQUARE_METERS, 0.0},
+    {L1TEST_SQUARE_METERS, L1TEST_SQUARE_METERS},
+    {0.0, L1TEST_SQUARE_METERS},
+    {0.0, 0.0},
+};
+
+#define L1TEST_WPT_NUM              (sizeof(L1Test_Square) / sizeof(L1Test_Square[0]))
+
+static volatile float L1Test_Sink;
+
+
+/*
+ *******************************************************************************
+ * Private functions declaration
+ *******************************************************************************
+ */
+
+static int8_t L1Test_Upload(GPS_COORD_POINT *p_origin);
+static void L1Test_ToCoord(GPS_COORD_POINT *p_origin, double north_m, double east_m,
+                           GPS_COORD_POINT *p_coord);
+static int8_t L1Test_Fly(GPS_COORD_POINT *p_origin);
+static void L1Test_Bench(GPS_COORD_POINT *p_origin);
+static float L1Test_NavBearingDistance(GPS_COORD_POINT *p_src, GPS_COORD_POINT *p_dest);
+
+
+/*
+ *******************************************************************************
+ * Public functions
+ *******************************************************************************
+ */
+
+int main(int argc, char *argv[])
+{
+    GPS_COORD_POINT origin;
+    int8_t result;
+
+    memset(L1Test_Rom, 0xFF, sizeof(L1Test_Rom));
+
+    origin.LAT_DD = L1TEST_ORIGIN_LAT_DD;
+    origin.LONG_DD = L1TEST_ORIGIN_LONG_DD;
+
+    Mission_Init();
+
+    if(L1Test_Upload(&origin) != 0){
+        printf("FAIL mission upload\n");
+        return EXIT_FAILURE;
+    }
+
+    L1Test_Bench(&origin);
+
+    result = L1Test_Fly(&origin);
+
+    printf("%s %.0f m square, %.0f m/s airspeed, %.0f m/s crosswind\n",
+           (result == 0) ? "PASS" : "FAIL", L1TEST_SQUARE_METERS, L1TEST_AIRSPEED_MS,
+           fabs(L1TEST_WIND_E_MS));
+
+    return (result == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* ROM driver of host, writing is done immediately */
+bool ROM_IsBusy()
+{
+    return false;
+}
+
+int8_t ROM_ReadBytes(uint16_t rom_addr, uint8_t *p_data, uint16_t data_size)
+{
+    if(rom_addr + data_size > sizeof(L1Test_Rom))
+        return -1;
+
+    memcpy(p_data, &L1Test_Rom[rom_addr], data_size);
+
+    return 0;
+}
+
+int8_t ROM_UpdateBytes(uint16_t rom_addr, uint8_t *p_data, uint16_t data_size)
+{
+    if(rom_addr + data_size > sizeof(L1Test_Rom))
+        return -1;
+
+    memcpy(&L1Test_Rom[rom_addr], p_data, data_size);
+
+    return 0;
+}
+
+int8_t ROM_UpdateStep(uint16_t rom_addr, uint8_t *p_data, uint16_t data_size,
+                      uint16_t *p_offset)
+{
+    if(ROM_UpdateBytes(rom_addr, p_data, data_size) != 0)
+        return -1;
+
+    *p_offset = data_size;
+
+    return 0;
+}
+
+void Uart0_Println(const char *p_fmt, ...)
+{
+}
+
+void MP_SendLog(uint16_t log_id, uint16_t arg_sig, ...)
+{
+}
+
+
+/*
+ *******************************************************************************
+ * Private functions
+ *******************************************************************************
+ */
+
+/**
+ * L1Test_Upload - Function to store the square mission to ROM.
+ *
+ * @param   [in]        *p_origin       Mission origin.
+ *
+ * @return  [int8_t]    Function executing result.
+ * @retval  [0]         Success.
+ * @retval  [-1]        Fail.
+ *
+ */
+static int8_t L1Test_Upload(GPS_COORD_POINT *p_origin)
+{
+    GPS_COORD_POINT coord;
+    uint16_t wpt_idx;
+    int8_t result;
+
+    if(Mission_Create(p_origin) != 0)
+        return -1;
+
+    for(wpt_idx = 0; wpt_idx < L1TEST_WPT_NUM; wpt_idx++){
+
+        L1Test_ToCoord(p_origin, L1Test_Square[wpt_idx][0], L1Test_Square[wpt_idx][1], &coord);
+
+        /* Busy while previous page is being written */
+        while((result = Mission_SetWpt(wpt_idx, &coord)) == 1)
+            Mission_Task();
+
+        if(result != 0)
+            return -1;
+    }
+
+    if(Mission_Commit(L1TEST_WPT_NUM) != 0)
+        return -1;
+
+    while(Mission_Task() == 1);
+
+    /* Load it back from ROM */
+    if(Mission_Init() != 0 || Mission_GetTotalWpt() != L1TEST_WPT_NUM)
+        return -1;
+
+    return 0;
+}
+
+/**
+ * L1Test_ToCoord - Function to convert local north/east position to
+ *                  coordinate.
+ *
+ * @param   [in]        *p_origin       Mission origin.
+ * @param   [in]        north_m         North of origin, meters.
+ * @param   [in]        east_m          East of origin, meters.
+ * @param   [out]       *p_coord        Coordinate.
+ *
+ * @return  [none]
+ *
+ */
+static void L1Test_ToCoord(GPS_COORD_POINT *p_origin, double north_m, double east_m,
+                           GPS_COORD_POINT *p_coord)
+{
+    p_coord->LAT_DD = p_origin->LAT_DD + north_m * L1TEST_METERS_TO_LAT_DD;
+    p_coord->LONG_DD = p_origin->LONG_DD
+                       + east_m * L1TEST_METERS_TO_LAT_DD / cos(MATH_DEG2RAD(p_origin->LAT_DD));
+}
+
+/**
+ * L1Test_Fly - Function to fly the stored mission and check cross-track
+ *              error of each leg.
+ *
+ * The airplane starts south west of the origin heading east, so the first
+ * leg includes the capture of the track, it's not checked.
+ *
+ * @param   [in]        *p_origin       Mission origin.
+ *
+ * @return  [int8_t]    Function executing result.
+ * @retval  [0]         All legs are completed within limits.
+ * @retval  [-1]        Fail.
+ *
+ */
+static int8_t L1Test_Fly(GPS_COORD_POINT *p_origin)
+{
+    L1TEST_LEG_STAT leg_stat[L1TEST_WPT_NUM];
+    GPS_NMEA_REPORT nmea;
+    MISSION_GUIDANCE guide;
+    uint32_t time_ms;
+    uint32_t fix_ms;
+    uint16_t leg_idx;
+    double north_m;
+    double east_m;
+    double heading_rad;
+    double bank_deg;
+    double bank_cmd_deg;
+    double bank_step_deg;
+    double vel_n;
+    double vel_e;
+    double dt_s;
+    double xtrack_mean;
+    int8_t result;
+
+    memset(leg_stat, 0, sizeof(leg_stat));
+    memset(&nmea, 0, sizeof(nmea));
+
+    nmea.gpgga.fix_status = 1;
+    nmea.gprmc.fix_status = 1;
+    nmea.gprmc.nav_status = 1;
+
+    if(Mission_Start(0) != 0)
+        return -1;
+
+    north_m = -50.0;
+    east_m = -80.0;
+    heading_rad = MATH_DEG2RAD(90.0);
+    bank_deg = 0.0;
+    fix_ms = 0;
+    dt_s = L1TEST_CTRL_PERIOD_MS * 0.001;
+    bank_step_deg = L1TEST_ROLL_RATE_DPS * dt_s;
+
+    for(time_ms = 0; time_ms < L1TEST_TIMEOUT_MS && Mission_IsActive(); time_ms += L1TEST_CTRL_PERIOD_MS){
+
+        vel_n = L1TEST_AIRSPEED_MS * cos(heading_rad) + L1TEST_WIND_N_MS;
+        vel_e = L1TEST_AIRSPEED_MS * sin(heading_rad) + L1TEST_WIND_E_MS;
+
+        if(time_ms % L1TEST_FIX_PERIOD_MS == 0){
+            L1Test_ToCoord(p_origin, north_m, east_m, &nmea.gpgga.coord);
+            nmea.gprmc.gnd_speed_MS = sqrt(vel_n * vel_n + vel_e * vel_e);
+            nmea.gprmc.COG_degrees = fmod(MATH_RAD2DEG(atan2(vel_e, vel_n)) + 360.0, 360.0);
+            Mission_UpdateFix(&nmea);
+            fix_ms = time_ms;
+        }
+
+        bank_cmd_deg = 0.0;
+        leg_idx = Mission_GetActiveIdx();
+
+        if(Mission_UpdateGuidance(time_ms - fix_ms, &guide) == 0){
+
+            bank_cmd_deg = guide.bank_angle;
+
+            if(fabs(guide.xtrack_m) > leg_stat[leg_idx].overshoot)
+                leg_stat[leg_idx].overshoot = fabs(guide.xtrack_m);
+
+            if(leg_idx > 0 && guide.along_m >= L1TEST_SETTLE_METERS && guide.is_leg_done == false){
+                leg_stat[leg_idx].xtrack_sum += fabs(guide.xtrack_m);
+                leg_stat[leg_idx].sample_cnt++;
+                if(fabs(guide.xtrack_m) > leg_stat[leg_idx].xtrack_peak)
+                    leg_stat[leg_idx].xtrack_peak = fabs(guide.xtrack_m);
+            }
+
+            if(guide.is_leg_done == true){
+                leg_stat[leg_idx].done_ms = time_ms;
+                Mission_Advance();
+            }
+        }
+
+        /* Roll rate limit, then coordinated turn */
+        bank_deg += fmax(-bank_step_deg, fmin(bank_cmd_deg - bank_deg, bank_step_deg));
+        heading_rad += L1TEST_GRAVITY_MS2 * tan(MATH_DEG2RAD(bank_deg)) / L1TEST_AIRSPEED_MS * dt_s;
+
+        north_m += vel_n * dt_s;
+        east_m += vel_e * dt_s;
+    }
+
+    result = 0;
+
+    for(leg_idx = 0; leg_idx < L1TEST_WPT_NUM; leg_idx++){
+
+        if(leg_stat[leg_idx].done_ms == 0){
+            printf("leg %u: not completed\n", leg_idx);
+            result = -1;
+            continue;
+        }
+
+        if(leg_idx == 0){
+            printf("leg %u: done at %5.1f s (track capture)\n", leg_idx, leg_stat[leg_idx].done_ms * 0.001);
+            continue;
+        }
+
+        xtrack_mean = (leg_stat[leg_idx].sample_cnt != 0)
+                      ? leg_stat[leg_idx].xtrack_sum / leg_stat[leg_idx].sample_cnt : 0.0;
+
+        printf("leg %u: done at %5.1f s, turn overshoot %.1f m, cross-track mean %.2f m, peak %.2f m\n",
+               leg_idx, leg_stat[leg_idx].done_ms * 0.001, leg_stat[leg_idx].overshoot,
+               xtrack_mean, leg_stat[leg_idx].xtrack_peak);
+
+        if(leg_stat[leg_idx].sample_cnt == 0
+           || xtrack_mean > L1TEST_XTRACK_MEAN_MAX
+           || leg_stat[leg_idx].xtrack_peak > L1TEST_XTRACK_PEAK_MAX){
+            result = -1;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * L1Test_Bench - Function to measure host time of navigation calculations.
+ *
+ * @param   [in]        *p_origin       Mission origin.
+ *
+ * @return  [none]
+ *
+ */
+static void L1Test_Bench(GPS_COORD_POINT *p_origin)
+{
+    std::chrono::steady_clock::time_point start;
+    GPS_NMEA_REPORT nmea;
+    GPS_COORD_POINT wpt;
+    MISSION_GUIDANCE guide;
+    double nav_ns;
+    double fix_ns;
+    double guide_ns;
+    uint32_t loop;
+
+    memset(&nmea, 0, sizeof(nmea));
+
+    nmea.gpgga.fix_status = 1;
+    nmea.gprmc.fix_status = 1;
+    nmea.gprmc.nav_status = 1;
+    nmea.gprmc.gnd_speed_MS = L1TEST_AIRSPEED_MS;
+    nmea.gprmc.COG_degrees = 10.0;
+
+    L1Test_ToCoord(p_origin, 150.0, 20.0, &nmea.gpgga.coord);
+    L1Test_ToCoord(p_origin, L1Test_Square[0][0], L1Test_Square[0][1], &wpt);
+
+    if(Mission_Start(0) != 0 || Mission_UpdateFix(&nmea) != 0)
+        return;
+
+    /* Before: bearing and distance to waypoint, per fix */
+    start = std::chrono::steady_clock::now();
+    for(loop = 0; loop < L1TEST_BENCH_LOOPS; loop++){
+        nmea.gpgga.coord.LAT_DD += 1e-7;
+        L1Test_Sink = L1Test_NavBearingDistance(&nmea.gpgga.coord, &wpt);
+    }
+    nav_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count()
+             / L1TEST_BENCH_LOOPS;
+
+    /* After: local frame fix and velocity, per fix */
+    start = std::chrono::steady_clock::now();
+    for(loop = 0; loop < L1TEST_BENCH_LOOPS; loop++){
+        nmea.gprmc.COG_degrees += 1e-4;
+        Mission_UpdateFix(&nmea);
+    }
+    fix_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count()
+             / L1TEST_BENCH_LOOPS;
+
+    /* After: L1 guidance, per control cycle */
+    start = std::chrono::steady_clock::now();
+    for(loop = 0; loop < L1TEST_BENCH_LOOPS; loop++){
+        Mission_UpdateGuidance(loop % L1TEST_FIX_PERIOD_MS, &guide);
+        L1Test_Sink = guide.bank_angle;
+    }
+    guide_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count()
+               / L1TEST_BENCH_LOOPS;
+
+    printf("host ns/call: wpt bearing+distance %.1f, Mission_UpdateFix %.1f, Mission_UpdateGuidance %.1f\n",
+           nav_ns, fix_ns, guide_ns);
+    printf("host ns/s at %u ms cycle, %u ms fix: bearing %.0f, L1 %.0f\n",
+           L1TEST_CTRL_PERIOD_MS, L1TEST_FIX_PERIOD_MS,
+           nav_ns * (1000 / L1TEST_FIX_PERIOD_MS),
+           fix_ns * (1000 / L1TEST_FIX_PERIOD_MS) + guide_ns * (1000 / L1TEST_CTRL_PERIOD_MS));
+
+    Mission_Stop();
+}
+
+/**
+ * L1Test_NavBearingDistance - Function to calculate waypoint bearing and
+ *                             distance as GPS_UpdateNav() does on every fix.
+ *
+ * Same formulas as GPS_CalInitTrueBearingAngle() and GPS_CalApproxDistance()
+ * of gps.cpp, which can't be built on host.
+ *
+ * @param   [in]        *p_src          Current position.
+ * @param   [in]        *p_dest         Waypoint.
+ *
+ * @return  [float]     Sum of bearing and distance, keeps both results used.
+ *
+ */
+static float L1Test_NavBearingDistance(GPS_COORD_POINT *p_src, GPS_COORD_POINT *p_dest)
+{
+    float long_delta_rad;
+    float desc_lat_rad;
+    float src_lat_rad;
+    float x;
+    float y;
+    float bearing;
+    float distance;
+
+    long_delta_rad = MATH_DEG2RAD((p_dest->LONG_DD - p_src->LONG_DD));
+    desc_lat_rad = MATH_DEG2RAD(p_dest->LAT_DD);
+    src_lat_rad = MATH_DEG2RAD(p_src->LAT_DD);
+
+    /* GPS_CalInitTrueBearingAngle() */
+    y = sin(long_delta_rad) * cos(desc_lat_rad);
+    x = cos(src_lat_rad) * sin(desc_lat_rad) - sin(src_lat_rad) * cos(desc_lat_rad) * cos(long_delta_rad);
+
+    bearing = MATH_RAD2DEG(atan2(y, x));
+    if(bearing < 0.0)
+        bearing += 360.0;
+
+    /* GPS_CalApproxDistance() */
+    x = long_delta_rad * cos((desc_lat_rad + src_lat_rad) * 0.5);
+    y = desc_lat_rad - src_lat_rad;
+    distance = Math_FastSqrt((x * x + y * y)) * GPS_EARTH_RADIUS_METERS;
+
+    return bearing + distance;
+}
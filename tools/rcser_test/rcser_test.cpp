@@ -0,0 +1,349 @@
+/**
+ *******************************************************************************
+ *      ______  _   __  ______  ____     ______        ___    ______   ____
+ *     / __  / / \ / / / ____/ / __ \   /  ___/       /  /   /_   _/  / __ \
+ *    / /_/ / /   \ / / ____/ /  -- /  /  /__   __   /  /__  _/  /_  / __ <
+ *   /_____/ /_/ \_/ /_____/ /__/ \_\ /_____/  /_/  /_____/ /_____/ /_____/
+ *
+ *     An amateur remote control software library. Use at your own risk.
+ *
+ * @file    rcser_test.cpp
+ * @brief   Host test of serial RC receiver (SBUS / IBUS) decoder, feeds
+ *          captured receiver byte streams to rc_serial.cpp and checks the
+ *          decoded channels and counters.
+ *
+ *          Capture file is a text file:
+ *              # comment
+ *              proto sbus|ibus
+ *              0F E0 03 ...            received bytes, hex
+ *              expect frm 3 err 0 lost 0 failsafe 0 flags 0x00
+ *              expect ch 3000 3000 ... channels from CH1 (Timer1 ticks)
+ *
+ *          Counters are totals since start of the capture, only listed
+ *          items are checked. Every capture is decoded in chunks of 1, 7
+ *          and 64 bytes, same as reading UART0 RX FIFO in
+ *          RCIN_ReadChannels(), results must not depend on chunk size.
+ * @author  Y.S.Kuo in Hsinchu
+ *******************************************************************************
+ */
+
+/*
+ * Build:
+ *      g++ -std=c++11 -Wall -DF_CPU=16000000UL -I../../OneRCFW/libraries/OneRCLib \
+ *          -o rcser_test rcser_test.cpp ../../OneRCFW/libraries/OneRCLib/rc_serial.cpp
+ *
+ * Usage:
+ *      rcser_test sbus_capture.txt ibus_capture.txt
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rc_serial.h"
+
+
+/*
+ *******************************************************************************
+ * Constant value definition
+ *******************************************************************************
+ */
+
+#define RCSER_TEST_LINE_SIZE        256
+#define RCSER_TEST_SEGMENT_SIZE     1024    /* Max bytes between expect lines */
+
+
+/*
+ *******************************************************************************
+ * Global variables
+ *******************************************************************************
+ */
+
+/* Bytes per RCSER_Parse() call, Eg. received bytes of one RX FIFO read */
+static const uint8_t RcserTest_ChunkSizes[] = {1, 7, 64};
+
+
+/*
+ *******************************************************************************
+ * Private functions declaration
+ *******************************************************************************
+ */
+
+static int8_t RcserTest_RunFile(const char *p_path, uint8_t chunk_size);
+static uint16_t RcserTest_Feed(RCSER_DATA *p_rs, const uint8_t *p_data, uint16_t bytes,
+                               uint8_t chunk_size);
+static int8_t RcserTest_Expect(RCSER_DATA *p_rs, char *p_items, const char *p_path,
+                               unsigned line_num);
+
+
+/*
+ *******************************************************************************
+ * Public functions
+ *******************************************************************************
+ */
+
+int main(int argc, char *argv[])
+{
+    unsigned fail_cnt;
+    unsigned size_idx;
+    int arg_idx;
+
+    if(argc < 2){
+        fprintf(stderr, "Usage: %s capture.txt [capture.txt ...]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    fail_cnt = 0;
+
+    for(arg_idx = 1; arg_idx < argc; arg_idx++){
+        for(size_idx = 0; size_idx < sizeof(RcserTest_ChunkSizes); size_idx++){
+
+            if(RcserTest_RunFile(argv[arg_idx], RcserTest_ChunkSizes[size_idx]) == 0){
+                printf("PASS %s (chunk %u)\n", argv[arg_idx], RcserTest_ChunkSizes[size_idx]);
+            }
+            else{
+                printf("FAIL %s (chunk %u)\n", argv[arg_idx], RcserTest_ChunkSizes[size_idx]);
+                fail_cnt++;
+            }
+        }
+    }
+
+    return (fail_cnt == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+
+/*
+ *******************************************************************************
+ * Private functions
+ *******************************************************************************
+ */
+
+/**
+ * RcserTest_RunFile - Function to decode a capture file and check all
+ *                     expect lines.
+ *
+ * @param   [in]        *p_path         Capture file.
+ * @param   [in]        chunk_size      Bytes per RCSER_Parse() call.
+ *
+ * @return  [int8_t]    Function executing result.
+ * @retval  [0]         All expect lines are matched.
+ * @retval  [-1]        Fail.
+ *
+ */
+static int8_t RcserTest_RunFile(const char *p_path, uint8_t chunk_size)
+{
+    static uint8_t segment[RCSER_TEST_SEGMENT_SIZE];
+    char line[RCSER_TEST_LINE_SIZE];
+    char *p_token;
+    char *p_end;
+    FILE *p_file;
+    RCSER_DATA rs;
+    bool is_init;
+    uint16_t bytes;
+    uint32_t frm_cnt;
+    unsigned long value;
+    unsigned line_num;
+    int8_t result;
+
+    p_file = fopen(p_path, "r");
+
+    if(p_file == NULL){
+        fprintf(stderr, "%s: can't open\n", p_path);
+        return -1;
+    }
+
+    is_init = false;
+    bytes = 0;
+    frm_cnt = 0;
+    line_num = 0;
+    result = 0;
+
+    while(result == 0 && fgets(line, sizeof(line), p_file) != NULL){
+
+        line_num++;
+
+        p_token = strtok(line, " \t\r\n");
+
+        if(p_token == NULL || p_token[0] == '#')
+            continue;
+
+        if(strcmp(p_token, "proto") == 0){
+
+            p_token = strtok(NULL, " \t\r\n");
+
+            if(p_token != NULL && strcmp(p_token, "sbus") == 0)
+                RCSER_Init(&rs, RCSER_PROTO_SBUS);
+            else if(p_token != NULL && strcmp(p_token, "ibus") == 0)
+                RCSER_Init(&rs, RCSER_PROTO_IBUS);
+            else{
+                fprintf(stderr, "%s:%u: unknown protocol\n", p_path, line_num);
+                result = -1;
+            }
+
+            is_init = true;
+            continue;
+        }
+
+        if(is_init == false){
+            fprintf(stderr, "%s:%u: proto is not set\n", p_path, line_num);
+            result = -1;
+            continue;
+        }
+
+        if(strcmp(p_token, "expect") == 0){
+
+            frm_cnt += RcserTest_Feed(&rs, segment, bytes, chunk_size);
+            bytes = 0;
+
+            /* Returned frames must match frame counter */
+            if(frm_cnt != rs.frm_cnt){
+                fprintf(stderr, "%s:%u: RCSER_Parse() returned %lu frames, frm_cnt %u\n",
+                        p_path, line_num, (unsigned long)frm_cnt, rs.frm_cnt);
+                result = -1;
+                continue;
+            }
+
+            result = RcserTest_Expect(&rs, strtok(NULL, "\r\n"), p_path, line_num);
+            continue;
+        }
+
+        /* Received bytes */
+        for(; p_token != NULL; p_token = strtok(NULL, " \t\r\n")){
+
+            value = strtoul(p_token, &p_end, 16);
+
+            if(*p_end != 0 || value > 0xFF || bytes >= sizeof(segment)){
+                fprintf(stderr, "%s:%u: invalid byte \"%s\"\n", p_path, line_num, p_token);
+                result = -1;
+                break;
+            }
+
+            segment[bytes++] = (uint8_t)value;
+        }
+    }
+
+    fclose(p_file);
+
+    return result;
+}
+
+/**
+ * RcserTest_Feed - Function to decode received bytes in chunks.
+ *
+ * @param   [in/out]    *p_rs           Decoder.
+ * @param   [in]        *p_data         Received bytes.
+ * @param   [in]        bytes           Number of received bytes.
+ * @param   [in]        chunk_size      Bytes per RCSER_Parse() call.
+ *
+ * @return  [uint16_t]  Number of decoded frames.
+ *
+ */
+static uint16_t RcserTest_Feed(RCSER_DATA *p_rs, const uint8_t *p_data, uint16_t bytes,
+                               uint8_t chunk_size)
+{
+    uint16_t frm_cnt;
+    uint8_t chunk;
+
+    frm_cnt = 0;
+
+    while(bytes != 0){
+
+        chunk = (bytes < chunk_size) ? bytes : chunk_size;
+
+        frm_cnt += RCSER_Parse(p_rs, p_data, chunk);
+
+        p_data += chunk;
+        bytes -= chunk;
+    }
+
+    return frm_cnt;
+}
+
+/**
+ * RcserTest_Expect - Function to check decoder state with items of an
+ *                    expect line.
+ *
+ * @param   [in]        *p_rs           Decoder.
+ * @param   [in]        *p_items        Items, "NAME VALUE ..." or "ch VALUE ...".
+ * @param   [in]        *p_path         Capture file, for message.
+ * @param   [in]        line_num        Line number, for message.
+ *
+ * @return  [int8_t]    Function executing result.
+ * @retval  [0]         All items are matched.
+ * @retval  [-1]        Fail.
+ *
+ */
+static int8_t RcserTest_Expect(RCSER_DATA *p_rs, char *p_items, const char *p_path,
+                               unsigned line_num)
+{
+    char *p_name;
+    char *p_value;
+    unsigned long expect;
+    unsigned long actual;
+    uint8_t ch_idx;
+
+    p_name = (p_items != NULL) ? strtok(p_items, " \t") : NULL;
+
+    if(p_name != NULL && strcmp(p_name, "ch") == 0){
+
+        ch_idx = 0;
+
+        while((p_value = strtok(NULL, " \t")) != NULL){
+
+            expect = strtoul(p_value, NULL, 0);
+
+            if(ch_idx >= p_rs->ch_num){
+                fprintf(stderr, "%s:%u: only %u channels\n", p_path, line_num, p_rs->ch_num);
+                return -1;
+            }
+
+            if(p_rs->ch_ticks[ch_idx] != expect){
+                fprintf(stderr, "%s:%u: CH%u %u, expect %lu\n", p_path, line_num,
+                        ch_idx + 1, p_rs->ch_ticks[ch_idx], expect);
+                return -1;
+            }
+
+            ch_idx++;
+        }
+
+        return 0;
+    }
+
+    while(p_name != NULL){
+
+        p_value = strtok(NULL, " \t");
+
+        if(p_value == NULL){
+            fprintf(stderr, "%s:%u: no value of %s\n", p_path, line_num, p_name);
+            return -1;
+        }
+
+        expect = strtoul(p_value, NULL, 0);
+
+        if(strcmp(p_name, "frm") == 0)
+            actual = p_rs->frm_cnt;
+        else if(strcmp(p_name, "err") == 0)
+            actual = p_rs->err_cnt;
+        else if(strcmp(p_name, "lost") == 0)
+            actual = p_rs->lost_cnt;
+        else if(strcmp(p_name, "failsafe") == 0)
+            actual = p_rs->failsafe_cnt;
+        else if(strcmp(p_name, "flags") == 0)
+            actual = p_rs->flags;
+        else{
+            fprintf(stderr, "%s:%u: unknown item %s\n", p_path, line_num, p_name);
+            return -1;
+        }
+
+        if(actual != expect){
+            fprintf(stderr, "%s:%u: %s %lu, expect %lu\n", p_path, line_num,
+                    p_name, actual, expect);
+            return -1;
+        }
+
+        p_name = strtok(NULL, " \t");
+    }
+
+    return 0;
+}